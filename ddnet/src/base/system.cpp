@@ -45,6 +45,14 @@
 
 #include <dirent.h>
 
+#if defined(CONF_PLATFORM_LINUX) && __has_include(<linux/io_uring.h>)
+#define CONF_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
 #if defined(CONF_PLATFORM_MACOS)
 // some lock and pthread functions are already defined in headers
 // included from Carbon.h
@@ -493,7 +501,198 @@ IOHANDLE io_current_exe()
 }
 
 #define ASYNC_BUFSIZE (8 * 1024)
-#define ASYNC_LOCAL_BUFSIZE (64 * 1024)
+
+#if defined(CONF_IO_URING)
+// Minimal io_uring submission and completion queue for the ASYNCIO thread,
+// using the system calls directly to avoid depending on liburing. Writes
+// are submitted straight from the ring buffer of the ASYNCIO, which is
+// registered with the kernel if the memory lock limit allows it. They go to
+// the current file position like regular writes, so other writers sharing
+// the open file, e.g. stderr redirected to the same log, do not overwrite
+// them.
+class CAioUring
+{
+	enum
+	{
+		QUEUE_ENTRIES = 4,
+	};
+
+	int m_Fd = -1;
+	void *m_pSqRing = MAP_FAILED;
+	size_t m_SqRingSize = 0;
+	void *m_pCqRing = MAP_FAILED;
+	size_t m_CqRingSize = 0;
+	io_uring_sqe *m_pSqes = (io_uring_sqe *)MAP_FAILED;
+	size_t m_SqesSize = 0;
+
+	unsigned *m_pSqTail;
+	unsigned *m_pSqMask;
+	unsigned *m_pSqArray;
+	unsigned *m_pCqHead;
+	unsigned *m_pCqTail;
+	unsigned *m_pCqMask;
+	io_uring_cqe *m_pCqes;
+
+	// a new buffer can reuse the address of a freed one, so buffers are
+	// told apart by their generation
+	bool m_BufferRegistered = false;
+	unsigned m_RegisteredGeneration = 0;
+	bool m_CanRegister = true;
+
+	bool RegisterBuffer(const unsigned char *pBuffer, unsigned Size, unsigned Generation)
+	{
+		if(m_BufferRegistered && m_RegisteredGeneration == Generation)
+			return true;
+		if(m_BufferRegistered)
+		{
+			syscall(__NR_io_uring_register, m_Fd, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+			m_BufferRegistered = false;
+		}
+		if(!m_CanRegister)
+			return false;
+		iovec Buffer = {(void *)pBuffer, Size};
+		if(syscall(__NR_io_uring_register, m_Fd, IORING_REGISTER_BUFFERS, &Buffer, 1) < 0)
+		{
+			// most likely RLIMIT_MEMLOCK, do not try again for every batch
+			m_CanRegister = false;
+			return false;
+		}
+		m_BufferRegistered = true;
+		m_RegisteredGeneration = Generation;
+		return true;
+	}
+
+public:
+	~CAioUring()
+	{
+		if(m_pSqes != MAP_FAILED)
+			munmap(m_pSqes, m_SqesSize);
+		if(m_pCqRing != MAP_FAILED && m_pCqRing != m_pSqRing)
+			munmap(m_pCqRing, m_CqRingSize);
+		if(m_pSqRing != MAP_FAILED)
+			munmap(m_pSqRing, m_SqRingSize);
+		if(m_Fd >= 0)
+			close(m_Fd);
+	}
+
+	bool Init()
+	{
+		io_uring_params Params;
+		mem_zero(&Params, sizeof(Params));
+		m_Fd = syscall(__NR_io_uring_setup, QUEUE_ENTRIES, &Params);
+		if(m_Fd < 0)
+			return false;
+		if(!(Params.features & IORING_FEAT_RW_CUR_POS))
+			return false;
+
+		m_SqRingSize = Params.sq_off.array + Params.sq_entries * sizeof(unsigned);
+		m_CqRingSize = Params.cq_off.cqes + Params.cq_entries * sizeof(io_uring_cqe);
+		const bool SingleMmap = Params.features & IORING_FEAT_SINGLE_MMAP;
+		if(SingleMmap)
+			m_SqRingSize = m_CqRingSize = std::max(m_SqRingSize, m_CqRingSize);
+
+		m_pSqRing = mmap(nullptr, m_SqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_Fd, IORING_OFF_SQ_RING);
+		if(m_pSqRing == MAP_FAILED)
+			return false;
+		m_pCqRing = SingleMmap ? m_pSqRing : mmap(nullptr, m_CqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_Fd, IORING_OFF_CQ_RING);
+		if(m_pCqRing == MAP_FAILED)
+			return false;
+		m_SqesSize = Params.sq_entries * sizeof(io_uring_sqe);
+		m_pSqes = (io_uring_sqe *)mmap(nullptr, m_SqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_Fd, IORING_OFF_SQES);
+		if(m_pSqes == MAP_FAILED)
+			return false;
+
+		unsigned char *pSq = (unsigned char *)m_pSqRing;
+		m_pSqTail = (unsigned *)(pSq + Params.sq_off.tail);
+		m_pSqMask = (unsigned *)(pSq + Params.sq_off.ring_mask);
+		m_pSqArray = (unsigned *)(pSq + Params.sq_off.array);
+		unsigned char *pCq = (unsigned char *)m_pCqRing;
+		m_pCqHead = (unsigned *)(pCq + Params.cq_off.head);
+		m_pCqTail = (unsigned *)(pCq + Params.cq_off.tail);
+		m_pCqMask = (unsigned *)(pCq + Params.cq_off.ring_mask);
+		m_pCqes = (io_uring_cqe *)(pCq + Params.cq_off.cqes);
+		return true;
+	}
+
+	// Writes the segments in order at the current file position. The
+	// segments must lie inside the given buffer, whose generation changes
+	// whenever it is replaced. Returns the number of bytes written, which
+	// is less than requested on short writes, or -1 if nothing could be
+	// written.
+	int64_t Write(int FileFd, const unsigned char *pBuffer, unsigned BufferSize, unsigned BufferGeneration, const iovec *pSegments, int NumSegments)
+	{
+		dbg_assert(NumSegments > 0 && NumSegments <= QUEUE_ENTRIES, "invalid number of segments");
+		const bool Fixed = RegisterBuffer(pBuffer, BufferSize, BufferGeneration);
+		const int NumEntries = Fixed ? NumSegments : 1;
+
+		unsigned Tail = *m_pSqTail;
+		for(int i = 0; i < NumEntries; i++)
+		{
+			const unsigned Index = Tail & *m_pSqMask;
+			io_uring_sqe *pSqe = &m_pSqes[Index];
+			mem_zero(pSqe, sizeof(*pSqe));
+			pSqe->fd = FileFd;
+			pSqe->off = (uint64_t)-1; // current file position, which the write advances
+			pSqe->user_data = i;
+			if(Fixed)
+			{
+				// later segments are only written if the previous ones were written completely
+				pSqe->opcode = IORING_OP_WRITE_FIXED;
+				pSqe->addr = (uintptr_t)pSegments[i].iov_base;
+				pSqe->len = pSegments[i].iov_len;
+				pSqe->buf_index = 0;
+				pSqe->flags = i + 1 < NumEntries ? IOSQE_IO_LINK : 0;
+			}
+			else
+			{
+				pSqe->opcode = IORING_OP_WRITEV;
+				pSqe->addr = (uintptr_t)pSegments;
+				pSqe->len = NumSegments;
+			}
+			m_pSqArray[Index] = Index;
+			Tail++;
+		}
+		std::atomic_ref<unsigned>(*m_pSqTail).store(Tail, std::memory_order_release);
+
+		int aResults[QUEUE_ENTRIES];
+		int NumToSubmit = NumEntries;
+		int NumCompleted = 0;
+		while(NumCompleted < NumEntries)
+		{
+			const int Result = syscall(__NR_io_uring_enter, m_Fd, NumToSubmit, NumEntries - NumCompleted, IORING_ENTER_GETEVENTS, nullptr, 0);
+			if(Result < 0)
+			{
+				if(errno == EINTR)
+					continue;
+				return -1;
+			}
+			NumToSubmit = std::max(NumToSubmit - Result, 0);
+
+			unsigned Head = *m_pCqHead;
+			const unsigned CqTail = std::atomic_ref<unsigned>(*m_pCqTail).load(std::memory_order_acquire);
+			for(; Head != CqTail; Head++)
+			{
+				const io_uring_cqe *pCqe = &m_pCqes[Head & *m_pCqMask];
+				aResults[pCqe->user_data] = pCqe->res;
+				NumCompleted++;
+			}
+			std::atomic_ref<unsigned>(*m_pCqHead).store(Head, std::memory_order_release);
+		}
+
+		int64_t Written = 0;
+		for(int i = 0; i < NumEntries; i++)
+		{
+			// linked writes after a short or failed write are canceled
+			if(aResults[i] < 0)
+				return Written > 0 ? Written : -1;
+			Written += aResults[i];
+			if(Fixed && (size_t)aResults[i] < pSegments[i].iov_len)
+				break;
+		}
+		return Written;
+	}
+};
+#endif
 
 struct ASYNCIO
 {
@@ -507,6 +706,16 @@ struct ASYNCIO
 	unsigned int read_pos;
 	unsigned int write_pos;
 
+	// The thread writes directly from the buffer without holding the lock.
+	// A writer that grows the buffer meanwhile hands the old one to the
+	// thread, which frees it once the write has finished.
+	unsigned char *in_flight_buffer;
+	unsigned char *retired_buffer;
+	unsigned buffer_generation; // increases whenever the buffer is replaced
+
+	int64_t queued_since;
+	ASYNCIO_STATS stats;
+
 	int error;
 	unsigned char finish;
 	unsigned char refcount;
@@ -559,17 +768,38 @@ static void aio_handle_free_and_unlock(ASYNCIO *aio) RELEASE(aio->lock)
 	}
 }
 
+// Writes the queued segments with the blocking file functions, used if
+// io_uring is not available
+static int64_t aio_write_buffers(ASYNCIO *aio, const struct BUFFERS *buffers)
+{
+	int64_t written = io_write(aio->io, buffers->buf1, buffers->len1);
+	if(buffers->buf2 && written == buffers->len1)
+	{
+		written += io_write(aio->io, buffers->buf2, buffers->len2);
+	}
+	io_flush(aio->io);
+	return io_error(aio->io) ? -1 : written;
+}
+
 static void aio_thread(void *user)
 {
 	ASYNCIO *aio = (ASYNCIO *)user;
 
+#if defined(CONF_IO_URING)
+	// The file descriptor is written directly, so nothing must be left in
+	// the buffer of the stdio handle.
+	CAioUring uring;
+	const int uring_fd = io_flush(aio->io) == 0 ? fileno((FILE *)aio->io) : -1;
+	const bool use_uring = uring_fd >= 0 && uring.Init();
+#endif
+
 	aio->lock.lock();
+#if defined(CONF_IO_URING)
+	aio->stats.io_uring = use_uring;
+#endif
 	while(true)
 	{
 		struct BUFFERS buffers;
-		int result_io_error;
-		unsigned char local_buffer[ASYNC_LOCAL_BUFSIZE];
-		unsigned int local_buffer_len = 0;
 
 		if(aio->read_pos == aio->write_pos)
 		{
@@ -589,33 +819,66 @@ static void aio_thread(void *user)
 		}
 
 		buffer_ptrs(aio, &buffers);
-		if(buffers.buf1)
-		{
-			if(buffers.len1 > sizeof(local_buffer) - local_buffer_len)
-			{
-				buffers.len1 = sizeof(local_buffer) - local_buffer_len;
-			}
-			mem_copy(local_buffer + local_buffer_len, buffers.buf1, buffers.len1);
-			local_buffer_len += buffers.len1;
-			if(buffers.buf2)
-			{
-				if(buffers.len2 > sizeof(local_buffer) - local_buffer_len)
-				{
-					buffers.len2 = sizeof(local_buffer) - local_buffer_len;
-				}
-				mem_copy(local_buffer + local_buffer_len, buffers.buf2, buffers.len2);
-				local_buffer_len += buffers.len2;
-			}
-		}
-		aio->read_pos = (aio->read_pos + buffers.len1 + buffers.len2) % aio->buffer_size;
+		const unsigned int batch_len = buffers.len1 + buffers.len2;
+		const int64_t batch_queued = aio->queued_since;
+		aio->queued_since = 0;
+		aio->in_flight_buffer = aio->buffer;
+#if defined(CONF_IO_URING)
+		const unsigned char *batch_buffer = aio->buffer;
+		const unsigned int batch_buffer_size = aio->buffer_size;
+		const unsigned batch_buffer_generation = aio->buffer_generation;
+#endif
 		aio->lock.unlock();
 
-		io_write(aio->io, local_buffer, local_buffer_len);
-		io_flush(aio->io);
-		result_io_error = io_error(aio->io);
+		int64_t written;
+#if defined(CONF_IO_URING)
+		if(use_uring)
+		{
+			const iovec segments[2] = {{buffers.buf1, buffers.len1}, {buffers.buf2, buffers.len2}};
+			written = uring.Write(uring_fd, batch_buffer, batch_buffer_size, batch_buffer_generation, segments, buffers.buf2 ? 2 : 1);
+		}
+		else
+#endif
+		{
+			written = aio_write_buffers(aio, &buffers);
+		}
+		const int64_t now = time_get();
 
 		aio->lock.lock();
-		aio->error = result_io_error;
+		aio->in_flight_buffer = nullptr;
+		if(aio->retired_buffer)
+		{
+			free(aio->retired_buffer);
+			aio->retired_buffer = nullptr;
+		}
+
+		// data that could not be written is dropped like before, the error
+		// is reported through aio_error
+		unsigned int done = batch_len;
+		if(written < 0)
+		{
+			aio->error = 1;
+		}
+		else if(written > 0 && written < batch_len)
+		{
+			// short write, retry the rest
+			done = written;
+			aio->queued_since = batch_queued;
+		}
+		else if(written == 0)
+		{
+			aio->error = 1;
+		}
+		aio->read_pos = (aio->read_pos + done) % aio->buffer_size;
+
+		if(written > 0)
+		{
+			aio->stats.written_bytes += written;
+		}
+		aio->stats.queued_bytes -= done;
+		aio->stats.writes++;
+		aio->stats.max_latency = std::max(aio->stats.max_latency, now - batch_queued);
+		aio->stats.total_latency += now - batch_queued;
 	}
 }
 
@@ -640,6 +903,11 @@ ASYNCIO *aio_new(IOHANDLE io)
 	aio->buffer_size = ASYNC_BUFSIZE;
 	aio->read_pos = 0;
 	aio->write_pos = 0;
+	aio->in_flight_buffer = nullptr;
+	aio->retired_buffer = nullptr;
+	aio->buffer_generation = 0;
+	aio->queued_since = 0;
+	mem_zero(&aio->stats, sizeof(aio->stats));
 	aio->error = 0;
 	aio->finish = ASYNCIO_RUNNING;
 	aio->refcount = 2;
@@ -689,6 +957,16 @@ void aio_unlock(ASYNCIO *aio) RELEASE(aio->lock)
 
 void aio_write_unlocked(ASYNCIO *aio, const void *buffer, unsigned size)
 {
+	if(size == 0)
+	{
+		return;
+	}
+	if(aio->queued_since == 0)
+	{
+		aio->queued_since = time_get();
+	}
+	aio->stats.queued_bytes += size;
+
 	unsigned int remaining;
 	remaining = aio->buffer_size - buffer_len(aio);
 
@@ -729,9 +1007,20 @@ void aio_write_unlocked(ASYNCIO *aio, const void *buffer, unsigned size)
 		mem_copy(next_buffer + next_len, buffer, size);
 		next_len += size;
 
-		free(aio->buffer);
+		if(aio->buffer == aio->in_flight_buffer)
+		{
+			// The thread is still writing from the old buffer. It can only
+			// have one write in flight, so at most one buffer is retired.
+			dbg_assert(aio->retired_buffer == nullptr, "retired buffer not freed");
+			aio->retired_buffer = aio->buffer;
+		}
+		else
+		{
+			free(aio->buffer);
+		}
 		aio->buffer = next_buffer;
 		aio->buffer_size = next_size;
+		aio->buffer_generation++;
 		aio->read_pos = 0;
 		aio->write_pos = next_len;
 	}
@@ -766,6 +1055,12 @@ int aio_error(ASYNCIO *aio)
 	return aio->error;
 }
 
+void aio_stats(ASYNCIO *aio, ASYNCIO_STATS *stats)
+{
+	CLockScope ls(aio->lock);
+	*stats = aio->stats;
+}
+
 void aio_close(ASYNCIO *aio)
 {
 	{
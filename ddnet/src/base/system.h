@@ -567,6 +567,59 @@ void aio_write_newline_unlocked(ASYNCIO *aio);
  */
 int aio_error(ASYNCIO *aio);
 
+/**
+ * Statistics of an `ASYNCIO` handle.
+ *
+ * @ingroup File-IO
+ *
+ * @see aio_stats
+ */
+typedef struct ASYNCIO_STATS
+{
+	/**
+	 * Number of bytes queued but not yet written.
+	 */
+	uint64_t queued_bytes;
+
+	/**
+	 * Number of bytes written to the file.
+	 */
+	uint64_t written_bytes;
+
+	/**
+	 * Number of batched writes done by the writer thread.
+	 */
+	uint64_t writes;
+
+	/**
+	 * Longest time between queueing data and writing it, in units of
+	 * @link time_freq @endlink.
+	 */
+	int64_t max_latency;
+
+	/**
+	 * Sum of the latencies of all writes, in units of
+	 * @link time_freq @endlink.
+	 */
+	int64_t total_latency;
+
+	/**
+	 * Whether the writes are submitted through io_uring instead of the
+	 * blocking file functions.
+	 */
+	bool io_uring;
+} ASYNCIO_STATS;
+
+/**
+ * Gets the statistics of the asynchronous writing.
+ *
+ * @ingroup File-IO
+ *
+ * @param aio Handle to the file.
+ * @param stats Pointer to the struct that receives the statistics.
+ */
+void aio_stats(ASYNCIO *aio, ASYNCIO_STATS *stats);
+
 /**
  * Queues file closing.
  *
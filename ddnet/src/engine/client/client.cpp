@@ -882,6 +882,13 @@ void CClient::RenderDebug()
 	str_format(aBuffer, sizeof(aBuffer), "Prediction time: %d ms", GetPredictionTime());
 	Graphics()->QuadsText(2, 2 + FontSize, FontSize, aBuffer);
 
+	const STextRenderStats TextStats = m_pTextRender->Stats();
+	str_format(aBuffer, sizeof(aBuffer), "Glyph misses: %d, pending: %d", TextStats.m_GlyphCacheMisses, TextStats.m_PendingGlyphs);
+	Graphics()->QuadsText(2, 2 + 2 * FontSize, FontSize, aBuffer);
+
+	str_format(aBuffer, sizeof(aBuffer), "Layout hits: %d/%d", TextStats.m_LayoutCacheHits, TextStats.m_LayoutCacheHits + TextStats.m_LayoutCacheMisses);
+	Graphics()->QuadsText(20.0f * FontSize, 2 + 2 * FontSize, FontSize, aBuffer);
+
 	str_format(aBuffer, sizeof(aBuffer), "FPS: %3d", round_to_int(1.0f / m_FrameTimeAverage));
 	Graphics()->QuadsText(20.0f * FontSize, 2, FontSize, aBuffer);
 
@@ -1057,6 +1064,8 @@ const char *CClient::ErrorString() const
 
 void CClient::Render()
 {
+	m_pTextRender->Update();
+
 	if(m_EditorActive)
 	{
 		m_pEditor->OnRender();
@@ -2427,8 +2436,11 @@ static TVersion ToVersion(char *pStr)
 
 void CClient::LoadDDNetInfo()
 {
-	const json_value *pDDNetInfo = m_ServerBrowser.LoadDDNetInfo();
+	ApplyDDNetInfo(m_ServerBrowser.LoadDDNetInfo());
+}
 
+void CClient::ApplyDDNetInfo(const json_value *pDDNetInfo)
+{
 	if(!pDDNetInfo)
 	{
 		m_InfoState = EInfoState::ERROR;
@@ -2903,7 +2915,7 @@ void CClient::Update()
 			else
 			{
 				log_debug("client/info", "Loading new DDNet info");
-				LoadDDNetInfo();
+				m_ServerBrowser.LoadDDNetInfoInBackground();
 			}
 
 			ResetDDNetInfoTask();
@@ -2915,6 +2927,12 @@ void CClient::Update()
 		}
 	}
 
+	const json_value *pDDNetInfo;
+	if(m_ServerBrowser.FinishLoadDDNetInfo(&pDDNetInfo))
+	{
+		ApplyDDNetInfo(pDDNetInfo);
+	}
+
 	if(State() == IClient::STATE_ONLINE)
 	{
 		if(!m_EditJobs.empty())
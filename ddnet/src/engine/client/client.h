@@ -389,6 +389,7 @@ public:
 	void RequestDDNetInfo() override;
 	void ResetDDNetInfoTask();
 	void LoadDDNetInfo();
+	void ApplyDDNetInfo(const json_value *pDDNetInfo);
 
 	bool IsSixup() const override { return m_Sixup; }
 
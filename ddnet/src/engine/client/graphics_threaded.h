@@ -948,6 +948,7 @@ public:
 
 	// simple uncompressed RGBA loaders
 	IGraphics::CTextureHandle LoadTexture(const char *pFilename, int StorageType, int Flags = 0) override;
+	IGraphics::CTextureHandle NullTexture() const override { return m_NullTexture; }
 	bool LoadPng(CImageInfo &Image, const char *pFilename, int StorageType) override;
 	bool LoadPng(CImageInfo &Image, const uint8_t *pData, size_t DataSize, const char *pContextName) override;
 
@@ -6,6 +6,7 @@
 #include "serverbrowser_ping_cache.h"
 
 #include <algorithm>
+#include <functional>
 #include <map>
 #include <set>
 #include <vector>
@@ -29,26 +30,33 @@
 #include <engine/http.h>
 #include <engine/storage.h>
 
-class CSortWrap
+static std::string LowercaseSearchKey(const char *pStr)
 {
-	typedef bool (CServerBrowser::*SortFunc)(int, int) const;
-	SortFunc m_pfnSort;
-	CServerBrowser *m_pThis;
-
-public:
-	CSortWrap(CServerBrowser *pServer, SortFunc Func) :
-		m_pfnSort(Func), m_pThis(pServer) {}
-	bool operator()(int a, int b) { return (g_Config.m_BrSortOrder ? (m_pThis->*m_pfnSort)(b, a) : (m_pThis->*m_pfnSort)(a, b)); }
-};
-
-static bool MatchesPart(const char *a, const char *b)
-{
-	return str_utf8_find_nocase(a, b) != nullptr;
+	// lowercase characters take at most 1.5 times the bytes of uppercase ones
+	std::string Lowercase(str_length(pStr) * 2 + 1, '\0');
+	str_utf8_tolower(pStr, Lowercase.data(), Lowercase.size());
+	Lowercase.resize(str_length(Lowercase.c_str()));
+	return Lowercase;
 }
 
-static bool MatchesExactly(const char *a, const char *b)
+// Sorts the indices by a key extracted once per server instead of looking up
+// the servers in every comparison, the order of equal keys is kept
+template<typename TKey, typename TKeyFunc, typename TLess>
+static void SortIndicesByKey(int *pIndices, int NumIndices, bool Reverse, TKeyFunc &&KeyFunc, TLess &&Less)
 {
-	return str_comp(a, &b[1]) == 0;
+	std::vector<std::pair<TKey, int>> vKeys;
+	vKeys.reserve(NumIndices);
+	for(int i = 0; i < NumIndices; i++)
+	{
+		vKeys.emplace_back(KeyFunc(pIndices[i]), pIndices[i]);
+	}
+	std::stable_sort(vKeys.begin(), vKeys.end(), [&](const std::pair<TKey, int> &Key1, const std::pair<TKey, int> &Key2) {
+		return Reverse ? Less(Key2.first, Key1.first) : Less(Key1.first, Key2.first);
+	});
+	for(int i = 0; i < NumIndices; i++)
+	{
+		pIndices[i] = vKeys[i].second;
+	}
 }
 
 CServerBrowser::CServerBrowser() :
@@ -344,72 +352,158 @@ int CServerBrowser::GetExtraToken(int Token)
 	return Token >> 8;
 }
 
-bool CServerBrowser::SortCompareName(int Index1, int Index2) const
+bool CServerBrowser::CSearchTerm::Matches(const char *pStr, const std::string &Lowercase) const
 {
-	CServerEntry *pIndex1 = m_ppServerlist[Index1];
-	CServerEntry *pIndex2 = m_ppServerlist[Index2];
-	//	make sure empty entries are listed last
-	return (pIndex1->m_GotInfo && pIndex2->m_GotInfo) || (!pIndex1->m_GotInfo && !pIndex2->m_GotInfo) ? str_comp(pIndex1->m_Info.m_aName, pIndex2->m_Info.m_aName) < 0 :
-													    pIndex1->m_GotInfo != 0;
+	if(m_IsExact)
+	{
+		return str_comp(pStr, m_Exact.c_str()) == 0;
+	}
+	return str_find(Lowercase.c_str(), m_Lowercase.c_str()) != nullptr;
 }
 
-bool CServerBrowser::SortCompareMap(int Index1, int Index2) const
+void CServerBrowser::ParseSearchTerms(const char *pStr, std::vector<CSearchTerm> &vTerms)
 {
-	CServerEntry *pIndex1 = m_ppServerlist[Index1];
-	CServerEntry *pIndex2 = m_ppServerlist[Index2];
-	return str_comp(pIndex1->m_Info.m_aMap, pIndex2->m_Info.m_aMap) < 0;
-}
+	vTerms.clear();
+	char aTerm[256];
+	char aTermTrimmed[256];
+	while((pStr = str_next_token(pStr, IServerBrowser::SEARCH_EXCLUDE_TOKEN, aTerm, sizeof(aTerm))))
+	{
+		str_copy(aTermTrimmed, str_utf8_skip_whitespaces(aTerm));
+		str_utf8_trim_right(aTermTrimmed);
 
-bool CServerBrowser::SortComparePing(int Index1, int Index2) const
-{
-	CServerEntry *pIndex1 = m_ppServerlist[Index1];
-	CServerEntry *pIndex2 = m_ppServerlist[Index2];
-	return pIndex1->m_Info.m_Latency < pIndex2->m_Info.m_Latency;
+		if(aTermTrimmed[0] == '\0')
+		{
+			continue;
+		}
+		CSearchTerm Term;
+		const int TermLen = str_length(aTermTrimmed);
+		Term.m_IsExact = aTermTrimmed[0] == '"' && aTermTrimmed[TermLen - 1] == '"';
+		if(Term.m_IsExact)
+		{
+			aTermTrimmed[TermLen - 1] = '\0';
+			Term.m_Exact = &aTermTrimmed[1];
+		}
+		else
+		{
+			Term.m_Lowercase = LowercaseSearchKey(aTermTrimmed);
+		}
+		vTerms.push_back(std::move(Term));
+	}
 }
 
-bool CServerBrowser::SortCompareGametype(int Index1, int Index2) const
+void CServerBrowser::UpdateSearchTerms()
 {
-	CServerEntry *pIndex1 = m_ppServerlist[Index1];
-	CServerEntry *pIndex2 = m_ppServerlist[Index2];
-	return str_comp(pIndex1->m_Info.m_aGameType, pIndex2->m_Info.m_aGameType) < 0;
-}
+	char aConfig[sizeof(g_Config.m_BrFilterString) + sizeof(g_Config.m_BrExcludeString) + sizeof(g_Config.m_BrFilterServerAddress) + sizeof(g_Config.m_BrFilterGametype) + 16];
+	str_format(aConfig, sizeof(aConfig), "%d%d\n%s\n%s\n%s\n%s", g_Config.m_BrFilterGametypeStrict, g_Config.m_BrFilterConnectingPlayers,
+		g_Config.m_BrFilterString, g_Config.m_BrExcludeString, g_Config.m_BrFilterServerAddress, g_Config.m_BrFilterGametype);
+	if(m_SearchConfig == aConfig)
+	{
+		return;
+	}
+	m_SearchConfig = aConfig;
+	m_SearchVersion++;
 
-bool CServerBrowser::SortCompareNumPlayers(int Index1, int Index2) const
-{
-	CServerEntry *pIndex1 = m_ppServerlist[Index1];
-	CServerEntry *pIndex2 = m_ppServerlist[Index2];
-	return pIndex1->m_Info.m_NumFilteredPlayers > pIndex2->m_Info.m_NumFilteredPlayers;
+	ParseSearchTerms(g_Config.m_BrFilterString, m_vSearchTerms);
+	ParseSearchTerms(g_Config.m_BrExcludeString, m_vExcludeTerms);
+	m_LowercaseAddressFilter = LowercaseSearchKey(g_Config.m_BrFilterServerAddress);
+	m_LowercaseGametypeFilter = LowercaseSearchKey(g_Config.m_BrFilterGametype);
 }
 
-bool CServerBrowser::SortCompareNumClients(int Index1, int Index2) const
+// Applies the text filters, the result only changes with the filters or the
+// server info, so it is cached per server
+bool CServerBrowser::SearchFiltered(CServerEntry *pEntry)
 {
-	CServerEntry *pIndex1 = m_ppServerlist[Index1];
-	CServerEntry *pIndex2 = m_ppServerlist[Index2];
-	return pIndex1->m_Info.m_NumClients > pIndex2->m_Info.m_NumClients;
-}
+	CServerInfo &Info = pEntry->m_Info;
+	CSearchKeys &Keys = m_vSearchKeys[pEntry->m_SearchKeysIndex];
+	const int NumClients = minimum(Info.m_NumClients, (int)MAX_CLIENTS);
+	if(!Keys.m_Valid)
+	{
+		Keys.m_Name = LowercaseSearchKey(Info.m_aName);
+		Keys.m_Map = LowercaseSearchKey(Info.m_aMap);
+		Keys.m_GameType = LowercaseSearchKey(Info.m_aGameType);
+		Keys.m_Address = LowercaseSearchKey(Info.m_aAddress);
+		Keys.m_vPlayerNames.resize(NumClients);
+		Keys.m_vPlayerClans.resize(NumClients);
+		for(int p = 0; p < NumClients; p++)
+		{
+			Keys.m_vPlayerNames[p] = LowercaseSearchKey(Info.m_aClients[p].m_aName);
+			Keys.m_vPlayerClans[p] = LowercaseSearchKey(Info.m_aClients[p].m_aClan);
+		}
+		Keys.m_SearchVersion = -1;
+		Keys.m_Valid = true;
+	}
+	if(Keys.m_SearchVersion == m_SearchVersion)
+	{
+		Info.m_QuickSearchHit = Keys.m_QuickSearchHit;
+		return Keys.m_Filtered;
+	}
 
-bool CServerBrowser::SortCompareNumFriends(int Index1, int Index2) const
-{
-	CServerEntry *pIndex1 = m_ppServerlist[Index1];
-	CServerEntry *pIndex2 = m_ppServerlist[Index2];
+	bool Filtered = false;
+	if(g_Config.m_BrFilterServerAddress[0] && !str_find(Keys.m_Address.c_str(), m_LowercaseAddressFilter.c_str()))
+		Filtered = true;
+	else if(g_Config.m_BrFilterGametypeStrict && g_Config.m_BrFilterGametype[0] && str_comp_nocase(Info.m_aGameType, g_Config.m_BrFilterGametype))
+		Filtered = true;
+	else if(!g_Config.m_BrFilterGametypeStrict && g_Config.m_BrFilterGametype[0] && !str_find(Keys.m_GameType.c_str(), m_LowercaseGametypeFilter.c_str()))
+		Filtered = true;
 
-	if(pIndex1->m_Info.m_FriendNum == pIndex2->m_Info.m_FriendNum)
-		return pIndex1->m_Info.m_NumFilteredPlayers > pIndex2->m_Info.m_NumFilteredPlayers;
-	else
-		return pIndex1->m_Info.m_FriendNum > pIndex2->m_Info.m_FriendNum;
-}
+	if(!Filtered && g_Config.m_BrFilterString[0] != '\0')
+	{
+		Info.m_QuickSearchHit = 0;
+		for(const CSearchTerm &Term : m_vSearchTerms)
+		{
+			// match against server name
+			if(Term.Matches(Info.m_aName, Keys.m_Name))
+			{
+				Info.m_QuickSearchHit |= IServerBrowser::QUICK_SERVERNAME;
+			}
 
-bool CServerBrowser::SortCompareNumPlayersAndPing(int Index1, int Index2) const
-{
-	CServerEntry *pIndex1 = m_ppServerlist[Index1];
-	CServerEntry *pIndex2 = m_ppServerlist[Index2];
+			// match against players
+			for(int p = 0; p < NumClients; p++)
+			{
+				if(Term.Matches(Info.m_aClients[p].m_aName, Keys.m_vPlayerNames[p]) ||
+					Term.Matches(Info.m_aClients[p].m_aClan, Keys.m_vPlayerClans[p]))
+				{
+					if(g_Config.m_BrFilterConnectingPlayers &&
+						str_comp(Info.m_aClients[p].m_aName, "(connecting)") == 0 &&
+						Info.m_aClients[p].m_aClan[0] == '\0')
+					{
+						continue;
+					}
+					Info.m_QuickSearchHit |= IServerBrowser::QUICK_PLAYER;
+					break;
+				}
+			}
 
-	if(pIndex1->m_Info.m_NumFilteredPlayers == pIndex2->m_Info.m_NumFilteredPlayers)
-		return pIndex1->m_Info.m_Latency > pIndex2->m_Info.m_Latency;
-	else if(pIndex1->m_Info.m_NumFilteredPlayers == 0 || pIndex2->m_Info.m_NumFilteredPlayers == 0 || pIndex1->m_Info.m_Latency / 100 == pIndex2->m_Info.m_Latency / 100)
-		return pIndex1->m_Info.m_NumFilteredPlayers < pIndex2->m_Info.m_NumFilteredPlayers;
-	else
-		return pIndex1->m_Info.m_Latency > pIndex2->m_Info.m_Latency;
+			// match against map
+			if(Term.Matches(Info.m_aMap, Keys.m_Map))
+			{
+				Info.m_QuickSearchHit |= IServerBrowser::QUICK_MAPNAME;
+			}
+		}
+
+		if(!Info.m_QuickSearchHit)
+			Filtered = true;
+	}
+
+	if(!Filtered)
+	{
+		for(const CSearchTerm &Term : m_vExcludeTerms)
+		{
+			// match against server name, map and gametype
+			if(Term.Matches(Info.m_aName, Keys.m_Name) ||
+				Term.Matches(Info.m_aMap, Keys.m_Map) ||
+				Term.Matches(Info.m_aGameType, Keys.m_GameType))
+			{
+				Filtered = true;
+				break;
+			}
+		}
+	}
+
+	Keys.m_SearchVersion = m_SearchVersion;
+	Keys.m_Filtered = Filtered;
+	Keys.m_QuickSearchHit = Info.m_QuickSearchHit;
+	return Filtered;
 }
 
 void CServerBrowser::Filter()
@@ -417,6 +511,8 @@ void CServerBrowser::Filter()
 	m_NumSortedServers = 0;
 	m_NumSortedPlayers = 0;
 
+	UpdateSearchTerms();
+
 	// allocate the sorted list
 	if(m_NumSortedServersCapacity < m_NumServers)
 	{
@@ -437,12 +533,6 @@ void CServerBrowser::Filter()
 			Filtered = true;
 		else if(g_Config.m_BrFilterPw && Info.m_Flags & SERVER_FLAG_PASSWORD)
 			Filtered = true;
-		else if(g_Config.m_BrFilterServerAddress[0] && !str_find_nocase(Info.m_aAddress, g_Config.m_BrFilterServerAddress))
-			Filtered = true;
-		else if(g_Config.m_BrFilterGametypeStrict && g_Config.m_BrFilterGametype[0] && str_comp_nocase(Info.m_aGameType, g_Config.m_BrFilterGametype))
-			Filtered = true;
-		else if(!g_Config.m_BrFilterGametypeStrict && g_Config.m_BrFilterGametype[0] && !str_utf8_find_nocase(Info.m_aGameType, g_Config.m_BrFilterGametype))
-			Filtered = true;
 		else if(g_Config.m_BrFilterUnfinishedMap && Info.m_HasRank == CServerInfo::RANK_RANKED)
 			Filtered = true;
 		else if(g_Config.m_BrFilterLogin && Info.m_RequiresLogin)
@@ -477,107 +567,9 @@ void CServerBrowser::Filter()
 				}
 			}
 
-			if(!Filtered && g_Config.m_BrFilterString[0] != '\0')
+			if(!Filtered)
 			{
-				Info.m_QuickSearchHit = 0;
-
-				const char *pStr = g_Config.m_BrFilterString;
-				char aFilterStr[sizeof(g_Config.m_BrFilterString)];
-				char aFilterStrTrimmed[sizeof(g_Config.m_BrFilterString)];
-				while((pStr = str_next_token(pStr, IServerBrowser::SEARCH_EXCLUDE_TOKEN, aFilterStr, sizeof(aFilterStr))))
-				{
-					str_copy(aFilterStrTrimmed, str_utf8_skip_whitespaces(aFilterStr));
-					str_utf8_trim_right(aFilterStrTrimmed);
-
-					if(aFilterStrTrimmed[0] == '\0')
-					{
-						continue;
-					}
-					auto MatchesFn = MatchesPart;
-					const int FilterLen = str_length(aFilterStrTrimmed);
-					if(aFilterStrTrimmed[0] == '"' && aFilterStrTrimmed[FilterLen - 1] == '"')
-					{
-						aFilterStrTrimmed[FilterLen - 1] = '\0';
-						MatchesFn = MatchesExactly;
-					}
-
-					// match against server name
-					if(MatchesFn(Info.m_aName, aFilterStrTrimmed))
-					{
-						Info.m_QuickSearchHit |= IServerBrowser::QUICK_SERVERNAME;
-					}
-
-					// match against players
-					for(int p = 0; p < minimum(Info.m_NumClients, (int)MAX_CLIENTS); p++)
-					{
-						if(MatchesFn(Info.m_aClients[p].m_aName, aFilterStrTrimmed) ||
-							MatchesFn(Info.m_aClients[p].m_aClan, aFilterStrTrimmed))
-						{
-							if(g_Config.m_BrFilterConnectingPlayers &&
-								str_comp(Info.m_aClients[p].m_aName, "(connecting)") == 0 &&
-								Info.m_aClients[p].m_aClan[0] == '\0')
-							{
-								continue;
-							}
-							Info.m_QuickSearchHit |= IServerBrowser::QUICK_PLAYER;
-							break;
-						}
-					}
-
-					// match against map
-					if(MatchesFn(Info.m_aMap, aFilterStrTrimmed))
-					{
-						Info.m_QuickSearchHit |= IServerBrowser::QUICK_MAPNAME;
-					}
-				}
-
-				if(!Info.m_QuickSearchHit)
-					Filtered = true;
-			}
-
-			if(!Filtered && g_Config.m_BrExcludeString[0] != '\0')
-			{
-				const char *pStr = g_Config.m_BrExcludeString;
-				char aExcludeStr[sizeof(g_Config.m_BrExcludeString)];
-				char aExcludeStrTrimmed[sizeof(g_Config.m_BrExcludeString)];
-				while((pStr = str_next_token(pStr, IServerBrowser::SEARCH_EXCLUDE_TOKEN, aExcludeStr, sizeof(aExcludeStr))))
-				{
-					str_copy(aExcludeStrTrimmed, str_utf8_skip_whitespaces(aExcludeStr));
-					str_utf8_trim_right(aExcludeStrTrimmed);
-
-					if(aExcludeStrTrimmed[0] == '\0')
-					{
-						continue;
-					}
-					auto MatchesFn = MatchesPart;
-					const int FilterLen = str_length(aExcludeStrTrimmed);
-					if(aExcludeStrTrimmed[0] == '"' && aExcludeStrTrimmed[FilterLen - 1] == '"')
-					{
-						aExcludeStrTrimmed[FilterLen - 1] = '\0';
-						MatchesFn = MatchesExactly;
-					}
-
-					// match against server name
-					if(MatchesFn(Info.m_aName, aExcludeStrTrimmed))
-					{
-						Filtered = true;
-						break;
-					}
-
-					// match against map
-					if(MatchesFn(Info.m_aMap, aExcludeStrTrimmed))
-					{
-						Filtered = true;
-						break;
-					}
-
-					// match against gametype
-					if(MatchesFn(Info.m_aGameType, aExcludeStrTrimmed))
-					{
-						Filtered = true;
-						break;
-					}
-				}
+				Filtered = SearchFiltered(m_ppServerlist[i]);
 			}
 		}
 
@@ -623,20 +615,45 @@ void CServerBrowser::Sort()
 	Filter();
 
 	// sort
+	const bool Reverse = g_Config.m_BrSortOrder;
+	const auto &&Info = [&](int Index) -> const CServerInfo & { return m_ppServerlist[Index]->m_Info; };
+	const auto &&StrLess = [](const char *pStr1, const char *pStr2) { return str_comp(pStr1, pStr2) < 0; };
 	if(g_Config.m_BrSortOrder == 2 && (g_Config.m_BrSort == IServerBrowser::SORT_NUMPLAYERS || g_Config.m_BrSort == IServerBrowser::SORT_PING))
-		std::stable_sort(m_pSortedServerlist, m_pSortedServerlist + m_NumSortedServers, CSortWrap(this, &CServerBrowser::SortCompareNumPlayersAndPing));
+	{
+		using TPlayersAndPing = std::pair<int, int>;
+		SortIndicesByKey<TPlayersAndPing>(
+			m_pSortedServerlist, m_NumSortedServers, Reverse,
+			[&](int Index) { return TPlayersAndPing(Info(Index).m_NumFilteredPlayers, Info(Index).m_Latency); },
+			[](const TPlayersAndPing &Key1, const TPlayersAndPing &Key2) {
+				if(Key1.first == Key2.first)
+					return Key1.second > Key2.second;
+				else if(Key1.first == 0 || Key2.first == 0 || Key1.second / 100 == Key2.second / 100)
+					return Key1.first < Key2.first;
+				else
+					return Key1.second > Key2.second;
+			});
+	}
 	else if(g_Config.m_BrSort == IServerBrowser::SORT_NAME)
-		std::stable_sort(m_pSortedServerlist, m_pSortedServerlist + m_NumSortedServers, CSortWrap(this, &CServerBrowser::SortCompareName));
+	{
+		// make sure empty entries are listed last
+		using TGotInfoAndName = std::pair<bool, const char *>;
+		SortIndicesByKey<TGotInfoAndName>(
+			m_pSortedServerlist, m_NumSortedServers, Reverse,
+			[&](int Index) { return TGotInfoAndName(!m_ppServerlist[Index]->m_GotInfo, Info(Index).m_aName); },
+			[&](const TGotInfoAndName &Key1, const TGotInfoAndName &Key2) {
+				return Key1.first == Key2.first ? StrLess(Key1.second, Key2.second) : Key2.first;
+			});
+	}
 	else if(g_Config.m_BrSort == IServerBrowser::SORT_PING)
-		std::stable_sort(m_pSortedServerlist, m_pSortedServerlist + m_NumSortedServers, CSortWrap(this, &CServerBrowser::SortComparePing));
+		SortIndicesByKey<int>(m_pSortedServerlist, m_NumSortedServers, Reverse, [&](int Index) { return Info(Index).m_Latency; }, std::less<int>());
 	else if(g_Config.m_BrSort == IServerBrowser::SORT_MAP)
-		std::stable_sort(m_pSortedServerlist, m_pSortedServerlist + m_NumSortedServers, CSortWrap(this, &CServerBrowser::SortCompareMap));
+		SortIndicesByKey<const char *>(m_pSortedServerlist, m_NumSortedServers, Reverse, [&](int Index) { return Info(Index).m_aMap; }, StrLess);
 	else if(g_Config.m_BrSort == IServerBrowser::SORT_NUMFRIENDS)
-		std::stable_sort(m_pSortedServerlist, m_pSortedServerlist + m_NumSortedServers, CSortWrap(this, &CServerBrowser::SortCompareNumFriends));
+		SortIndicesByKey<int64_t>(m_pSortedServerlist, m_NumSortedServers, Reverse, [&](int Index) { return -(((int64_t)Info(Index).m_FriendNum << 32) | (uint32_t)Info(Index).m_NumFilteredPlayers); }, std::less<int64_t>());
 	else if(g_Config.m_BrSort == IServerBrowser::SORT_NUMPLAYERS)
-		std::stable_sort(m_pSortedServerlist, m_pSortedServerlist + m_NumSortedServers, CSortWrap(this, &CServerBrowser::SortCompareNumPlayers));
+		SortIndicesByKey<int>(m_pSortedServerlist, m_NumSortedServers, Reverse, [&](int Index) { return -Info(Index).m_NumFilteredPlayers; }, std::less<int>());
 	else if(g_Config.m_BrSort == IServerBrowser::SORT_GAMETYPE)
-		std::stable_sort(m_pSortedServerlist, m_pSortedServerlist + m_NumSortedServers, CSortWrap(this, &CServerBrowser::SortCompareGametype));
+		SortIndicesByKey<const char *>(m_pSortedServerlist, m_NumSortedServers, Reverse, [&](int Index) { return Info(Index).m_aGameType; }, StrLess);
 
 	m_Sorthash = SortHash();
 }
@@ -681,7 +698,61 @@ void CServerBrowser::QueueRequest(CServerEntry *pEntry)
 		m_pFirstReqServer = pEntry;
 	m_pLastReqServer = pEntry;
 	pEntry->m_pNextReq = nullptr;
+	pEntry->m_RequestTime = 0;
+	pEntry->m_LostRequestTime = 0;
+	pEntry->m_RequestTries = 0;
 	m_NumRequests++;
+	m_NeedPrioritizeRequests = true;
+}
+
+void CServerBrowser::PrioritizeRequests()
+{
+	// Favorites are requested first, then the servers shown with the
+	// current filters. Only the requests not sent yet are reordered.
+	CServerEntry *pFirstUnsent = m_pFirstReqServer;
+	while(pFirstUnsent && pFirstUnsent->m_RequestTime > 0)
+	{
+		pFirstUnsent = pFirstUnsent->m_pNextReq;
+	}
+	if(!pFirstUnsent)
+	{
+		return;
+	}
+
+	std::vector<bool> vShown(m_NumServers, false);
+	for(int i = 0; i < m_NumSortedServers; i++)
+	{
+		vShown[m_pSortedServerlist[i]] = true;
+	}
+	const auto &&Priority = [&](const CServerEntry *pEntry) {
+		if(pEntry->m_Info.m_Favorite != TRISTATE::NONE)
+			return 0;
+		if(pEntry->m_Info.m_ServerIndex < m_NumServers && vShown[pEntry->m_Info.m_ServerIndex])
+			return 1;
+		return 2;
+	};
+
+	std::vector<CServerEntry *> vpUnsent;
+	for(CServerEntry *pEntry = pFirstUnsent; pEntry; pEntry = pEntry->m_pNextReq)
+	{
+		vpUnsent.push_back(pEntry);
+	}
+	std::stable_sort(vpUnsent.begin(), vpUnsent.end(), [&](const CServerEntry *pEntry1, const CServerEntry *pEntry2) {
+		return Priority(pEntry1) < Priority(pEntry2);
+	});
+
+	CServerEntry *pPrev = pFirstUnsent->m_pPrevReq;
+	for(CServerEntry *pEntry : vpUnsent)
+	{
+		pEntry->m_pPrevReq = pPrev;
+		if(pPrev)
+			pPrev->m_pNextReq = pEntry;
+		else
+			m_pFirstReqServer = pEntry;
+		pPrev = pEntry;
+	}
+	pPrev->m_pNextReq = nullptr;
+	m_pLastReqServer = pPrev;
 }
 
 static void ServerBrowserFormatAddresses(char *pBuffer, int BufferSize, NETADDR *pAddrs, int NumAddrs)
@@ -703,8 +774,10 @@ static void ServerBrowserFormatAddresses(char *pBuffer, int BufferSize, NETADDR
 	}
 }
 
-void CServerBrowser::SetInfo(CServerEntry *pEntry, const CServerInfo &Info) const
+void CServerBrowser::SetInfo(CServerEntry *pEntry, const CServerInfo &Info)
 {
+	m_vSearchKeys[pEntry->m_SearchKeysIndex].m_Valid = false;
+
 	const CServerInfo TmpInfo = pEntry->m_Info;
 	pEntry->m_Info = Info;
 	pEntry->m_Info.m_Favorite = TmpInfo.m_Favorite;
@@ -816,8 +889,23 @@ void CServerBrowser::SetLatency(NETADDR Addr, int Latency)
 CServerBrowser::CServerEntry *CServerBrowser::Add(const NETADDR *pAddrs, int NumAddrs)
 {
 	// create new pEntry
-	CServerEntry *pEntry = m_ServerlistHeap.Allocate<CServerEntry>();
+	CServerEntry *pEntry;
+	int SearchKeysIndex;
+	if(!m_vpFreeServerEntries.empty())
+	{
+		pEntry = m_vpFreeServerEntries.back();
+		m_vpFreeServerEntries.pop_back();
+		SearchKeysIndex = pEntry->m_SearchKeysIndex;
+	}
+	else
+	{
+		pEntry = m_ServerlistHeap.Allocate<CServerEntry>();
+		SearchKeysIndex = m_vSearchKeys.size();
+		m_vSearchKeys.emplace_back();
+	}
 	mem_zero(pEntry, sizeof(CServerEntry));
+	pEntry->m_SearchKeysIndex = SearchKeysIndex;
+	m_vSearchKeys[SearchKeysIndex].m_Valid = false;
 
 	// set the info
 	mem_copy(pEntry->m_Info.m_aAddresses, pAddrs, NumAddrs * sizeof(pAddrs[0]));
@@ -863,6 +951,7 @@ CServerBrowser::CServerEntry *CServerBrowser::ReplaceEntry(CServerEntry *pEntry,
 	{
 		m_ByAddr.erase(pEntry->m_Info.m_aAddresses[i]);
 	}
+	m_vSearchKeys[pEntry->m_SearchKeysIndex].m_Valid = false;
 
 	// set the info
 	mem_copy(pEntry->m_Info.m_aAddresses, pAddrs, NumAddrs * sizeof(pAddrs[0]));
@@ -955,17 +1044,26 @@ void CServerBrowser::OnServerInfoUpdate(const NETADDR &Addr, int Token, const CS
 		SetInfo(pEntry, *pInfo);
 		pEntry->m_Info.m_Latency = minimum(static_cast<int>((time_get() - m_BroadcastTime) * 1000 / time_freq()), 999);
 	}
-	else if(pEntry->m_RequestTime > 0)
+	else if(pEntry->m_RequestTime > 0 || pEntry->m_LostRequestTime > 0)
 	{
 		if(!pEntry->m_RequestIgnoreInfo)
 		{
 			SetInfo(pEntry, *pInfo);
 		}
 
-		int Latency = minimum(static_cast<int>((time_get() - pEntry->m_RequestTime) * 1000 / time_freq()), 999);
+		// a late answer to a request that timed out is still used, it was
+		// already counted as lost by the ping scheduler
+		const bool Late = pEntry->m_RequestTime <= 0;
+		const int64_t RequestTime = Late ? pEntry->m_LostRequestTime : pEntry->m_RequestTime;
+		int Latency = minimum(static_cast<int>((time_get() - RequestTime) * 1000 / time_freq()), 999);
+		if(!Late && (pEntry->m_pPrevReq || pEntry->m_pNextReq || m_pFirstReqServer == pEntry))
+		{
+			m_PingScheduler.OnAnswered(Latency);
+		}
 		if(!pEntry->m_RequestIgnoreInfo)
 		{
 			pEntry->m_Info.m_Latency = Latency;
+			m_pPingCache->CachePing(Addr, Latency);
 		}
 		else
 		{
@@ -975,6 +1073,7 @@ void CServerBrowser::OnServerInfoUpdate(const NETADDR &Addr, int Token, const CS
 			SetLatency(Addr, Latency);
 		}
 		pEntry->m_RequestTime = -1; // Request has been answered
+		pEntry->m_LostRequestTime = 0;
 	}
 	RemoveRequest(pEntry);
 	RequestResort();
@@ -1117,7 +1216,10 @@ void CServerBrowser::RequestImpl(const NETADDR &Addr, CServerEntry *pEntry, int
 	}
 
 	if(pEntry)
+	{
 		pEntry->m_RequestTime = time_get();
+		pEntry->m_RequestTries++;
+	}
 }
 
 void CServerBrowser::RequestCurrentServer(const NETADDR &Addr) const
@@ -1137,6 +1239,25 @@ void CServerBrowser::SetCurrentServerPing(const NETADDR &Addr, int Ping)
 
 void CServerBrowser::UpdateFromHttp()
 {
+	// If the entries were built from the previous server list, only the
+	// servers that changed since then are updated and the others are kept.
+	const int Generation = m_pHttp->Generation();
+	const bool SameList = Generation == m_HttpGeneration;
+	const bool Incremental = m_HttpGeneration != -1 && (SameList || Generation == m_HttpGeneration + 1);
+	if(Incremental)
+	{
+		while(m_pFirstReqServer)
+		{
+			RemoveRequest(m_pFirstReqServer);
+		}
+		m_PingScheduler.Reset(time_get(), g_Config.m_BrMaxRequests);
+	}
+	else
+	{
+		CleanUp();
+	}
+	m_HttpGeneration = Generation;
+
 	int OwnLocation;
 	if(str_comp(g_Config.m_BrLocation, "auto") == 0)
 	{
@@ -1189,28 +1310,86 @@ void CServerBrowser::UpdateFromHttp()
 		};
 	}
 
+	const auto &&UpdateLatency = [&](CServerInfo *pInfo) {
+		int Ping = m_pPingCache->GetPing(pInfo->m_aAddresses, pInfo->m_NumAddresses);
+		pInfo->m_LatencyIsEstimated = Ping == -1;
+		if(pInfo->m_LatencyIsEstimated)
+		{
+			pInfo->m_Latency = CServerInfo::EstimateLatency(OwnLocation, pInfo->m_Location);
+		}
+		else
+		{
+			pInfo->m_Latency = Ping;
+		}
+	};
+
+	std::vector<bool> vKeep(Incremental ? m_NumServers : 0, false);
 	for(int i = 0; i < NumServers; i++)
 	{
-		CServerInfo Info = m_pHttp->Server(i);
-		if(!Want(Info.m_aAddresses, Info.m_NumAddresses))
+		const CServerInfo &HttpInfo = m_pHttp->Server(i);
+		if(!Want(HttpInfo.m_aAddresses, HttpInfo.m_NumAddresses))
 		{
 			continue;
 		}
-		int Ping = m_pPingCache->GetPing(Info.m_aAddresses, Info.m_NumAddresses);
-		Info.m_LatencyIsEstimated = Ping == -1;
-		if(Info.m_LatencyIsEstimated)
+		CServerEntry *pEntry = Incremental ? Find(HttpInfo.m_aAddresses[0]) : nullptr;
+		if(pEntry &&
+			pEntry->m_Info.m_ServerIndex < (int)vKeep.size() &&
+			!vKeep[pEntry->m_Info.m_ServerIndex] &&
+			pEntry->m_GotInfo &&
+			pEntry->m_RequestIgnoreInfo &&
+			pEntry->m_Info.m_NumAddresses == HttpInfo.m_NumAddresses &&
+			mem_comp(pEntry->m_Info.m_aAddresses, HttpInfo.m_aAddresses, HttpInfo.m_NumAddresses * sizeof(HttpInfo.m_aAddresses[0])) == 0)
 		{
-			Info.m_Latency = CServerInfo::EstimateLatency(OwnLocation, Info.m_Location);
+			vKeep[pEntry->m_Info.m_ServerIndex] = true;
+			pEntry->m_RequestTime = 0;
+			if(SameList || !m_pHttp->ServerChanged(i))
+			{
+				UpdateLatency(&pEntry->m_Info);
+				continue;
+			}
 		}
 		else
 		{
-			Info.m_Latency = Ping;
+			pEntry = Add(HttpInfo.m_aAddresses, HttpInfo.m_NumAddresses);
 		}
-		CServerEntry *pEntry = Add(Info.m_aAddresses, Info.m_NumAddresses);
+		CServerInfo Info = HttpInfo;
+		UpdateLatency(&Info);
 		SetInfo(pEntry, Info);
 		pEntry->m_RequestIgnoreInfo = true;
 	}
 
+	if(Incremental)
+	{
+		// Remove the servers that are not in the new list, entries added
+		// above are behind the old ones and always kept.
+		int NumKept = 0;
+		for(int i = 0; i < m_NumServers; i++)
+		{
+			CServerEntry *pEntry = m_ppServerlist[i];
+			if(i < (int)vKeep.size() && !vKeep[i])
+			{
+				m_vpFreeServerEntries.push_back(pEntry);
+				continue;
+			}
+			pEntry->m_Info.m_ServerIndex = NumKept;
+			m_ppServerlist[NumKept] = pEntry;
+			NumKept++;
+		}
+		if(NumKept != m_NumServers)
+		{
+			m_NumServers = NumKept;
+			m_ByAddr.clear();
+			for(int i = 0; i < m_NumServers; i++)
+			{
+				const CServerInfo &Info = m_ppServerlist[i]->m_Info;
+				for(int j = 0; j < Info.m_NumAddresses; j++)
+				{
+					m_ByAddr[Info.m_aAddresses[j]] = i;
+				}
+			}
+		}
+	}
+
 	if(m_ServerlistType == IServerBrowser::TYPE_FAVORITES)
 	{
 		const IFavorites::CEntry *pFavorites;
@@ -1247,6 +1426,8 @@ void CServerBrowser::CleanUp()
 {
 	// clear out everything
 	m_ServerlistHeap.Reset();
+	m_vpFreeServerEntries.clear();
+	m_vSearchKeys.clear();
 	m_NumServers = 0;
 	m_NumSortedServers = 0;
 	m_NumSortedPlayers = 0;
@@ -1254,14 +1435,12 @@ void CServerBrowser::CleanUp()
 	m_pFirstReqServer = nullptr;
 	m_pLastReqServer = nullptr;
 	m_NumRequests = 0;
-	m_CurrentMaxRequests = g_Config.m_BrMaxRequests;
+	m_PingScheduler.Reset(time_get(), g_Config.m_BrMaxRequests);
+	m_HttpGeneration = -1;
 }
 
 void CServerBrowser::Update()
 {
-	int64_t Timeout = time_freq();
-	int64_t Now = time_get();
-
 	const char *pHttpBestUrl;
 	if(!m_pHttp->GetBestUrl(&pHttpBestUrl) && pHttpBestUrl != m_pHttpPrevBestUrl)
 	{
@@ -1271,68 +1450,76 @@ void CServerBrowser::Update()
 
 	m_pHttp->Update();
 
+	if(m_pPingCache->Update())
+	{
+		// the stored pings replace the estimated latencies
+		for(int i = 0; i < m_NumServers; i++)
+		{
+			CServerInfo *pInfo = &m_ppServerlist[i]->m_Info;
+			if(!pInfo->m_LatencyIsEstimated)
+			{
+				continue;
+			}
+			const int Ping = m_pPingCache->GetPing(pInfo->m_aAddresses, pInfo->m_NumAddresses);
+			if(Ping != -1)
+			{
+				pInfo->m_Latency = Ping;
+				pInfo->m_LatencyIsEstimated = false;
+				RequestResort();
+			}
+		}
+	}
+
 	if(m_ServerlistType != TYPE_LAN && m_RefreshingHttp && !m_pHttp->IsRefreshing())
 	{
 		m_RefreshingHttp = false;
-		CleanUp();
 		UpdateFromHttp();
 		// TODO: move this somewhere else
 		Sort();
 		return;
 	}
 
+	if(m_NeedPrioritizeRequests)
+	{
+		PrioritizeRequests();
+		m_NeedPrioritizeRequests = false;
+	}
+
+	// The requests are sent in the order of the list, so the ones in flight
+	// are at the front. Lost requests are retried at the back of the list.
+	const int64_t Now = time_get();
+	int InFlight = 0;
 	CServerEntry *pEntry = m_pFirstReqServer;
-	int Count = 0;
-	while(true)
+	while(pEntry && pEntry->m_RequestTime > 0)
 	{
-		if(!pEntry) // no more entries
-			break;
-		if(pEntry->m_RequestTime && pEntry->m_RequestTime + Timeout < Now)
+		CServerEntry *pNext = pEntry->m_pNextReq;
+		if(pEntry->m_RequestTime + pEntry->m_RequestTimeout < Now)
 		{
-			pEntry = pEntry->m_pNextReq;
-			continue;
+			m_PingScheduler.OnLost(Now);
+			const int Tries = pEntry->m_RequestTries;
+			const int64_t RequestTime = pEntry->m_RequestTime;
+			RemoveRequest(pEntry);
+			if(Tries <= MAX_REQUEST_RETRIES)
+			{
+				QueueRequest(pEntry);
+				pEntry->m_RequestTries = Tries;
+				pEntry->m_LostRequestTime = RequestTime;
+			}
 		}
-		// no more than 10 concurrent requests
-		if(Count == m_CurrentMaxRequests)
-			break;
-
-		if(pEntry->m_RequestTime == 0)
+		else
 		{
-			RequestImpl(pEntry->m_Info.m_aAddresses[0], pEntry, nullptr, nullptr, false);
+			InFlight++;
 		}
-
-		Count++;
-		pEntry = pEntry->m_pNextReq;
+		pEntry = pNext;
 	}
 
-	if(m_pFirstReqServer && Count == 0 && m_CurrentMaxRequests > 1) //NO More current Server Requests
+	for(int Budget = m_PingScheduler.Budget(Now, InFlight); pEntry && Budget > 0; Budget--)
 	{
-		//reset old ones
-		pEntry = m_pFirstReqServer;
-		while(true)
-		{
-			if(!pEntry) // no more entries
-				break;
-			pEntry->m_RequestTime = 0;
-			pEntry = pEntry->m_pNextReq;
-		}
-
-		//update max-requests
-		m_CurrentMaxRequests = m_CurrentMaxRequests / 2;
-		if(m_CurrentMaxRequests < 1)
-			m_CurrentMaxRequests = 1;
-	}
-	else if(Count == 0 && m_CurrentMaxRequests == 1) //we reached the limit, just release all left requests. IF a server sends us a packet, a new request will be added automatically, so we can delete all
-	{
-		pEntry = m_pFirstReqServer;
-		while(true)
-		{
-			if(!pEntry) // no more entries
-				break;
-			CServerEntry *pNext = pEntry->m_pNextReq;
-			RemoveRequest(pEntry); //release request
-			pEntry = pNext;
-		}
+		const int CachedPing = m_pPingCache->GetPing(pEntry->m_Info.m_aAddresses, pEntry->m_Info.m_NumAddresses);
+		pEntry->m_RequestTimeout = m_PingScheduler.TimeoutMs(CachedPing) * time_freq() / 1000;
+		RequestImpl(pEntry->m_Info.m_aAddresses[0], pEntry, nullptr, nullptr, false);
+		m_PingScheduler.OnSent(1);
+		pEntry = pEntry->m_pNextReq;
 	}
 
 	// check if we need to resort
@@ -1349,56 +1536,103 @@ void CServerBrowser::Update()
 	}
 }
 
+CServerBrowser::CDDNetInfo::~CDDNetInfo()
+{
+	json_value_free(m_pJson);
+}
+
+void CServerBrowser::CLoadDDNetInfoJob::Run()
+{
+	LoadDDNetInfoJson(m_pStorage, &m_Info);
+	LoadDDNetLocation(&m_Info);
+	LoadDDNetServers(&m_Info);
+}
+
 const json_value *CServerBrowser::LoadDDNetInfo()
 {
-	LoadDDNetInfoJson();
-	LoadDDNetLocation();
-	LoadDDNetServers();
+	CDDNetInfo Info;
+	LoadDDNetInfoJson(m_pStorage, &Info);
+	LoadDDNetLocation(&Info);
+	LoadDDNetServers(&Info);
+	ApplyDDNetInfo(&Info);
+	return m_pDDNetInfo;
+}
+
+void CServerBrowser::LoadDDNetInfoInBackground()
+{
+	m_pLoadDDNetInfoJob = std::make_shared<CLoadDDNetInfoJob>(m_pStorage);
+	m_pEngine->AddJob(m_pLoadDDNetInfoJob);
+}
+
+bool CServerBrowser::FinishLoadDDNetInfo(const json_value **ppDDNetInfo)
+{
+	if(!m_pLoadDDNetInfoJob || !m_pLoadDDNetInfoJob->Done())
+	{
+		return false;
+	}
+	std::shared_ptr<CLoadDDNetInfoJob> pJob = nullptr;
+	std::swap(m_pLoadDDNetInfoJob, pJob);
+	ApplyDDNetInfo(&pJob->m_Info);
+	*ppDDNetInfo = m_pDDNetInfo;
+	return true;
+}
+
+void CServerBrowser::ApplyDDNetInfo(CDDNetInfo *pInfo)
+{
+	json_value_free(m_pDDNetInfo);
+	m_pDDNetInfo = pInfo->m_pJson;
+	pInfo->m_pJson = nullptr;
+	m_DDNetInfoSha256 = pInfo->m_Sha256;
+	m_OwnLocation = pInfo->m_OwnLocation;
+	m_vCommunities = std::move(pInfo->m_vCommunities);
+	m_CommunityServersByAddr = std::move(pInfo->m_CommunityServersByAddr);
+
+	// Remove unknown elements from exclude lists
+	CleanFilters();
+
 	for(int i = 0; i < m_NumServers; i++)
 	{
 		UpdateServerCommunity(&m_ppServerlist[i]->m_Info);
 		UpdateServerRank(&m_ppServerlist[i]->m_Info);
 	}
-	return m_pDDNetInfo;
 }
 
-void CServerBrowser::LoadDDNetInfoJson()
+void CServerBrowser::LoadDDNetInfoJson(IStorage *pStorage, CDDNetInfo *pInfo)
 {
 	void *pBuf;
 	unsigned Length;
-	if(!m_pStorage->ReadFile(DDNET_INFO_FILE, IStorage::TYPE_SAVE, &pBuf, &Length))
+	if(!pStorage->ReadFile(DDNET_INFO_FILE, IStorage::TYPE_SAVE, &pBuf, &Length))
 	{
-		m_DDNetInfoSha256 = SHA256_ZEROED;
+		pInfo->m_Sha256 = SHA256_ZEROED;
 		return;
 	}
 
-	m_DDNetInfoSha256 = sha256(pBuf, Length);
+	pInfo->m_Sha256 = sha256(pBuf, Length);
 
-	json_value_free(m_pDDNetInfo);
 	json_settings JsonSettings{};
 	char aError[256];
-	m_pDDNetInfo = json_parse_ex(&JsonSettings, static_cast<json_char *>(pBuf), Length, aError);
+	pInfo->m_pJson = json_parse_ex(&JsonSettings, static_cast<json_char *>(pBuf), Length, aError);
 	free(pBuf);
 
-	if(m_pDDNetInfo == nullptr)
+	if(pInfo->m_pJson == nullptr)
 	{
 		log_error("serverbrowser", "invalid info json: '%s'", aError);
 	}
-	else if(m_pDDNetInfo->type != json_object)
+	else if(pInfo->m_pJson->type != json_object)
 	{
 		log_error("serverbrowser", "invalid info root");
-		json_value_free(m_pDDNetInfo);
-		m_pDDNetInfo = nullptr;
+		json_value_free(pInfo->m_pJson);
+		pInfo->m_pJson = nullptr;
 	}
 }
 
-void CServerBrowser::LoadDDNetLocation()
+void CServerBrowser::LoadDDNetLocation(CDDNetInfo *pInfo)
 {
-	m_OwnLocation = CServerInfo::LOC_UNKNOWN;
-	if(m_pDDNetInfo)
+	pInfo->m_OwnLocation = CServerInfo::LOC_UNKNOWN;
+	if(pInfo->m_pJson)
 	{
-		const json_value &Location = (*m_pDDNetInfo)["location"];
-		if(Location.type != json_string || CServerInfo::ParseLocation(&m_OwnLocation, Location))
+		const json_value &Location = (*pInfo->m_pJson)["location"];
+		if(Location.type != json_string || CServerInfo::ParseLocation(&pInfo->m_OwnLocation, Location))
 		{
 			log_error("serverbrowser", "invalid location");
 		}
@@ -1490,18 +1724,18 @@ bool CServerBrowser::ParseCommunityFinishes(CCommunity *pCommunity, const json_v
 	return true;
 }
 
-void CServerBrowser::LoadDDNetServers()
+void CServerBrowser::LoadDDNetServers(CDDNetInfo *pInfo)
 {
 	// Parse communities
-	m_vCommunities.clear();
-	m_CommunityServersByAddr.clear();
+	pInfo->m_vCommunities.clear();
+	pInfo->m_CommunityServersByAddr.clear();
 
-	if(!m_pDDNetInfo)
+	if(!pInfo->m_pJson)
 	{
 		return;
 	}
 
-	const json_value &Communities = (*m_pDDNetInfo)["communities"];
+	const json_value &Communities = (*pInfo->m_pJson)["communities"];
 	if(Communities.type != json_array)
 	{
 		return;
@@ -1545,18 +1779,18 @@ void CServerBrowser::LoadDDNetServers()
 		{
 			if(str_comp(Id, COMMUNITY_DDNET) == 0)
 			{
-				pFinishes = &(*m_pDDNetInfo)["maps"];
+				pFinishes = &(*pInfo->m_pJson)["maps"];
 			}
 		}
 		if(pServers->type == json_none)
 		{
 			if(str_comp(Id, COMMUNITY_DDNET) == 0)
 			{
-				pServers = &(*m_pDDNetInfo)["servers"];
+				pServers = &(*pInfo->m_pJson)["servers"];
 			}
 			else if(str_comp(Id, "kog") == 0)
 			{
-				pServers = &(*m_pDDNetInfo)["servers-kog"];
+				pServers = &(*pInfo->m_pJson)["servers-kog"];
 			}
 		}
 		if(false ||
@@ -1594,10 +1828,10 @@ void CServerBrowser::LoadDDNetServers()
 		{
 			for(const auto &Server : Country.Servers())
 			{
-				m_CommunityServersByAddr.emplace(Server.Address(), CCommunityServer(NewCommunity.Id(), Country.Name(), Server.TypeName()));
+				pInfo->m_CommunityServersByAddr.emplace(Server.Address(), CCommunityServer(NewCommunity.Id(), Country.Name(), Server.TypeName()));
 			}
 		}
-		m_vCommunities.push_back(std::move(NewCommunity));
+		pInfo->m_vCommunities.push_back(std::move(NewCommunity));
 	}
 
 	// Add default none community
@@ -1605,11 +1839,8 @@ void CServerBrowser::LoadDDNetServers()
 		CCommunity NoneCommunity(COMMUNITY_NONE, "None", SHA256_ZEROED, "");
 		NoneCommunity.m_vCountries.emplace_back(COMMUNITY_COUNTRY_NONE, -1);
 		NoneCommunity.m_vTypes.emplace_back(COMMUNITY_TYPE_NONE);
-		m_vCommunities.push_back(std::move(NoneCommunity));
+		pInfo->m_vCommunities.push_back(std::move(NoneCommunity));
 	}
-
-	// Remove unknown elements from exclude lists
-	CleanFilters();
 }
 
 void CServerBrowser::UpdateServerFilteredPlayers(CServerInfo *pInfo) const
@@ -8,11 +8,16 @@
 
 #include <engine/console.h>
 #include <engine/serverbrowser.h>
+#include <engine/shared/jobs.h>
 #include <engine/shared/memheap.h>
 
+#include "serverbrowser_ping_scheduler.h"
+
 #include <functional>
 #include <map>
+#include <memory>
 #include <set>
+#include <string>
 
 typedef struct _json_value json_value;
 class CNetClient;
@@ -268,9 +273,8 @@ public:
 	const CServerInfo *SortedGet(int Index) const override;
 
 	const json_value *LoadDDNetInfo();
-	void LoadDDNetInfoJson();
-	void LoadDDNetLocation();
-	void LoadDDNetServers();
+	void LoadDDNetInfoInBackground();
+	bool FinishLoadDDNetInfo(const json_value **ppDDNetInfo);
 	void UpdateServerFilteredPlayers(CServerInfo *pInfo) const;
 	void UpdateServerFriends(CServerInfo *pInfo) const;
 	void UpdateServerCommunity(CServerInfo *pInfo) const;
@@ -332,6 +336,7 @@ private:
 	const char *m_pHttpPrevBestUrl = nullptr;
 
 	CHeap m_ServerlistHeap;
+	std::vector<CServerEntry *> m_vpFreeServerEntries; // removed by incremental updates, reused by Add
 	CServerEntry **m_ppServerlist;
 	int *m_pSortedServerlist;
 	std::unordered_map<NETADDR, int> m_ByAddr;
@@ -347,8 +352,44 @@ private:
 	CExcludedCommunityCountryFilterList m_CountriesFilter;
 	CExcludedCommunityTypeFilterList m_TypesFilter;
 
+	// The DDNet info with everything parsed from it, prepared on a job
+	// thread when it is updated while the client is running
+	class CDDNetInfo
+	{
+	public:
+		json_value *m_pJson = nullptr;
+		SHA256_DIGEST m_Sha256 = SHA256_ZEROED;
+		int m_OwnLocation = CServerInfo::LOC_UNKNOWN;
+		std::vector<CCommunity> m_vCommunities;
+		std::unordered_map<NETADDR, CCommunityServer> m_CommunityServersByAddr;
+
+		CDDNetInfo() = default;
+		CDDNetInfo(const CDDNetInfo &Other) = delete;
+		CDDNetInfo &operator=(const CDDNetInfo &Other) = delete;
+		~CDDNetInfo();
+	};
+
+	class CLoadDDNetInfoJob : public IJob
+	{
+		IStorage *m_pStorage;
+		void Run() override;
+
+	public:
+		CLoadDDNetInfoJob(IStorage *pStorage) :
+			m_pStorage(pStorage)
+		{
+		}
+		CDDNetInfo m_Info;
+	};
+
 	json_value *m_pDDNetInfo = nullptr;
 	SHA256_DIGEST m_DDNetInfoSha256 = SHA256_ZEROED;
+	std::shared_ptr<CLoadDDNetInfoJob> m_pLoadDDNetInfoJob;
+
+	static void LoadDDNetInfoJson(IStorage *pStorage, CDDNetInfo *pInfo);
+	static void LoadDDNetLocation(CDDNetInfo *pInfo);
+	static void LoadDDNetServers(CDDNetInfo *pInfo);
+	void ApplyDDNetInfo(CDDNetInfo *pInfo);
 
 	CServerEntry *m_pFirstReqServer; // request list
 	CServerEntry *m_pLastReqServer;
@@ -357,8 +398,14 @@ private:
 	bool m_NeedResort;
 	int m_Sorthash;
 
-	// used instead of g_Config.br_max_requests to get more servers
-	int m_CurrentMaxRequests;
+	enum
+	{
+		MAX_REQUEST_RETRIES = 3,
+	};
+
+	// paces the requests, starting at g_Config.br_max_requests in flight
+	CServerBrowserPingScheduler m_PingScheduler;
+	bool m_NeedPrioritizeRequests = false;
 
 	int m_NumSortedServers;
 	int m_NumSortedServersCapacity;
@@ -367,6 +414,7 @@ private:
 	int m_NumServerCapacity;
 
 	int m_ServerlistType;
+	int m_HttpGeneration; // of the HTTP server list the entries were built from, -1 if none
 	int64_t m_BroadcastTime;
 	unsigned char m_aTokenSeed[16];
 
@@ -374,15 +422,45 @@ private:
 	static int GetBasicToken(int Token);
 	static int GetExtraToken(int Token);
 
-	// sorting criteria
-	bool SortCompareName(int Index1, int Index2) const;
-	bool SortCompareMap(int Index1, int Index2) const;
-	bool SortComparePing(int Index1, int Index2) const;
-	bool SortCompareGametype(int Index1, int Index2) const;
-	bool SortCompareNumPlayers(int Index1, int Index2) const;
-	bool SortCompareNumClients(int Index1, int Index2) const;
-	bool SortCompareNumFriends(int Index1, int Index2) const;
-	bool SortCompareNumPlayersAndPing(int Index1, int Index2) const;
+	// Lowercased strings of a server for the text filters, rebuilt when the
+	// server info changes, and the cached result of the text filters
+	class CSearchKeys
+	{
+	public:
+		bool m_Valid = false;
+		std::string m_Name;
+		std::string m_Map;
+		std::string m_GameType;
+		std::string m_Address;
+		std::vector<std::string> m_vPlayerNames;
+		std::vector<std::string> m_vPlayerClans;
+
+		int m_SearchVersion = -1; // of the text filters the result is for
+		bool m_Filtered = false;
+		int m_QuickSearchHit = 0;
+	};
+
+	class CSearchTerm
+	{
+	public:
+		std::string m_Lowercase;
+		std::string m_Exact; // without quotes
+		bool m_IsExact;
+
+		bool Matches(const char *pStr, const std::string &Lowercase) const;
+	};
+
+	std::vector<CSearchKeys> m_vSearchKeys;
+	std::string m_SearchConfig; // the text filters the terms were parsed from
+	int m_SearchVersion = 0;
+	std::vector<CSearchTerm> m_vSearchTerms;
+	std::vector<CSearchTerm> m_vExcludeTerms;
+	std::string m_LowercaseAddressFilter;
+	std::string m_LowercaseGametypeFilter;
+
+	static void ParseSearchTerms(const char *pStr, std::vector<CSearchTerm> &vTerms);
+	void UpdateSearchTerms();
+	bool SearchFiltered(CServerEntry *pEntry);
 
 	//
 	void Filter();
@@ -396,6 +474,7 @@ private:
 	CServerEntry *ReplaceEntry(CServerEntry *pEntry, const NETADDR *pAddrs, int NumAddrs);
 
 	void RemoveRequest(CServerEntry *pEntry);
+	void PrioritizeRequests();
 
 	void RequestImpl(const NETADDR &Addr, CServerEntry *pEntry, int *pBasicToken, int *pToken, bool RandomToken) const;
 
@@ -415,7 +494,7 @@ private:
 	bool ValidateCountryName(const char *pCountryName) const;
 	bool ValidateTypeName(const char *pTypeName) const;
 
-	void SetInfo(CServerEntry *pEntry, const CServerInfo &Info) const;
+	void SetInfo(CServerEntry *pEntry, const CServerInfo &Info);
 	void SetLatency(NETADDR Addr, int Latency);
 
 	static bool ParseCommunityFinishes(CCommunity *pCommunity, const json_value &Finishes);
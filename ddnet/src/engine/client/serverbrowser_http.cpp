@@ -15,6 +15,7 @@
 #include <base/system.h>
 
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 #include <chrono>
@@ -314,12 +315,14 @@ public:
 
 	int NumServers() const override
 	{
-		return m_vServers.size();
+		return m_pServers->size();
 	}
 	const CServerInfo &Server(int Index) const override
 	{
-		return m_vServers[Index];
+		return (*m_pServers)[Index];
 	}
+	int Generation() const override { return m_Generation; }
+	bool ServerChanged(int Index) const override { return m_vServerChanged[Index]; }
 
 private:
 	enum
@@ -327,22 +330,49 @@ private:
 		STATE_DONE,
 		STATE_WANTREFRESH,
 		STATE_REFRESHING,
+		STATE_PARSING,
 		STATE_NO_MASTER,
 	};
 
+	// Parses the downloaded server list and compares it to the previous one
+	// on a job thread, the previous list is only read while the job runs
+	class CParseJob : public IJob
+	{
+		void Run() override;
+
+	public:
+		CParseJob(std::shared_ptr<CHttpRequest> pGetServers, std::shared_ptr<const std::vector<CServerInfo>> pPrevServers) :
+			m_pGetServers(std::move(pGetServers)),
+			m_pPrevServers(std::move(pPrevServers))
+		{
+		}
+
+		std::shared_ptr<CHttpRequest> m_pGetServers;
+		std::shared_ptr<const std::vector<CServerInfo>> m_pPrevServers;
+		std::shared_ptr<std::vector<CServerInfo>> m_pServers;
+		std::vector<bool> m_vServerChanged;
+		bool m_Success = false;
+	};
+
 	static bool Validate(json_value *pJson);
 	static bool Parse(json_value *pJson, std::vector<CServerInfo> *pvServers);
+	static bool SameServerInfo(const CServerInfo &Info1, const CServerInfo &Info2);
 
+	IEngine *m_pEngine;
 	IHttp *m_pHttp;
 
 	int m_State = STATE_WANTREFRESH;
 	std::shared_ptr<CHttpRequest> m_pGetServers;
+	std::shared_ptr<CParseJob> m_pParseJob;
 	std::unique_ptr<CChooseMaster> m_pChooseMaster;
 
-	std::vector<CServerInfo> m_vServers;
+	std::shared_ptr<const std::vector<CServerInfo>> m_pServers = std::make_shared<const std::vector<CServerInfo>>();
+	std::vector<bool> m_vServerChanged;
+	int m_Generation = 0;
 };
 
 CServerBrowserHttp::CServerBrowserHttp(IEngine *pEngine, IHttp *pHttp, const char **ppUrls, int NumUrls, int PreviousBestIndex) :
+	m_pEngine(pEngine),
 	m_pHttp(pHttp),
 	m_pChooseMaster(new CChooseMaster(pEngine, pHttp, Validate, ppUrls, NumUrls, PreviousBestIndex))
 {
@@ -383,16 +413,23 @@ void CServerBrowserHttp::Update()
 		{
 			return;
 		}
-		m_State = STATE_DONE;
+		m_State = STATE_PARSING;
 		std::shared_ptr<CHttpRequest> pGetServers = nullptr;
 		std::swap(m_pGetServers, pGetServers);
+		m_pParseJob = std::make_shared<CParseJob>(std::move(pGetServers), m_pServers);
+		m_pEngine->AddJob(m_pParseJob);
+	}
+	else if(m_State == STATE_PARSING)
+	{
+		if(!m_pParseJob->Done())
+		{
+			return;
+		}
+		m_State = STATE_DONE;
+		std::shared_ptr<CParseJob> pParseJob = nullptr;
+		std::swap(m_pParseJob, pParseJob);
 
-		bool Success = true;
-		json_value *pJson = pGetServers->State() == EHttpState::DONE ? pGetServers->ResultJson() : nullptr;
-		Success = Success && pJson;
-		Success = Success && !Parse(pJson, &m_vServers);
-		json_value_free(pJson);
-		if(!Success)
+		if(!pParseJob->m_Success)
 		{
 			log_error("serverbrowser_http", "failed getting serverlist, trying to find best URL");
 			m_pChooseMaster->Reset();
@@ -400,9 +437,13 @@ void CServerBrowserHttp::Update()
 		}
 		else
 		{
+			m_pServers = std::move(pParseJob->m_pServers);
+			m_vServerChanged = std::move(pParseJob->m_vServerChanged);
+			m_Generation++;
+
 			// Try to find new master if the current one returns
 			// results that are 5 minutes old.
-			int Age = SanitizeAge(pGetServers->ResultAgeSeconds());
+			int Age = SanitizeAge(pParseJob->m_pGetServers->ResultAgeSeconds());
 			if(Age > 300)
 			{
 				log_info("serverbrowser_http", "got stale serverlist, age=%ds, trying to find best URL", Age);
@@ -423,6 +464,35 @@ void CServerBrowserHttp::Refresh()
 		m_State = STATE_WANTREFRESH;
 	Update();
 }
+void CServerBrowserHttp::CParseJob::Run()
+{
+	json_value *pJson = m_pGetServers->State() == EHttpState::DONE ? m_pGetServers->ResultJson() : nullptr;
+	std::shared_ptr<std::vector<CServerInfo>> pServers = std::make_shared<std::vector<CServerInfo>>();
+	m_Success = pJson && !Parse(pJson, pServers.get());
+	json_value_free(pJson);
+	if(!m_Success)
+	{
+		return;
+	}
+
+	// Servers are identified by their first address, most of them do not
+	// change between two refreshes.
+	const std::vector<CServerInfo> &vPrevServers = *m_pPrevServers;
+	std::unordered_map<NETADDR, int> PrevByAddr;
+	PrevByAddr.reserve(vPrevServers.size());
+	for(int i = 0; i < (int)vPrevServers.size(); i++)
+	{
+		PrevByAddr.emplace(vPrevServers[i].m_aAddresses[0], i);
+	}
+	m_vServerChanged.resize(pServers->size());
+	for(int i = 0; i < (int)pServers->size(); i++)
+	{
+		const CServerInfo &Server = (*pServers)[i];
+		const auto Prev = PrevByAddr.find(Server.m_aAddresses[0]);
+		m_vServerChanged[i] = Prev == PrevByAddr.end() || !SameServerInfo(vPrevServers[Prev->second], Server);
+	}
+	m_pServers = std::move(pServers);
+}
 static bool ServerbrowserParseUrl(NETADDR *pOut, const char *pUrl)
 {
 	int Failure = net_addr_from_url(pOut, pUrl, nullptr, 0);
@@ -517,9 +587,61 @@ bool CServerBrowserHttp::Parse(json_value *pJson, std::vector<CServerInfo> *pvSe
 			vServers.push_back(SetInfo);
 		}
 	}
-	*pvServers = vServers;
+	*pvServers = std::move(vServers);
 	return false;
 }
+// Compares everything that Parse sets
+bool CServerBrowserHttp::SameServerInfo(const CServerInfo &Info1, const CServerInfo &Info2)
+{
+	bool Unequal;
+	Unequal = false;
+	Unequal = Unequal || Info1.m_NumAddresses != Info2.m_NumAddresses;
+	Unequal = Unequal || mem_comp(Info1.m_aAddresses, Info2.m_aAddresses, Info1.m_NumAddresses * sizeof(Info1.m_aAddresses[0])) != 0;
+	Unequal = Unequal || Info1.m_Location != Info2.m_Location;
+	Unequal = Unequal || Info1.m_MaxClients != Info2.m_MaxClients;
+	Unequal = Unequal || Info1.m_NumClients != Info2.m_NumClients;
+	Unequal = Unequal || Info1.m_MaxPlayers != Info2.m_MaxPlayers;
+	Unequal = Unequal || Info1.m_NumPlayers != Info2.m_NumPlayers;
+	Unequal = Unequal || Info1.m_ClientScoreKind != Info2.m_ClientScoreKind;
+	Unequal = Unequal || Info1.m_RequiresLogin != Info2.m_RequiresLogin;
+	Unequal = Unequal || Info1.m_Flags != Info2.m_Flags;
+	Unequal = Unequal || Info1.m_NumReceivedClients != Info2.m_NumReceivedClients;
+	Unequal = Unequal || str_comp(Info1.m_aGameType, Info2.m_aGameType) != 0;
+	Unequal = Unequal || str_comp(Info1.m_aName, Info2.m_aName) != 0;
+	Unequal = Unequal || str_comp(Info1.m_aMap, Info2.m_aMap) != 0;
+	Unequal = Unequal || str_comp(Info1.m_aVersion, Info2.m_aVersion) != 0;
+	if(Unequal)
+	{
+		return false;
+	}
+	for(int i = 0; i < Info1.m_NumReceivedClients; i++)
+	{
+		const CServerInfo::CClient &Client1 = Info1.m_aClients[i];
+		const CServerInfo::CClient &Client2 = Info2.m_aClients[i];
+		Unequal = false;
+		Unequal = Unequal || str_comp(Client1.m_aName, Client2.m_aName) != 0;
+		Unequal = Unequal || str_comp(Client1.m_aClan, Client2.m_aClan) != 0;
+		Unequal = Unequal || Client1.m_Country != Client2.m_Country;
+		Unequal = Unequal || Client1.m_Score != Client2.m_Score;
+		Unequal = Unequal || Client1.m_Player != Client2.m_Player;
+		Unequal = Unequal || Client1.m_Afk != Client2.m_Afk;
+		Unequal = Unequal || str_comp(Client1.m_aSkin, Client2.m_aSkin) != 0;
+		Unequal = Unequal || Client1.m_CustomSkinColors != Client2.m_CustomSkinColors;
+		Unequal = Unequal || Client1.m_CustomSkinColorBody != Client2.m_CustomSkinColorBody;
+		Unequal = Unequal || Client1.m_CustomSkinColorFeet != Client2.m_CustomSkinColorFeet;
+		for(int Part = 0; Part < protocol7::NUM_SKINPARTS; Part++)
+		{
+			Unequal = Unequal || str_comp(Client1.m_aaSkin7[Part], Client2.m_aaSkin7[Part]) != 0;
+			Unequal = Unequal || Client1.m_aUseCustomSkinColor7[Part] != Client2.m_aUseCustomSkinColor7[Part];
+			Unequal = Unequal || Client1.m_aCustomSkinColor7[Part] != Client2.m_aCustomSkinColor7[Part];
+		}
+		if(Unequal)
+		{
+			return false;
+		}
+	}
+	return true;
+}
 
 static const char *DEFAULT_SERVERLIST_URLS[] = {
 	"https://master1.ddnet.org/ddnet/15/servers.json",
@@ -22,6 +22,10 @@ public:
 
 	virtual int NumServers() const = 0;
 	virtual const CServerInfo &Server(int Index) const = 0;
+	// Incremented every time a new server list has been received
+	virtual int Generation() const = 0;
+	// Whether the server is new or differs from the previous server list
+	virtual bool ServerChanged(int Index) const = 0;
 };
 
 IServerBrowserHttp *CreateServerBrowserHttp(IEngine *pEngine, IStorage *pStorage, IHttp *pHttp, const char *pPreviousBestUrl);
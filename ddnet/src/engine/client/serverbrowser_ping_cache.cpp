@@ -6,9 +6,18 @@
 
 #include <sqlite3.h>
 
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
+using namespace std::chrono_literals;
+
+// The pings are answered from memory. The database is only accessed by a
+// worker thread which stores the pending pings in batches, one transaction
+// each, and loads the stored pings when asked to.
 class CServerBrowserPingCache : public IServerBrowserPingCache
 {
 public:
@@ -20,96 +29,269 @@ public:
 	};
 
 	CServerBrowserPingCache(IConsole *pConsole, IStorage *pStorage);
-	~CServerBrowserPingCache() override = default;
+	~CServerBrowserPingCache() override;
 
 	void Load() override;
+	bool Update() override;
+	void Wait() override;
 
 	int NumEntries() const override;
 	void CachePing(const NETADDR &Addr, int Ping) override;
 	int GetPing(const NETADDR *pAddrs, int NumAddrs) const override;
 
 private:
+	static void ThreadMain(void *pUser);
+	void RunLoop();
+	bool OpenDisk();
+	void LoadDisk(std::vector<CEntry> *pvEntries);
+	void StoreDisk(const std::vector<CEntry> &vEntries);
+
 	IConsole *m_pConsole;
+	IStorage *m_pStorage;
+	void *m_pThread;
 
+	// only accessed by the worker thread
 	CSqlite m_pDisk;
 	CSqliteStmt m_pLoadStmt;
 	CSqliteStmt m_pStoreStmt;
 
+	// only accessed by the main thread
 	std::unordered_map<NETADDR, int> m_Entries;
+	bool m_Loading = false;
+	std::unordered_set<NETADDR> m_ChangedWhileLoading;
+
+	// shared with the worker thread, protected by m_Lock
+	std::mutex m_Lock;
+	std::condition_variable m_Cv;
+	bool m_Shutdown = false;
+	bool m_Busy = false;
+	int m_NumWaiting = 0;
+	bool m_LoadRequested = false;
+	bool m_LoadDone = false;
+	std::vector<CEntry> m_vLoadedEntries;
+	std::unordered_map<NETADDR, int> m_PendingStores;
 };
 
 CServerBrowserPingCache::CServerBrowserPingCache(IConsole *pConsole, IStorage *pStorage) :
-	m_pConsole(pConsole)
+	m_pConsole(pConsole),
+	m_pStorage(pStorage)
+{
+	m_pThread = thread_init(ThreadMain, this, "ping cache");
+}
+
+CServerBrowserPingCache::~CServerBrowserPingCache()
+{
+	{
+		std::unique_lock Lock(m_Lock);
+		m_Shutdown = true;
+		m_Cv.notify_all();
+	}
+	thread_wait(m_pThread);
+}
+
+void CServerBrowserPingCache::ThreadMain(void *pUser)
+{
+	static_cast<CServerBrowserPingCache *>(pUser)->RunLoop();
+}
+
+void CServerBrowserPingCache::RunLoop()
+{
+	const bool Open = OpenDisk();
+
+	std::unique_lock Lock(m_Lock);
+	while(true)
+	{
+		m_Cv.wait(Lock, [this]() { return m_Shutdown || m_LoadRequested || !m_PendingStores.empty(); });
+		if(!m_Shutdown && !m_LoadRequested && !m_PendingStores.empty())
+		{
+			// give further pings the chance to end up in the same transaction
+			m_Cv.wait_for(Lock, 500ms, [this]() { return m_Shutdown || m_LoadRequested || m_NumWaiting > 0; });
+		}
+
+		std::vector<CEntry> vStores;
+		vStores.reserve(m_PendingStores.size());
+		for(const auto &[Addr, Ping] : m_PendingStores)
+		{
+			vStores.push_back(CEntry{Addr, Ping});
+		}
+		m_PendingStores.clear();
+		const bool Load = m_LoadRequested;
+		m_LoadRequested = false;
+		m_Busy = true;
+		Lock.unlock();
+
+		// stores first, so the loaded entries include them
+		std::vector<CEntry> vLoadedEntries;
+		if(Open)
+		{
+			if(!vStores.empty())
+				StoreDisk(vStores);
+			if(Load)
+				LoadDisk(&vLoadedEntries);
+		}
+
+		Lock.lock();
+		if(Load)
+		{
+			m_vLoadedEntries = std::move(vLoadedEntries);
+			m_LoadDone = true;
+		}
+		m_Busy = false;
+		m_Cv.notify_all();
+		if(m_Shutdown && !m_LoadRequested && m_PendingStores.empty())
+		{
+			break;
+		}
+	}
+}
+
+bool CServerBrowserPingCache::OpenDisk()
 {
-	m_pDisk = SqliteOpen(pConsole, pStorage, "ddnet-cache.sqlite3");
+	m_pDisk = SqliteOpen(m_pConsole, m_pStorage, "ddnet-cache.sqlite3");
 	if(!m_pDisk)
 	{
-		pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "serverbrowse_ping_cache", "failed to open ddnet-cache.sqlite3");
-		return;
+		m_pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "serverbrowse_ping_cache", "failed to open ddnet-cache.sqlite3");
+		return false;
 	}
 	sqlite3 *pSqlite = m_pDisk.get();
+	IConsole *pConsole = m_pConsole;
 	static const char TABLE[] = "CREATE TABLE IF NOT EXISTS server_pings (ip_address TEXT PRIMARY KEY NOT NULL, ping INTEGER NOT NULL, utc_timestamp TEXT NOT NULL)";
 	if(SQLITE_HANDLE_ERROR(sqlite3_exec(pSqlite, TABLE, nullptr, nullptr, nullptr)))
 	{
 		m_pDisk = nullptr;
 		pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "serverbrowse_ping_cache", "failed to create server_pings table");
-		return;
+		return false;
 	}
 	m_pLoadStmt = SqlitePrepare(pConsole, pSqlite, "SELECT ip_address, ping FROM server_pings");
 	m_pStoreStmt = SqlitePrepare(pConsole, pSqlite, "INSERT OR REPLACE INTO server_pings (ip_address, ping, utc_timestamp) VALUES (?, ?, datetime('now'))");
+	return true;
 }
 
-void CServerBrowserPingCache::Load()
+void CServerBrowserPingCache::LoadDisk(std::vector<CEntry> *pvEntries)
 {
-	if(m_pDisk)
+	sqlite3 *pSqlite = m_pDisk.get();
+	IConsole *pConsole = m_pConsole;
+	bool Error = false;
+	bool WarnedForBadAddress = false;
+	Error = Error || !m_pLoadStmt;
+	Error = Error || SQLITE_HANDLE_ERROR(sqlite3_reset(m_pLoadStmt.get())) != SQLITE_OK;
+	while(!Error)
 	{
-		std::vector<CEntry> vNewEntries;
-
-		sqlite3 *pSqlite = m_pDisk.get();
-		IConsole *pConsole = m_pConsole;
-		bool Error = false;
-		bool WarnedForBadAddress = false;
-		Error = Error || !m_pLoadStmt;
-		while(!Error)
+		int StepResult = SQLITE_HANDLE_ERROR(sqlite3_step(m_pLoadStmt.get()));
+		if(StepResult == SQLITE_DONE)
 		{
-			int StepResult = SQLITE_HANDLE_ERROR(sqlite3_step(m_pLoadStmt.get()));
-			if(StepResult == SQLITE_DONE)
-			{
-				break;
-			}
-			else if(StepResult == SQLITE_ROW)
+			break;
+		}
+		else if(StepResult == SQLITE_ROW)
+		{
+			const char *pIpAddress = (const char *)sqlite3_column_text(m_pLoadStmt.get(), 0);
+			int Ping = sqlite3_column_int(m_pLoadStmt.get(), 1);
+			NETADDR Addr;
+			if(net_addr_from_str(&Addr, pIpAddress))
 			{
-				const char *pIpAddress = (const char *)sqlite3_column_text(m_pLoadStmt.get(), 0);
-				int Ping = sqlite3_column_int(m_pLoadStmt.get(), 1);
-				NETADDR Addr;
-				if(net_addr_from_str(&Addr, pIpAddress))
+				if(!WarnedForBadAddress)
 				{
-					if(!WarnedForBadAddress)
-					{
-						char aBuf[64];
-						str_format(aBuf, sizeof(aBuf), "invalid address: %s", pIpAddress);
-						pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "serverbrowse_ping_cache", aBuf);
-						WarnedForBadAddress = true;
-					}
-					continue;
+					char aBuf[64];
+					str_format(aBuf, sizeof(aBuf), "invalid address: %s", pIpAddress);
+					pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "serverbrowse_ping_cache", aBuf);
+					WarnedForBadAddress = true;
 				}
-				vNewEntries.push_back(CEntry{Addr, Ping});
-			}
-			else
-			{
-				Error = true;
+				continue;
 			}
+			pvEntries->push_back(CEntry{Addr, Ping});
 		}
+		else
+		{
+			Error = true;
+		}
+	}
+	if(Error)
+	{
+		pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "serverbrowse_ping_cache", "failed to load ping cache");
+		pvEntries->clear();
+	}
+}
+
+void CServerBrowserPingCache::StoreDisk(const std::vector<CEntry> &vEntries)
+{
+	sqlite3 *pSqlite = m_pDisk.get();
+	IConsole *pConsole = m_pConsole;
+	bool Error = false;
+	Error = Error || !m_pStoreStmt;
+	Error = Error || SQLITE_HANDLE_ERROR(sqlite3_exec(pSqlite, "BEGIN", nullptr, nullptr, nullptr)) != SQLITE_OK;
+	if(Error)
+	{
+		pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "serverbrowse_ping_cache", "failed to store pings");
+		return;
+	}
+	for(const CEntry &Entry : vEntries)
+	{
+		char aAddr[NETADDR_MAXSTRSIZE];
+		net_addr_str(&Entry.m_Addr, aAddr, sizeof(aAddr), false);
+
+		Error = Error || SQLITE_HANDLE_ERROR(sqlite3_reset(m_pStoreStmt.get())) != SQLITE_OK;
+		Error = Error || SQLITE_HANDLE_ERROR(sqlite3_bind_text(m_pStoreStmt.get(), 1, aAddr, -1, SQLITE_STATIC)) != SQLITE_OK;
+		Error = Error || SQLITE_HANDLE_ERROR(sqlite3_bind_int(m_pStoreStmt.get(), 2, Entry.m_Ping)) != SQLITE_OK;
+		Error = Error || SQLITE_HANDLE_ERROR(sqlite3_step(m_pStoreStmt.get())) != SQLITE_DONE;
 		if(Error)
 		{
-			pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "serverbrowse_ping_cache", "failed to load ping cache");
-			return;
+			break;
+		}
+	}
+	Error = Error || SQLITE_HANDLE_ERROR(sqlite3_exec(pSqlite, "COMMIT", nullptr, nullptr, nullptr)) != SQLITE_OK;
+	if(Error)
+	{
+		sqlite3_exec(pSqlite, "ROLLBACK", nullptr, nullptr, nullptr);
+		pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "serverbrowse_ping_cache", "failed to store pings");
+	}
+}
+
+void CServerBrowserPingCache::Load()
+{
+	m_Loading = true;
+	m_ChangedWhileLoading.clear();
+
+	std::unique_lock Lock(m_Lock);
+	m_LoadRequested = true;
+	m_Cv.notify_all();
+}
+
+bool CServerBrowserPingCache::Update()
+{
+	std::vector<CEntry> vLoadedEntries;
+	{
+		std::unique_lock Lock(m_Lock);
+		if(!m_LoadDone)
+		{
+			return false;
 		}
-		for(const auto &Entry : vNewEntries)
+		m_LoadDone = false;
+		vLoadedEntries = std::move(m_vLoadedEntries);
+	}
+
+	// pings cached after the load was requested are newer
+	for(const auto &Entry : vLoadedEntries)
+	{
+		if(!m_ChangedWhileLoading.count(Entry.m_Addr))
 		{
 			m_Entries[Entry.m_Addr] = Entry.m_Ping;
 		}
 	}
+	m_Loading = false;
+	m_ChangedWhileLoading.clear();
+	return true;
+}
+
+void CServerBrowserPingCache::Wait()
+{
+	{
+		std::unique_lock Lock(m_Lock);
+		m_NumWaiting++;
+		m_Cv.notify_all();
+		m_Cv.wait(Lock, [this]() { return !m_Busy && !m_LoadRequested && m_PendingStores.empty(); });
+		m_NumWaiting--;
+	}
+	Update();
 }
 
 int CServerBrowserPingCache::NumEntries() const
@@ -123,24 +305,14 @@ void CServerBrowserPingCache::CachePing(const NETADDR &Addr, int Ping)
 	StoredAddr.type &= ~NETTYPE_TW7;
 	StoredAddr.port = 0;
 	m_Entries[StoredAddr] = Ping;
-	if(m_pDisk)
+	if(m_Loading)
 	{
-		sqlite3 *pSqlite = m_pDisk.get();
-		IConsole *pConsole = m_pConsole;
-		char aAddr[NETADDR_MAXSTRSIZE];
-		net_addr_str(&StoredAddr, aAddr, sizeof(aAddr), false);
-
-		bool Error = false;
-		Error = Error || !m_pStoreStmt;
-		Error = Error || SQLITE_HANDLE_ERROR(sqlite3_reset(m_pStoreStmt.get())) != SQLITE_OK;
-		Error = Error || SQLITE_HANDLE_ERROR(sqlite3_bind_text(m_pStoreStmt.get(), 1, aAddr, -1, SQLITE_STATIC)) != SQLITE_OK;
-		Error = Error || SQLITE_HANDLE_ERROR(sqlite3_bind_int(m_pStoreStmt.get(), 2, Ping)) != SQLITE_OK;
-		Error = Error || SQLITE_HANDLE_ERROR(sqlite3_step(m_pStoreStmt.get())) != SQLITE_DONE;
-		if(Error)
-		{
-			pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "serverbrowse_ping_cache", "failed to store ping");
-		}
+		m_ChangedWhileLoading.insert(StoredAddr);
 	}
+
+	std::unique_lock Lock(m_Lock);
+	m_PendingStores[StoredAddr] = Ping;
+	m_Cv.notify_all();
 }
 
 int CServerBrowserPingCache::GetPing(const NETADDR *pAddrs, int NumAddrs) const
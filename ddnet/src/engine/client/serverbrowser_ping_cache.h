@@ -10,7 +10,13 @@ class IServerBrowserPingCache
 public:
 	virtual ~IServerBrowserPingCache() = default;
 
+	// Loads the stored pings in the background, they are added by the
+	// next `Update` after they have been loaded.
 	virtual void Load() = 0;
+	// Returns true if stored pings were added.
+	virtual bool Update() = 0;
+	// Blocks until the pending loads and stores are done.
+	virtual void Wait() = 0;
 
 	virtual int NumEntries() const = 0;
 	virtual void CachePing(const NETADDR &Addr, int Ping) = 0;
@@ -0,0 +1,81 @@
+#include "serverbrowser_ping_scheduler.h"
+
+#include <base/math.h>
+#include <base/system.h>
+
+#include <algorithm>
+
+// assumed round trip time until the first request is answered
+static const int DEFAULT_RTT_MS = 200;
+
+void CServerBrowserPingScheduler::Reset(int64_t Now, int InitialWindow)
+{
+	m_Window = std::clamp(InitialWindow, 1, (int)MAX_WINDOW);
+	m_SlowStart = true;
+	m_Tokens = m_Window;
+	m_LastBudget = Now;
+	m_LastDecrease = Now;
+	m_SmoothedRtt = -1;
+	m_RttVariance = 0;
+}
+
+int CServerBrowserPingScheduler::Budget(int64_t Now, int InFlight)
+{
+	// refill at one window per round trip, at most one window at once
+	const int Rtt = maximum(m_SmoothedRtt >= 0 ? m_SmoothedRtt : DEFAULT_RTT_MS, 1);
+	const double Elapsed = (Now - m_LastBudget) / (double)time_freq();
+	m_LastBudget = Now;
+	m_Tokens = minimum(m_Tokens + Elapsed * 1000.0 / Rtt * m_Window, m_Window);
+	return maximum(minimum((int)m_Tokens, Window() - InFlight), 0);
+}
+
+void CServerBrowserPingScheduler::OnSent(int Num)
+{
+	m_Tokens -= Num;
+}
+
+void CServerBrowserPingScheduler::OnAnswered(int RttMs)
+{
+	if(m_SmoothedRtt < 0)
+	{
+		m_SmoothedRtt = RttMs;
+		m_RttVariance = RttMs / 2;
+	}
+	else
+	{
+		m_RttVariance = (3 * m_RttVariance + absolute(m_SmoothedRtt - RttMs)) / 4;
+		m_SmoothedRtt = (7 * m_SmoothedRtt + RttMs) / 8;
+	}
+
+	// double the window per round trip until the first loss, then grow it
+	// by one request per round trip
+	m_Window = minimum(m_Window + (m_SlowStart ? 1.0 : 1.0 / m_Window), (double)MAX_WINDOW);
+}
+
+void CServerBrowserPingScheduler::OnLost(int64_t Now)
+{
+	// losses of the same round trip only shrink the window once
+	const int Rtt = m_SmoothedRtt >= 0 ? m_SmoothedRtt : DEFAULT_RTT_MS;
+	if((Now - m_LastDecrease) * 1000 < (int64_t)Rtt * time_freq())
+	{
+		return;
+	}
+	m_LastDecrease = Now;
+	m_SlowStart = false;
+	m_Window = maximum(m_Window / 2.0, 1.0);
+	m_Tokens = minimum(m_Tokens, m_Window);
+}
+
+int CServerBrowserPingScheduler::TimeoutMs(int CachedPingMs) const
+{
+	int Timeout = MAX_TIMEOUT_MS;
+	if(CachedPingMs >= 0)
+	{
+		Timeout = 2 * CachedPingMs + 150;
+	}
+	else if(m_SmoothedRtt >= 0)
+	{
+		Timeout = m_SmoothedRtt + 4 * m_RttVariance + 150;
+	}
+	return std::clamp(Timeout, (int)MIN_TIMEOUT_MS, (int)MAX_TIMEOUT_MS);
+}
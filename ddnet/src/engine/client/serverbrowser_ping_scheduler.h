@@ -0,0 +1,46 @@
+#ifndef ENGINE_CLIENT_SERVERBROWSER_PING_SCHEDULER_H
+#define ENGINE_CLIENT_SERVERBROWSER_PING_SCHEDULER_H
+
+#include <cstdint>
+
+// Paces the server info requests of the server browser. The number of
+// requests in flight adapts to the answered and lost requests like a
+// congestion window, new requests are spread over time at the rate the
+// window allows per round trip instead of being sent once per frame.
+class CServerBrowserPingScheduler
+{
+public:
+	enum
+	{
+		MIN_TIMEOUT_MS = 250,
+		MAX_TIMEOUT_MS = 1000,
+		MAX_WINDOW = 1000,
+	};
+
+	void Reset(int64_t Now, int InitialWindow);
+
+	// Returns the number of new requests that may be sent at `Now`.
+	int Budget(int64_t Now, int InFlight);
+	void OnSent(int Num);
+	void OnAnswered(int RttMs);
+	void OnLost(int64_t Now);
+
+	// Returns the time after which a request is considered lost, in
+	// milliseconds. `CachedPingMs` is the last known ping of the server or
+	// -1 if it isn't known.
+	int TimeoutMs(int CachedPingMs) const;
+
+	int Window() const { return (int)m_Window; }
+	int SmoothedRttMs() const { return m_SmoothedRtt; }
+
+private:
+	double m_Window = 1.0;
+	bool m_SlowStart = true;
+	double m_Tokens = 0.0;
+	int64_t m_LastBudget = 0;
+	int64_t m_LastDecrease = 0;
+	int m_SmoothedRtt = -1;
+	int m_RttVariance = 0;
+};
+
+#endif // ENGINE_CLIENT_SERVERBROWSER_PING_SCHEDULER_H
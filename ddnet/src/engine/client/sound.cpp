@@ -10,6 +10,7 @@
 #include <engine/storage.h>
 
 #include "sound.h"
+#include "sound_mix.h"
 
 #if defined(CONF_VIDEORECORDER)
 #include <engine/shared/video.h>
@@ -34,46 +35,44 @@ void CSound::Mix(short *pFinalOut, unsigned Frames)
 
 	const int MasterVol = m_SoundVolume.load(std::memory_order_relaxed);
 
-	for(auto &Voice : m_aVoices)
+	for(int VoiceId = 0; VoiceId < NUM_VOICES; VoiceId++)
 	{
+		CVoice &Voice = m_aVoices[VoiceId];
 		if(!Voice.m_pSample)
 			continue;
+		CVoiceParams &Params = m_aVoiceParams[VoiceId];
 
 		// mix voice
-		int *pOut = m_pMixBuffer;
-
-		const int Step = Voice.m_pSample->m_Channels; // setup input sources
-		short *pInL = &Voice.m_pSample->m_pData[Voice.m_Tick * Step];
-		short *pInR = &Voice.m_pSample->m_pData[Voice.m_Tick * Step + 1];
+		const int Channels = Voice.m_pSample->m_Channels;
+		const short *pIn = &Voice.m_pSample->m_pData[Voice.m_Tick * Channels];
 
 		unsigned End = Voice.m_pSample->m_NumFrames - Voice.m_Tick;
 
-		int VolumeR = round_truncate(Voice.m_pChannel->m_Vol * (Voice.m_Vol / 255.0f));
+		const float VoiceVolume = Params.m_Vol.load(std::memory_order_relaxed) / 255.0f;
+		int VolumeR = round_truncate(Voice.m_pChannel->m_Vol * VoiceVolume);
 		int VolumeL = VolumeR;
 
 		// make sure that we don't go outside the sound data
 		if(Frames < End)
 			End = Frames;
 
-		// check if we have a mono sound
-		if(Voice.m_pSample->m_Channels == 1)
-			pInR = pInL;
-
 		// volume calculation
 		if(Voice.m_Flags & ISound::FLAG_POS && Voice.m_pChannel->m_Pan)
 		{
 			// TODO: we should respect the channel panning value
-			const vec2 Delta = Voice.m_Position - vec2(m_ListenerPositionX.load(std::memory_order_relaxed), m_ListenerPositionY.load(std::memory_order_relaxed));
+			const vec2 Position = vec2(Params.m_PositionX.load(std::memory_order_relaxed), Params.m_PositionY.load(std::memory_order_relaxed));
+			const vec2 Delta = Position - vec2(m_ListenerPositionX.load(std::memory_order_relaxed), m_ListenerPositionY.load(std::memory_order_relaxed));
+			const float VoiceFalloff = Params.m_Falloff.load(std::memory_order_relaxed);
 			vec2 Falloff = vec2(0.0f, 0.0f);
 
 			float RangeX = 0.0f; // for panning
 			bool InVoiceField = false;
 
-			switch(Voice.m_Shape)
+			switch(Params.m_Shape.load(std::memory_order_relaxed))
 			{
 			case ISound::SHAPE_CIRCLE:
 			{
-				const float Radius = Voice.m_Circle.m_Radius;
+				const float Radius = Params.m_CircleRadius.load(std::memory_order_relaxed);
 				RangeX = Radius;
 
 				const float Dist = length(Delta);
@@ -82,7 +81,7 @@ void CSound::Mix(short *pFinalOut, unsigned Frames)
 					InVoiceField = true;
 
 					// falloff
-					const float FalloffDistance = Radius * Voice.m_Falloff;
+					const float FalloffDistance = Radius * VoiceFalloff;
 					Falloff.x = Falloff.y = Dist > FalloffDistance ? (Radius - Dist) / (Radius - FalloffDistance) : 1.0f;
 				}
 				break;
@@ -91,8 +90,8 @@ void CSound::Mix(short *pFinalOut, unsigned Frames)
 			case ISound::SHAPE_RECTANGLE:
 			{
 				const vec2 AbsoluteDelta = vec2(absolute(Delta.x), absolute(Delta.y));
-				const float w = Voice.m_Rectangle.m_Width / 2.0f;
-				const float h = Voice.m_Rectangle.m_Height / 2.0f;
+				const float w = Params.m_RectangleWidth.load(std::memory_order_relaxed) / 2.0f;
+				const float h = Params.m_RectangleHeight.load(std::memory_order_relaxed) / 2.0f;
 				RangeX = w;
 
 				if(AbsoluteDelta.x < w && AbsoluteDelta.y < h)
@@ -100,7 +99,7 @@ void CSound::Mix(short *pFinalOut, unsigned Frames)
 					InVoiceField = true;
 
 					// falloff
-					const vec2 FalloffDistance = vec2(w, h) * Voice.m_Falloff;
+					const vec2 FalloffDistance = vec2(w, h) * VoiceFalloff;
 					Falloff.x = AbsoluteDelta.x > FalloffDistance.x ? (w - AbsoluteDelta.x) / (w - FalloffDistance.x) : 1.0f;
 					Falloff.y = AbsoluteDelta.y > FalloffDistance.y ? (h - AbsoluteDelta.y) / (h - FalloffDistance.y) : 1.0f;
 				}
@@ -131,15 +130,10 @@ void CSound::Mix(short *pFinalOut, unsigned Frames)
 			}
 		}
 
-		// process all frames
-		for(unsigned s = 0; s < End; s++)
-		{
-			*pOut++ += (*pInL) * VolumeL;
-			*pOut++ += (*pInR) * VolumeR;
-			pInL += Step;
-			pInR += Step;
-			Voice.m_Tick++;
-		}
+		// process all frames, silent voices only need to advance
+		if(VolumeL != 0 || VolumeR != 0)
+			SoundMixVoice(m_pMixBuffer, pIn, Channels, End, VolumeL, VolumeR);
+		Voice.m_Tick += End;
 
 		// free voice if not used any more
 		if(Voice.m_Tick == Voice.m_pSample->m_NumFrames)
@@ -149,7 +143,8 @@ void CSound::Mix(short *pFinalOut, unsigned Frames)
 			else
 			{
 				Voice.m_pSample = nullptr;
-				Voice.m_Age++;
+				const CLockScope ParamsLockScope(m_VoiceParamsLock);
+				Params.m_Age.fetch_add(1, std::memory_order_relaxed);
 			}
 		}
 	}
@@ -157,8 +152,7 @@ void CSound::Mix(short *pFinalOut, unsigned Frames)
 	m_SoundLock.unlock();
 
 	// clamp accumulated values
-	for(unsigned i = 0; i < Frames * 2; i++)
-		pFinalOut[i] = std::clamp<int>(((m_pMixBuffer[i] * MasterVol) / 101) >> 8, std::numeric_limits<short>::min(), std::numeric_limits<short>::max());
+	SoundMixClamp(pFinalOut, m_pMixBuffer, Frames * 2, MasterVol);
 
 #if defined(CONF_ARCH_ENDIAN_BIG)
 	swap_endian(pFinalOut, sizeof(short), Frames * 2);
@@ -728,14 +722,13 @@ void CSound::SetVoiceVolume(CVoiceHandle Voice, float Volume)
 	if(!Voice.IsValid())
 		return;
 
-	int VoiceId = Voice.Id();
-
-	const CLockScope LockScope(m_SoundLock);
-	if(m_aVoices[VoiceId].m_Age != Voice.Age())
+	CVoiceParams &Params = m_aVoiceParams[Voice.Id()];
+	const CLockScope LockScope(m_VoiceParamsLock);
+	if(Params.m_Age.load(std::memory_order_relaxed) != Voice.Age())
 		return;
 
 	Volume = std::clamp(Volume, 0.0f, 1.0f);
-	m_aVoices[VoiceId].m_Vol = (int)(Volume * 255.0f);
+	Params.m_Vol.store((int)(Volume * 255.0f), std::memory_order_relaxed);
 }
 
 void CSound::SetVoiceFalloff(CVoiceHandle Voice, float Falloff)
@@ -743,14 +736,13 @@ void CSound::SetVoiceFalloff(CVoiceHandle Voice, float Falloff)
 	if(!Voice.IsValid())
 		return;
 
-	int VoiceId = Voice.Id();
-
-	const CLockScope LockScope(m_SoundLock);
-	if(m_aVoices[VoiceId].m_Age != Voice.Age())
+	CVoiceParams &Params = m_aVoiceParams[Voice.Id()];
+	const CLockScope LockScope(m_VoiceParamsLock);
+	if(Params.m_Age.load(std::memory_order_relaxed) != Voice.Age())
 		return;
 
 	Falloff = std::clamp(Falloff, 0.0f, 1.0f);
-	m_aVoices[VoiceId].m_Falloff = Falloff;
+	Params.m_Falloff.store(Falloff, std::memory_order_relaxed);
 }
 
 void CSound::SetVoicePosition(CVoiceHandle Voice, vec2 Position)
@@ -758,13 +750,13 @@ void CSound::SetVoicePosition(CVoiceHandle Voice, vec2 Position)
 	if(!Voice.IsValid())
 		return;
 
-	int VoiceId = Voice.Id();
-
-	const CLockScope LockScope(m_SoundLock);
-	if(m_aVoices[VoiceId].m_Age != Voice.Age())
+	CVoiceParams &Params = m_aVoiceParams[Voice.Id()];
+	const CLockScope LockScope(m_VoiceParamsLock);
+	if(Params.m_Age.load(std::memory_order_relaxed) != Voice.Age())
 		return;
 
-	m_aVoices[VoiceId].m_Position = Position;
+	Params.m_PositionX.store(Position.x, std::memory_order_relaxed);
+	Params.m_PositionY.store(Position.y, std::memory_order_relaxed);
 }
 
 void CSound::SetVoiceTimeOffset(CVoiceHandle Voice, float TimeOffset)
@@ -775,7 +767,7 @@ void CSound::SetVoiceTimeOffset(CVoiceHandle Voice, float TimeOffset)
 	int VoiceId = Voice.Id();
 
 	const CLockScope LockScope(m_SoundLock);
-	if(m_aVoices[VoiceId].m_Age != Voice.Age())
+	if(m_aVoiceParams[VoiceId].m_Age.load(std::memory_order_relaxed) != Voice.Age())
 		return;
 
 	if(!m_aVoices[VoiceId].m_pSample)
@@ -806,14 +798,13 @@ void CSound::SetVoiceCircle(CVoiceHandle Voice, float Radius)
 	if(!Voice.IsValid())
 		return;
 
-	int VoiceId = Voice.Id();
-
-	const CLockScope LockScope(m_SoundLock);
-	if(m_aVoices[VoiceId].m_Age != Voice.Age())
+	CVoiceParams &Params = m_aVoiceParams[Voice.Id()];
+	const CLockScope LockScope(m_VoiceParamsLock);
+	if(Params.m_Age.load(std::memory_order_relaxed) != Voice.Age())
 		return;
 
-	m_aVoices[VoiceId].m_Shape = ISound::SHAPE_CIRCLE;
-	m_aVoices[VoiceId].m_Circle.m_Radius = maximum(0.0f, Radius);
+	Params.m_CircleRadius.store(maximum(0.0f, Radius), std::memory_order_relaxed);
+	Params.m_Shape.store(ISound::SHAPE_CIRCLE, std::memory_order_relaxed);
 }
 
 void CSound::SetVoiceRectangle(CVoiceHandle Voice, float Width, float Height)
@@ -821,15 +812,14 @@ void CSound::SetVoiceRectangle(CVoiceHandle Voice, float Width, float Height)
 	if(!Voice.IsValid())
 		return;
 
-	int VoiceId = Voice.Id();
-
-	const CLockScope LockScope(m_SoundLock);
-	if(m_aVoices[VoiceId].m_Age != Voice.Age())
+	CVoiceParams &Params = m_aVoiceParams[Voice.Id()];
+	const CLockScope LockScope(m_VoiceParamsLock);
+	if(Params.m_Age.load(std::memory_order_relaxed) != Voice.Age())
 		return;
 
-	m_aVoices[VoiceId].m_Shape = ISound::SHAPE_RECTANGLE;
-	m_aVoices[VoiceId].m_Rectangle.m_Width = maximum(0.0f, Width);
-	m_aVoices[VoiceId].m_Rectangle.m_Height = maximum(0.0f, Height);
+	Params.m_RectangleWidth.store(maximum(0.0f, Width), std::memory_order_relaxed);
+	Params.m_RectangleHeight.store(maximum(0.0f, Height), std::memory_order_relaxed);
+	Params.m_Shape.store(ISound::SHAPE_RECTANGLE, std::memory_order_relaxed);
 }
 
 ISound::CVoiceHandle CSound::Play(int ChannelId, int SampleId, int Flags, float Volume, vec2 Position)
@@ -869,13 +859,15 @@ ISound::CVoiceHandle CSound::Play(int ChannelId, int SampleId, int Flags, float
 	{
 		m_aVoices[VoiceId].m_Tick = 0;
 	}
-	m_aVoices[VoiceId].m_Vol = (int)(std::clamp(Volume, 0.0f, 1.0f) * 255.0f);
 	m_aVoices[VoiceId].m_Flags = Flags;
-	m_aVoices[VoiceId].m_Position = Position;
-	m_aVoices[VoiceId].m_Falloff = 0.0f;
-	m_aVoices[VoiceId].m_Shape = ISound::SHAPE_CIRCLE;
-	m_aVoices[VoiceId].m_Circle.m_Radius = 1500;
-	return CreateVoiceHandle(VoiceId, m_aVoices[VoiceId].m_Age);
+	CVoiceParams &Params = m_aVoiceParams[VoiceId];
+	Params.m_Vol.store((int)(std::clamp(Volume, 0.0f, 1.0f) * 255.0f), std::memory_order_relaxed);
+	Params.m_PositionX.store(Position.x, std::memory_order_relaxed);
+	Params.m_PositionY.store(Position.y, std::memory_order_relaxed);
+	Params.m_Falloff.store(0.0f, std::memory_order_relaxed);
+	Params.m_Shape.store(ISound::SHAPE_CIRCLE, std::memory_order_relaxed);
+	Params.m_CircleRadius.store(1500.0f, std::memory_order_relaxed);
+	return CreateVoiceHandle(VoiceId, Params.m_Age.load(std::memory_order_relaxed));
 }
 
 ISound::CVoiceHandle CSound::PlayAt(int ChannelId, int SampleId, int Flags, float Volume, vec2 Position)
@@ -952,11 +944,12 @@ void CSound::StopVoice(CVoiceHandle Voice)
 	int VoiceId = Voice.Id();
 
 	const CLockScope LockScope(m_SoundLock);
-	if(m_aVoices[VoiceId].m_Age != Voice.Age())
+	if(m_aVoiceParams[VoiceId].m_Age.load(std::memory_order_relaxed) != Voice.Age())
 		return;
 
 	m_aVoices[VoiceId].m_pSample = nullptr;
-	m_aVoices[VoiceId].m_Age++;
+	const CLockScope ParamsLockScope(m_VoiceParamsLock);
+	m_aVoiceParams[VoiceId].m_Age.fetch_add(1, std::memory_order_relaxed);
 }
 
 bool CSound::IsPlaying(int SampleId)
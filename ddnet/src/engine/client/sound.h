@@ -45,19 +45,29 @@ struct CVoice
 {
 	CSample *m_pSample;
 	CChannel *m_pChannel;
-	int m_Age; // increases when reused
 	int m_Tick;
-	int m_Vol; // 0 - 255
 	int m_Flags;
-	vec2 m_Position;
-	float m_Falloff; // [0.0, 1.0]
+};
 
-	int m_Shape;
-	union
-	{
-		ISound::CVoiceShapeCircle m_Circle;
-		ISound::CVoiceShapeRectangle m_Rectangle;
-	};
+// Parameters of a voice which are updated without the sound lock, so the
+// game thread is not blocked while the audio thread is mixing.
+// Updates check the age and store under the voice params lock, which is
+// also held when the age increases, so a reused voice never receives the
+// parameters of an old handle.
+// Position and shape are stored as individual atomics, a mix can observe
+// a partially updated position, which is not audible.
+struct CVoiceParams
+{
+	std::atomic<int> m_Age = 0; // increases when reused, only changed with the sound lock and the voice params lock
+	std::atomic<int> m_Vol = 0; // 0 - 255
+	std::atomic<float> m_Falloff = 0.0f; // [0.0, 1.0]
+	std::atomic<float> m_PositionX = 0.0f;
+	std::atomic<float> m_PositionY = 0.0f;
+
+	std::atomic<int> m_Shape = ISound::SHAPE_CIRCLE;
+	std::atomic<float> m_CircleRadius = 0.0f;
+	std::atomic<float> m_RectangleWidth = 0.0f;
+	std::atomic<float> m_RectangleHeight = 0.0f;
 };
 
 class CSound : public IEngineSound
@@ -72,11 +82,13 @@ class CSound : public IEngineSound
 	bool m_SoundEnabled = false;
 	SDL_AudioDeviceID m_Device = 0;
 	CLock m_SoundLock;
+	CLock m_VoiceParamsLock;
 
 	CSample m_aSamples[NUM_SAMPLES] GUARDED_BY(m_SoundLock) = {{0}};
 	int m_FirstFreeSampleIndex GUARDED_BY(m_SoundLock) = 0;
 
 	CVoice m_aVoices[NUM_VOICES] GUARDED_BY(m_SoundLock) = {{nullptr}};
+	CVoiceParams m_aVoiceParams[NUM_VOICES];
 	CChannel m_aChannels[NUM_CHANNELS] GUARDED_BY(m_SoundLock) = {{255, 0}};
 	int m_NextVoice GUARDED_BY(m_SoundLock) = 0;
 	uint32_t m_MaxFrames = 0;
@@ -121,13 +133,13 @@ public:
 	void SetChannel(int ChannelId, float Vol, float Pan) override REQUIRES(!m_SoundLock);
 	void SetListenerPosition(vec2 Position) override;
 
-	void SetVoiceVolume(CVoiceHandle Voice, float Volume) override REQUIRES(!m_SoundLock);
-	void SetVoiceFalloff(CVoiceHandle Voice, float Falloff) override REQUIRES(!m_SoundLock);
-	void SetVoicePosition(CVoiceHandle Voice, vec2 Position) override REQUIRES(!m_SoundLock);
+	void SetVoiceVolume(CVoiceHandle Voice, float Volume) override REQUIRES(!m_VoiceParamsLock);
+	void SetVoiceFalloff(CVoiceHandle Voice, float Falloff) override REQUIRES(!m_VoiceParamsLock);
+	void SetVoicePosition(CVoiceHandle Voice, vec2 Position) override REQUIRES(!m_VoiceParamsLock);
 	void SetVoiceTimeOffset(CVoiceHandle Voice, float TimeOffset) override REQUIRES(!m_SoundLock); // in s
 
-	void SetVoiceCircle(CVoiceHandle Voice, float Radius) override REQUIRES(!m_SoundLock);
-	void SetVoiceRectangle(CVoiceHandle Voice, float Width, float Height) override REQUIRES(!m_SoundLock);
+	void SetVoiceCircle(CVoiceHandle Voice, float Radius) override REQUIRES(!m_VoiceParamsLock);
+	void SetVoiceRectangle(CVoiceHandle Voice, float Width, float Height) override REQUIRES(!m_VoiceParamsLock);
 
 	CVoiceHandle Play(int ChannelId, int SampleId, int Flags, float Volume, vec2 Position) REQUIRES(!m_SoundLock);
 	CVoiceHandle PlayAt(int ChannelId, int SampleId, int Flags, float Volume, vec2 Position) override REQUIRES(!m_SoundLock);
@@ -135,11 +147,11 @@ public:
 	void Pause(int SampleId) override REQUIRES(!m_SoundLock);
 	void Stop(int SampleId) override REQUIRES(!m_SoundLock);
 	void StopAll() override REQUIRES(!m_SoundLock);
-	void StopVoice(CVoiceHandle Voice) override REQUIRES(!m_SoundLock);
+	void StopVoice(CVoiceHandle Voice) override REQUIRES(!m_SoundLock) REQUIRES(!m_VoiceParamsLock);
 	bool IsPlaying(int SampleId) override REQUIRES(!m_SoundLock);
 
 	int MixingRate() const override { return m_MixingRate; }
-	void Mix(short *pFinalOut, unsigned Frames) override REQUIRES(!m_SoundLock);
+	void Mix(short *pFinalOut, unsigned Frames) override REQUIRES(!m_SoundLock) REQUIRES(!m_VoiceParamsLock);
 
 	void PauseAudioDevice() override;
 	void UnpauseAudioDevice() override;
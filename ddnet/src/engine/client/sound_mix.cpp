@@ -0,0 +1,111 @@
+#include "sound_mix.h"
+
+#include <base/system.h>
+
+#include <algorithm>
+#include <limits>
+
+#if defined(CONF_ARCH_AMD64) || defined(__SSE2__)
+#define SOUND_MIX_SSE2
+#include <emmintrin.h>
+#endif
+
+static void SoundMixVoiceScalar(int *pMixBuffer, const short *pData, int Channels, unsigned Frames, int VolumeL, int VolumeR)
+{
+	const short *pInL = pData;
+	const short *pInR = Channels == 1 ? pData : pData + 1;
+	for(unsigned s = 0; s < Frames; s++)
+	{
+		*pMixBuffer++ += (*pInL) * VolumeL;
+		*pMixBuffer++ += (*pInR) * VolumeR;
+		pInL += Channels;
+		pInR += Channels;
+	}
+}
+
+#if defined(SOUND_MIX_SSE2)
+// Adds the exact 32 bit products of eight 16 bit samples and volumes to the mix buffer
+static void SoundMixAccumulate8(int *pMixBuffer, __m128i Samples, __m128i Volumes)
+{
+	const __m128i Low = _mm_mullo_epi16(Samples, Volumes);
+	const __m128i High = _mm_mulhi_epi16(Samples, Volumes);
+	__m128i *pOut = (__m128i *)pMixBuffer;
+	_mm_storeu_si128(pOut, _mm_add_epi32(_mm_loadu_si128(pOut), _mm_unpacklo_epi16(Low, High)));
+	_mm_storeu_si128(pOut + 1, _mm_add_epi32(_mm_loadu_si128(pOut + 1), _mm_unpackhi_epi16(Low, High)));
+}
+#endif
+
+void SoundMixVoice(int *pMixBuffer, const short *pData, int Channels, unsigned Frames, int VolumeL, int VolumeR)
+{
+	unsigned Frame = 0;
+#if defined(SOUND_MIX_SSE2)
+	// the 16 bit multiplication is exact as long as the volumes fit into 16 bits, which they always do in practice
+	const bool VolumesFit = VolumeL >= std::numeric_limits<short>::min() && VolumeL <= std::numeric_limits<short>::max() &&
+				VolumeR >= std::numeric_limits<short>::min() && VolumeR <= std::numeric_limits<short>::max();
+	if(VolumesFit && (Channels == 1 || Channels == 2))
+	{
+		const __m128i Volumes = _mm_set_epi16(VolumeR, VolumeL, VolumeR, VolumeL, VolumeR, VolumeL, VolumeR, VolumeL);
+		if(Channels == 2)
+		{
+			for(; Frame + 4 <= Frames; Frame += 4)
+			{
+				const __m128i Samples = _mm_loadu_si128((const __m128i *)&pData[Frame * 2]);
+				SoundMixAccumulate8(&pMixBuffer[Frame * 2], Samples, Volumes);
+			}
+		}
+		else
+		{
+			for(; Frame + 8 <= Frames; Frame += 8)
+			{
+				const __m128i Samples = _mm_loadu_si128((const __m128i *)&pData[Frame]);
+				SoundMixAccumulate8(&pMixBuffer[Frame * 2], _mm_unpacklo_epi16(Samples, Samples), Volumes);
+				SoundMixAccumulate8(&pMixBuffer[Frame * 2 + 8], _mm_unpackhi_epi16(Samples, Samples), Volumes);
+			}
+		}
+	}
+#endif
+	SoundMixVoiceScalar(&pMixBuffer[Frame * 2], &pData[Frame * Channels], Channels, Frames - Frame, VolumeL, VolumeR);
+}
+
+#if defined(SOUND_MIX_SSE2)
+// Low 32 bits of the products of four values with a small non-negative factor, like the scalar multiplication
+static __m128i SoundMixMultiply(__m128i Values, __m128i Factor)
+{
+	const __m128i Even = _mm_mul_epu32(Values, Factor);
+	const __m128i Odd = _mm_mul_epu32(_mm_srli_epi64(Values, 32), Factor);
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(Even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(Odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+// Signed division by 101 rounding towards zero, using a multiplication with the inverse
+static __m128i SoundMixDivide101(__m128i Values)
+{
+	static constexpr unsigned MAGIC = 2721563436u; // ceil(2^38 / 101), exact for all dividends below 2^31 + 1
+	const __m128i Magic = _mm_set1_epi32(MAGIC);
+	const __m128i Sign = _mm_srai_epi32(Values, 31);
+	const __m128i Absolute = _mm_sub_epi32(_mm_xor_si128(Values, Sign), Sign);
+	const __m128i Even = _mm_srli_epi64(_mm_mul_epu32(Absolute, Magic), 38);
+	const __m128i Odd = _mm_srli_epi64(_mm_mul_epu32(_mm_srli_epi64(Absolute, 32), Magic), 38);
+	const __m128i Quotient = _mm_unpacklo_epi32(_mm_shuffle_epi32(Even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(Odd, _MM_SHUFFLE(0, 0, 2, 0)));
+	return _mm_sub_epi32(_mm_xor_si128(Quotient, Sign), Sign);
+}
+#endif
+
+void SoundMixClamp(short *pFinalOut, const int *pMixBuffer, unsigned NumValues, int MasterVolume)
+{
+	unsigned i = 0;
+#if defined(SOUND_MIX_SSE2)
+	if(MasterVolume >= 0)
+	{
+		const __m128i Factor = _mm_set1_epi32(MasterVolume);
+		for(; i + 8 <= NumValues; i += 8)
+		{
+			const __m128i First = _mm_srai_epi32(SoundMixDivide101(SoundMixMultiply(_mm_loadu_si128((const __m128i *)&pMixBuffer[i]), Factor)), 8);
+			const __m128i Second = _mm_srai_epi32(SoundMixDivide101(SoundMixMultiply(_mm_loadu_si128((const __m128i *)&pMixBuffer[i + 4]), Factor)), 8);
+			// saturating pack clamps to the range of short
+			_mm_storeu_si128((__m128i *)&pFinalOut[i], _mm_packs_epi32(First, Second));
+		}
+	}
+#endif
+	for(; i < NumValues; i++)
+		pFinalOut[i] = std::clamp<int>(((pMixBuffer[i] * MasterVolume) / 101) >> 8, std::numeric_limits<short>::min(), std::numeric_limits<short>::max());
+}
@@ -0,0 +1,30 @@
+#ifndef ENGINE_CLIENT_SOUND_MIX_H
+#define ENGINE_CLIENT_SOUND_MIX_H
+
+#include <cstdint>
+
+// Mixing kernels of the software mixer, the output is always interleaved stereo.
+
+/**
+ * Accumulates the frames of one voice into the mix buffer.
+ *
+ * @param pMixBuffer Interleaved stereo buffer with at least `Frames * 2` values.
+ * @param pData First frame of the sample data to mix.
+ * @param Channels Number of interleaved channels of the sample data, mono samples are mixed into both channels.
+ * @param Frames Number of frames to mix.
+ * @param VolumeL Volume of the left channel.
+ * @param VolumeR Volume of the right channel.
+ */
+void SoundMixVoice(int *pMixBuffer, const short *pData, int Channels, unsigned Frames, int VolumeL, int VolumeR);
+
+/**
+ * Applies the master volume to the mix buffer and clamps it into the final output.
+ *
+ * @param pFinalOut Output buffer with at least `NumValues` values.
+ * @param pMixBuffer Accumulated mix buffer.
+ * @param NumValues Number of values, i.e. twice the number of stereo frames.
+ * @param MasterVolume Master volume between 0 and 100.
+ */
+void SoundMixClamp(short *pFinalOut, const int *pMixBuffer, unsigned NumValues, int MasterVolume);
+
+#endif
@@ -6,6 +6,7 @@
 
 #include <engine/console.h>
 #include <engine/graphics.h>
+#include <engine/shared/config.h>
 #include <engine/shared/json.h>
 #include <engine/storage.h>
 #include <engine/textrender.h>
@@ -14,9 +15,16 @@
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <cstddef>
+#include <deque>
 #include <limits>
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
 #include <tuple>
 #include <unordered_map>
 #include <vector>
@@ -33,6 +41,10 @@ struct SGlyph
 	enum class EState
 	{
 		UNINITIALIZED,
+		// only queued for prewarming, the metrics are not known yet
+		PREWARMING,
+		// metrics and atlas position are known, the bitmap is still being rasterized
+		PENDING,
 		RENDERED,
 		ERROR,
 	};
@@ -329,6 +341,76 @@ private:
 	std::vector<FT_Face> m_vFallbackFaces;
 	std::vector<FT_Face> m_vFtFaces;
 
+	/**
+	 * The maximum number of characters queued for prewarming per frame.
+	 */
+	static constexpr int PREWARM_CHARACTERS_PER_UPDATE = 256;
+
+	struct SRasterizeRequest
+	{
+		// face of the glyph in the glyph map, only used by the main thread
+		FT_Face m_Face;
+		// index of the face in m_vFtFaces and m_vRasterizerFaces
+		size_t m_FaceIndex;
+		int m_Chr;
+		FT_UInt m_GlyphIndex;
+		int m_FontSize;
+		unsigned m_Generation;
+	};
+
+	struct SRasterizedGlyph
+	{
+		SRasterizeRequest m_Request;
+		bool m_Success;
+		// metrics of the glyph without the atlas position
+		SGlyph m_Glyph;
+		std::vector<uint8_t> m_vFill;
+		std::vector<uint8_t> m_vOutline;
+	};
+
+	struct SPrewarmRange
+	{
+		int m_First;
+		int m_Last;
+	};
+
+	struct SPrewarmProgress
+	{
+		int m_FontSize;
+		size_t m_Range;
+		int m_Chr;
+	};
+
+	// Glyphs are rasterized by a background thread with its own FreeType library and faces,
+	// as a FreeType face must not be used by multiple threads at the same time.
+	void *m_pRasterizerThread = nullptr;
+	FT_Library m_RasterizerLibrary = nullptr;
+	std::mutex m_RasterizerFaceLock;
+	std::vector<FT_Face> m_vRasterizerFaces; // protected by m_RasterizerFaceLock
+	// shared with the rasterizer thread, protected by m_RasterizerLock
+	std::mutex m_RasterizerLock;
+	std::condition_variable m_RasterizerCv;
+	std::deque<SRasterizeRequest> m_RasterizeRequests;
+	std::deque<SRasterizeRequest> m_PrewarmRequests;
+	std::vector<SRasterizedGlyph> m_vRasterizedGlyphs;
+	bool m_RasterizerShutdown = false;
+	std::atomic_bool m_HasRasterizedGlyphs = false;
+
+	// results of requests made before the atlas was cleared are discarded
+	unsigned m_Generation = 0;
+	// incremented when glyphs that were already used in layouts change
+	unsigned m_LayoutGeneration = 0;
+	int m_NumPendingGlyphs = 0;
+	int m_NumFrameCacheMisses = 0;
+	int m_NumLastFrameCacheMisses = 0;
+
+	bool m_aPrewarmStarted[MAX_FONT_SIZE + 1] = {};
+	// set when a prewarmed glyph did not fit into the atlas without growing it
+	bool m_PrewarmStopped = false;
+	char m_aPrewarmRangesConfig[256] = "";
+	std::vector<SPrewarmRange> m_vPrewarmRanges;
+	std::deque<SPrewarmProgress> m_PrewarmQueue;
+
 	FT_Face GetFaceByName(const char *pFamilyName)
 	{
 		if(pFamilyName == nullptr || pFamilyName[0] == '\0')
@@ -488,7 +570,8 @@ private:
 		{
 			mem_copy(&m_apTextureData[TextureIndex][PosX + ((y + PosY) * m_TextureDimension)], &pData[y * Width], Width);
 		}
-		Graphics()->UpdateTextTexture(m_aTextures[TextureIndex], PosX, PosY, Width, Height, pData, true);
+		// the data is owned by the rasterized glyph, so the graphics copy it
+		Graphics()->UpdateTextTexture(m_aTextures[TextureIndex], PosX, PosY, Width, Height, pData, false);
 	}
 
 	bool FitGlyph(size_t Width, size_t Height, int &PosX, int &PosY)
@@ -496,89 +579,365 @@ private:
 		return m_TextureAtlas.Add(Width, Height, PosX, PosY);
 	}
 
-	bool RenderGlyph(SGlyph &Glyph)
+	bool ReserveGlyph(SGlyph &Glyph, bool Grow)
+	{
+		int X = 0;
+		int Y = 0;
+
+		if(Glyph.m_Width > 0 && Glyph.m_Height > 0)
+		{
+			// find space in atlas, or increase size if necessary
+			while(!FitGlyph(Glyph.m_Width, Glyph.m_Height, X, Y))
+			{
+				if(!Grow)
+					return false;
+				if(!IncreaseGlyphMapSize())
+				{
+					log_debug("textrender", "Cannot fit glyph into atlas, which is already at maximum size. Chr=%d GlyphIndex=%u", Glyph.m_Chr, Glyph.m_GlyphIndex);
+					return false;
+				}
+			}
+		}
+
+		Glyph.m_aUVs[0] = X;
+		Glyph.m_aUVs[1] = Y;
+		Glyph.m_aUVs[2] = Glyph.m_aUVs[0] + Glyph.m_Width;
+		Glyph.m_aUVs[3] = Glyph.m_aUVs[1] + Glyph.m_Height;
+		return true;
+	}
+
+	void SetGlyphMetrics(SGlyph &Glyph, FT_GlyphSlot pSlot, int FontSize) const
+	{
+		// adjust spacing
+		const unsigned RealWidth = pSlot->bitmap.width;
+		const unsigned RealHeight = pSlot->bitmap.rows;
+		const int Spacing = RealWidth > 0 ? AdjustOutlineThicknessToFontSize(1, FontSize) + 1 : 0;
+
+		Glyph.m_Height = RealHeight + Spacing * 2;
+		Glyph.m_Width = RealWidth + Spacing * 2;
+		Glyph.m_CharHeight = RealHeight;
+		Glyph.m_CharWidth = RealWidth;
+		Glyph.m_OffsetX = (pSlot->metrics.horiBearingX >> 6);
+		Glyph.m_OffsetY = -((pSlot->metrics.height >> 6) - (pSlot->metrics.horiBearingY >> 6));
+		Glyph.m_AdvanceX = (pSlot->advance.x >> 6);
+	}
+
+	// Loads the metrics of the glyph and reserves its space in the atlas, so it can be used
+	// by text containers right away. It is empty until it was rasterized in the background.
+	bool LoadGlyph(SGlyph &Glyph, bool QueueRasterize)
 	{
 		FT_Set_Pixel_Sizes(Glyph.m_Face, 0, Glyph.m_FontSize);
 
-		if(FT_Load_Glyph(Glyph.m_Face, Glyph.m_GlyphIndex, FT_LOAD_RENDER | FT_LOAD_NO_BITMAP))
+		// the bitmap size is known without rendering the outline
+		if(FT_Load_Glyph(Glyph.m_Face, Glyph.m_GlyphIndex, FT_LOAD_NO_BITMAP))
 		{
 			log_debug("textrender", "Error loading glyph. Chr=%d GlyphIndex=%u", Glyph.m_Chr, Glyph.m_GlyphIndex);
 			return false;
 		}
 
-		const FT_Bitmap *pBitmap = &Glyph.m_Face->glyph->bitmap;
-		if(pBitmap->pixel_mode != FT_PIXEL_MODE_GRAY)
+		if(Glyph.m_Face->glyph->format != FT_GLYPH_FORMAT_OUTLINE)
 		{
-			log_debug("textrender", "Error loading glyph, unsupported pixel mode. Chr=%d GlyphIndex=%u PixelMode=%d", Glyph.m_Chr, Glyph.m_GlyphIndex, pBitmap->pixel_mode);
+			log_debug("textrender", "Error loading glyph, unsupported format. Chr=%d GlyphIndex=%u Format=%d", Glyph.m_Chr, Glyph.m_GlyphIndex, (int)Glyph.m_Face->glyph->format);
 			return false;
 		}
 
-		const unsigned RealWidth = pBitmap->width;
-		const unsigned RealHeight = pBitmap->rows;
+		SetGlyphMetrics(Glyph, Glyph.m_Face->glyph, Glyph.m_FontSize);
+		if(!ReserveGlyph(Glyph, true))
+			return false;
 
-		// adjust spacing
-		int OutlineThickness = 0;
-		int x = 0;
-		int y = 0;
-		if(RealWidth > 0)
+		if(Glyph.m_Width > 0 && Glyph.m_Height > 0)
 		{
-			OutlineThickness = AdjustOutlineThicknessToFontSize(1, Glyph.m_FontSize);
-			x += (OutlineThickness + 1);
-			y += (OutlineThickness + 1);
+			Glyph.m_State = SGlyph::EState::PENDING;
+			if(QueueRasterize)
+				RequestRasterize(Glyph, false);
 		}
+		else
+		{
+			Glyph.m_State = SGlyph::EState::RENDERED;
+		}
+		return true;
+	}
 
-		const unsigned Width = RealWidth + x * 2;
-		const unsigned Height = RealHeight + y * 2;
+	const SGlyph *ReplaceGlyph(SGlyph &Glyph)
+	{
+		// Use replacement character if the glyph could not be rendered,
+		// also retrieve replacement character from the atlas.
+		const SGlyph *pReplacementCharacter = Glyph.m_Chr == REPLACEMENT_CHARACTER ? nullptr : GetGlyph(REPLACEMENT_CHARACTER, Glyph.m_FontSize);
+		if(pReplacementCharacter)
+		{
+			Glyph = *pReplacementCharacter;
+			return &Glyph;
+		}
 
-		int X = 0;
-		int Y = 0;
+		// Keep failed glyph in the cache so we don't attempt to render it again,
+		// but set its state to ERROR so we don't return it to the text render.
+		Glyph.m_State = SGlyph::EState::ERROR;
+		return nullptr;
+	}
 
-		if(Width > 0 && Height > 0)
+	void RequestRasterize(const SGlyph &Glyph, bool Prewarm)
+	{
+		const auto FaceIt = std::find(m_vFtFaces.begin(), m_vFtFaces.end(), Glyph.m_Face);
+		dbg_assert(FaceIt != m_vFtFaces.end(), "Glyph face was not added to the glyph map");
+		const SRasterizeRequest Request = {Glyph.m_Face, (size_t)(FaceIt - m_vFtFaces.begin()), Glyph.m_Chr, Glyph.m_GlyphIndex, Glyph.m_FontSize, m_Generation};
 		{
-			// find space in atlas, or increase size if necessary
-			while(!FitGlyph(Width, Height, X, Y))
+			const std::unique_lock Lock(m_RasterizerLock);
+			// glyphs that are already displayed are rasterized before prewarmed ones
+			(Prewarm ? m_PrewarmRequests : m_RasterizeRequests).push_back(Request);
+			m_RasterizerCv.notify_one();
+		}
+		m_NumPendingGlyphs++;
+	}
+
+	static void RasterizerThread(void *pUser)
+	{
+		static_cast<CGlyphMap *>(pUser)->RunRasterizer();
+	}
+
+	void RunRasterizer()
+	{
+		std::unique_lock Lock(m_RasterizerLock);
+		while(true)
+		{
+			m_RasterizerCv.wait(Lock, [this]() { return m_RasterizerShutdown || !m_RasterizeRequests.empty() || !m_PrewarmRequests.empty(); });
+			if(m_RasterizerShutdown)
+				return;
+
+			std::deque<SRasterizeRequest> &Requests = m_RasterizeRequests.empty() ? m_PrewarmRequests : m_RasterizeRequests;
+			SRasterizedGlyph Result;
+			Result.m_Request = Requests.front();
+			Requests.pop_front();
+			Lock.unlock();
+
+			Result.m_Success = Rasterize(Result);
+
+			Lock.lock();
+			m_vRasterizedGlyphs.push_back(std::move(Result));
+			m_HasRasterizedGlyphs.store(true);
+		}
+	}
+
+	// Called by the rasterizer thread
+	bool Rasterize(SRasterizedGlyph &Result)
+	{
+		const SRasterizeRequest &Request = Result.m_Request;
+		const std::unique_lock Lock(m_RasterizerFaceLock);
+		FT_Face Face = m_vRasterizerFaces[Request.m_FaceIndex];
+		if(Face == nullptr)
+			return false;
+
+		FT_Set_Pixel_Sizes(Face, 0, Request.m_FontSize);
+
+		if(FT_Load_Glyph(Face, Request.m_GlyphIndex, FT_LOAD_RENDER | FT_LOAD_NO_BITMAP))
+		{
+			log_debug("textrender", "Error loading glyph. Chr=%d GlyphIndex=%u", Request.m_Chr, Request.m_GlyphIndex);
+			return false;
+		}
+
+		const FT_Bitmap *pBitmap = &Face->glyph->bitmap;
+		if(pBitmap->pixel_mode != FT_PIXEL_MODE_GRAY)
+		{
+			log_debug("textrender", "Error loading glyph, unsupported pixel mode. Chr=%d GlyphIndex=%u PixelMode=%d", Request.m_Chr, Request.m_GlyphIndex, pBitmap->pixel_mode);
+			return false;
+		}
+
+		SetGlyphMetrics(Result.m_Glyph, Face->glyph, Request.m_FontSize);
+		const unsigned Width = Result.m_Glyph.m_Width;
+		const unsigned Height = Result.m_Glyph.m_Height;
+		if(Width == 0 || Height == 0)
+			return true;
+
+		// prepare glyph data
+		const int OutlineThickness = AdjustOutlineThicknessToFontSize(1, Request.m_FontSize);
+		const unsigned x = OutlineThickness + 1;
+		const unsigned y = OutlineThickness + 1;
+		Result.m_vFill.resize((size_t)Width * Height);
+		Result.m_vOutline.resize((size_t)Width * Height);
+		for(unsigned py = 0; py < pBitmap->rows; ++py)
+		{
+			mem_copy(&Result.m_vFill[(py + y) * Width + x], &pBitmap->buffer[py * pBitmap->width], pBitmap->width);
+		}
+		Grow(Result.m_vFill.data(), Result.m_vOutline.data(), Width, Height, OutlineThickness);
+		return true;
+	}
+
+	void UploadRasterizedGlyph(SRasterizedGlyph &Result)
+	{
+		const auto GlyphIt = m_Glyphs.find(std::make_tuple(Result.m_Request.m_Face, Result.m_Request.m_Chr, Result.m_Request.m_FontSize));
+		if(GlyphIt == m_Glyphs.end())
+			return;
+		SGlyph &Glyph = GlyphIt->second;
+		// failed glyphs might have been replaced by the replacement character in the meantime
+		if((Glyph.m_State != SGlyph::EState::PENDING && Glyph.m_State != SGlyph::EState::PREWARMING) || Glyph.m_Chr != Result.m_Request.m_Chr)
+			return;
+
+		if(!Result.m_Success)
+		{
+			if(Glyph.m_State == SGlyph::EState::PREWARMING)
 			{
-				if(!IncreaseGlyphMapSize())
+				m_Glyphs.erase(GlyphIt);
+			}
+			else
+			{
+				ReplaceGlyph(Glyph);
+				m_LayoutGeneration++;
+			}
+			return;
+		}
+
+		// the space of pending glyphs was reserved with the same size, unless the loaded metrics differ
+		if(Glyph.m_State == SGlyph::EState::PREWARMING || Glyph.m_Width != Result.m_Glyph.m_Width || Glyph.m_Height != Result.m_Glyph.m_Height)
+		{
+			if(Glyph.m_State == SGlyph::EState::PENDING)
+				m_LayoutGeneration++;
+			Glyph.m_Width = Result.m_Glyph.m_Width;
+			Glyph.m_Height = Result.m_Glyph.m_Height;
+			Glyph.m_CharWidth = Result.m_Glyph.m_CharWidth;
+			Glyph.m_CharHeight = Result.m_Glyph.m_CharHeight;
+			Glyph.m_OffsetX = Result.m_Glyph.m_OffsetX;
+			Glyph.m_OffsetY = Result.m_Glyph.m_OffsetY;
+			Glyph.m_AdvanceX = Result.m_Glyph.m_AdvanceX;
+			// prewarmed glyphs only use the free space of the atlas, it is never grown for them
+			const bool Prewarming = Glyph.m_State == SGlyph::EState::PREWARMING;
+			if(!ReserveGlyph(Glyph, !Prewarming))
+			{
+				if(Prewarming)
 				{
-					log_debug("textrender", "Cannot fit glyph into atlas, which is already at maximum size. Chr=%d GlyphIndex=%u", Glyph.m_Chr, Glyph.m_GlyphIndex);
-					return false;
+					m_Glyphs.erase(GlyphIt);
+					StopPrewarm();
 				}
+				else
+					ReplaceGlyph(Glyph);
+				return;
 			}
+		}
+
+		if(!Result.m_vFill.empty())
+		{
+			UploadGlyph(FONT_TEXTURE_FILL, Glyph.m_aUVs[0], Glyph.m_aUVs[1], Glyph.m_Width, Glyph.m_Height, Result.m_vFill.data());
+			UploadGlyph(FONT_TEXTURE_OUTLINE, Glyph.m_aUVs[0], Glyph.m_aUVs[1], Glyph.m_Width, Glyph.m_Height, Result.m_vOutline.data());
+		}
+		Glyph.m_State = SGlyph::EState::RENDERED;
+	}
 
-			// prepare glyph data
-			const size_t GlyphDataSize = (size_t)Width * Height * sizeof(uint8_t);
-			uint8_t *pGlyphDataFill = static_cast<uint8_t *>(malloc(GlyphDataSize));
-			uint8_t *pGlyphDataOutline = static_cast<uint8_t *>(malloc(GlyphDataSize));
-			mem_zero(pGlyphDataFill, GlyphDataSize);
-			for(unsigned py = 0; py < pBitmap->rows; ++py)
+	void StartPrewarm(int FontSize)
+	{
+		if(m_PrewarmStopped || m_aPrewarmStarted[FontSize])
+			return;
+		m_aPrewarmStarted[FontSize] = true;
+
+		if(str_comp(m_aPrewarmRangesConfig, g_Config.m_ClTextPrewarm) != 0)
+			ParsePrewarmRanges();
+		if(!m_vPrewarmRanges.empty())
+			m_PrewarmQueue.push_back({FontSize, 0, m_vPrewarmRanges.front().m_First});
+	}
+
+	void StopPrewarm()
+	{
+		// the atlas is full, drop the remaining prewarm requests until it is cleared
+		m_PrewarmStopped = true;
+		m_PrewarmQueue.clear();
+		const std::unique_lock Lock(m_RasterizerLock);
+		for(const SRasterizeRequest &Request : m_PrewarmRequests)
+		{
+			const auto GlyphIt = m_Glyphs.find(std::make_tuple(Request.m_Face, Request.m_Chr, Request.m_FontSize));
+			if(GlyphIt != m_Glyphs.end() && GlyphIt->second.m_State == SGlyph::EState::PREWARMING)
 			{
-				mem_copy(&pGlyphDataFill[(py + y) * Width + x], &pBitmap->buffer[py * pBitmap->width], pBitmap->width);
+				m_Glyphs.erase(GlyphIt);
+				m_NumPendingGlyphs--;
+			}
+			else
+			{
+				// the glyph was used in the meantime and waits for this request
+				m_RasterizeRequests.push_back(Request);
 			}
-			Grow(pGlyphDataFill, pGlyphDataOutline, Width, Height, OutlineThickness);
-
-			// upload the glyph
-			UploadGlyph(FONT_TEXTURE_FILL, X, Y, Width, Height, pGlyphDataFill);
-			UploadGlyph(FONT_TEXTURE_OUTLINE, X, Y, Width, Height, pGlyphDataOutline);
 		}
+		m_PrewarmRequests.clear();
+	}
 
-		// set glyph info
+	void ParsePrewarmRanges()
+	{
+		// ranges of hexadecimal code points, e.g. "20-7e a0-17f"
+		str_copy(m_aPrewarmRangesConfig, g_Config.m_ClTextPrewarm);
+		m_vPrewarmRanges.clear();
+		char aRange[64];
+		const char *pRanges = m_aPrewarmRangesConfig;
+		while((pRanges = str_next_token(pRanges, " ", aRange, sizeof(aRange))))
 		{
-			Glyph.m_Height = Height;
-			Glyph.m_Width = Width;
-			Glyph.m_CharHeight = RealHeight;
-			Glyph.m_CharWidth = RealWidth;
-			Glyph.m_OffsetX = (Glyph.m_Face->glyph->metrics.horiBearingX >> 6);
-			Glyph.m_OffsetY = -((Glyph.m_Face->glyph->metrics.height >> 6) - (Glyph.m_Face->glyph->metrics.horiBearingY >> 6));
-			Glyph.m_AdvanceX = (Glyph.m_Face->glyph->advance.x >> 6);
+			char aFirst[64];
+			str_copy(aFirst, aRange);
+			const char *pLast = aFirst;
+			char *pSeparator = (char *)str_find(aFirst, "-");
+			if(pSeparator != nullptr)
+			{
+				*pSeparator = '\0';
+				pLast = pSeparator + 1;
+			}
+			if(!aFirst[0] || !pLast[0] || !str_isallnum_hex(aFirst) || !str_isallnum_hex(pLast))
+			{
+				log_error("textrender", "Invalid prewarm character range '%s'", aRange);
+				continue;
+			}
+			const unsigned long First = str_toulong_base(aFirst, 16);
+			const unsigned long Last = str_toulong_base(pLast, 16);
+			if(First > Last || Last > 0x10ffff)
+			{
+				log_error("textrender", "Invalid prewarm character range '%s'", aRange);
+				continue;
+			}
+			m_vPrewarmRanges.push_back({(int)First, (int)Last});
+		}
+	}
 
-			Glyph.m_aUVs[0] = X;
-			Glyph.m_aUVs[1] = Y;
-			Glyph.m_aUVs[2] = Glyph.m_aUVs[0] + Width;
-			Glyph.m_aUVs[3] = Glyph.m_aUVs[1] + Height;
+	void PrewarmGlyph(int Chr, int FontSize)
+	{
+		FT_Face Face;
+		const FT_UInt GlyphIndex = GetCharGlyph(Chr, &Face, false);
+		if(GlyphIndex == 0)
+			return;
 
-			Glyph.m_State = SGlyph::EState::RENDERED;
+		const auto [GlyphIt, Inserted] = m_Glyphs.try_emplace(std::make_tuple(Face, Chr, FontSize));
+		if(!Inserted)
+			return;
+
+		// the metrics are loaded by the rasterizer thread
+		SGlyph &Glyph = GlyphIt->second;
+		Glyph.m_FontSize = FontSize;
+		Glyph.m_Face = Face;
+		Glyph.m_Chr = Chr;
+		Glyph.m_GlyphIndex = GlyphIndex;
+		Glyph.m_State = SGlyph::EState::PREWARMING;
+		RequestRasterize(Glyph, true);
+	}
+
+	void PrewarmGlyphs()
+	{
+		if(m_PrewarmQueue.empty())
+			return;
+
+		// prewarm the glyphs of the default fonts, not the selected preset
+		FT_Face SelectedFace = m_SelectedFace;
+		m_SelectedFace = nullptr;
+		int Budget = PREWARM_CHARACTERS_PER_UPDATE;
+		while(Budget > 0 && !m_PrewarmQueue.empty())
+		{
+			SPrewarmProgress &Progress = m_PrewarmQueue.front();
+			if(Progress.m_Range >= m_vPrewarmRanges.size())
+			{
+				m_PrewarmQueue.pop_front();
+				continue;
+			}
+			if(Progress.m_Chr > m_vPrewarmRanges[Progress.m_Range].m_Last)
+			{
+				Progress.m_Range++;
+				if(Progress.m_Range < m_vPrewarmRanges.size())
+					Progress.m_Chr = m_vPrewarmRanges[Progress.m_Range].m_First;
+				continue;
+			}
+			PrewarmGlyph(Progress.m_Chr++, Progress.m_FontSize);
+			Budget--;
 		}
-		return true;
+		m_SelectedFace = SelectedFace;
 	}
 
 public:
@@ -593,10 +952,31 @@ public:
 
 		m_TextureAtlas.Clear(m_TextureDimension);
 		UploadTextures();
+
+		if(FT_Init_FreeType(&m_RasterizerLibrary))
+		{
+			log_error("textrender", "Failed to initialize glyph rasterizer");
+			m_RasterizerLibrary = nullptr;
+		}
+		m_pRasterizerThread = thread_init(RasterizerThread, this, "glyph rasterizer");
 	}
 
 	~CGlyphMap()
 	{
+		{
+			const std::unique_lock Lock(m_RasterizerLock);
+			m_RasterizerShutdown = true;
+			m_RasterizerCv.notify_all();
+		}
+		thread_wait(m_pRasterizerThread);
+		for(FT_Face Face : m_vRasterizerFaces)
+		{
+			if(Face != nullptr)
+				FT_Done_Face(Face);
+		}
+		if(m_RasterizerLibrary != nullptr)
+			FT_Done_FreeType(m_RasterizerLibrary);
+
 		UnloadTextures();
 		for(auto &pTextureData : m_apTextureData)
 		{
@@ -614,13 +994,34 @@ public:
 		return m_IconFace;
 	}
 
-	void AddFace(FT_Face Face)
+	FT_Face SelectedFace() const
+	{
+		return m_SelectedFace;
+	}
+
+	unsigned LayoutGeneration() const
+	{
+		return m_LayoutGeneration;
+	}
+
+	void AddFace(FT_Face Face, const FT_Byte *pFontData, FT_Long FontDataSize, FT_Long FaceIndex)
 	{
 		m_vFtFaces.push_back(Face);
+
+		// the rasterizer thread loads its own face from the same font data
+		const std::unique_lock Lock(m_RasterizerFaceLock);
+		FT_Face RasterizerFace = nullptr;
+		if(m_RasterizerLibrary == nullptr || FT_New_Memory_Face(m_RasterizerLibrary, pFontData, FontDataSize, FaceIndex, &RasterizerFace))
+		{
+			log_error("textrender", "Failed to load font face %ld '%s %s' for the glyph rasterizer", FaceIndex, Face->family_name, Face->style_name);
+			RasterizerFace = nullptr;
+		}
+		m_vRasterizerFaces.push_back(RasterizerFace);
 	}
 
 	bool SetDefaultFaceByName(const char *pFamilyName)
 	{
+		m_LayoutGeneration++;
 		m_DefaultFace = GetFaceByName(pFamilyName);
 		if(!m_DefaultFace)
 		{
@@ -636,6 +1037,7 @@ public:
 
 	bool SetIconFaceByName(const char *pFamilyName)
 	{
+		m_LayoutGeneration++;
 		m_IconFace = GetFaceByName(pFamilyName);
 		if(!m_IconFace)
 		{
@@ -659,6 +1061,7 @@ public:
 			return true;
 		}
 		m_vFallbackFaces.push_back(Face);
+		m_LayoutGeneration++;
 		return true;
 	}
 
@@ -701,6 +1104,53 @@ public:
 
 		m_TextureAtlas.Clear(m_TextureDimension);
 		m_Glyphs.clear();
+
+		// requests of the cleared glyphs are dropped, results that are already being rasterized are discarded
+		m_Generation++;
+		m_LayoutGeneration++;
+		{
+			const std::unique_lock Lock(m_RasterizerLock);
+			m_NumPendingGlyphs -= (int)(m_RasterizeRequests.size() + m_PrewarmRequests.size());
+			m_RasterizeRequests.clear();
+			m_PrewarmRequests.clear();
+		}
+		std::fill(std::begin(m_aPrewarmStarted), std::end(m_aPrewarmStarted), false);
+		m_PrewarmStopped = false;
+		m_PrewarmQueue.clear();
+	}
+
+	void UploadRasterizedGlyphs()
+	{
+		if(!m_HasRasterizedGlyphs.load())
+			return;
+
+		std::vector<SRasterizedGlyph> vRasterizedGlyphs;
+		{
+			const std::unique_lock Lock(m_RasterizerLock);
+			std::swap(vRasterizedGlyphs, m_vRasterizedGlyphs);
+			m_HasRasterizedGlyphs.store(false);
+		}
+
+		for(SRasterizedGlyph &Result : vRasterizedGlyphs)
+		{
+			m_NumPendingGlyphs--;
+			if(Result.m_Request.m_Generation == m_Generation)
+				UploadRasterizedGlyph(Result);
+		}
+	}
+
+	void Update()
+	{
+		UploadRasterizedGlyphs();
+		PrewarmGlyphs();
+		m_NumLastFrameCacheMisses = m_NumFrameCacheMisses;
+		m_NumFrameCacheMisses = 0;
+	}
+
+	void Stats(STextRenderStats &Stats) const
+	{
+		Stats.m_GlyphCacheMisses = m_NumLastFrameCacheMisses;
+		Stats.m_PendingGlyphs = m_NumPendingGlyphs;
 	}
 
 	const SGlyph *GetGlyph(int Chr, int FontSize)
@@ -717,34 +1167,27 @@ public:
 			return Chr == REPLACEMENT_CHARACTER ? nullptr : GetGlyph(REPLACEMENT_CHARACTER, FontSize);
 		}
 
-		// Check if glyph for this (font face, character, font size)-combination was already rendered.
+		StartPrewarm(FontSize);
+
+		// Check if glyph for this (font face, character, font size)-combination was already loaded.
+		// Pending glyphs can be used, they appear once they are rasterized.
 		SGlyph &Glyph = m_Glyphs[std::make_tuple(Face, Chr, FontSize)];
-		if(Glyph.m_State == SGlyph::EState::RENDERED)
+		if(Glyph.m_State == SGlyph::EState::RENDERED || Glyph.m_State == SGlyph::EState::PENDING)
 			return &Glyph;
 		else if(Glyph.m_State == SGlyph::EState::ERROR)
 			return nullptr;
 
-		// Else, render it.
+		// Else, load it and rasterize it in the background, unless it is already queued for prewarming.
+		m_NumFrameCacheMisses++;
+		const bool Prewarming = Glyph.m_State == SGlyph::EState::PREWARMING;
 		Glyph.m_FontSize = FontSize;
 		Glyph.m_Face = Face;
 		Glyph.m_Chr = Chr;
 		Glyph.m_GlyphIndex = GlyphIndex;
-		if(RenderGlyph(Glyph))
+		if(LoadGlyph(Glyph, !Prewarming))
 			return &Glyph;
 
-		// Use replacement character if the glyph could not be rendered,
-		// also retrieve replacement character from the atlas.
-		const SGlyph *pReplacementCharacter = Chr == REPLACEMENT_CHARACTER ? nullptr : GetGlyph(REPLACEMENT_CHARACTER, FontSize);
-		if(pReplacementCharacter)
-		{
-			Glyph = *pReplacementCharacter;
-			return &Glyph;
-		}
-
-		// Keep failed glyph in the cache so we don't attempt to render it again,
-		// but set its state to ERROR so we don't return it to the text render.
-		Glyph.m_State = SGlyph::EState::ERROR;
-		return nullptr;
+		return ReplaceGlyph(Glyph);
 	}
 
 	vec2 Kerning(const SGlyph *pLeft, const SGlyph *pRight) const
@@ -929,6 +1372,78 @@ struct SFontLanguageVariant
 	char m_aFamilyName[FONT_NAME_SIZE];
 };
 
+/**
+ * Least recently used cache of the layouts of text that is only measured and not rendered,
+ * i.e. by TextWidth and TextBoundingBox, which are called repeatedly with the same text by
+ * many components. The word wrapping of text containers measures words at their absolute
+ * position and does not use the cache.
+ */
+class CTextLayoutCache
+{
+public:
+	/**
+	 * The state of the text cursor after the layout.
+	 */
+	struct SLayout
+	{
+		int m_Flags;
+		int m_LineCount;
+		int m_GlyphCount;
+		int m_CharCount;
+		float m_X;
+		float m_Y;
+		float m_MaxCharacterHeight;
+		float m_LongestLineWidth;
+		float m_AlignedFontSize;
+		float m_AlignedLineSpacing;
+	};
+
+private:
+	static constexpr size_t MAX_ENTRIES = 8192;
+
+	struct SEntry
+	{
+		std::string m_Key;
+		SLayout m_Layout;
+	};
+
+	// most recently used entry first
+	std::list<SEntry> m_Entries;
+	std::unordered_map<std::string_view, std::list<SEntry>::iterator> m_EntryMap;
+	unsigned m_Generation = 0;
+
+public:
+	const SLayout *Find(const std::string &Key)
+	{
+		const auto EntryIt = m_EntryMap.find(Key);
+		if(EntryIt == m_EntryMap.end())
+			return nullptr;
+		m_Entries.splice(m_Entries.begin(), m_Entries, EntryIt->second);
+		return &EntryIt->second->m_Layout;
+	}
+
+	void Add(std::string &&Key, const SLayout &Layout)
+	{
+		if(m_Entries.size() >= MAX_ENTRIES)
+		{
+			m_EntryMap.erase(m_Entries.back().m_Key);
+			m_Entries.pop_back();
+		}
+		m_Entries.push_front(SEntry{std::move(Key), Layout});
+		m_EntryMap.emplace(m_Entries.front().m_Key, m_Entries.begin());
+	}
+
+	// Clears the cache if the glyphs changed since the layouts were added
+	void Validate(unsigned Generation)
+	{
+		if(m_Generation == Generation)
+			return;
+		m_Generation = Generation;
+		m_EntryMap.clear();
+		m_Entries.clear();
+	}
+};
+
 class CTextRender : public IEngineTextRender
 {
 	IConsole *m_pConsole;
@@ -959,6 +1474,12 @@ class CTextRender : public IEngineTextRender
 
 	std::chrono::nanoseconds m_CursorRenderTime;
 
+	CTextLayoutCache m_LayoutCache;
+	int m_NumFrameLayoutCacheHits = 0;
+	int m_NumFrameLayoutCacheMisses = 0;
+	int m_NumLastFrameLayoutCacheHits = 0;
+	int m_NumLastFrameLayoutCacheMisses = 0;
+
 	int GetFreeTextContainerIndex()
 	{
 		if(m_FirstFreeTextContainerIndex == -1)
@@ -1018,6 +1539,65 @@ class CTextRender : public IEngineTextRender
 		}
 	}
 
+	// All inputs of the layout of text that is not rendered, which does not depend on colors
+	std::string LayoutCacheKey(const CTextCursor *pCursor, const char *pText, int Length)
+	{
+		struct SKey
+		{
+			uintptr_t m_Face;
+			unsigned m_RenderFlags;
+			float m_aScreen[4];
+			int m_ScreenWidth;
+			int m_ScreenHeight;
+			int m_Flags;
+			int m_LineCount;
+			int m_GlyphCount;
+			int m_CharCount;
+			int m_MaxLines;
+			float m_StartX;
+			float m_StartY;
+			float m_LineWidth;
+			float m_X;
+			float m_Y;
+			float m_MaxCharacterHeight;
+			float m_LongestLineWidth;
+			float m_FontSize;
+			float m_LineSpacing;
+		};
+		SKey Key;
+		mem_zero(&Key, sizeof(Key));
+		Key.m_Face = (uintptr_t)m_pGlyphMap->SelectedFace();
+		Key.m_RenderFlags = m_RenderFlags;
+		Graphics()->GetScreen(&Key.m_aScreen[0], &Key.m_aScreen[1], &Key.m_aScreen[2], &Key.m_aScreen[3]);
+		Key.m_ScreenWidth = Graphics()->ScreenWidth();
+		Key.m_ScreenHeight = Graphics()->ScreenHeight();
+		Key.m_Flags = pCursor->m_Flags;
+		Key.m_LineCount = pCursor->m_LineCount;
+		Key.m_GlyphCount = pCursor->m_GlyphCount;
+		Key.m_CharCount = pCursor->m_CharCount;
+		Key.m_MaxLines = pCursor->m_MaxLines;
+		Key.m_StartX = pCursor->m_StartX;
+		Key.m_StartY = pCursor->m_StartY;
+		Key.m_LineWidth = pCursor->m_LineWidth;
+		Key.m_X = pCursor->m_X;
+		Key.m_Y = pCursor->m_Y;
+		Key.m_MaxCharacterHeight = pCursor->m_MaxCharacterHeight;
+		Key.m_LongestLineWidth = pCursor->m_LongestLineWidth;
+		Key.m_FontSize = pCursor->m_FontSize;
+		Key.m_LineSpacing = pCursor->m_LineSpacing;
+
+		if(Length < 0)
+			Length = str_length(pText);
+		else
+			Length = minimum(Length, str_length(pText));
+
+		std::string Result;
+		Result.reserve(sizeof(Key) + Length);
+		Result.append((const char *)&Key, sizeof(Key));
+		Result.append(pText, Length);
+		return Result;
+	}
+
 	bool LoadFontCollection(const char *pFontName, const FT_Byte *pFontData, FT_Long FontDataSize)
 	{
 		FT_Face FtFace;
@@ -1042,7 +1622,7 @@ class CTextRender : public IEngineTextRender
 				continue;
 			}
 
-			m_pGlyphMap->AddFace(FtFace);
+			m_pGlyphMap->AddFace(FtFace, pFontData, FontDataSize, FaceIndex);
 
 			log_debug("textrender", "Loaded font face %ld '%s %s' from font file '%s'", FaceIndex, FtFace->family_name, FtFace->style_name, pFontName);
 			LoadedAny = true;
@@ -1467,6 +2047,56 @@ public:
 	}
 
 	void TextEx(CTextCursor *pCursor, const char *pText, int Length = -1) override
+	{
+		// the layout of text that is only measured is reused
+		const bool UseLayoutCache = (pCursor->m_Flags & TEXTFLAG_RENDER) == 0 &&
+					    pCursor->m_CalculateSelectionMode == TEXT_CURSOR_SELECTION_MODE_NONE &&
+					    pCursor->m_CursorMode == TEXT_CURSOR_CURSOR_MODE_NONE;
+		std::string LayoutKey;
+		if(UseLayoutCache)
+		{
+			m_LayoutCache.Validate(m_pGlyphMap->LayoutGeneration());
+			LayoutKey = LayoutCacheKey(pCursor, pText, Length);
+			const CTextLayoutCache::SLayout *pLayout = m_LayoutCache.Find(LayoutKey);
+			if(pLayout != nullptr)
+			{
+				pCursor->m_Flags = pLayout->m_Flags;
+				pCursor->m_LineCount = pLayout->m_LineCount;
+				pCursor->m_GlyphCount = pLayout->m_GlyphCount;
+				pCursor->m_CharCount = pLayout->m_CharCount;
+				pCursor->m_X = pLayout->m_X;
+				pCursor->m_Y = pLayout->m_Y;
+				pCursor->m_MaxCharacterHeight = pLayout->m_MaxCharacterHeight;
+				pCursor->m_LongestLineWidth = pLayout->m_LongestLineWidth;
+				pCursor->m_AlignedFontSize = pLayout->m_AlignedFontSize;
+				pCursor->m_AlignedLineSpacing = pLayout->m_AlignedLineSpacing;
+				m_NumFrameLayoutCacheHits++;
+				return;
+			}
+			m_NumFrameLayoutCacheMisses++;
+		}
+
+		LayoutText(pCursor, pText, Length);
+
+		if(UseLayoutCache)
+		{
+			const CTextLayoutCache::SLayout Layout = {
+				pCursor->m_Flags,
+				pCursor->m_LineCount,
+				pCursor->m_GlyphCount,
+				pCursor->m_CharCount,
+				pCursor->m_X,
+				pCursor->m_Y,
+				pCursor->m_MaxCharacterHeight,
+				pCursor->m_LongestLineWidth,
+				pCursor->m_AlignedFontSize,
+				pCursor->m_AlignedLineSpacing};
+			m_LayoutCache.Add(std::move(LayoutKey), Layout);
+		}
+	}
+
+	// Lays out and optionally renders the text without the layout cache
+	void LayoutText(CTextCursor *pCursor, const char *pText, int Length)
 	{
 		const unsigned OldRenderFlags = m_RenderFlags;
 		m_RenderFlags |= TEXT_RENDER_FLAG_ONE_TIME_USE;
@@ -1699,7 +2329,7 @@ public:
 				Compare.m_Flags &= ~TEXTFLAG_RENDER;
 				Compare.m_Flags |= TEXTFLAG_DISALLOW_NEWLINE;
 				Compare.m_LineWidth = -1;
-				TextEx(&Compare, pCurrent, Wlen);
+				LayoutText(&Compare, pCurrent, Wlen);
 
 				if(Compare.m_X - DrawX > pCursor->m_LineWidth)
 				{
@@ -1714,7 +2344,7 @@ public:
 					Cutter.m_Flags &= ~TEXTFLAG_RENDER;
 					Cutter.m_Flags |= TEXTFLAG_STOP_AT_END | TEXTFLAG_DISALLOW_NEWLINE;
 
-					TextEx(&Cutter, pCurrent, Wlen);
+					LayoutText(&Cutter, pCurrent, Wlen);
 					Wlen = str_utf8_rewind(pCurrent, Cutter.m_CharCount); // rewind once to skip the last character that did not fit
 					NewLine = true;
 
@@ -2135,6 +2765,9 @@ public:
 
 		if(!TextContainer.m_StringInfo.m_vCharacterQuads.empty())
 		{
+			// show glyphs that were rasterized since the frame started
+			m_pGlyphMap->UploadRasterizedGlyphs();
+
 			if(Graphics()->IsTextBufferingEnabled())
 			{
 				Graphics()->TextureClear();
@@ -2327,6 +2960,24 @@ public:
 		return WidthOfText;
 	}
 
+	void Update() override
+	{
+		m_pGlyphMap->Update();
+		m_NumLastFrameLayoutCacheHits = m_NumFrameLayoutCacheHits;
+		m_NumLastFrameLayoutCacheMisses = m_NumFrameLayoutCacheMisses;
+		m_NumFrameLayoutCacheHits = 0;
+		m_NumFrameLayoutCacheMisses = 0;
+	}
+
+	STextRenderStats Stats() const override
+	{
+		STextRenderStats Stats;
+		m_pGlyphMap->Stats(Stats);
+		Stats.m_LayoutCacheHits = m_NumLastFrameLayoutCacheHits;
+		Stats.m_LayoutCacheMisses = m_NumLastFrameLayoutCacheMisses;
+		return Stats;
+	}
+
 	void OnPreWindowResize() override
 	{
 		for(auto *pTextContainer : m_vpTextContainers)
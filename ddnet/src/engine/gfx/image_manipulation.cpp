@@ -3,6 +3,17 @@
 #include <base/math.h>
 #include <base/system.h>
 
+#include <engine/shared/jobs.h>
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#if defined(CONF_ARCH_AMD64) || defined(__SSE2__)
+#define IMAGE_MANIPULATION_SSE2
+#include <emmintrin.h>
+#endif
+
 bool ConvertToRgba(uint8_t *pDest, const CImageInfo &SourceImage)
 {
 	if(SourceImage.m_Format == CImageInfo::FORMAT_RGBA)
@@ -68,90 +79,181 @@ bool ConvertToRgba(CImageInfo &Image)
 	return false;
 }
 
+// Runs Func(RowBegin, RowEnd) on bands of rows, in the worker threads of the shared job pool for large images
+static void ForEachRowBand(int Height, size_t PixelCount, const std::function<void(int, int)> &Func)
+{
+	static constexpr size_t MIN_PIXELS_PER_BAND = 256 * 256;
+
+	CJobPool::ParallelForShared(Height, minimum<size_t>(PixelCount / MIN_PIXELS_PER_BAND, maximum(Height, 0)), Func);
+}
+
+class CGrayscaleTables
+{
+public:
+	float m_aR[256];
+	float m_aG[256];
+	float m_aB[256];
+
+	CGrayscaleTables()
+	{
+		for(int i = 0; i < 256; ++i)
+		{
+			m_aR[i] = 0.2126f * i;
+			m_aG[i] = 0.7152f * i;
+			m_aB[i] = 0.0722f * i;
+		}
+	}
+};
+
+template<size_t Step>
+static void ConvertToGrayscaleRows(uint8_t *pData, size_t Begin, size_t End)
+{
+	static const CGrayscaleTables s_Tables;
+	for(size_t i = Begin; i < End; ++i)
+	{
+		uint8_t *pPixel = &pData[i * Step];
+		const uint8_t Luma = (uint8_t)(s_Tables.m_aR[pPixel[0]] + s_Tables.m_aG[pPixel[1]] + s_Tables.m_aB[pPixel[2]]);
+		pPixel[0] = Luma;
+		pPixel[1] = Luma;
+		pPixel[2] = Luma;
+	}
+}
+
 void ConvertToGrayscale(const CImageInfo &Image)
 {
 	if(Image.m_Format == CImageInfo::FORMAT_R || Image.m_Format == CImageInfo::FORMAT_RA)
 		return;
 
-	const size_t Step = Image.PixelSize();
-	for(size_t i = 0; i < Image.m_Width * Image.m_Height; ++i)
-	{
-		const uint8_t R = Image.m_pData[i * Step];
-		const uint8_t G = Image.m_pData[i * Step + 1];
-		const uint8_t B = Image.m_pData[i * Step + 2];
-		const uint8_t Luma = (uint8_t)(0.2126f * R + 0.7152f * G + 0.0722f * B);
-
-		Image.m_pData[i * Step] = Luma;
-		Image.m_pData[i * Step + 1] = Luma;
-		Image.m_pData[i * Step + 2] = Luma;
-	}
+	const size_t Width = Image.m_Width;
+	const bool Rgba = Image.m_Format == CImageInfo::FORMAT_RGBA;
+	ForEachRowBand(Image.m_Height, Image.m_Width * Image.m_Height, [&](int RowBegin, int RowEnd) {
+		if(Rgba)
+			ConvertToGrayscaleRows<4>(Image.m_pData, RowBegin * Width, RowEnd * Width);
+		else
+			ConvertToGrayscaleRows<3>(Image.m_pData, RowBegin * Width, RowEnd * Width);
+	});
 }
 
 static constexpr int DILATE_BPP = 4; // RGBA assumed
 static constexpr uint8_t DILATE_ALPHA_THRESHOLD = 10;
 
-static void Dilate(int w, int h, const uint8_t *pSrc, uint8_t *pDest)
+static bool DilateIsOpaque(const uint8_t *pPixel)
 {
-	const int aDirX[] = {0, -1, 1, 0};
-	const int aDirY[] = {-1, 0, 0, 1};
+	return pPixel[DILATE_BPP - 1] > DILATE_ALPHA_THRESHOLD;
+}
 
-	int m = 0;
-	for(int y = 0; y < h; y++)
+// A transparent pixel takes the color of the first opaque neighbour in the order up, left, right, down.
+// Neighbours outside of the image are clamped to the border.
+static void DilatePixel(const uint8_t *pCenter, const uint8_t *pUp, const uint8_t *pLeft, const uint8_t *pRight, const uint8_t *pDown, uint8_t *pDest)
+{
+	const uint8_t *pOpaque = nullptr;
+	if(!DilateIsOpaque(pCenter))
 	{
-		for(int x = 0; x < w; x++, m += DILATE_BPP)
-		{
-			for(int i = 0; i < DILATE_BPP; ++i)
-				pDest[m + i] = pSrc[m + i];
-			if(pSrc[m + DILATE_BPP - 1] > DILATE_ALPHA_THRESHOLD)
-				continue;
-
-			// --- Implementation Note ---
-			// The sum and counter variable can be used to compute a smoother dilated image.
-			// In this reference implementation, the loop breaks as soon as Counter == 1.
-			// We break the loop here to match the selection of the previously used algorithm.
-			int aSumOfOpaque[] = {0, 0, 0};
-			int Counter = 0;
-			for(int c = 0; c < 4; c++)
-			{
-				const int ClampedX = std::clamp(x + aDirX[c], 0, w - 1);
-				const int ClampedY = std::clamp(y + aDirY[c], 0, h - 1);
-				const int SrcIndex = ClampedY * w * DILATE_BPP + ClampedX * DILATE_BPP;
-				if(pSrc[SrcIndex + DILATE_BPP - 1] > DILATE_ALPHA_THRESHOLD)
-				{
-					for(int p = 0; p < DILATE_BPP - 1; ++p)
-						aSumOfOpaque[p] += pSrc[SrcIndex + p];
-					++Counter;
-					break;
-				}
-			}
+		if(DilateIsOpaque(pUp))
+			pOpaque = pUp;
+		else if(DilateIsOpaque(pLeft))
+			pOpaque = pLeft;
+		else if(DilateIsOpaque(pRight))
+			pOpaque = pRight;
+		else if(DilateIsOpaque(pDown))
+			pOpaque = pDown;
+	}
 
-			if(Counter > 0)
-			{
-				for(int i = 0; i < DILATE_BPP - 1; ++i)
-				{
-					aSumOfOpaque[i] /= Counter;
-					pDest[m + i] = (uint8_t)aSumOfOpaque[i];
-				}
+	if(pOpaque == nullptr)
+	{
+		mem_copy(pDest, pCenter, DILATE_BPP);
+	}
+	else
+	{
+		mem_copy(pDest, pOpaque, DILATE_BPP - 1);
+		pDest[DILATE_BPP - 1] = 255;
+	}
+}
 
-				pDest[m + DILATE_BPP - 1] = 255;
-			}
+#if defined(IMAGE_MANIPULATION_SSE2)
+static __m128i DilateSelect(__m128i Mask, __m128i A, __m128i B)
+{
+	return _mm_or_si128(_mm_and_si128(Mask, A), _mm_andnot_si128(Mask, B));
+}
+
+static __m128i DilateOpaqueMask(__m128i Pixels)
+{
+	return _mm_cmpgt_epi32(_mm_srli_epi32(Pixels, 24), _mm_set1_epi32(DILATE_ALPHA_THRESHOLD));
+}
+
+// Dilates four pixels at once, the neighbours on both sides must be within the row
+static void DilatePixels4(const uint8_t *pCenter, const uint8_t *pUp, const uint8_t *pDown, uint8_t *pDest)
+{
+	const __m128i Alpha = _mm_set1_epi32((int)0xff000000);
+	const __m128i Center = _mm_loadu_si128((const __m128i *)pCenter);
+	const __m128i Up = _mm_loadu_si128((const __m128i *)pUp);
+	const __m128i Left = _mm_loadu_si128((const __m128i *)(pCenter - DILATE_BPP));
+	const __m128i Right = _mm_loadu_si128((const __m128i *)(pCenter + DILATE_BPP));
+	const __m128i Down = _mm_loadu_si128((const __m128i *)pDown);
+
+	// select from the lowest to the highest priority
+	__m128i Result = Center;
+	Result = DilateSelect(DilateOpaqueMask(Down), _mm_or_si128(Down, Alpha), Result);
+	Result = DilateSelect(DilateOpaqueMask(Right), _mm_or_si128(Right, Alpha), Result);
+	Result = DilateSelect(DilateOpaqueMask(Left), _mm_or_si128(Left, Alpha), Result);
+	Result = DilateSelect(DilateOpaqueMask(Up), _mm_or_si128(Up, Alpha), Result);
+	Result = DilateSelect(DilateOpaqueMask(Center), Center, Result);
+	_mm_storeu_si128((__m128i *)pDest, Result);
+}
+#endif
+
+static void DilateRows(int w, int h, const uint8_t *pSrc, uint8_t *pDest, int RowBegin, int RowEnd)
+{
+	const size_t Pitch = (size_t)w * DILATE_BPP;
+	for(int y = RowBegin; y < RowEnd; y++)
+	{
+		const uint8_t *pRow = &pSrc[y * Pitch];
+		const uint8_t *pUpRow = y > 0 ? pRow - Pitch : pRow;
+		const uint8_t *pDownRow = y < h - 1 ? pRow + Pitch : pRow;
+		uint8_t *pDestRow = &pDest[y * Pitch];
+
+		int x = 0;
+		DilatePixel(pRow, pUpRow, pRow, w > 1 ? pRow + DILATE_BPP : pRow, pDownRow, pDestRow);
+		x++;
+#if defined(IMAGE_MANIPULATION_SSE2)
+		for(; x + 4 < w; x += 4)
+		{
+			const size_t Offset = (size_t)x * DILATE_BPP;
+			DilatePixels4(pRow + Offset, pUpRow + Offset, pDownRow + Offset, pDestRow + Offset);
+		}
+#endif
+		for(; x < w; x++)
+		{
+			const size_t Offset = (size_t)x * DILATE_BPP;
+			const size_t RightOffset = x < w - 1 ? Offset + DILATE_BPP : Offset;
+			DilatePixel(pRow + Offset, pUpRow + Offset, pRow + Offset - DILATE_BPP, pRow + RightOffset, pDownRow + Offset, pDestRow + Offset);
 		}
 	}
 }
 
-static void CopyColorValues(int w, int h, const uint8_t *pSrc, uint8_t *pDest)
+static void Dilate(int w, int h, const uint8_t *pSrc, uint8_t *pDest)
+{
+	ForEachRowBand(h, (size_t)w * h, [&](int RowBegin, int RowEnd) {
+		DilateRows(w, h, pSrc, pDest, RowBegin, RowEnd);
+	});
+}
+
+static void CopyColorValues(int w, int h, const uint8_t *pSrc, uint8_t *pDest, size_t DestPitch)
 {
-	int m = 0;
-	for(int y = 0; y < h; y++)
-	{
-		for(int x = 0; x < w; x++, m += DILATE_BPP)
+	ForEachRowBand(h, (size_t)w * h, [&](int RowBegin, int RowEnd) {
+		for(int y = RowBegin; y < RowEnd; y++)
 		{
-			if(pDest[m + DILATE_BPP - 1] == 0)
+			const uint8_t *pSrcRow = &pSrc[(size_t)y * w * DILATE_BPP];
+			uint8_t *pDestRow = &pDest[y * DestPitch];
+			for(int x = 0; x < w; x++)
 			{
-				mem_copy(&pDest[m], &pSrc[m], DILATE_BPP - 1);
+				if(pDestRow[x * DILATE_BPP + DILATE_BPP - 1] == 0)
+				{
+					mem_copy(&pDestRow[x * DILATE_BPP], &pSrcRow[x * DILATE_BPP], DILATE_BPP - 1);
+				}
 			}
 		}
-	}
+	});
 }
 
 void DilateImage(uint8_t *pImageBuff, int w, int h)
@@ -167,19 +269,25 @@ void DilateImage(const CImageInfo &Image)
 
 void DilateImageSub(uint8_t *pImageBuff, int w, int h, int x, int y, int SubWidth, int SubHeight)
 {
-	uint8_t *apBuffer[2] = {nullptr, nullptr};
-
-	const size_t ImageSize = (size_t)SubWidth * SubHeight * sizeof(uint8_t) * DILATE_BPP;
-	apBuffer[0] = (uint8_t *)malloc(ImageSize);
-	apBuffer[1] = (uint8_t *)malloc(ImageSize);
-	uint8_t *pBufferOriginal = (uint8_t *)malloc(ImageSize);
+	if(SubWidth <= 0 || SubHeight <= 0)
+		return;
 
-	for(int Y = 0; Y < SubHeight; ++Y)
+	const size_t Pitch = (size_t)w * DILATE_BPP;
+	const size_t SubPitch = (size_t)SubWidth * DILATE_BPP;
+	const size_t ImageSize = SubPitch * SubHeight;
+	uint8_t *pSubImage = &pImageBuff[y * Pitch + x * DILATE_BPP];
+
+	// the original sub image is only copied if its rows are not contiguous in the image buffer
+	const bool Contiguous = SubWidth == w;
+	uint8_t *pBuffers = (uint8_t *)malloc(ImageSize * (Contiguous ? 2 : 3));
+	uint8_t *apBuffer[2] = {pBuffers, pBuffers + ImageSize};
+	const uint8_t *pBufferOriginal = pSubImage;
+	if(!Contiguous)
 	{
-		int SrcImgOffset = ((y + Y) * w * DILATE_BPP) + (x * DILATE_BPP);
-		int DstImgOffset = (Y * SubWidth * DILATE_BPP);
-		int CopySize = SubWidth * DILATE_BPP;
-		mem_copy(&pBufferOriginal[DstImgOffset], &pImageBuff[SrcImgOffset], CopySize);
+		uint8_t *pCopy = pBuffers + 2 * ImageSize;
+		for(int Y = 0; Y < SubHeight; ++Y)
+			mem_copy(&pCopy[Y * SubPitch], &pSubImage[Y * Pitch], SubPitch);
+		pBufferOriginal = pCopy;
 	}
 
 	Dilate(SubWidth, SubHeight, pBufferOriginal, apBuffer[0]);
@@ -190,20 +298,9 @@ void DilateImageSub(uint8_t *pImageBuff, int w, int h, int x, int y, int SubWidt
 		Dilate(SubWidth, SubHeight, apBuffer[1], apBuffer[0]);
 	}
 
-	CopyColorValues(SubWidth, SubHeight, apBuffer[0], pBufferOriginal);
-
-	free(apBuffer[0]);
-	free(apBuffer[1]);
-
-	for(int Y = 0; Y < SubHeight; ++Y)
-	{
-		int SrcImgOffset = ((y + Y) * w * DILATE_BPP) + (x * DILATE_BPP);
-		int DstImgOffset = (Y * SubWidth * DILATE_BPP);
-		int CopySize = SubWidth * DILATE_BPP;
-		mem_copy(&pImageBuff[SrcImgOffset], &pBufferOriginal[DstImgOffset], CopySize);
-	}
+	CopyColorValues(SubWidth, SubHeight, apBuffer[0], pSubImage, Pitch);
 
-	free(pBufferOriginal);
+	free(pBuffers);
 }
 
 static float CubicHermite(float A, float B, float C, float D, float t)
@@ -216,57 +313,62 @@ static float CubicHermite(float A, float B, float C, float D, float t)
 	return (a * t * t * t) + (b * t * t) + (c * t) + d;
 }
 
-static void GetPixelClamped(const uint8_t *pSourceImage, int x, int y, uint32_t W, uint32_t H, size_t BPP, uint8_t aSample[4])
-{
-	x = std::clamp<int>(x, 0, (int)W - 1);
-	y = std::clamp<int>(y, 0, (int)H - 1);
-
-	mem_copy(aSample, &pSourceImage[x * BPP + (W * BPP * y)], BPP);
-}
-
-static void SampleBicubic(const uint8_t *pSourceImage, float u, float v, uint32_t W, uint32_t H, size_t BPP, uint8_t aSample[4])
+// The clamped source coordinates and the fraction of one axis of a bicubic sample
+class CBicubicTap
 {
-	float X = (u * W) - 0.5f;
-	int xInt = (int)X;
-	float xFract = X - std::floor(X);
-
-	float Y = (v * H) - 0.5f;
-	int yInt = (int)Y;
-	float yFract = Y - std::floor(Y);
-
-	uint8_t aaaSamples[4][4][4];
-	for(int y = 0; y < 4; ++y)
-	{
-		for(int x = 0; x < 4; ++x)
-		{
-			GetPixelClamped(pSourceImage, xInt + x - 1, yInt + y - 1, W, H, BPP, aaaSamples[x][y]);
-		}
-	}
+public:
+	int m_aIndices[4];
+	float m_Fract;
 
-	for(size_t i = 0; i < BPP; i++)
+	void Init(int Pos, int NewSize, uint32_t Size)
 	{
-		float aRows[4];
-		for(int y = 0; y < 4; ++y)
-		{
-			aRows[y] = CubicHermite(aaaSamples[0][y][i], aaaSamples[1][y][i], aaaSamples[2][y][i], aaaSamples[3][y][i], xFract);
-		}
-		aSample[i] = (uint8_t)std::clamp<float>(CubicHermite(aRows[0], aRows[1], aRows[2], aRows[3], yFract), 0.0f, 255.0f);
+		const float Coord = (float)Pos / (float)(NewSize - 1);
+		const float Scaled = (Coord * Size) - 0.5f;
+		const int Int = (int)Scaled;
+		m_Fract = Scaled - std::floor(Scaled);
+		for(int i = 0; i < 4; ++i)
+			m_aIndices[i] = std::clamp<int>(Int + i - 1, 0, (int)Size - 1);
 	}
-}
+};
 
 static void ResizeImage(const uint8_t *pSourceImage, uint32_t SW, uint32_t SH, uint8_t *pDestinationImage, uint32_t W, uint32_t H, size_t BPP)
 {
-	for(int y = 0; y < (int)H; ++y)
-	{
-		float v = (float)y / (float)(H - 1);
-		for(int x = 0; x < (int)W; ++x)
+	std::vector<CBicubicTap> vColumnTaps(W);
+	for(uint32_t x = 0; x < W; ++x)
+		vColumnTaps[x].Init(x, W, SW);
+
+	const size_t SourcePitch = SW * BPP;
+	ForEachRowBand(H, (size_t)W * H, [&](int RowBegin, int RowEnd) {
+		for(int y = RowBegin; y < RowEnd; ++y)
 		{
-			float u = (float)x / (float)(W - 1);
-			uint8_t aSample[4];
-			SampleBicubic(pSourceImage, u, v, SW, SH, BPP, aSample);
-			mem_copy(&pDestinationImage[x * BPP + ((W * BPP) * y)], aSample, BPP);
+			CBicubicTap RowTap;
+			RowTap.Init(y, H, SH);
+			const uint8_t *apSourceRows[4];
+			for(int Row = 0; Row < 4; ++Row)
+				apSourceRows[Row] = &pSourceImage[RowTap.m_aIndices[Row] * SourcePitch];
+
+			uint8_t *pDestinationRow = &pDestinationImage[(W * BPP) * y];
+			for(uint32_t x = 0; x < W; ++x)
+			{
+				const CBicubicTap &ColumnTap = vColumnTaps[x];
+				for(size_t i = 0; i < BPP; i++)
+				{
+					float aRows[4];
+					for(int Row = 0; Row < 4; ++Row)
+					{
+						const uint8_t *pSourceRow = apSourceRows[Row];
+						aRows[Row] = CubicHermite(
+							pSourceRow[ColumnTap.m_aIndices[0] * BPP + i],
+							pSourceRow[ColumnTap.m_aIndices[1] * BPP + i],
+							pSourceRow[ColumnTap.m_aIndices[2] * BPP + i],
+							pSourceRow[ColumnTap.m_aIndices[3] * BPP + i],
+							ColumnTap.m_Fract);
+					}
+					pDestinationRow[x * BPP + i] = (uint8_t)std::clamp<float>(CubicHermite(aRows[0], aRows[1], aRows[2], aRows[3], RowTap.m_Fract), 0.0f, 255.0f);
+				}
+			}
 		}
-	}
+	});
 }
 
 uint8_t *ResizeImage(const uint8_t *pImageData, int Width, int Height, int NewWidth, int NewHeight, int BPP)
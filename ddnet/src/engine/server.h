@@ -78,53 +78,146 @@ public:
 	virtual int GetClientVersion(int ClientId) const = 0;
 	virtual int SendMsg(CMsgPacker *pMsg, int Flags, int ClientId) = 0;
 
+	/**
+	 * Sends a message to all clients of a recipient mask.
+	 *
+	 * The message is packed at most once per protocol version, instead of
+	 * once per recipient.
+	 *
+	 * @param pMsg the message to send.
+	 * @param Flags the message flags, see MSGFLAG_*.
+	 * @param Recipients the clients to send the message to.
+	 * @param RecordServerDemos whether the message is recorded to the manual
+	 * and automatic server demos, which happens once regardless of the number
+	 * of recipients. The demos of the recipients always record the message
+	 * they receive, unless MSGFLAG_NORECORD is set.
+	 *
+	 * @return 0 on success, -1 if the message could not be packed.
+	 */
+	virtual int SendMsgMulticast(CMsgPacker *pMsg, int Flags, const CClientMask &Recipients, bool RecordServerDemos) = 0;
+
 	template<class T, typename std::enable_if<!protocol7::is_sixup<T>::value, int>::type = 0>
 	inline int SendPackMsg(const T *pMsg, int Flags, int ClientId)
 	{
-		int Result = 0;
 		if(ClientId == -1)
-		{
-			for(int i = 0; i < MaxClients(); i++)
-				if(ClientIngame(i))
-					Result = SendPackMsgTranslate(pMsg, Flags, i);
-		}
-		else
-		{
-			Result = SendPackMsgTranslate(pMsg, Flags, ClientId);
-		}
-		return Result;
+			return SendPackMsgMulticast(pMsg, Flags, IngameClients());
+		return SendPackMsgTranslate(pMsg, Flags, ClientId);
 	}
 
 	template<class T, typename std::enable_if<protocol7::is_sixup<T>::value, int>::type = 1>
 	inline int SendPackMsg(const T *pMsg, int Flags, int ClientId)
 	{
-		int Result = 0;
 		if(ClientId == -1)
+			return SendPackMsgMulticast(pMsg, Flags, IngameClients());
+		else if(IsSixup(ClientId))
+			return SendPackMsgOne(pMsg, Flags, ClientId);
+		return 0;
+	}
+
+	/**
+	 * Sends a message to all clients of a recipient mask, packing it once for
+	 * all 0.6 clients and once for all 0.7 clients. Only old vanilla clients,
+	 * which need the client ids translated to their own id map, get
+	 * individually packed copies.
+	 */
+	template<class T>
+	int SendPackMsgMulticast(const T *pMsg, int Flags, const CClientMask &Recipients)
+	{
+		if(Recipients.none())
+			return 0;
+		CClientMask Sixup, Six, Legacy;
+		SplitRecipients(Recipients, Sixup, Six, Legacy);
+		return SendPackMsgMulticastTranslate(pMsg, Flags, Sixup, Six, Legacy);
+	}
+
+	template<class T>
+	int SendPackMsgMulticastTranslate(const T *pMsg, int Flags, const CClientMask &Sixup, const CClientMask &Six, const CClientMask &Legacy)
+	{
+		if(protocol7::is_sixup<T>::value)
+			return SendPackMsgMulticastOne(pMsg, Flags, Sixup, true);
+		return SendPackMsgMulticastOne(pMsg, Flags, Sixup | Six | Legacy, true);
+	}
+
+	int SendPackMsgMulticastTranslate(const CNetMsg_Sv_Emoticon *pMsg, int Flags, const CClientMask &Sixup, const CClientMask &Six, const CClientMask &Legacy)
+	{
+		int Result = SendPackMsgMulticastOne(pMsg, Flags, Sixup | Six, true);
+		for(int i = 0; i < MAX_CLIENTS; i++)
+			if(Legacy.test(i) && SendPackMsgTranslate(pMsg, Flags, i, false) < 0)
+				Result = -1;
+		return Result;
+	}
+
+	int SendPackMsgMulticastTranslate(const CNetMsg_Sv_Chat *pMsg, int Flags, const CClientMask &Sixup, const CClientMask &Six, const CClientMask &Legacy)
+	{
+		int Result = 0;
+		if(Sixup.any())
 		{
-			for(int i = 0; i < MaxClients(); i++)
-				if(ClientIngame(i) && IsSixup(i))
-					Result = SendPackMsgOne(pMsg, Flags, i);
+			protocol7::CNetMsg_Sv_Chat Msg7;
+			Msg7.m_ClientId = pMsg->m_ClientId;
+			Msg7.m_pMessage = pMsg->m_pMessage;
+			Msg7.m_Mode = pMsg->m_Team > 0 ? protocol7::CHAT_TEAM : protocol7::CHAT_ALL;
+			Msg7.m_TargetId = -1;
+			Result = SendPackMsgMulticastOne(&Msg7, Flags, Sixup, false);
 		}
-		else if(IsSixup(ClientId))
-			Result = SendPackMsgOne(pMsg, Flags, ClientId);
+		if(SendPackMsgMulticastOne(pMsg, Flags, Six, true) < 0)
+			Result = -1;
+		for(int i = 0; i < MAX_CLIENTS; i++)
+			if(Legacy.test(i) && SendPackMsgTranslate(pMsg, Flags, i, false) < 0)
+				Result = -1;
+		return Result;
+	}
 
+	int SendPackMsgMulticastTranslate(const CNetMsg_Sv_KillMsg *pMsg, int Flags, const CClientMask &Sixup, const CClientMask &Six, const CClientMask &Legacy)
+	{
+		int Result = SendPackMsgMulticastOne(pMsg, Flags, Sixup | Six, true);
+		for(int i = 0; i < MAX_CLIENTS; i++)
+			if(Legacy.test(i) && SendPackMsgTranslate(pMsg, Flags, i, false) < 0)
+				Result = -1;
+		return Result;
+	}
+
+	int SendPackMsgMulticastTranslate(const CNetMsg_Sv_RaceFinish *pMsg, int Flags, const CClientMask &Sixup, const CClientMask &Six, const CClientMask &Legacy)
+	{
+		int Result = 0;
+		if(Sixup.any())
+		{
+			protocol7::CNetMsg_Sv_RaceFinish Msg7;
+			Msg7.m_ClientId = pMsg->m_ClientId;
+			Msg7.m_Diff = pMsg->m_Diff;
+			Msg7.m_Time = pMsg->m_Time;
+			Msg7.m_RecordPersonal = pMsg->m_RecordPersonal;
+			Msg7.m_RecordServer = pMsg->m_RecordServer;
+			Result = SendPackMsgMulticastOne(&Msg7, Flags, Sixup, false);
+		}
+		if(SendPackMsgMulticastOne(pMsg, Flags, Six | Legacy, true) < 0)
+			Result = -1;
 		return Result;
 	}
 
 	template<class T>
-	int SendPackMsgTranslate(const T *pMsg, int Flags, int ClientId)
+	int SendPackMsgMulticastOne(const T *pMsg, int Flags, const CClientMask &Recipients, bool RecordServerDemos)
 	{
-		return SendPackMsgOne(pMsg, Flags, ClientId);
+		CMsgPacker Packer(T::ms_MsgId, false, protocol7::is_sixup<T>::value);
+
+		if(pMsg->Pack(&Packer))
+			return -1;
+		return SendMsgMulticast(&Packer, Flags, Recipients, RecordServerDemos);
+	}
+
+	template<class T>
+	int SendPackMsgTranslate(const T *pMsg, int Flags, int ClientId, bool RecordServerDemos = true)
+	{
+		return SendPackMsgOne(pMsg, Flags, ClientId, RecordServerDemos);
 	}
 
-	int SendPackMsgTranslate(const CNetMsg_Sv_Emoticon *pMsg, int Flags, int ClientId)
+	int SendPackMsgTranslate(const CNetMsg_Sv_Emoticon *pMsg, int Flags, int ClientId, bool RecordServerDemos = true)
 	{
 		CNetMsg_Sv_Emoticon MsgCopy;
 		mem_copy(&MsgCopy, pMsg, sizeof(MsgCopy));
-		return Translate(MsgCopy.m_ClientId, ClientId) && SendPackMsgOne(&MsgCopy, Flags, ClientId);
+		return Translate(MsgCopy.m_ClientId, ClientId) && SendPackMsgOne(&MsgCopy, Flags, ClientId, RecordServerDemos);
 	}
 
-	int SendPackMsgTranslate(const CNetMsg_Sv_Chat *pMsg, int Flags, int ClientId)
+	int SendPackMsgTranslate(const CNetMsg_Sv_Chat *pMsg, int Flags, int ClientId, bool RecordServerDemos = true)
 	{
 		CNetMsg_Sv_Chat MsgCopy;
 		mem_copy(&MsgCopy, pMsg, sizeof(MsgCopy));
@@ -144,13 +237,13 @@ public:
 			Msg7.m_pMessage = MsgCopy.m_pMessage;
 			Msg7.m_Mode = MsgCopy.m_Team > 0 ? protocol7::CHAT_TEAM : protocol7::CHAT_ALL;
 			Msg7.m_TargetId = -1;
-			return SendPackMsgOne(&Msg7, Flags, ClientId);
+			return SendPackMsgOne(&Msg7, Flags, ClientId, RecordServerDemos);
 		}
 
-		return SendPackMsgOne(&MsgCopy, Flags, ClientId);
+		return SendPackMsgOne(&MsgCopy, Flags, ClientId, RecordServerDemos);
 	}
 
-	int SendPackMsgTranslate(const CNetMsg_Sv_KillMsg *pMsg, int Flags, int ClientId)
+	int SendPackMsgTranslate(const CNetMsg_Sv_KillMsg *pMsg, int Flags, int ClientId, bool RecordServerDemos = true)
 	{
 		CNetMsg_Sv_KillMsg MsgCopy;
 		mem_copy(&MsgCopy, pMsg, sizeof(MsgCopy));
@@ -158,10 +251,10 @@ public:
 			return 0;
 		if(!Translate(MsgCopy.m_Killer, ClientId))
 			MsgCopy.m_Killer = MsgCopy.m_Victim;
-		return SendPackMsgOne(&MsgCopy, Flags, ClientId);
+		return SendPackMsgOne(&MsgCopy, Flags, ClientId, RecordServerDemos);
 	}
 
-	int SendPackMsgTranslate(const CNetMsg_Sv_RaceFinish *pMsg, int Flags, int ClientId)
+	int SendPackMsgTranslate(const CNetMsg_Sv_RaceFinish *pMsg, int Flags, int ClientId, bool RecordServerDemos = true)
 	{
 		if(IsSixup(ClientId))
 		{
@@ -171,27 +264,58 @@ public:
 			Msg7.m_Time = pMsg->m_Time;
 			Msg7.m_RecordPersonal = pMsg->m_RecordPersonal;
 			Msg7.m_RecordServer = pMsg->m_RecordServer;
-			return SendPackMsgOne(&Msg7, Flags, ClientId);
+			return SendPackMsgOne(&Msg7, Flags, ClientId, RecordServerDemos);
 		}
-		return SendPackMsgOne(pMsg, Flags, ClientId);
+		return SendPackMsgOne(pMsg, Flags, ClientId, RecordServerDemos);
 	}
 
 	template<class T>
-	int SendPackMsgOne(const T *pMsg, int Flags, int ClientId)
+	int SendPackMsgOne(const T *pMsg, int Flags, int ClientId, bool RecordServerDemos = true)
 	{
 		dbg_assert(ClientId != -1, "SendPackMsgOne called with -1");
 		CMsgPacker Packer(T::ms_MsgId, false, protocol7::is_sixup<T>::value);
 
 		if(pMsg->Pack(&Packer))
 			return -1;
+		if(!RecordServerDemos)
+			return SendMsgMulticast(&Packer, Flags, CClientMask().set(ClientId), false);
 		return SendMsg(&Packer, Flags, ClientId);
 	}
 
+	// Old vanilla clients only know VANILLA_MAX_CLIENTS client ids and see
+	// the other clients through their id map
+	bool NeedsIdTranslation(int ClientId)
+	{
+		return !IsSixup(ClientId) && GetClientVersion(ClientId) < VERSION_DDNET_OLD;
+	}
+
+	CClientMask IngameClients()
+	{
+		CClientMask Mask;
+		for(int i = 0; i < MaxClients(); i++)
+			if(ClientIngame(i))
+				Mask.set(i);
+		return Mask;
+	}
+
+	void SplitRecipients(const CClientMask &Recipients, CClientMask &Sixup, CClientMask &Six, CClientMask &Legacy)
+	{
+		for(int i = 0; i < MAX_CLIENTS; i++)
+		{
+			if(!Recipients.test(i))
+				continue;
+			if(IsSixup(i))
+				Sixup.set(i);
+			else if(NeedsIdTranslation(i))
+				Legacy.set(i);
+			else
+				Six.set(i);
+		}
+	}
+
 	bool Translate(int &Target, int Client)
 	{
-		if(IsSixup(Client))
-			return true;
-		if(GetClientVersion(Client) >= VERSION_DDNET_OLD)
+		if(!NeedsIdTranslation(Client))
 			return true;
 		int *pMap = GetIdMap(Client);
 		bool Found = false;
@@ -209,9 +333,7 @@ public:
 
 	bool ReverseTranslate(int &Target, int Client)
 	{
-		if(IsSixup(Client))
-			return true;
-		if(GetClientVersion(Client) >= VERSION_DDNET_OLD)
+		if(!NeedsIdTranslation(Client))
 			return true;
 		Target = std::clamp(Target, 0, VANILLA_MAX_CLIENTS - 1);
 		int *pMap = GetIdMap(Client);
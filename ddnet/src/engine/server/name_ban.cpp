@@ -1,9 +1,89 @@
 #include "name_ban.h"
 
+#include <base/math.h>
 #include <base/system.h>
 
 #include <engine/shared/config.h>
 
+#include <algorithm>
+
+// Bit-parallel edit distance of one skeleton to many others (Myers' algorithm
+// as described by Hyyrö), for skeletons of up to 64 characters
+class CSkeletonMatcher
+{
+	enum
+	{
+		HASH_SIZE = 128,
+	};
+	int m_aKeys[HASH_SIZE];
+	uint64_t m_aMasks[HASH_SIZE];
+	int m_Length;
+
+	static int Hash(int Char) { return ((unsigned)Char * 2654435761u) >> 25; }
+
+	uint64_t Mask(int Char) const
+	{
+		for(int Slot = Hash(Char);; Slot = (Slot + 1) % HASH_SIZE)
+		{
+			if(m_aKeys[Slot] == Char)
+				return m_aMasks[Slot];
+			if(m_aKeys[Slot] == -1)
+				return 0;
+		}
+	}
+
+public:
+	bool Init(const int *pSkeleton, int Length)
+	{
+		if(Length > 64)
+			return false;
+		m_Length = Length;
+		for(int &Key : m_aKeys)
+			Key = -1;
+		for(int i = 0; i < Length; i++)
+		{
+			int Slot = Hash(pSkeleton[i]);
+			while(m_aKeys[Slot] != -1 && m_aKeys[Slot] != pSkeleton[i])
+				Slot = (Slot + 1) % HASH_SIZE;
+			if(m_aKeys[Slot] == -1)
+			{
+				m_aKeys[Slot] = pSkeleton[i];
+				m_aMasks[Slot] = 0;
+			}
+			m_aMasks[Slot] |= (uint64_t)1 << i;
+		}
+		return true;
+	}
+
+	int Distance(const int *pSkeleton, int Length) const
+	{
+		if(m_Length == 0)
+			return Length;
+
+		const uint64_t LastBit = (uint64_t)1 << (m_Length - 1);
+		uint64_t Pv = ~(uint64_t)0;
+		uint64_t Mv = 0;
+		int Score = m_Length;
+		for(int i = 0; i < Length; i++)
+		{
+			const uint64_t Eq = Mask(pSkeleton[i]);
+			const uint64_t Xv = Eq | Mv;
+			const uint64_t Xh = (((Eq & Pv) + Pv) ^ Pv) | Eq;
+			uint64_t Ph = Mv | ~(Xh | Pv);
+			uint64_t Mh = Pv & Xh;
+			if(Ph & LastBit)
+				Score++;
+			else if(Mh & LastBit)
+				Score--;
+			Ph = (Ph << 1) | 1;
+			Mh <<= 1;
+			Pv = Mh | ~(Xv | Ph);
+			Mv = Ph & Xv;
+		}
+		return Score;
+	}
+};
+
 CNameBan::CNameBan(const char *pName, const char *pReason, int Distance, bool IsSubstring) :
 	m_Distance(Distance), m_IsSubstring(IsSubstring)
 {
@@ -36,11 +116,13 @@ void CNameBans::Ban(const char *pName, const char *pReason, const int Distance,
 			str_copy(Ban.m_aReason, pReason);
 			Ban.m_Distance = Distance;
 			Ban.m_IsSubstring = IsSubstring;
+			RebuildIndex();
 			return;
 		}
 	}
 
 	m_vNameBans.emplace_back(pName, pReason, Distance, IsSubstring);
+	AddToIndex(m_vNameBans.size() - 1);
 	if(m_pConsole)
 	{
 		char aBuf[256];
@@ -70,9 +152,62 @@ void CNameBans::Unban(const char *pName)
 			m_pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "name_ban", aBuf);
 		}
 		m_vNameBans.erase(ToRemove, m_vNameBans.end());
+		RebuildIndex();
+	}
+}
+
+void CNameBans::AddToIndex(int Ban)
+{
+	const CNameBan &NameBan = m_vNameBans[Ban];
+	m_MaxDistance = maximum(m_MaxDistance, NameBan.m_Distance);
+	if(NameBan.m_IsSubstring)
+		m_vSubstringBans.push_back(Ban);
+
+	CSkeletonNode NewNode;
+	NewNode.m_Ban = Ban;
+	NewNode.m_ParentDistance = 0;
+	NewNode.m_FirstChild = -1;
+	NewNode.m_NextSibling = -1;
+	const int NewIndex = m_vSkeletonTree.size();
+	if(m_vSkeletonTree.empty())
+	{
+		m_vSkeletonTree.push_back(NewNode);
+		return;
+	}
+
+	int aBuffer[MAX_NAME_SKELETON_LENGTH * 2 + 2];
+	CSkeletonMatcher Matcher;
+	const bool UseMatcher = Matcher.Init(NameBan.m_aSkeleton, NameBan.m_SkeletonLength);
+	int Node = 0;
+	while(true)
+	{
+		const CNameBan &NodeBan = m_vNameBans[m_vSkeletonTree[Node].m_Ban];
+		const int Distance = UseMatcher ? Matcher.Distance(NodeBan.m_aSkeleton, NodeBan.m_SkeletonLength) : str_utf32_dist_buffer(NameBan.m_aSkeleton, NameBan.m_SkeletonLength, NodeBan.m_aSkeleton, NodeBan.m_SkeletonLength, aBuffer, std::size(aBuffer));
+
+		int Child = m_vSkeletonTree[Node].m_FirstChild;
+		while(Child >= 0 && m_vSkeletonTree[Child].m_ParentDistance != Distance)
+			Child = m_vSkeletonTree[Child].m_NextSibling;
+		if(Child < 0)
+		{
+			NewNode.m_ParentDistance = Distance;
+			NewNode.m_NextSibling = m_vSkeletonTree[Node].m_FirstChild;
+			m_vSkeletonTree[Node].m_FirstChild = NewIndex;
+			m_vSkeletonTree.push_back(NewNode);
+			return;
+		}
+		Node = Child;
 	}
 }
 
+void CNameBans::RebuildIndex()
+{
+	m_vSkeletonTree.clear();
+	m_vSubstringBans.clear();
+	m_MaxDistance = 0;
+	for(int Ban = 0; Ban < (int)m_vNameBans.size(); Ban++)
+		AddToIndex(Ban);
+}
+
 void CNameBans::Dump() const
 {
 	if(!m_pConsole)
@@ -95,15 +230,38 @@ const CNameBan *CNameBans::IsBanned(const char *pName) const
 	int aSkeleton[MAX_NAME_SKELETON_LENGTH];
 	int SkeletonLength = str_utf8_to_skeleton(aTrimmed, aSkeleton, std::size(aSkeleton));
 	int aBuffer[MAX_NAME_SKELETON_LENGTH * 2 + 2];
+	CSkeletonMatcher Matcher;
+	const bool UseMatcher = Matcher.Init(aSkeleton, SkeletonLength);
+
+	// the last matching ban wins, like when checking all bans in order
+	int Result = -1;
+	for(int Ban : m_vSubstringBans)
+	{
+		if(Ban > Result && str_utf8_find_nocase(pName, m_vNameBans[Ban].m_aName))
+			Result = Ban;
+	}
 
-	const CNameBan *pResult = nullptr;
-	for(const CNameBan &Ban : m_vNameBans)
+	if(!m_vSkeletonTree.empty())
 	{
-		int Distance = str_utf32_dist_buffer(aSkeleton, SkeletonLength, Ban.m_aSkeleton, Ban.m_SkeletonLength, aBuffer, std::size(aBuffer));
-		if(Distance <= Ban.m_Distance || (Ban.m_IsSubstring && str_utf8_find_nocase(pName, Ban.m_aName)))
-			pResult = &Ban;
+		std::vector<int> vStack = {0};
+		while(!vStack.empty())
+		{
+			const int Node = vStack.back();
+			vStack.pop_back();
+
+			const CNameBan &Ban = m_vNameBans[m_vSkeletonTree[Node].m_Ban];
+			const int Distance = UseMatcher ? Matcher.Distance(Ban.m_aSkeleton, Ban.m_SkeletonLength) : str_utf32_dist_buffer(aSkeleton, SkeletonLength, Ban.m_aSkeleton, Ban.m_SkeletonLength, aBuffer, std::size(aBuffer));
+			if(Distance <= Ban.m_Distance)
+				Result = maximum(Result, m_vSkeletonTree[Node].m_Ban);
+
+			for(int Child = m_vSkeletonTree[Node].m_FirstChild; Child >= 0; Child = m_vSkeletonTree[Child].m_NextSibling)
+			{
+				if(absolute(m_vSkeletonTree[Child].m_ParentDistance - Distance) <= m_MaxDistance)
+					vStack.push_back(Child);
+			}
+		}
 	}
-	return pResult;
+	return Result >= 0 ? &m_vNameBans[Result] : nullptr;
 }
 
 void CNameBans::ConNameBan(IConsole::IResult *pResult, void *pUser)
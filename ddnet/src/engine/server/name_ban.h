@@ -30,6 +30,25 @@ class CNameBans
 	IConsole *m_pConsole = nullptr;
 	std::vector<CNameBan> m_vNameBans;
 
+	// BK-tree over the skeletons of all bans. The edit distance is a metric,
+	// so only subtrees whose distance to the parent is within the largest
+	// ban distance of the distance between the name and the parent can
+	// contain matches.
+	class CSkeletonNode
+	{
+	public:
+		int m_Ban;
+		int m_ParentDistance;
+		int m_FirstChild;
+		int m_NextSibling;
+	};
+	std::vector<CSkeletonNode> m_vSkeletonTree;
+	std::vector<int> m_vSubstringBans;
+	int m_MaxDistance = 0;
+
+	void AddToIndex(int Ban);
+	void RebuildIndex();
+
 	static void ConNameBan(IConsole::IResult *pResult, void *pUser);
 	static void ConNameUnban(IConsole::IResult *pResult, void *pUser);
 	static void ConNameBans(IConsole::IResult *pResult, void *pUser);
@@ -909,6 +909,69 @@ int CServer::SendMsg(CMsgPacker *pMsg, int Flags, int ClientId)
 	return 0;
 }
 
+int CServer::SendMsgMulticast(CMsgPacker *pMsg, int Flags, const CClientMask &Recipients, bool RecordServerDemos)
+{
+	CNetChunk Packet;
+	mem_zero(&Packet, sizeof(CNetChunk));
+	if(Flags & MSGFLAG_VITAL)
+		Packet.m_Flags |= NETSENDFLAG_VITAL;
+	if(Flags & MSGFLAG_FLUSH)
+		Packet.m_Flags |= NETSENDFLAG_FLUSH;
+
+	// pack lazily, so protocol versions without recipients are never packed
+	CPacker aPacks[2];
+	bool aPacked[2] = {false, false};
+	bool aValid[2] = {false, false};
+	const auto GetPack = [&](bool Sixup) -> const CPacker * {
+		const int Index = Sixup ? 1 : 0;
+		if(!aPacked[Index])
+		{
+			aValid[Index] = RepackMsg(pMsg, aPacks[Index], Sixup);
+			aPacked[Index] = true;
+		}
+		return aValid[Index] ? &aPacks[Index] : nullptr;
+	};
+
+	int Result = 0;
+	if(RecordServerDemos && !(Flags & MSGFLAG_NORECORD) &&
+		(m_aDemoRecorder[RECORDER_MANUAL].IsRecording() || m_aDemoRecorder[RECORDER_AUTO].IsRecording()))
+	{
+		const CPacker *pPack = GetPack(false);
+		if(!pPack)
+			return -1;
+		for(int Recorder : {RECORDER_MANUAL, RECORDER_AUTO})
+			if(m_aDemoRecorder[Recorder].IsRecording())
+				m_aDemoRecorder[Recorder].RecordMessage(pPack->Data(), pPack->Size());
+	}
+
+	for(int i = 0; i < MAX_CLIENTS; i++)
+	{
+		if(!Recipients.test(i) || m_aClients[i].m_State == CClient::STATE_EMPTY)
+			continue;
+
+		const CPacker *pPack = GetPack(m_aClients[i].m_Sixup);
+		if(!pPack)
+		{
+			Result = -1;
+			continue;
+		}
+
+		Packet.m_ClientId = i;
+		Packet.m_pData = pPack->Data();
+		Packet.m_DataSize = pPack->Size();
+		if(Antibot()->OnEngineServerMessage(i, Packet.m_pData, Packet.m_DataSize, Flags))
+			continue;
+
+		if(!(Flags & MSGFLAG_NORECORD) && m_aDemoRecorder[i].IsRecording())
+			m_aDemoRecorder[i].RecordMessage(pPack->Data(), pPack->Size());
+
+		if(!(Flags & MSGFLAG_NOSEND))
+			m_NetServer.Send(&Packet);
+	}
+
+	return Result;
+}
+
 void CServer::SendMsgRaw(int ClientId, const void *pData, int Size, int Flags)
 {
 	CNetChunk Packet;
@@ -2730,7 +2793,7 @@ void CServer::PumpNetwork(bool PacketWaiting)
 						Packer.AddRaw(SERVERBROWSE_INFO, sizeof(SERVERBROWSE_INFO));
 						Packer.AddInt(SrvBrwsToken);
 						GetServerInfoSixup(&Packer, RateLimitServerInfoConnless());
-						CNetBase::SendPacketConnlessWithToken7(m_NetServer.Socket(), &Packet.m_Address, Packer.Data(), Packer.Size(), ResponseToken, m_NetServer.GetToken(Packet.m_Address));
+						m_NetServer.SendPacketConnlessWithToken7(&Packet.m_Address, Packer.Data(), Packer.Size(), ResponseToken, m_NetServer.GetToken(Packet.m_Address));
 					}
 					else if(Type != -1)
 					{
@@ -3017,6 +3080,9 @@ int CServer::Run()
 	if(Port == 0)
 		log_info("server", "using port %d", BindAddr.port);
 
+	if(Config()->m_SvNetThread)
+		m_NetServer.StartThread();
+
 #if defined(CONF_UPNP)
 	m_UPnP.Open(BindAddr);
 #endif
@@ -3328,14 +3394,14 @@ int CServer::Run()
 				!m_aDemoRecorder[RECORDER_MANUAL].IsRecording() &&
 				!m_aDemoRecorder[RECORDER_AUTO].IsRecording())
 			{
-				PacketWaiting = net_socket_read_wait(m_NetServer.Socket(), 1s);
+				PacketWaiting = m_NetServer.Wait(1s);
 			}
 			else
 			{
 				set_new_tick();
 				LastTime = time_get();
 				const auto MicrosecondsToWait = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::nanoseconds(TickStartTime(m_CurrentGameTick + 1) - LastTime)) + 1us;
-				PacketWaiting = MicrosecondsToWait > 0us ? net_socket_read_wait(m_NetServer.Socket(), MicrosecondsToWait) : true;
+				PacketWaiting = MicrosecondsToWait > 0us ? m_NetServer.Wait(MicrosecondsToWait) : true;
 			}
 			if(IsInterrupted())
 			{
@@ -331,6 +331,7 @@ public:
 
 	int GetClientVersion(int ClientId) const override;
 	int SendMsg(CMsgPacker *pMsg, int Flags, int ClientId) override;
+	int SendMsgMulticast(CMsgPacker *pMsg, int Flags, const CClientMask &Recipients, bool RecordServerDemos) override;
 
 	void DoSnapshot();
 
@@ -306,12 +306,17 @@ public:
 	{
 	public:
 		int64_t m_RequestTime;
+		int64_t m_RequestTimeout;
+		int64_t m_LostRequestTime; // when the last request that timed out was sent, its answer can still arrive
+		int m_RequestTries;
 		bool m_RequestIgnoreInfo;
 		int m_GotInfo;
 		CServerInfo m_Info;
 
 		CServerEntry *m_pPrevReq; // request list
 		CServerEntry *m_pNextReq;
+
+		int m_SearchKeysIndex; // in the search keys of the server browser
 	};
 
 	static constexpr const char *COMMUNITY_DDNET = "ddnet";
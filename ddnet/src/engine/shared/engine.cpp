@@ -76,12 +76,14 @@ public:
 		const size_t ThreadCount = std::max(4, (int)std::thread::hardware_concurrency()) - 2;
 #endif
 		m_JobPool.Init(ThreadCount);
+		CJobPool::SetShared(&m_JobPool);
 
 		m_Logging = false;
 	}
 
 	~CEngine() override
 	{
+		CJobPool::SetShared(nullptr);
 		CNetBase::CloseLog();
 	}
 
@@ -103,6 +105,7 @@ public:
 
 	void ShutdownJobs() override
 	{
+		CJobPool::SetShared(nullptr);
 		m_JobPool.Shutdown();
 	}
 
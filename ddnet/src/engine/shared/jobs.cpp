@@ -3,6 +3,9 @@
 #include "jobs.h"
 #include <algorithm>
 
+static thread_local bool gs_IsWorkerThread = false;
+static std::atomic<CJobPool *> gs_pSharedJobPool = nullptr;
+
 IJob::IJob() :
 	m_pNext(nullptr),
 	m_State(STATE_QUEUED),
@@ -57,6 +60,7 @@ CJobPool::~CJobPool()
 
 void CJobPool::WorkerThread(void *pUser)
 {
+	gs_IsWorkerThread = true;
 	static_cast<CJobPool *>(pUser)->RunLoop();
 }
 
@@ -135,6 +139,7 @@ void CJobPool::Init(int NumThreads)
 	sphore_init(&m_Semaphore);
 	m_pFirstJob = nullptr;
 	m_pLastJob = nullptr;
+	m_NumThreads = NumThreads;
 
 	// start worker threads
 	char aName[16]; // unix kernel length limit
@@ -228,3 +233,105 @@ void CJobPool::Add(std::shared_ptr<IJob> pJob)
 	// signal a worker thread that a job is available
 	sphore_signal(&m_Semaphore);
 }
+
+// The ranges of one ParallelFor call, shared by the calling thread and the jobs
+class CParallelForRanges
+{
+	const std::function<void(int, int)> *m_pFunc;
+	int m_Count;
+	int m_NumRanges;
+	std::atomic<int> m_NextRange;
+	std::atomic<int> m_RemainingRanges;
+	SEMAPHORE m_DoneSemaphore;
+
+public:
+	CParallelForRanges(const std::function<void(int, int)> *pFunc, int Count, int NumRanges) :
+		m_pFunc(pFunc),
+		m_Count(Count),
+		m_NumRanges(NumRanges),
+		m_NextRange(0),
+		m_RemainingRanges(NumRanges)
+	{
+		sphore_init(&m_DoneSemaphore);
+	}
+
+	~CParallelForRanges()
+	{
+		sphore_destroy(&m_DoneSemaphore);
+	}
+
+	// The function is only called for claimed ranges, so jobs which start after
+	// all ranges are done never touch it after the caller has returned
+	void Run()
+	{
+		while(true)
+		{
+			const int Range = m_NextRange.fetch_add(1);
+			if(Range >= m_NumRanges)
+				break;
+			(*m_pFunc)((int)((int64_t)m_Count * Range / m_NumRanges), (int)((int64_t)m_Count * (Range + 1) / m_NumRanges));
+			if(m_RemainingRanges.fetch_sub(1) == 1)
+				sphore_signal(&m_DoneSemaphore);
+		}
+	}
+
+	void Wait()
+	{
+		sphore_wait(&m_DoneSemaphore);
+	}
+};
+
+class CParallelForJob : public IJob
+{
+	std::shared_ptr<CParallelForRanges> m_pRanges;
+
+	void Run() override
+	{
+		m_pRanges->Run();
+	}
+
+public:
+	CParallelForJob(std::shared_ptr<CParallelForRanges> pRanges) :
+		m_pRanges(std::move(pRanges))
+	{
+	}
+};
+
+void CJobPool::ParallelFor(int Count, int MaxRanges, const std::function<void(int, int)> &Func)
+{
+	if(Count <= 0)
+		return;
+
+	const int NumRanges = IsWorkerThread() ? 1 : std::clamp(MaxRanges, 1, std::min(Count, m_NumThreads + 1));
+	if(NumRanges == 1)
+	{
+		Func(0, Count);
+		return;
+	}
+
+	// jobs which are aborted or not started yet leave their ranges to the calling thread
+	std::shared_ptr<CParallelForRanges> pRanges = std::make_shared<CParallelForRanges>(&Func, Count, NumRanges);
+	for(int i = 1; i < NumRanges; i++)
+		Add(std::make_shared<CParallelForJob>(pRanges));
+	pRanges->Run();
+	pRanges->Wait();
+}
+
+bool CJobPool::IsWorkerThread()
+{
+	return gs_IsWorkerThread;
+}
+
+void CJobPool::SetShared(CJobPool *pPool)
+{
+	gs_pSharedJobPool = pPool;
+}
+
+void CJobPool::ParallelForShared(int Count, int MaxRanges, const std::function<void(int, int)> &Func)
+{
+	CJobPool *pPool = gs_pSharedJobPool;
+	if(pPool)
+		pPool->ParallelFor(Count, MaxRanges, Func);
+	else if(Count > 0)
+		Func(0, Count);
+}
@@ -8,6 +8,7 @@
 
 #include <atomic>
 #include <deque>
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -127,6 +128,7 @@ public:
 class CJobPool
 {
 	std::vector<void *> m_vpThreads;
+	int m_NumThreads = 0;
 	std::atomic<bool> m_Shutdown;
 
 	CLock m_Lock;
@@ -170,5 +172,39 @@ public:
 	 * will be enqueue anymore. Abortable jobs will immediately be aborted.
 	 */
 	void Add(std::shared_ptr<IJob> pJob) REQUIRES(!m_Lock);
+
+	/**
+	 * Calls `Func(Begin, End)` for consecutive ranges which cover `[0, Count)`
+	 * together and returns once all of them are done. The calling thread works
+	 * on the ranges while idle worker threads of the job pool help out.
+	 *
+	 * @param Count The size of the whole range.
+	 * @param MaxRanges The maximum number of ranges to split the work into.
+	 * @param Func The function called for each range, possibly concurrently.
+	 *
+	 * @remark Runs everything on the calling thread if it is a worker thread
+	 * of a job pool itself, so jobs never wait for other jobs.
+	 */
+	void ParallelFor(int Count, int MaxRanges, const std::function<void(int, int)> &Func) REQUIRES(!m_Lock);
+
+	/**
+	 * Returns whether the calling thread is a worker thread of a job pool.
+	 */
+	static bool IsWorkerThread();
+
+	/**
+	 * Sets the job pool used by @link ParallelForShared @endlink.
+	 *
+	 * @param pPool The job pool or `nullptr` to run everything on the
+	 * calling thread.
+	 */
+	static void SetShared(CJobPool *pPool);
+
+	/**
+	 * Same as @link ParallelFor @endlink with the job pool set by
+	 * @link SetShared @endlink, for code which has no access to the engine.
+	 * Runs everything on the calling thread if no job pool is set.
+	 */
+	static void ParallelForShared(int Count, int MaxRanges, const std::function<void(int, int)> &Func);
 };
 #endif
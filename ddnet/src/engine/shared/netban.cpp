@@ -276,6 +276,7 @@ void CNetBan::Init(IConsole *pConsole, IStorage *pStorage)
 	m_pStorage = pStorage;
 	m_BanAddrPool.Reset();
 	m_BanRangePool.Reset();
+	ClearBlocklist();
 
 	net_host_lookup("localhost", &m_LocalhostIpV4, NETTYPE_IPV4);
 	net_host_lookup("localhost", &m_LocalhostIpV6, NETTYPE_IPV6);
@@ -288,6 +289,9 @@ void CNetBan::Init(IConsole *pConsole, IStorage *pStorage)
 	Console()->Register("bans", "?i[page]", CFGFLAG_SERVER | CFGFLAG_MASTER, ConBans, this, "Show banlist (page 1 by default, 20 entries per page)");
 	Console()->Register("bans_find", "s[ip]", CFGFLAG_SERVER | CFGFLAG_MASTER, ConBansFind, this, "Find all ban records for the specified IP address");
 	Console()->Register("bans_save", "s[file]", CFGFLAG_SERVER | CFGFLAG_MASTER | CFGFLAG_STORE, ConBansSave, this, "Save banlist in a file");
+	Console()->Register("blocklist_load", "s[file] ?r[reason]", CFGFLAG_SERVER | CFGFLAG_MASTER | CFGFLAG_STORE, ConBlocklistLoad, this, "Replace the blocklist by the address ranges in a file (text or binary)");
+	Console()->Register("blocklist_save", "s[file]", CFGFLAG_SERVER | CFGFLAG_MASTER, ConBlocklistSave, this, "Save the blocklist in binary format for faster loading");
+	Console()->Register("blocklist_clear", "", CFGFLAG_SERVER | CFGFLAG_MASTER | CFGFLAG_STORE, ConBlocklistClear, this, "Remove all blocklist entries");
 }
 
 void CNetBan::Update()
@@ -409,9 +413,65 @@ bool CNetBan::IsBanned(const NETADDR *pOrigAddr, char *pBuf, unsigned BufferSize
 		}
 	}
 
+	// check blocklist
+	if(m_pBlocklist && m_pBlocklist->Contains(pAddr))
+	{
+		str_format(pBuf, BufferSize, "You have been banned (%s)", m_aBlocklistReason);
+		return true;
+	}
+
 	return false;
 }
 
+bool CNetBan::LoadBlocklist(const char *pFilename, const char *pReason)
+{
+	char aBuf[256];
+	void *pData;
+	unsigned DataSize;
+	if(!Storage()->ReadFile(pFilename, IStorage::TYPE_ALL, &pData, &DataSize))
+	{
+		str_format(aBuf, sizeof(aBuf), "failed to open blocklist '%s'", pFilename);
+		Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "net_ban", aBuf);
+		return false;
+	}
+
+	// build the new blocklist completely before replacing the old one
+	const int64_t StartTime = time_get();
+	std::unique_ptr<CNetBlocklist> pBlocklist = std::make_unique<CNetBlocklist>();
+	int NumInvalid = 0;
+	if(CNetBlocklist::IsBinary(pData, DataSize))
+	{
+		if(!pBlocklist->LoadBinary(pData, DataSize))
+		{
+			free(pData);
+			str_format(aBuf, sizeof(aBuf), "failed to load blocklist '%s' (invalid binary blocklist)", pFilename);
+			Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "net_ban", aBuf);
+			return false;
+		}
+	}
+	else
+	{
+		std::vector<CNetBlocklist::CPrefix> vPrefixes;
+		NumInvalid = CNetBlocklist::ParseText(vPrefixes, static_cast<const char *>(pData), DataSize);
+		pBlocklist->Build(vPrefixes);
+	}
+	free(pData);
+
+	m_pBlocklist = std::move(pBlocklist);
+	str_copy(m_aBlocklistReason, pReason[0] ? pReason : "blocklisted");
+
+	str_format(aBuf, sizeof(aBuf), "loaded blocklist '%s' with %d prefixes in %.2fms (%d invalid lines, %d KiB)",
+		pFilename, m_pBlocklist->NumPrefixes(), (time_get() - StartTime) * 1000.0 / time_freq(), NumInvalid, (int)(m_pBlocklist->MemoryUsage() / 1024));
+	Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "net_ban", aBuf);
+	return true;
+}
+
+void CNetBan::ClearBlocklist()
+{
+	m_pBlocklist = nullptr;
+	m_aBlocklistReason[0] = '\0';
+}
+
 void CNetBan::ConBan(IConsole::IResult *pResult, void *pUser)
 {
 	CNetBan *pThis = static_cast<CNetBan *>(pUser);
@@ -580,6 +640,14 @@ void CNetBan::ConBansFind(IConsole::IResult *pResult, void *pUser)
 			Found++;
 		}
 	}
+	// check blocklist
+	if(pThis->m_pBlocklist && pThis->m_pBlocklist->Contains(&Addr))
+	{
+		str_format(aMsg, sizeof(aMsg), "%s blocklisted (%s)", pThis->NetToString(&Addr, aBuf, sizeof(aBuf)), pThis->m_aBlocklistReason);
+		pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "net_ban", aMsg);
+
+		Found++;
+	}
 
 	if(Found)
 		str_format(aMsg, sizeof(aMsg), "%i ban records found.", Found);
@@ -626,3 +694,43 @@ void CNetBan::ConBansSave(IConsole::IResult *pResult, void *pUser)
 	str_format(aBuf, sizeof(aBuf), "saved banlist to '%s'", pResult->GetString(0));
 	pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "net_ban", aBuf);
 }
+
+void CNetBan::ConBlocklistLoad(IConsole::IResult *pResult, void *pUser)
+{
+	CNetBan *pThis = static_cast<CNetBan *>(pUser);
+	pThis->LoadBlocklist(pResult->GetString(0), pResult->NumArguments() > 1 ? pResult->GetString(1) : "");
+}
+
+void CNetBan::ConBlocklistSave(IConsole::IResult *pResult, void *pUser)
+{
+	CNetBan *pThis = static_cast<CNetBan *>(pUser);
+
+	char aBuf[256];
+	if(!pThis->m_pBlocklist)
+	{
+		pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "net_ban", "blocklist_save error (no blocklist loaded)");
+		return;
+	}
+
+	IOHANDLE File = pThis->Storage()->OpenFile(pResult->GetString(0), IOFLAG_WRITE, IStorage::TYPE_SAVE);
+	if(!File)
+	{
+		str_format(aBuf, sizeof(aBuf), "failed to save blocklist to '%s'", pResult->GetString(0));
+		pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "net_ban", aBuf);
+		return;
+	}
+
+	std::vector<unsigned char> vData;
+	pThis->m_pBlocklist->SaveBinary(vData);
+	io_write(File, vData.data(), vData.size());
+	io_close(File);
+	str_format(aBuf, sizeof(aBuf), "saved blocklist with %d prefixes to '%s'", pThis->m_pBlocklist->NumPrefixes(), pResult->GetString(0));
+	pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "net_ban", aBuf);
+}
+
+void CNetBan::ConBlocklistClear(IConsole::IResult *pResult, void *pUser)
+{
+	CNetBan *pThis = static_cast<CNetBan *>(pUser);
+	pThis->ClearBlocklist();
+	pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "net_ban", "cleared blocklist");
+}
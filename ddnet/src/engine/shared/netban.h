@@ -4,6 +4,10 @@
 #include <base/system.h>
 #include <engine/console.h>
 
+#include "netblocklist.h"
+
+#include <memory>
+
 inline int NetComp(const NETADDR *pAddr1, const NETADDR *pAddr2)
 {
 	return mem_comp(pAddr1, pAddr2, pAddr1->type == NETTYPE_IPV4 ? 8 : 20);
@@ -161,6 +165,10 @@ protected:
 	CBanRangePool m_BanRangePool;
 	NETADDR m_LocalhostIpV4, m_LocalhostIpV6;
 
+	// only replaced as a whole, never modified while in use
+	std::unique_ptr<const CNetBlocklist> m_pBlocklist;
+	char m_aBlocklistReason[CBanInfo::REASON_LENGTH];
+
 public:
 	enum
 	{
@@ -184,6 +192,8 @@ public:
 	int UnbanByIndex(int Index);
 	void UnbanAll();
 	bool IsBanned(const NETADDR *pOrigAddr, char *pBuf, unsigned BufferSize) const;
+	bool LoadBlocklist(const char *pFilename, const char *pReason);
+	void ClearBlocklist();
 
 	static void ConBan(class IConsole::IResult *pResult, void *pUser);
 	static void ConBanRange(class IConsole::IResult *pResult, void *pUser);
@@ -193,6 +203,9 @@ public:
 	static void ConBans(class IConsole::IResult *pResult, void *pUser);
 	static void ConBansFind(class IConsole::IResult *pResult, void *pUser);
 	static void ConBansSave(class IConsole::IResult *pResult, void *pUser);
+	static void ConBlocklistLoad(class IConsole::IResult *pResult, void *pUser);
+	static void ConBlocklistSave(class IConsole::IResult *pResult, void *pUser);
+	static void ConBlocklistClear(class IConsole::IResult *pResult, void *pUser);
 };
 
 template<class T>
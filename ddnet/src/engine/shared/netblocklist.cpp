@@ -0,0 +1,366 @@
+#include "netblocklist.h"
+#include "netban.h"
+
+#include <base/math.h>
+
+#include <algorithm>
+#include <bit>
+
+static const unsigned char BLOCKLIST_MAGIC[4] = {'T', 'W', 'B', 'L'};
+static const unsigned BLOCKLIST_VERSION = 1;
+static const size_t BLOCKLIST_HEADER_SIZE = sizeof(BLOCKLIST_MAGIC) + 8;
+static const size_t BLOCKLIST_PREFIX_SIZE = 17;
+
+static uint64_t PrefixMask(int Length, int Part)
+{
+	const int Bits = std::clamp(Length - Part * 64, 0, 64);
+	return Bits == 0 ? 0 : ~(uint64_t)0 << (64 - Bits);
+}
+
+static int CommonPrefixLength(const CNetBlocklist::CKey &Key1, const CNetBlocklist::CKey &Key2)
+{
+	if(Key1.m_aParts[0] != Key2.m_aParts[0])
+		return std::countl_zero(Key1.m_aParts[0] ^ Key2.m_aParts[0]);
+	return 64 + std::countl_zero(Key1.m_aParts[1] ^ Key2.m_aParts[1]);
+}
+
+CNetBlocklist::CKey CNetBlocklist::CKey::First(int Length) const
+{
+	CKey Key;
+	Key.m_aParts[0] = m_aParts[0] & PrefixMask(Length, 0);
+	Key.m_aParts[1] = m_aParts[1] & PrefixMask(Length, 1);
+	return Key;
+}
+
+CNetBlocklist::CKey CNetBlocklist::CKey::Last(int Length) const
+{
+	CKey Key;
+	Key.m_aParts[0] = m_aParts[0] | ~PrefixMask(Length, 0);
+	Key.m_aParts[1] = m_aParts[1] | ~PrefixMask(Length, 1);
+	return Key;
+}
+
+bool CNetBlocklist::CKey::FromAddr(const NETADDR *pAddr, CKey *pKey, int *pPrefixOffset)
+{
+	if(pAddr->type & (NETTYPE_IPV4 | NETTYPE_WEBSOCKET_IPV4))
+	{
+		pKey->m_aParts[0] = 0;
+		pKey->m_aParts[1] = 0x0000ffff00000000ull | bytes_be_to_uint(pAddr->ip);
+		*pPrefixOffset = IPV4_PREFIX_OFFSET;
+		return true;
+	}
+	if(pAddr->type & (NETTYPE_IPV6 | NETTYPE_WEBSOCKET_IPV6))
+	{
+		pKey->m_aParts[0] = ((uint64_t)bytes_be_to_uint(&pAddr->ip[0]) << 32) | bytes_be_to_uint(&pAddr->ip[4]);
+		pKey->m_aParts[1] = ((uint64_t)bytes_be_to_uint(&pAddr->ip[8]) << 32) | bytes_be_to_uint(&pAddr->ip[12]);
+		*pPrefixOffset = 0;
+		return true;
+	}
+	return false;
+}
+
+int CNetBlocklist::NewNode(const CKey &Key, int Length, bool Terminal)
+{
+	CNode Node;
+	Node.m_Key = Key;
+	Node.m_Length = Length;
+	Node.m_Terminal = Terminal;
+	Node.m_aChildren[0] = -1;
+	Node.m_aChildren[1] = -1;
+	m_vNodes.push_back(Node);
+	return m_vNodes.size() - 1;
+}
+
+void CNetBlocklist::Insert(const CKey &Key, int Length)
+{
+	// the slot pointing to the current node, -1 for the root
+	int Parent = -1;
+	int ParentBit = 0;
+	int Index = m_Root;
+	while(Index >= 0)
+	{
+		const CNode &Node = m_vNodes[Index];
+		const int Common = minimum(CommonPrefixLength(Key, Node.m_Key), Length, (int)Node.m_Length);
+		if(Common == Node.m_Length)
+		{
+			if(Node.m_Terminal)
+				return; // already covered
+			if(Common == Length)
+			{
+				// covers the whole subtree
+				m_vNodes[Index].m_Terminal = true;
+				m_vNodes[Index].m_aChildren[0] = -1;
+				m_vNodes[Index].m_aChildren[1] = -1;
+				return;
+			}
+			Parent = Index;
+			ParentBit = Key.Bit(Common);
+			Index = Node.m_aChildren[ParentBit];
+			continue;
+		}
+
+		// the prefix diverges within the current node, split it
+		int NewIndex;
+		if(Common == Length)
+		{
+			NewIndex = NewNode(Key, Length, true);
+		}
+		else
+		{
+			NewIndex = NewNode(Key.First(Common), Common, false);
+			const int Leaf = NewNode(Key, Length, true);
+			m_vNodes[NewIndex].m_aChildren[Key.Bit(Common)] = Leaf;
+			m_vNodes[NewIndex].m_aChildren[m_vNodes[Index].m_Key.Bit(Common)] = Index;
+		}
+		if(Parent < 0)
+			m_Root = NewIndex;
+		else
+			m_vNodes[Parent].m_aChildren[ParentBit] = NewIndex;
+		return;
+	}
+
+	const int Leaf = NewNode(Key, Length, true);
+	if(Parent < 0)
+		m_Root = Leaf;
+	else
+		m_vNodes[Parent].m_aChildren[ParentBit] = Leaf;
+}
+
+void CNetBlocklist::Build(std::vector<CPrefix> &vPrefixes)
+{
+	std::sort(vPrefixes.begin(), vPrefixes.end(), [](const CPrefix &Prefix1, const CPrefix &Prefix2) {
+		return Prefix1.m_Key < Prefix2.m_Key || (Prefix1.m_Key == Prefix2.m_Key && Prefix1.m_Length < Prefix2.m_Length);
+	});
+
+	// after sorting, prefixes covered by another prefix directly follow it
+	size_t NumUnique = 0;
+	for(size_t i = 0; i < vPrefixes.size(); i++)
+	{
+		if(NumUnique > 0 && vPrefixes[i].m_Key.HasPrefix(vPrefixes[NumUnique - 1].m_Key, vPrefixes[NumUnique - 1].m_Length))
+			continue;
+		vPrefixes[NumUnique++] = vPrefixes[i];
+	}
+	vPrefixes.resize(NumUnique);
+
+	m_vNodes.clear();
+	m_vNodes.reserve(2 * NumUnique);
+	m_Root = -1;
+	for(const CPrefix &Prefix : vPrefixes)
+		Insert(Prefix.m_Key, Prefix.m_Length);
+	m_NumPrefixes = NumUnique;
+}
+
+bool CNetBlocklist::Contains(const CKey &Key) const
+{
+	int Index = m_Root;
+	while(Index >= 0)
+	{
+		const CNode &Node = m_vNodes[Index];
+		if(!Key.HasPrefix(Node.m_Key, Node.m_Length))
+			return false;
+		if(Node.m_Terminal)
+			return true;
+		Index = Node.m_aChildren[Key.Bit(Node.m_Length)];
+	}
+	return false;
+}
+
+bool CNetBlocklist::Contains(const NETADDR *pAddr) const
+{
+	CKey Key;
+	int PrefixOffset;
+	return m_Root >= 0 && CKey::FromAddr(pAddr, &Key, &PrefixOffset) && Contains(Key);
+}
+
+void CNetBlocklist::Prefixes(std::vector<CPrefix> &vPrefixes) const
+{
+	vPrefixes.clear();
+	vPrefixes.reserve(m_NumPrefixes);
+	if(m_Root < 0)
+		return;
+
+	std::vector<int> vStack = {m_Root};
+	while(!vStack.empty())
+	{
+		const CNode &Node = m_vNodes[vStack.back()];
+		vStack.pop_back();
+		if(Node.m_Terminal)
+		{
+			vPrefixes.push_back({Node.m_Key, Node.m_Length});
+			continue;
+		}
+		for(int Bit = 1; Bit >= 0; Bit--)
+		{
+			if(Node.m_aChildren[Bit] >= 0)
+				vStack.push_back(Node.m_aChildren[Bit]);
+		}
+	}
+}
+
+bool CNetBlocklist::AddPrefix(std::vector<CPrefix> &vPrefixes, const NETADDR *pAddr, int PrefixLength)
+{
+	CKey Key;
+	int PrefixOffset;
+	if(!CKey::FromAddr(pAddr, &Key, &PrefixOffset) || PrefixLength < 0 || PrefixOffset + PrefixLength > KEY_BITS)
+		return false;
+	vPrefixes.push_back({Key.First(PrefixOffset + PrefixLength), PrefixOffset + PrefixLength});
+	return true;
+}
+
+bool CNetBlocklist::AddRange(std::vector<CPrefix> &vPrefixes, const CNetRange *pRange)
+{
+	CKey First, Last;
+	int FirstOffset, LastOffset;
+	if(!CKey::FromAddr(&pRange->m_LB, &First, &FirstOffset) || !CKey::FromAddr(&pRange->m_UB, &Last, &LastOffset) || FirstOffset != LastOffset || Last < First)
+		return false;
+
+	// split the range into the largest aligned blocks
+	while(true)
+	{
+		int Length = First.m_aParts[1] != 0 ? KEY_BITS - std::countr_zero(First.m_aParts[1]) : (First.m_aParts[0] != 0 ? 64 - std::countr_zero(First.m_aParts[0]) : 0);
+		while(!(First.Last(Length) <= Last))
+			Length++;
+		vPrefixes.push_back({First, Length});
+
+		const CKey BlockLast = First.Last(Length);
+		if(BlockLast == Last)
+			return true;
+		First = BlockLast;
+		if(++First.m_aParts[1] == 0)
+			First.m_aParts[0]++;
+	}
+}
+
+static bool ParseBlocklistAddr(const char *pStr, NETADDR *pAddr)
+{
+	// IPv6 addresses are usually written without brackets in blocklists
+	char aAddr[NETADDR_MAXSTRSIZE + 2];
+	if(pStr[0] != '[' && str_find(pStr, ":"))
+	{
+		str_format(aAddr, sizeof(aAddr), "[%s]", pStr);
+		pStr = aAddr;
+	}
+	return net_addr_from_str(pAddr, pStr) == 0;
+}
+
+bool CNetBlocklist::ParseLine(std::vector<CPrefix> &vPrefixes, const char *pLine)
+{
+	char aLine[128];
+	str_copy(aLine, str_skip_whitespaces_const(pLine));
+	for(char *pComment = aLine; *pComment; pComment++)
+	{
+		if(*pComment == '#' || *pComment == ';')
+		{
+			*pComment = '\0';
+			break;
+		}
+	}
+	str_utf8_trim_right(aLine);
+	if(aLine[0] == '\0')
+		return true;
+
+	if(char *pSeparator = (char *)str_find(aLine, "-"))
+	{
+		*pSeparator = '\0';
+		str_utf8_trim_right(aLine);
+		CNetRange Range;
+		return ParseBlocklistAddr(aLine, &Range.m_LB) && ParseBlocklistAddr(str_skip_whitespaces(pSeparator + 1), &Range.m_UB) && AddRange(vPrefixes, &Range);
+	}
+
+	NETADDR Addr;
+	if(char *pSlash = (char *)str_find(aLine, "/"))
+	{
+		*pSlash = '\0';
+		const char *pLength = pSlash + 1;
+		if(pLength[0] == '\0' || !str_isallnum(pLength) || str_length(pLength) > 3)
+			return false;
+		return ParseBlocklistAddr(aLine, &Addr) && AddPrefix(vPrefixes, &Addr, str_toint(pLength));
+	}
+
+	return ParseBlocklistAddr(aLine, &Addr) && AddPrefix(vPrefixes, &Addr, Addr.type == NETTYPE_IPV4 ? 32 : 128);
+}
+
+int CNetBlocklist::ParseText(std::vector<CPrefix> &vPrefixes, const char *pData, size_t Size)
+{
+	int NumInvalid = 0;
+	size_t LineStart = 0;
+	while(LineStart < Size)
+	{
+		size_t LineEnd = LineStart;
+		while(LineEnd < Size && pData[LineEnd] != '\n')
+			LineEnd++;
+
+		char aLine[128];
+		str_truncate(aLine, sizeof(aLine), &pData[LineStart], LineEnd - LineStart);
+		if(!ParseLine(vPrefixes, aLine))
+			NumInvalid++;
+		LineStart = LineEnd + 1;
+	}
+	return NumInvalid;
+}
+
+bool CNetBlocklist::IsBinary(const void *pData, size_t Size)
+{
+	return Size >= BLOCKLIST_HEADER_SIZE && mem_comp(pData, BLOCKLIST_MAGIC, sizeof(BLOCKLIST_MAGIC)) == 0;
+}
+
+bool CNetBlocklist::LoadBinary(const void *pData, size_t Size)
+{
+	const unsigned char *pBytes = static_cast<const unsigned char *>(pData);
+	if(!IsBinary(pData, Size) || bytes_be_to_uint(&pBytes[4]) != BLOCKLIST_VERSION)
+		return false;
+	const size_t NumPrefixes = bytes_be_to_uint(&pBytes[8]);
+	if((Size - BLOCKLIST_HEADER_SIZE) / BLOCKLIST_PREFIX_SIZE != NumPrefixes || (Size - BLOCKLIST_HEADER_SIZE) % BLOCKLIST_PREFIX_SIZE != 0)
+		return false;
+
+	// the prefixes are stored sorted and without covered ones, only
+	// validate that instead of sorting again
+	std::vector<CNode> vOldNodes;
+	std::swap(vOldNodes, m_vNodes);
+	const int OldRoot = m_Root;
+	m_vNodes.reserve(2 * NumPrefixes);
+	m_Root = -1;
+
+	CPrefix Previous;
+	for(size_t i = 0; i < NumPrefixes; i++)
+	{
+		const unsigned char *pPrefix = &pBytes[BLOCKLIST_HEADER_SIZE + i * BLOCKLIST_PREFIX_SIZE];
+		CPrefix Prefix;
+		for(int Part = 0; Part < 2; Part++)
+			Prefix.m_Key.m_aParts[Part] = ((uint64_t)bytes_be_to_uint(&pPrefix[Part * 8]) << 32) | bytes_be_to_uint(&pPrefix[Part * 8 + 4]);
+		Prefix.m_Length = pPrefix[16];
+
+		if(Prefix.m_Length > KEY_BITS || !(Prefix.m_Key == Prefix.m_Key.First(Prefix.m_Length)) ||
+			(i > 0 && (!(Previous.m_Key < Prefix.m_Key) || Prefix.m_Key.HasPrefix(Previous.m_Key, Previous.m_Length))))
+		{
+			std::swap(vOldNodes, m_vNodes);
+			m_Root = OldRoot;
+			return false;
+		}
+		Insert(Prefix.m_Key, Prefix.m_Length);
+		Previous = Prefix;
+	}
+	m_NumPrefixes = NumPrefixes;
+	return true;
+}
+
+void CNetBlocklist::SaveBinary(std::vector<unsigned char> &vData) const
+{
+	std::vector<CPrefix> vPrefixes;
+	Prefixes(vPrefixes);
+
+	vData.resize(BLOCKLIST_HEADER_SIZE + vPrefixes.size() * BLOCKLIST_PREFIX_SIZE);
+	mem_copy(vData.data(), BLOCKLIST_MAGIC, sizeof(BLOCKLIST_MAGIC));
+	uint_to_bytes_be(&vData[4], BLOCKLIST_VERSION);
+	uint_to_bytes_be(&vData[8], vPrefixes.size());
+	for(size_t i = 0; i < vPrefixes.size(); i++)
+	{
+		unsigned char *pPrefix = &vData[BLOCKLIST_HEADER_SIZE + i * BLOCKLIST_PREFIX_SIZE];
+		for(int Part = 0; Part < 2; Part++)
+		{
+			uint_to_bytes_be(&pPrefix[Part * 8], vPrefixes[i].m_Key.m_aParts[Part] >> 32);
+			uint_to_bytes_be(&pPrefix[Part * 8 + 4], vPrefixes[i].m_Key.m_aParts[Part]);
+		}
+		pPrefix[16] = vPrefixes[i].m_Length;
+	}
+}
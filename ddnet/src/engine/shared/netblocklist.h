@@ -0,0 +1,103 @@
+#ifndef ENGINE_SHARED_NETBLOCKLIST_H
+#define ENGINE_SHARED_NETBLOCKLIST_H
+
+#include <base/system.h>
+
+#include <cstdint>
+#include <vector>
+
+class CNetRange;
+
+// Large set of IPv4 and IPv6 address ranges, used for blocklists with many
+// thousands of entries that would not fit into the ban pools of CNetBan.
+//
+// Ranges are split into CIDR prefixes which are stored in a path-compressed
+// binary trie, so lookups take at most one step per prefix bit. IPv4
+// addresses are stored as IPv4-mapped IPv6 addresses (::ffff:0:0/96).
+//
+// A blocklist is built completely before it is used and not modified
+// afterwards, so it can be swapped atomically on reload.
+class CNetBlocklist
+{
+public:
+	class CKey
+	{
+	public:
+		uint64_t m_aParts[2]; // big-endian halves of the IPv6 address
+
+		bool operator==(const CKey &Other) const { return m_aParts[0] == Other.m_aParts[0] && m_aParts[1] == Other.m_aParts[1]; }
+		bool operator<(const CKey &Other) const { return m_aParts[0] < Other.m_aParts[0] || (m_aParts[0] == Other.m_aParts[0] && m_aParts[1] < Other.m_aParts[1]); }
+		bool operator<=(const CKey &Other) const { return !(Other < *this); }
+
+		int Bit(int Index) const { return (m_aParts[Index / 64] >> (63 - Index % 64)) & 1; }
+		CKey First(int Length) const; // all bits after the prefix cleared
+		CKey Last(int Length) const; // all bits after the prefix set
+		bool HasPrefix(const CKey &Prefix, int Length) const { return First(Length) == Prefix; }
+
+		static bool FromAddr(const NETADDR *pAddr, CKey *pKey, int *pPrefixOffset);
+	};
+
+	class CPrefix
+	{
+	public:
+		CKey m_Key;
+		int m_Length;
+	};
+
+	enum
+	{
+		KEY_BITS = 128,
+		IPV4_PREFIX_OFFSET = 96,
+	};
+
+private:
+	class CNode
+	{
+	public:
+		CKey m_Key;
+		uint8_t m_Length;
+		bool m_Terminal;
+		int32_t m_aChildren[2];
+	};
+
+	std::vector<CNode> m_vNodes;
+	int m_Root = -1;
+	int m_NumPrefixes = 0;
+
+	void Insert(const CKey &Key, int Length);
+	int NewNode(const CKey &Key, int Length, bool Terminal);
+
+public:
+	// Builds the trie from the given prefixes, the order does not matter and
+	// prefixes covered by other prefixes are dropped
+	void Build(std::vector<CPrefix> &vPrefixes);
+
+	bool Contains(const NETADDR *pAddr) const;
+	bool Contains(const CKey &Key) const;
+
+	int NumPrefixes() const { return m_NumPrefixes; }
+	int NumNodes() const { return m_vNodes.size(); }
+	size_t MemoryUsage() const { return m_vNodes.capacity() * sizeof(CNode); }
+
+	// All stored prefixes, sorted by key and without covered prefixes
+	void Prefixes(std::vector<CPrefix> &vPrefixes) const;
+
+	// Adds the prefixes covering exactly the given address or address range
+	static bool AddPrefix(std::vector<CPrefix> &vPrefixes, const NETADDR *pAddr, int PrefixLength);
+	static bool AddRange(std::vector<CPrefix> &vPrefixes, const CNetRange *pRange);
+
+	// Parses a blocklist line, either an address, a CIDR prefix like
+	// "192.0.2.0/24" or "2001:db8::/32", or a range like "192.0.2.1-192.0.2.7".
+	// Returns false for invalid lines, empty lines and comments starting
+	// with '#' or ';' are ignored.
+	static bool ParseLine(std::vector<CPrefix> &vPrefixes, const char *pLine);
+	// Parses all lines of a text blocklist, returns the number of invalid lines
+	static int ParseText(std::vector<CPrefix> &vPrefixes, const char *pData, size_t Size);
+
+	// Binary blocklist format: a header followed by the sorted prefixes
+	static bool IsBinary(const void *pData, size_t Size);
+	bool LoadBinary(const void *pData, size_t Size);
+	void SaveBinary(std::vector<unsigned char> &vData) const;
+};
+
+#endif
@@ -365,17 +365,21 @@ int CNetBase::UnpackPacket(unsigned char *pBuffer, int Size, CNetPacketConstruct
 	return 0;
 }
 
-void CNetBase::SendControlMsg(NETSOCKET Socket, NETADDR *pAddr, int Ack, int ControlMsg, const void *pExtra, int ExtraSize, SECURITY_TOKEN SecurityToken, bool Sixup)
+void CNetBase::ConstructControlMsg(CNetPacketConstruct *pPacket, int Ack, int ControlMsg, const void *pExtra, int ExtraSize)
 {
-	CNetPacketConstruct Construct;
-	Construct.m_Flags = NET_PACKETFLAG_CONTROL;
-	Construct.m_Ack = Ack;
-	Construct.m_NumChunks = 0;
-	Construct.m_DataSize = 1 + ExtraSize;
-	Construct.m_aChunkData[0] = ControlMsg;
+	pPacket->m_Flags = NET_PACKETFLAG_CONTROL;
+	pPacket->m_Ack = Ack;
+	pPacket->m_NumChunks = 0;
+	pPacket->m_DataSize = 1 + ExtraSize;
+	pPacket->m_aChunkData[0] = ControlMsg;
 	if(pExtra)
-		mem_copy(&Construct.m_aChunkData[1], pExtra, ExtraSize);
+		mem_copy(&pPacket->m_aChunkData[1], pExtra, ExtraSize);
+}
 
+void CNetBase::SendControlMsg(NETSOCKET Socket, NETADDR *pAddr, int Ack, int ControlMsg, const void *pExtra, int ExtraSize, SECURITY_TOKEN SecurityToken, bool Sixup)
+{
+	CNetPacketConstruct Construct;
+	ConstructControlMsg(&Construct, Ack, ControlMsg, pExtra, ExtraSize);
 	CNetBase::SendPacket(Socket, pAddr, &Construct, SecurityToken, Sixup);
 }
 
@@ -4,11 +4,18 @@
 #define ENGINE_SHARED_NETWORK_H
 
 #include "ringbuffer.h"
+#include "spsc_queue.h"
 #include "stun.h"
 
+#include <base/tl/threading.h>
 #include <base/types.h>
 
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <optional>
 
 class CHuffman;
@@ -265,6 +272,7 @@ private:
 	// client 0.7
 	static TOKEN GenerateToken7(const NETADDR *pPeerAddr);
 	class CNetBase *m_pNetBase;
+	class CNetServerThread *m_pServerThread = nullptr;
 	bool IsSixup() const { return m_Sixup; }
 
 	//
@@ -289,6 +297,7 @@ public:
 
 	void Reset(bool Rejoin = false);
 	void Init(NETSOCKET Socket, bool BlockCloseMsg);
+	void SetServerThread(class CNetServerThread *pServerThread) { m_pServerThread = pServerThread; }
 	int Connect(const NETADDR *pAddr, int NumAddrs);
 	int Connect7(const NETADDR *pAddr, int NumAddrs);
 	void Disconnect(const char *pReason);
@@ -392,6 +401,102 @@ public:
 	int FetchChunk(CNetChunk *pChunk);
 };
 
+// Network threads of the server, see sv_net_thread.
+//
+// The receive thread reads packets from the socket and decodes them, the
+// send thread compresses and sends the packets of the connections. Both hand
+// the packets over to the game thread through lock-free queues. Decoding
+// assumes 0.6 connections, packets of 0.7 connections are decoded again by the
+// game thread, because only it knows which connections use 0.7.
+//
+// While the threads run, the game thread does not use the socket. Every packet,
+// including control and connectionless ones, goes through the send queue, so
+// packets are sent in the order they were queued. The send thread is the only
+// one writing to the socket and the receive thread the only one reading from
+// it, which is only safe for plain UDP sockets, not for websockets.
+class CNetServerThread
+{
+public:
+	class CRecvPacket
+	{
+	public:
+		NETADDR m_Addr;
+		int m_Size;
+		unsigned char m_aData[NET_MAX_PACKETSIZE];
+
+		// result of CNetBase::UnpackPacket
+		int m_Result;
+		bool m_Sixup;
+		SECURITY_TOKEN m_Token;
+		SECURITY_TOKEN m_ResponseToken;
+		CNetPacketConstruct m_Packet;
+	};
+
+	class CSendPacket
+	{
+	public:
+		enum EType
+		{
+			TYPE_PACKET, // connection-oriented packet, compressed by the send thread
+			TYPE_CONNLESS,
+			TYPE_CONNLESS7,
+		};
+
+		EType m_Type;
+		NETADDR m_Addr;
+		SECURITY_TOKEN m_SecurityToken; // token of 0.7 connless packets
+		SECURITY_TOKEN m_ResponseToken;
+		bool m_Sixup;
+		bool m_Extended;
+		unsigned char m_aExtra[NET_CONNLESS_EXTRA_SIZE];
+		CNetPacketConstruct m_Packet; // connless packets only use the chunk data
+	};
+
+	enum
+	{
+		QUEUE_SIZE = 512,
+	};
+
+private:
+	NETSOCKET m_Socket = nullptr;
+	void *m_pRecvThread = nullptr;
+	void *m_pSendThread = nullptr;
+	std::atomic<bool> m_Shutdown = false;
+
+	CSpscQueue<CRecvPacket, QUEUE_SIZE> m_RecvQueue;
+	bool m_RecvHeld = false;
+	std::mutex m_RecvMutex;
+	std::condition_variable m_RecvCondition;
+
+	CSpscQueue<CSendPacket, QUEUE_SIZE> m_SendQueue;
+	CSemaphore m_SendSemaphore;
+
+	static void RecvThread(void *pUser);
+	static void SendThread(void *pUser);
+	void RunRecv();
+	void RunSend();
+	void FlushSendQueue();
+	CSendPacket *SendBegin(CSendPacket::EType Type, const NETADDR *pAddr);
+	void SendEnd();
+
+public:
+	~CNetServerThread();
+
+	void Start(NETSOCKET Socket);
+	void Stop();
+
+	// game thread: releases the packet returned by the previous call and
+	// returns the next received packet, or nullptr if there is none
+	CRecvPacket *NextRecv();
+	// game thread: waits until a packet has been received or the timeout expired
+	bool WaitRecv(std::chrono::nanoseconds Timeout);
+	// game thread: queue packets for the send thread, wait while the queue is full
+	void SendPacket(const NETADDR *pAddr, const CNetPacketConstruct *pPacket, SECURITY_TOKEN SecurityToken, bool Sixup);
+	void SendControlMsg(const NETADDR *pAddr, int Ack, int ControlMsg, const void *pExtra, int ExtraSize, SECURITY_TOKEN SecurityToken, bool Sixup);
+	void SendPacketConnless(const NETADDR *pAddr, const void *pData, int DataSize, bool Extended, const unsigned char aExtra[NET_CONNLESS_EXTRA_SIZE]);
+	void SendPacketConnlessWithToken7(const NETADDR *pAddr, const void *pData, int DataSize, SECURITY_TOKEN Token, SECURITY_TOKEN ResponseToken);
+};
+
 // server side
 class CNetServer
 {
@@ -430,6 +535,7 @@ class CNetServer
 	CSpamConn m_aSpamConns[NET_CONNLIMIT_IPS];
 
 	CNetRecvUnpacker m_RecvUnpacker;
+	std::unique_ptr<CNetServerThread> m_pThread;
 
 	void OnTokenCtrlMsg(NETADDR &Addr, int ControlMsg, const CNetPacketConstruct &Packet);
 	int OnSixupCtrlMsg(NETADDR &Addr, CNetChunk *pChunk, int ControlMsg, const CNetPacketConstruct &Packet, SECURITY_TOKEN &ResponseToken, SECURITY_TOKEN Token);
@@ -437,7 +543,7 @@ class CNetServer
 	void OnConnCtrlMsg(NETADDR &Addr, int ClientId, int ControlMsg, const CNetPacketConstruct &Packet);
 	bool ClientExists(const NETADDR &Addr) { return GetClientSlot(Addr) != -1; }
 	int GetClientSlot(const NETADDR &Addr);
-	void SendControl(NETADDR &Addr, int ControlMsg, const void *pExtra, int ExtraSize, SECURITY_TOKEN SecurityToken);
+	void SendControl(NETADDR &Addr, int ControlMsg, const void *pExtra, int ExtraSize, SECURITY_TOKEN SecurityToken, bool Sixup = false);
 
 	int TryAcceptClient(NETADDR &Addr, SECURITY_TOKEN SecurityToken, bool VanillaAuth = false, bool Sixup = false, SECURITY_TOKEN Token = 0);
 	int NumClientsWithAddr(NETADDR Addr);
@@ -455,7 +561,12 @@ public:
 	//
 	int Recv(CNetChunk *pChunk, SECURITY_TOKEN *pResponseToken);
 	int Send(CNetChunk *pChunk);
+	void SendPacketConnlessWithToken7(NETADDR *pAddr, const void *pData, int DataSize, SECURITY_TOKEN Token, SECURITY_TOKEN ResponseToken);
 	void Update();
+	bool Wait(std::chrono::nanoseconds Timeout);
+
+	// moves receiving and sending of packets to separate threads
+	void StartThread();
 
 	//
 	void Drop(int ClientId, const char *pReason);
@@ -618,6 +729,7 @@ public:
 
 	static bool IsValidConnectionOrientedPacket(const CNetPacketConstruct *pPacket);
 
+	static void ConstructControlMsg(CNetPacketConstruct *pPacket, int Ack, int ControlMsg, const void *pExtra, int ExtraSize);
 	static void SendControlMsg(NETSOCKET Socket, NETADDR *pAddr, int Ack, int ControlMsg, const void *pExtra, int ExtraSize, SECURITY_TOKEN SecurityToken, bool Sixup = false);
 	static void SendControlMsgWithToken7(NETSOCKET Socket, NETADDR *pAddr, TOKEN Token, int Ack, int ControlMsg, TOKEN MyToken, bool Extended);
 	static void SendPacketConnless(NETSOCKET Socket, NETADDR *pAddr, const void *pData, int DataSize, bool Extended, unsigned char aExtra[NET_CONNLESS_EXTRA_SIZE]);
@@ -83,12 +83,34 @@ int CNetServer::SetCallbacks(NETFUNC_NEWCLIENT pfnNewClient, NETFUNC_NEWCLIENT_N
 	return 0;
 }
 
+void CNetServer::StartThread()
+{
+	dbg_assert(m_Socket != nullptr && m_pThread == nullptr, "network thread started without socket or twice");
+	if(net_socket_type(m_Socket) & (NETTYPE_WEBSOCKET_IPV4 | NETTYPE_WEBSOCKET_IPV6))
+	{
+		// the websocket implementation must only be used from one thread
+		dbg_msg("netserver", "not using network threads, because the server accepts websocket connections");
+		return;
+	}
+	m_pThread = std::make_unique<CNetServerThread>();
+	m_pThread->Start(m_Socket);
+	for(auto &Slot : m_aSlots)
+		Slot.m_Connection.SetServerThread(m_pThread.get());
+}
+
 void CNetServer::Close()
 {
 	if(!m_Socket)
 	{
 		return;
 	}
+	if(m_pThread)
+	{
+		for(auto &Slot : m_aSlots)
+			Slot.m_Connection.SetServerThread(nullptr);
+		m_pThread->Stop();
+		m_pThread = nullptr;
+	}
 	net_udp_close(m_Socket);
 	m_Socket = nullptr;
 }
@@ -144,9 +166,12 @@ SECURITY_TOKEN CNetServer::GetVanillaToken(const NETADDR &Addr)
 	return absolute(GetToken(Addr));
 }
 
-void CNetServer::SendControl(NETADDR &Addr, int ControlMsg, const void *pExtra, int ExtraSize, SECURITY_TOKEN SecurityToken)
+void CNetServer::SendControl(NETADDR &Addr, int ControlMsg, const void *pExtra, int ExtraSize, SECURITY_TOKEN SecurityToken, bool Sixup)
 {
-	CNetBase::SendControlMsg(m_Socket, &Addr, 0, ControlMsg, pExtra, ExtraSize, SecurityToken);
+	if(m_pThread)
+		m_pThread->SendControlMsg(&Addr, 0, ControlMsg, pExtra, ExtraSize, SecurityToken, Sixup);
+	else
+		CNetBase::SendControlMsg(m_Socket, &Addr, 0, ControlMsg, pExtra, ExtraSize, SecurityToken, Sixup);
 }
 
 int CNetServer::NumClientsWithAddr(NETADDR Addr)
@@ -205,14 +230,14 @@ int CNetServer::TryAcceptClient(NETADDR &Addr, SECURITY_TOKEN SecurityToken, boo
 	if(Sixup && !g_Config.m_SvSixup)
 	{
 		const char aMsg[] = "0.7 connections are not accepted at this time";
-		CNetBase::SendControlMsg(m_Socket, &Addr, 0, NET_CTRLMSG_CLOSE, aMsg, sizeof(aMsg), SecurityToken, Sixup);
+		SendControl(Addr, NET_CTRLMSG_CLOSE, aMsg, sizeof(aMsg), SecurityToken, Sixup);
 		return -1; // failed to add client?
 	}
 
 	if(Connlimit(Addr))
 	{
 		const char aMsg[] = "Too many connections in a short time";
-		CNetBase::SendControlMsg(m_Socket, &Addr, 0, NET_CTRLMSG_CLOSE, aMsg, sizeof(aMsg), SecurityToken, Sixup);
+		SendControl(Addr, NET_CTRLMSG_CLOSE, aMsg, sizeof(aMsg), SecurityToken, Sixup);
 		return -1; // failed to add client
 	}
 
@@ -221,7 +246,7 @@ int CNetServer::TryAcceptClient(NETADDR &Addr, SECURITY_TOKEN SecurityToken, boo
 	{
 		char aBuf[128];
 		str_format(aBuf, sizeof(aBuf), "Only %d players with the same IP are allowed", m_MaxClientsPerIp);
-		CNetBase::SendControlMsg(m_Socket, &Addr, 0, NET_CTRLMSG_CLOSE, aBuf, str_length(aBuf) + 1, SecurityToken, Sixup);
+		SendControl(Addr, NET_CTRLMSG_CLOSE, aBuf, str_length(aBuf) + 1, SecurityToken, Sixup);
 		return -1; // failed to add client
 	}
 
@@ -238,7 +263,7 @@ int CNetServer::TryAcceptClient(NETADDR &Addr, SECURITY_TOKEN SecurityToken, boo
 	if(Slot == -1)
 	{
 		const char aFullMsg[] = "This server is full";
-		CNetBase::SendControlMsg(m_Socket, &Addr, 0, NET_CTRLMSG_CLOSE, aFullMsg, sizeof(aFullMsg), SecurityToken, Sixup);
+		SendControl(Addr, NET_CTRLMSG_CLOSE, aFullMsg, sizeof(aFullMsg), SecurityToken, Sixup);
 
 		return -1; // failed to add client
 	}
@@ -290,7 +315,10 @@ void CNetServer::SendMsgs(NETADDR &Addr, const CPacker **ppMsgs, int Num)
 	}
 
 	Construct.m_DataSize = (int)(pChunkData - Construct.m_aChunkData);
-	CNetBase::SendPacket(m_Socket, &Addr, &Construct, NET_SECURITY_TOKEN_UNSUPPORTED);
+	if(m_pThread)
+		m_pThread->SendPacket(&Addr, &Construct, NET_SECURITY_TOKEN_UNSUPPORTED, false);
+	else
+		CNetBase::SendPacket(m_Socket, &Addr, &Construct, NET_SECURITY_TOKEN_UNSUPPORTED);
 }
 
 // connection-less msg packet without token-support
@@ -538,7 +566,7 @@ int CNetServer::OnSixupCtrlMsg(NETADDR &Addr, CNetChunk *pChunk, int ControlMsg,
 		unsigned char aToken[sizeof(SECURITY_TOKEN)];
 		mem_copy(aToken, &MyToken, sizeof(aToken));
 
-		CNetBase::SendControlMsg(m_Socket, &Addr, 0, NET_CTRLMSG_CONNECTACCEPT, aToken, sizeof(aToken), ResponseToken, true);
+		SendControl(Addr, NET_CTRLMSG_CONNECTACCEPT, aToken, sizeof(aToken), ResponseToken, true);
 		if(Token == MyToken)
 			TryAcceptClient(Addr, ResponseToken, false, true, Token);
 	}
@@ -594,7 +622,21 @@ int CNetServer::Recv(CNetChunk *pChunk, SECURITY_TOKEN *pResponseToken)
 
 		// TODO: empty the recvinfo
 		unsigned char *pData;
-		int Bytes = net_udp_recv(m_Socket, &Addr, &pData);
+		int Bytes;
+		CNetServerThread::CRecvPacket *pRecvPacket = nullptr;
+		if(m_pThread)
+		{
+			pRecvPacket = m_pThread->NextRecv();
+			if(pRecvPacket == nullptr)
+				break;
+			Addr = pRecvPacket->m_Addr;
+			pData = pRecvPacket->m_aData;
+			Bytes = pRecvPacket->m_Size;
+		}
+		else
+		{
+			Bytes = net_udp_recv(m_Socket, &Addr, &pData);
+		}
 
 		// no more packets for now
 		if(Bytes <= 0)
@@ -605,7 +647,7 @@ int CNetServer::Recv(CNetChunk *pChunk, SECURITY_TOKEN *pResponseToken)
 		if(NetBan() && NetBan()->IsBanned(&Addr, aBuf, sizeof(aBuf)))
 		{
 			// banned, reply with a message
-			CNetBase::SendControlMsg(m_Socket, &Addr, 0, NET_CTRLMSG_CLOSE, aBuf, str_length(aBuf) + 1, NET_SECURITY_TOKEN_UNSUPPORTED);
+			SendControl(Addr, NET_CTRLMSG_CLOSE, aBuf, str_length(aBuf) + 1, NET_SECURITY_TOKEN_UNSUPPORTED);
 			continue;
 		}
 
@@ -620,7 +662,23 @@ int CNetServer::Recv(CNetChunk *pChunk, SECURITY_TOKEN *pResponseToken)
 		SECURITY_TOKEN Token;
 		int Slot = (*Flags & NET_PACKETFLAG_CONNLESS) == 0 ? GetClientSlot(Addr) : -1;
 		bool Sixup = Slot != -1 && m_aSlots[Slot].m_Connection.m_Sixup;
-		if(CNetBase::UnpackPacket(pData, Bytes, &m_RecvUnpacker.m_Data, Sixup, &Token, pResponseToken) == 0)
+		int Result;
+		if(pRecvPacket != nullptr && !Sixup)
+		{
+			// already decoded by the network thread
+			Result = pRecvPacket->m_Result;
+			Sixup = pRecvPacket->m_Sixup;
+			Token = pRecvPacket->m_Token;
+			if(pRecvPacket->m_ResponseToken != NET_SECURITY_TOKEN_UNKNOWN)
+				*pResponseToken = pRecvPacket->m_ResponseToken;
+			if(Result == 0)
+				m_RecvUnpacker.m_Data = pRecvPacket->m_Packet;
+		}
+		else
+		{
+			Result = CNetBase::UnpackPacket(pData, Bytes, &m_RecvUnpacker.m_Data, Sixup, &Token, pResponseToken);
+		}
+		if(Result == 0)
 		{
 			if(m_RecvUnpacker.m_Data.m_Flags & NET_PACKETFLAG_CONNLESS)
 			{
@@ -678,6 +736,13 @@ int CNetServer::Recv(CNetChunk *pChunk, SECURITY_TOKEN *pResponseToken)
 	return 0;
 }
 
+bool CNetServer::Wait(std::chrono::nanoseconds Timeout)
+{
+	if(m_pThread)
+		return m_pThread->WaitRecv(Timeout);
+	return net_socket_read_wait(m_Socket, Timeout);
+}
+
 int CNetServer::Send(CNetChunk *pChunk)
 {
 	if(pChunk->m_DataSize >= NET_MAX_PAYLOAD)
@@ -689,8 +754,12 @@ int CNetServer::Send(CNetChunk *pChunk)
 	if(pChunk->m_Flags & NETSENDFLAG_CONNLESS)
 	{
 		// send connectionless packet
-		CNetBase::SendPacketConnless(m_Socket, &pChunk->m_Address, pChunk->m_pData, pChunk->m_DataSize,
-			pChunk->m_Flags & NETSENDFLAG_EXTENDED, pChunk->m_aExtraData);
+		if(m_pThread)
+			m_pThread->SendPacketConnless(&pChunk->m_Address, pChunk->m_pData, pChunk->m_DataSize,
+				pChunk->m_Flags & NETSENDFLAG_EXTENDED, pChunk->m_aExtraData);
+		else
+			CNetBase::SendPacketConnless(m_Socket, &pChunk->m_Address, pChunk->m_pData, pChunk->m_DataSize,
+				pChunk->m_Flags & NETSENDFLAG_EXTENDED, pChunk->m_aExtraData);
 	}
 	else
 	{
@@ -716,12 +785,20 @@ int CNetServer::Send(CNetChunk *pChunk)
 	return 0;
 }
 
+void CNetServer::SendPacketConnlessWithToken7(NETADDR *pAddr, const void *pData, int DataSize, SECURITY_TOKEN Token, SECURITY_TOKEN ResponseToken)
+{
+	if(m_pThread)
+		m_pThread->SendPacketConnlessWithToken7(pAddr, pData, DataSize, Token, ResponseToken);
+	else
+		CNetBase::SendPacketConnlessWithToken7(m_Socket, pAddr, pData, DataSize, Token, ResponseToken);
+}
+
 void CNetServer::SendTokenSixup(NETADDR &Addr, SECURITY_TOKEN Token)
 {
 	unsigned char aRequestTokenBuf[NET_TOKENREQUEST_DATASIZE] = {};
 	WriteSecurityToken(aRequestTokenBuf, GetToken(Addr));
 	const int Size = Token == NET_SECURITY_TOKEN_UNKNOWN ? sizeof(aRequestTokenBuf) : sizeof(SECURITY_TOKEN);
-	CNetBase::SendControlMsg(m_Socket, &Addr, 0, protocol7::NET_CTRLMSG_TOKEN, aRequestTokenBuf, Size, Token, true);
+	SendControl(Addr, protocol7::NET_CTRLMSG_TOKEN, aRequestTokenBuf, Size, Token, true);
 }
 
 void CNetServer::SetMaxClientsPerIp(int Max)
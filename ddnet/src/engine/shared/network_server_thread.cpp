@@ -0,0 +1,217 @@
+#include <base/system.h>
+
+#include "network.h"
+
+#include <thread>
+
+CNetServerThread::~CNetServerThread()
+{
+	Stop();
+}
+
+void CNetServerThread::Start(NETSOCKET Socket)
+{
+	dbg_assert(m_pRecvThread == nullptr, "network threads already started");
+	m_Socket = Socket;
+	m_Shutdown.store(false);
+	m_pRecvThread = thread_init(RecvThread, this, "net recv");
+	m_pSendThread = thread_init(SendThread, this, "net send");
+}
+
+void CNetServerThread::Stop()
+{
+	if(m_pRecvThread == nullptr)
+		return;
+
+	m_Shutdown.store(true);
+	m_SendSemaphore.Signal();
+	thread_wait(m_pRecvThread);
+	thread_wait(m_pSendThread);
+	m_pRecvThread = nullptr;
+	m_pSendThread = nullptr;
+
+	// send what the game thread queued last, e.g. the disconnect messages
+	FlushSendQueue();
+}
+
+void CNetServerThread::RecvThread(void *pUser)
+{
+	static_cast<CNetServerThread *>(pUser)->RunRecv();
+}
+
+void CNetServerThread::SendThread(void *pUser)
+{
+	static_cast<CNetServerThread *>(pUser)->RunSend();
+}
+
+void CNetServerThread::RunRecv()
+{
+	while(!m_Shutdown.load())
+	{
+		int Received = 0;
+		while(true)
+		{
+			CRecvPacket *pPacket = m_RecvQueue.PushBegin();
+			if(pPacket == nullptr)
+				break;
+
+			unsigned char *pData;
+			const int Bytes = net_udp_recv(m_Socket, &pPacket->m_Addr, &pData);
+			if(Bytes <= 0)
+				break;
+			if(Bytes > (int)sizeof(pPacket->m_aData))
+				continue;
+
+			// keep the raw packet, the game thread checks bans and decodes 0.7 packets itself
+			pPacket->m_Size = Bytes;
+			mem_copy(pPacket->m_aData, pData, Bytes);
+
+			pPacket->m_Sixup = false;
+			pPacket->m_Token = NET_SECURITY_TOKEN_UNKNOWN;
+			pPacket->m_ResponseToken = NET_SECURITY_TOKEN_UNKNOWN;
+			pPacket->m_Result = CNetBase::UnpackPacket(pPacket->m_aData, Bytes, &pPacket->m_Packet, pPacket->m_Sixup, &pPacket->m_Token, &pPacket->m_ResponseToken);
+
+			m_RecvQueue.PushEnd();
+			Received++;
+		}
+
+		if(Received > 0)
+		{
+			// lock to not miss the game thread starting to wait
+			{
+				const std::unique_lock<std::mutex> Lock(m_RecvMutex);
+			}
+			m_RecvCondition.notify_one();
+		}
+
+		if(m_RecvQueue.PushBegin() == nullptr)
+		{
+			// the game thread is behind, let the socket buffer the packets meanwhile
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		else if(Received == 0)
+		{
+			net_socket_read_wait(m_Socket, std::chrono::milliseconds(100));
+		}
+	}
+
+	// wake up the game thread in case it is waiting
+	m_RecvCondition.notify_one();
+}
+
+void CNetServerThread::RunSend()
+{
+	while(true)
+	{
+		m_SendSemaphore.Wait();
+		if(m_Shutdown.load())
+			break;
+		FlushSendQueue();
+	}
+}
+
+void CNetServerThread::FlushSendQueue()
+{
+	while(CSendPacket *pPacket = m_SendQueue.Front())
+	{
+		switch(pPacket->m_Type)
+		{
+		case CSendPacket::TYPE_PACKET:
+			CNetBase::SendPacket(m_Socket, &pPacket->m_Addr, &pPacket->m_Packet, pPacket->m_SecurityToken, pPacket->m_Sixup);
+			break;
+		case CSendPacket::TYPE_CONNLESS:
+			CNetBase::SendPacketConnless(m_Socket, &pPacket->m_Addr, pPacket->m_Packet.m_aChunkData, pPacket->m_Packet.m_DataSize, pPacket->m_Extended, pPacket->m_aExtra);
+			break;
+		case CSendPacket::TYPE_CONNLESS7:
+			CNetBase::SendPacketConnlessWithToken7(m_Socket, &pPacket->m_Addr, pPacket->m_Packet.m_aChunkData, pPacket->m_Packet.m_DataSize, pPacket->m_SecurityToken, pPacket->m_ResponseToken);
+			break;
+		}
+		m_SendQueue.Pop();
+	}
+}
+
+CNetServerThread::CRecvPacket *CNetServerThread::NextRecv()
+{
+	if(m_RecvHeld)
+	{
+		m_RecvQueue.Pop();
+		m_RecvHeld = false;
+	}
+	CRecvPacket *pPacket = m_RecvQueue.Front();
+	m_RecvHeld = pPacket != nullptr;
+	return pPacket;
+}
+
+bool CNetServerThread::WaitRecv(std::chrono::nanoseconds Timeout)
+{
+	std::unique_lock<std::mutex> Lock(m_RecvMutex);
+	return m_RecvCondition.wait_for(Lock, Timeout, [this]() {
+		// the held packet was already handed out
+		return m_RecvQueue.Size() > (m_RecvHeld ? 1u : 0u) || m_Shutdown.load();
+	});
+}
+
+CNetServerThread::CSendPacket *CNetServerThread::SendBegin(CSendPacket::EType Type, const NETADDR *pAddr)
+{
+	// sending from the game thread instead would reorder the packets
+	CSendPacket *pSendPacket;
+	while((pSendPacket = m_SendQueue.PushBegin()) == nullptr)
+		std::this_thread::yield();
+
+	pSendPacket->m_Type = Type;
+	pSendPacket->m_Addr = *pAddr;
+	return pSendPacket;
+}
+
+void CNetServerThread::SendEnd()
+{
+	m_SendQueue.PushEnd();
+	m_SendSemaphore.Signal();
+}
+
+void CNetServerThread::SendPacket(const NETADDR *pAddr, const CNetPacketConstruct *pPacket, SECURITY_TOKEN SecurityToken, bool Sixup)
+{
+	CSendPacket *pSendPacket = SendBegin(CSendPacket::TYPE_PACKET, pAddr);
+	pSendPacket->m_SecurityToken = SecurityToken;
+	pSendPacket->m_Sixup = Sixup;
+	pSendPacket->m_Packet.m_Flags = pPacket->m_Flags;
+	pSendPacket->m_Packet.m_Ack = pPacket->m_Ack;
+	pSendPacket->m_Packet.m_NumChunks = pPacket->m_NumChunks;
+	pSendPacket->m_Packet.m_DataSize = pPacket->m_DataSize;
+	mem_copy(pSendPacket->m_Packet.m_aChunkData, pPacket->m_aChunkData, pPacket->m_DataSize);
+	SendEnd();
+}
+
+void CNetServerThread::SendControlMsg(const NETADDR *pAddr, int Ack, int ControlMsg, const void *pExtra, int ExtraSize, SECURITY_TOKEN SecurityToken, bool Sixup)
+{
+	CSendPacket *pSendPacket = SendBegin(CSendPacket::TYPE_PACKET, pAddr);
+	pSendPacket->m_SecurityToken = SecurityToken;
+	pSendPacket->m_Sixup = Sixup;
+	CNetBase::ConstructControlMsg(&pSendPacket->m_Packet, Ack, ControlMsg, pExtra, ExtraSize);
+	SendEnd();
+}
+
+void CNetServerThread::SendPacketConnless(const NETADDR *pAddr, const void *pData, int DataSize, bool Extended, const unsigned char aExtra[NET_CONNLESS_EXTRA_SIZE])
+{
+	dbg_assert(DataSize >= 0 && DataSize <= (int)sizeof(CNetPacketConstruct::m_aChunkData), "Invalid DataSize for CNetServerThread::SendPacketConnless: %d", DataSize);
+
+	CSendPacket *pSendPacket = SendBegin(CSendPacket::TYPE_CONNLESS, pAddr);
+	pSendPacket->m_Extended = Extended;
+	if(Extended)
+		mem_copy(pSendPacket->m_aExtra, aExtra, NET_CONNLESS_EXTRA_SIZE);
+	pSendPacket->m_Packet.m_DataSize = DataSize;
+	mem_copy(pSendPacket->m_Packet.m_aChunkData, pData, DataSize);
+	SendEnd();
+}
+
+void CNetServerThread::SendPacketConnlessWithToken7(const NETADDR *pAddr, const void *pData, int DataSize, SECURITY_TOKEN Token, SECURITY_TOKEN ResponseToken)
+{
+	dbg_assert(DataSize >= 0 && DataSize <= (int)sizeof(CNetPacketConstruct::m_aChunkData), "Invalid DataSize for CNetServerThread::SendPacketConnlessWithToken7: %d", DataSize);
+
+	CSendPacket *pSendPacket = SendBegin(CSendPacket::TYPE_CONNLESS7, pAddr);
+	pSendPacket->m_SecurityToken = Token;
+	pSendPacket->m_ResponseToken = ResponseToken;
+	pSendPacket->m_Packet.m_DataSize = DataSize;
+	mem_copy(pSendPacket->m_Packet.m_aChunkData, pData, DataSize);
+	SendEnd();
+}
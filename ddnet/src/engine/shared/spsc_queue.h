@@ -0,0 +1,59 @@
+#ifndef ENGINE_SHARED_SPSC_QUEUE_H
+#define ENGINE_SHARED_SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+
+// Bounded lock-free queue for exactly one producer and one consumer thread.
+//
+// Items are constructed once and reused, the producer fills the item returned
+// by PushBegin in place and publishes it with PushEnd, the consumer reads the
+// item returned by Front and releases it with Pop. This avoids copying large
+// items like network packets twice.
+template<typename T, size_t Capacity>
+class CSpscQueue
+{
+	static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+	// keep the indices on separate cache lines, they are written by different threads
+	alignas(64) std::atomic<size_t> m_Head{0}; // next item to consume
+	alignas(64) std::atomic<size_t> m_Tail{0}; // next item to produce
+	alignas(64) T m_aItems[Capacity];
+
+public:
+	// Producer: returns the item to fill, or nullptr if the queue is full
+	T *PushBegin()
+	{
+		const size_t Tail = m_Tail.load(std::memory_order_relaxed);
+		if(Tail - m_Head.load(std::memory_order_acquire) == Capacity)
+			return nullptr;
+		return &m_aItems[Tail % Capacity];
+	}
+
+	// Producer: publishes the item returned by PushBegin
+	void PushEnd()
+	{
+		m_Tail.store(m_Tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	// Consumer: returns the oldest item, or nullptr if the queue is empty
+	T *Front()
+	{
+		const size_t Head = m_Head.load(std::memory_order_relaxed);
+		if(Head == m_Tail.load(std::memory_order_acquire))
+			return nullptr;
+		return &m_aItems[Head % Capacity];
+	}
+
+	// Consumer: releases the item returned by Front
+	void Pop()
+	{
+		m_Head.store(m_Head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	// Approximate when called concurrently to the other thread
+	bool Empty() const { return m_Head.load(std::memory_order_acquire) == m_Tail.load(std::memory_order_acquire); }
+	size_t Size() const { return m_Tail.load(std::memory_order_acquire) - m_Head.load(std::memory_order_acquire); }
+};
+
+#endif
@@ -372,12 +372,28 @@ public:
 	virtual void OnWindowResize() = 0;
 };
 
+struct STextRenderStats
+{
+	// glyphs that were not in the atlas when they were requested during the last frame
+	int m_GlyphCacheMisses = 0;
+	// glyphs that are queued or being rasterized
+	int m_PendingGlyphs = 0;
+	// layouts of measured text that were reused or calculated during the last frame
+	int m_LayoutCacheHits = 0;
+	int m_LayoutCacheMisses = 0;
+};
+
 class IEngineTextRender : public ITextRender
 {
 	MACRO_INTERFACE("enginetextrender")
 public:
 	virtual void Init() = 0;
 	void Shutdown() override = 0;
+
+	// Uploads glyphs rasterized in the background, continues prewarming and
+	// starts the statistics of the next frame, called once per frame
+	virtual void Update() = 0;
+	virtual STextRenderStats Stats() const = 0;
 };
 
 extern IEngineTextRender *CreateEngineTextRender();
@@ -78,6 +78,9 @@ void CDebugHud::RenderNetCorrections()
 	str_format(aBuf, sizeof(aBuf), "%d", GameClient()->NetobjNumCorrections());
 	RenderRow("Netobj corrections", aBuf);
 	RenderRow(" on:", GameClient()->NetobjCorrectedOn());
+
+	str_format(aBuf, sizeof(aBuf), "%d", GameClient()->PredictionResimulatedTicksPerSecond());
+	RenderRow("Resimulated ticks/s:", aBuf);
 }
 
 void CDebugHud::RenderTuning()
@@ -4,6 +4,8 @@
 
 #include <base/log.h>
 
+#include <engine/engine.h>
+#include <engine/gfx/image_manipulation.h>
 #include <engine/graphics.h>
 #include <engine/map.h>
 #include <engine/storage.h>
@@ -15,6 +17,48 @@
 #include <game/localization.h>
 #include <game/mapitems.h>
 
+CMapImages::CMapImageLoadJob::CMapImageLoadJob(IGraphics *pGraphics, const char *pPath) :
+	m_pGraphics(pGraphics)
+{
+	str_copy(m_aPath, pPath);
+}
+
+CMapImages::CMapImageLoadJob::CMapImageLoadJob(IGraphics *pGraphics, const CImageInfo &EmbeddedImage) :
+	m_pGraphics(pGraphics)
+{
+	m_aPath[0] = '\0';
+	m_EmbeddedImage.m_Width = EmbeddedImage.m_Width;
+	m_EmbeddedImage.m_Height = EmbeddedImage.m_Height;
+	m_EmbeddedImage.m_Format = EmbeddedImage.m_Format;
+	m_EmbeddedImage.m_pData = EmbeddedImage.m_pData;
+}
+
+CMapImages::CMapImageLoadJob::~CMapImageLoadJob()
+{
+	m_Image.Free();
+}
+
+void CMapImages::CMapImageLoadJob::Run()
+{
+	const int64_t StartTime = time_get();
+	if(m_aPath[0] != '\0')
+	{
+		m_Success = m_pGraphics->LoadPng(m_Image, m_aPath, IStorage::TYPE_ALL);
+		if(m_Success && !ConvertToRgba(m_Image))
+			dbg_msg("mapimages", "converted image '%s' to RGBA, consider making its file format RGBA", m_aPath);
+	}
+	else
+	{
+		// the embedded data is owned by the map, so it's copied to be moved to the graphics later
+		m_Image.m_Width = m_EmbeddedImage.m_Width;
+		m_Image.m_Height = m_EmbeddedImage.m_Height;
+		m_Image.m_Format = CImageInfo::FORMAT_RGBA;
+		ConvertToRgbaAlloc(m_Image.m_pData, m_EmbeddedImage);
+		m_Success = true;
+	}
+	m_Duration = time_get() - StartTime;
+}
+
 CMapImages::CMapImages()
 {
 	m_Count = 0;
@@ -52,6 +96,13 @@ void CMapImages::Unload()
 
 void CMapImages::OnMapLoadImpl(class CLayers *pLayers, IMap *pMap)
 {
+	StartLoading(pLayers, pMap, false);
+	FinishLoading(pMap);
+}
+
+int CMapImages::StartLoading(class CLayers *pLayers, IMap *pMap, bool ReportProgress)
+{
+	dbg_assert(!m_Loading, "Map images are already loading");
 	Unload();
 
 	int Start;
@@ -96,8 +147,13 @@ void CMapImages::OnMapLoadImpl(class CLayers *pLayers, IMap *pMap)
 
 	const int TextureLoadFlag = Graphics()->Uses2DTextureArrays() ? IGraphics::TEXLOAD_TO_2D_ARRAY_TEXTURE : IGraphics::TEXLOAD_TO_3D_TEXTURE;
 
-	// load new textures
+	// read the image data and start decoding it on the job pool
+	m_Loading = true;
+	m_LoadingProgress = ReportProgress;
+	m_LoadingStart = Start;
+	m_LoadingStartTime = time_get();
 	bool ShowWarning = false;
+	int NumJobs = 0;
 	for(int i = 0; i < m_Count; i++)
 	{
 		if(aTextureUsedByTileOrQuadLayerFlag[i] == 0)
@@ -106,7 +162,7 @@ void CMapImages::OnMapLoadImpl(class CLayers *pLayers, IMap *pMap)
 			continue;
 		}
 
-		const int LoadFlag = (((aTextureUsedByTileOrQuadLayerFlag[i] & 1) != 0) ? TextureLoadFlag : 0) | (((aTextureUsedByTileOrQuadLayerFlag[i] & 2) != 0) ? 0 : (Graphics()->HasTextureArraysSupport() ? IGraphics::TEXLOAD_NO_2D_TEXTURE : 0));
+		m_aLoadingFlags[i] = (((aTextureUsedByTileOrQuadLayerFlag[i] & 1) != 0) ? TextureLoadFlag : 0) | (((aTextureUsedByTileOrQuadLayerFlag[i] & 2) != 0) ? 0 : (Graphics()->HasTextureArraysSupport() ? IGraphics::TEXLOAD_NO_2D_TEXTURE : 0));
 		const CMapItemImage_v2 *pImg = static_cast<const CMapItemImage_v2 *>(pMap->GetItem(Start + i));
 
 		const char *pName = pMap->GetDataString(pImg->m_ImageName);
@@ -130,7 +186,6 @@ void CMapImages::OnMapLoadImpl(class CLayers *pLayers, IMap *pMap)
 
 		if(pImg->m_External)
 		{
-			char aPath[IO_MAX_PATH_LENGTH];
 			bool Translated = false;
 			if(Client()->IsSixup())
 			{
@@ -140,8 +195,8 @@ void CMapImages::OnMapLoadImpl(class CLayers *pLayers, IMap *pMap)
 					!str_comp(pName, "winter_main") ||
 					!str_comp(pName, "generic_unhookable");
 			}
-			str_format(aPath, sizeof(aPath), "mapres/%s%s.png", pName, Translated ? "_0.7" : "");
-			m_aTextures[i] = Graphics()->LoadTexture(aPath, IStorage::TYPE_ALL, LoadFlag);
+			str_format(m_aaLoadingTexNames[i], sizeof(m_aaLoadingTexNames[i]), "mapres/%s%s.png", pName, Translated ? "_0.7" : "");
+			m_apLoadingJobs[i] = std::make_shared<CMapImageLoadJob>(Graphics(), m_aaLoadingTexNames[i]);
 		}
 		else
 		{
@@ -152,10 +207,8 @@ void CMapImages::OnMapLoadImpl(class CLayers *pLayers, IMap *pMap)
 			ImageInfo.m_pData = static_cast<uint8_t *>(pMap->GetData(pImg->m_ImageData));
 			if(ImageInfo.m_pData && (size_t)pMap->GetDataSize(pImg->m_ImageData) >= ImageInfo.DataSize())
 			{
-				char aTexName[IO_MAX_PATH_LENGTH];
-				str_format(aTexName, sizeof(aTexName), "embedded: %s", pName);
-				m_aTextures[i] = Graphics()->LoadTextureRaw(ImageInfo, LoadFlag, aTexName);
-				pMap->UnloadData(pImg->m_ImageData);
+				str_format(m_aaLoadingTexNames[i], sizeof(m_aaLoadingTexNames[i]), "embedded: %s", pName);
+				m_apLoadingJobs[i] = std::make_shared<CMapImageLoadJob>(Graphics(), ImageInfo);
 			}
 			else
 			{
@@ -165,9 +218,63 @@ void CMapImages::OnMapLoadImpl(class CLayers *pLayers, IMap *pMap)
 				continue;
 			}
 		}
+		Engine()->AddJob(m_apLoadingJobs[i]);
 		pMap->UnloadData(pImg->m_ImageName);
+		NumJobs++;
+	}
+	m_LoadingShowWarning = ShowWarning;
+	m_LoadingReadTime = time_get();
+	return NumJobs;
+}
+
+void CMapImages::FinishLoading(IMap *pMap)
+{
+	dbg_assert(m_Loading, "Map images are not loading");
+	m_Loading = false;
+
+	const char *pLoadingTitle = Localize("Loading map");
+	const char *pLoadingMessage = Localize("Uploading map images");
+	bool ShowWarning = m_LoadingShowWarning;
+	const int64_t FinishStartTime = time_get();
+
+	// upload the decoded images in order
+	int NumImages = 0;
+	int64_t DecodeDuration = 0;
+	int64_t WaitDuration = 0;
+	for(int i = 0; i < m_Count; i++)
+	{
+		if(!m_apLoadingJobs[i])
+			continue;
+
+		const int64_t WaitStart = time_get();
+		// the loading screen is only shown when loading the map of the server
+		GameClient()->m_Menus.WaitLoading(*m_apLoadingJobs[i], pLoadingTitle, pLoadingMessage, m_LoadingProgress);
+		WaitDuration += time_get() - WaitStart;
+		DecodeDuration += m_apLoadingJobs[i]->Duration();
+
+		const CMapItemImage_v2 *pImg = static_cast<const CMapItemImage_v2 *>(pMap->GetItem(m_LoadingStart + i));
+		if(!pImg->m_External)
+			pMap->UnloadData(pImg->m_ImageData);
+
+		if(m_apLoadingJobs[i]->Success())
+			m_aTextures[i] = Graphics()->LoadTextureRawMove(m_apLoadingJobs[i]->Image(), m_aLoadingFlags[i], m_aaLoadingTexNames[i]);
+		else
+		{
+			// the decoder already logged the reason
+			log_error("mapimages", "Failed to load map image %d '%s': failed to decode image.", i, m_aaLoadingTexNames[i]);
+			m_aTextures[i] = Graphics()->NullTexture();
+		}
+		m_apLoadingJobs[i] = nullptr;
 		ShowWarning = ShowWarning || m_aTextures[i].IsNullTexture();
+		NumImages++;
+		if(m_LoadingProgress)
+			GameClient()->m_Menus.RenderLoading(pLoadingTitle, pLoadingMessage, 1);
 	}
+	const int64_t EndTime = time_get();
+	log_debug("mapimages", "loaded %d images in %.2fms (reading %.2fms, decoding %.2fms in jobs, waiting %.2fms, uploading %.2fms)",
+		NumImages, (m_LoadingReadTime - m_LoadingStartTime + EndTime - FinishStartTime) * 1000.0f / (float)time_freq(), (m_LoadingReadTime - m_LoadingStartTime) * 1000.0f / (float)time_freq(),
+		DecodeDuration * 1000.0f / (float)time_freq(), WaitDuration * 1000.0f / (float)time_freq(), (EndTime - FinishStartTime - WaitDuration) * 1000.0f / (float)time_freq());
+
 	if(ShowWarning)
 	{
 		Client()->AddWarning(SWarning(Localize("Some map images could not be loaded. Check the local console for details.")));
@@ -178,7 +285,10 @@ void CMapImages::OnMapLoad()
 {
 	IMap *pMap = Kernel()->RequestInterface<IMap>();
 	CLayers *pLayers = GameClient()->Layers();
-	OnMapLoadImpl(pLayers, pMap);
+	// the images of the map of the server are usually already decoding since the start of loading the map
+	if(!m_Loading)
+		StartLoading(pLayers, pMap, false);
+	FinishLoading(pMap);
 }
 
 void CMapImages::LoadBackground(class CLayers *pLayers, class IMap *pMap)
@@ -5,6 +5,7 @@
 
 #include <engine/console.h>
 #include <engine/graphics.h>
+#include <engine/shared/jobs.h>
 
 #include <game/client/component.h>
 #include <game/mapitems.h>
@@ -58,6 +59,10 @@ public:
 	int Num() const { return m_Count; }
 
 	void OnMapLoadImpl(class CLayers *pLayers, class IMap *pMap);
+	// reads the images of the map and starts decoding them in jobs, returns the number of jobs
+	int StartLoading(class CLayers *pLayers, class IMap *pMap, bool ReportProgress);
+	// waits for the decoded images and uploads them, reporting one step of the loading progress per image if requested
+	void FinishLoading(class IMap *pMap);
 	void OnMapLoad() override;
 	void OnInit() override;
 	void Unload();
@@ -77,6 +82,40 @@ public:
 	void ChangeEntitiesPath(const char *pPath);
 
 private:
+	// decodes an external image or copies an embedded one into an owned RGBA buffer
+	class CMapImageLoadJob : public IJob
+	{
+		IGraphics *m_pGraphics;
+		char m_aPath[IO_MAX_PATH_LENGTH];
+		CImageInfo m_EmbeddedImage;
+		CImageInfo m_Image;
+		bool m_Success = false;
+		int64_t m_Duration = 0;
+
+	protected:
+		void Run() override;
+
+	public:
+		CMapImageLoadJob(IGraphics *pGraphics, const char *pPath);
+		CMapImageLoadJob(IGraphics *pGraphics, const CImageInfo &EmbeddedImage);
+		~CMapImageLoadJob();
+
+		CImageInfo &Image() { return m_Image; }
+		bool Success() const { return m_Success; }
+		int64_t Duration() const { return m_Duration; }
+	};
+
+	// images that are being decoded between StartLoading and FinishLoading
+	bool m_Loading = false;
+	bool m_LoadingProgress = false;
+	bool m_LoadingShowWarning = false;
+	int m_LoadingStart = 0;
+	int64_t m_LoadingStartTime = 0;
+	int64_t m_LoadingReadTime = 0;
+	std::shared_ptr<CMapImageLoadJob> m_apLoadingJobs[MAX_MAPIMAGES];
+	int m_aLoadingFlags[MAX_MAPIMAGES];
+	char m_aaLoadingTexNames[MAX_MAPIMAGES][IO_MAX_PATH_LENGTH];
+
 	bool m_aEntitiesIsLoaded[MAP_IMAGE_MOD_TYPE_COUNT * 2];
 	bool m_SpeedupArrowIsLoaded;
 	IGraphics::CTextureHandle m_aaEntitiesTextures[MAP_IMAGE_MOD_TYPE_COUNT * 2][MAP_IMAGE_ENTITY_LAYER_TYPE_COUNT];
@@ -1,5 +1,9 @@
 /* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
 /* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include <base/log.h>
+
+#include <engine/engine.h>
+
 #include <game/client/gameclient.h>
 #include <game/localization.h>
 
@@ -89,16 +93,55 @@ CCamera *CMapLayers::GetCurCamera()
 	return &GameClient()->m_Camera;
 }
 
+void CMapLayers::CTileVisualsJob::Run()
+{
+	const int64_t StartTime = time_get();
+	m_pLayer->GenerateVisuals();
+	m_Duration = time_get() - StartTime;
+}
+
 void CMapLayers::OnMapLoad()
 {
 	m_pEnvelopePoints = std::make_shared<CMapBasedEnvelopePointAccess>(m_pLayers->Map());
-	bool PassedGameLayer = false;
 	Unload();
 
 	const char *pLoadingTitle = Localize("Loading map");
 	const char *pLoadingMessage = Localize("Uploading map data to GPU");
 	GameClient()->m_Menus.RenderLoading(pLoadingTitle, pLoadingMessage, 0);
 
+	const int64_t StartTime = time_get();
+	std::vector<CRenderLayerTile *> vpTileLayers;
+	CreateRenderLayers(vpTileLayers);
+	const int64_t CreateTime = time_get();
+
+	// the vertex data of the tile layers is independent, so it's generated in jobs and uploaded in order
+	std::vector<std::shared_ptr<CTileVisualsJob>> vpJobs;
+	vpJobs.reserve(vpTileLayers.size());
+	for(CRenderLayerTile *pTileLayer : vpTileLayers)
+	{
+		vpJobs.push_back(std::make_shared<CTileVisualsJob>(pTileLayer));
+		Engine()->AddJob(vpJobs.back());
+	}
+
+	int64_t GenerateDuration = 0;
+	int64_t WaitDuration = 0;
+	for(size_t i = 0; i < vpJobs.size(); i++)
+	{
+		const int64_t WaitStart = time_get();
+		GameClient()->m_Menus.WaitLoading(*vpJobs[i], pLoadingTitle, pLoadingMessage);
+		WaitDuration += time_get() - WaitStart;
+		GenerateDuration += vpJobs[i]->Duration();
+		vpTileLayers[i]->UploadVisuals();
+	}
+	const int64_t EndTime = time_get();
+	log_debug("maplayers", "loaded %d tile layers in %.2fms (creating layers %.2fms, generating visuals %.2fms in jobs, waiting %.2fms, uploading %.2fms)",
+		(int)vpTileLayers.size(), (EndTime - StartTime) * 1000.0f / (float)time_freq(), (CreateTime - StartTime) * 1000.0f / (float)time_freq(),
+		GenerateDuration * 1000.0f / (float)time_freq(), WaitDuration * 1000.0f / (float)time_freq(), (EndTime - CreateTime - WaitDuration) * 1000.0f / (float)time_freq());
+}
+
+void CMapLayers::CreateRenderLayers(std::vector<CRenderLayerTile *> &vpTileLayers)
+{
+	bool PassedGameLayer = false;
 	for(int g = 0; g < m_pLayers->NumGroups(); g++)
 	{
 		CMapItemGroup *pGroup = m_pLayers->GetGroup(g);
@@ -211,6 +254,8 @@ void CMapLayers::OnMapLoad()
 				if(pRenderLayer->IsValid())
 				{
 					pRenderLayer->Init();
+					if(pLayer->m_Type == LAYERTYPE_TILES)
+						vpTileLayers.push_back(static_cast<CRenderLayerTile *>(pRenderLayer.get()));
 					m_vpRenderLayers.push_back(std::move(pRenderLayer));
 				}
 			}
@@ -2,6 +2,8 @@
 /* If you are missing that file, acquire a complete release at teeworlds.com.                */
 #ifndef GAME_CLIENT_COMPONENTS_MAPLAYERS_H
 #define GAME_CLIENT_COMPONENTS_MAPLAYERS_H
+#include <engine/shared/jobs.h>
+
 #include <game/client/component.h>
 #include <game/map/render_map.h>
 
@@ -63,7 +65,24 @@ public:
 	virtual CCamera *GetCurCamera();
 
 private:
+	// generates the vertex data of a tile layer
+	class CTileVisualsJob : public IJob
+	{
+		CRenderLayerTile *m_pLayer;
+		int64_t m_Duration = 0;
+
+	protected:
+		void Run() override;
+
+	public:
+		CTileVisualsJob(CRenderLayerTile *pLayer) :
+			m_pLayer(pLayer) {}
+
+		int64_t Duration() const { return m_Duration; }
+	};
+
 	std::vector<std::unique_ptr<CRenderLayer>> m_vpRenderLayers;
+	void CreateRenderLayers(std::vector<CRenderLayerTile *> &vpTileLayers);
 	int GetLayerType(const CMapItemLayer *pLayer) const;
 	CRenderLayerParams m_Params;
 };
@@ -3,6 +3,7 @@
 #include <base/log.h>
 
 #include <engine/demo.h>
+#include <engine/engine.h>
 #include <engine/sound.h>
 
 #include <game/client/components/camera.h>
@@ -12,6 +13,32 @@
 #include <game/localization.h>
 #include <game/mapitems.h>
 
+CMapSounds::CMapSoundLoadJob::CMapSoundLoadJob(ISound *pSound, const char *pPath) :
+	m_pSound(pSound),
+	m_pData(nullptr),
+	m_DataSize(0)
+{
+	str_copy(m_aPath, pPath);
+}
+
+CMapSounds::CMapSoundLoadJob::CMapSoundLoadJob(ISound *pSound, const void *pData, unsigned DataSize) :
+	m_pSound(pSound),
+	m_pData(pData),
+	m_DataSize(DataSize)
+{
+	m_aPath[0] = '\0';
+}
+
+void CMapSounds::CMapSoundLoadJob::Run()
+{
+	const int64_t StartTime = time_get();
+	if(m_aPath[0] != '\0')
+		m_SampleId = m_pSound->LoadOpus(m_aPath);
+	else
+		m_SampleId = m_pSound->LoadOpusFromMem(m_pData, m_DataSize);
+	m_Duration = time_get() - StartTime;
+}
+
 CMapSounds::CMapSounds()
 {
 	m_Count = 0;
@@ -33,25 +60,31 @@ void CMapSounds::PlayAt(int Channel, int SoundId, vec2 Position)
 	GameClient()->m_Sounds.PlaySampleAt(Channel, m_aSounds[SoundId], 0, 1.0f, Position);
 }
 
-void CMapSounds::OnMapLoad()
+int CMapSounds::StartLoading(bool ReportProgress)
 {
+	dbg_assert(!m_Loading, "Map sounds are already loading");
 	IMap *pMap = Kernel()->RequestInterface<IMap>();
 
 	Clear();
 
+	m_Loading = true;
+	m_LoadingProgress = ReportProgress;
+	m_LoadingShowWarning = false;
 	if(!Sound()->IsSoundEnabled())
-		return;
+		return 0;
 
 	// load samples
 	int Start;
 	pMap->GetType(MAPITEMTYPE_SOUND, &Start, &m_Count);
 
 	m_Count = std::clamp<int>(m_Count, 0, MAX_MAPSOUNDS);
+	m_LoadingStart = Start;
 
-	// load new samples
-	bool ShowWarning = false;
+	// start decoding the new samples on the job pool
+	int NumJobs = 0;
 	for(int i = 0; i < m_Count; i++)
 	{
+		m_aSounds[i] = -1;
 		CMapItemSound *pSound = (CMapItemSound *)pMap->GetItem(Start + i);
 		if(pSound->m_External)
 		{
@@ -59,29 +92,60 @@ void CMapSounds::OnMapLoad()
 			if(pName == nullptr || pName[0] == '\0')
 			{
 				log_error("mapsounds", "Failed to load map sound %d: failed to load name.", i);
-				ShowWarning = true;
+				m_LoadingShowWarning = true;
 				continue;
 			}
 
 			char aBuf[IO_MAX_PATH_LENGTH];
 			str_format(aBuf, sizeof(aBuf), "mapres/%s.opus", pName);
-			m_aSounds[i] = Sound()->LoadOpus(aBuf);
+			m_apLoadingJobs[i] = std::make_shared<CMapSoundLoadJob>(Sound(), aBuf);
 			pMap->UnloadData(pSound->m_SoundName);
 		}
 		else
 		{
+			// the data is unloaded when the job is done
 			const void *pData = pMap->GetData(pSound->m_SoundData);
 			if(pData == nullptr)
 			{
 				log_error("mapsounds", "Failed to load map sound %d: failed to load data.", i);
-				ShowWarning = true;
+				m_LoadingShowWarning = true;
 				continue;
 			}
 			const int SoundDataSize = pMap->GetDataSize(pSound->m_SoundData);
-			m_aSounds[i] = Sound()->LoadOpusFromMem(pData, SoundDataSize);
-			pMap->UnloadData(pSound->m_SoundData);
+			m_apLoadingJobs[i] = std::make_shared<CMapSoundLoadJob>(Sound(), pData, SoundDataSize);
 		}
+		Engine()->AddJob(m_apLoadingJobs[i]);
+		NumJobs++;
+	}
+	return NumJobs;
+}
+
+void CMapSounds::OnMapLoad()
+{
+	// the sounds of the map of the server are usually already decoding since the start of loading the map
+	if(!m_Loading)
+		StartLoading(false);
+	m_Loading = false;
+
+	IMap *pMap = Kernel()->RequestInterface<IMap>();
+	const char *pLoadingTitle = Localize("Loading map");
+	const char *pLoadingMessage = Localize("Loading map sounds");
+	bool ShowWarning = m_LoadingShowWarning;
+	for(int i = 0; i < m_Count; i++)
+	{
+		if(!m_apLoadingJobs[i])
+			continue;
+
+		GameClient()->m_Menus.WaitLoading(*m_apLoadingJobs[i], pLoadingTitle, pLoadingMessage, m_LoadingProgress);
+
+		const CMapItemSound *pSound = (CMapItemSound *)pMap->GetItem(m_LoadingStart + i);
+		if(!pSound->m_External)
+			pMap->UnloadData(pSound->m_SoundData);
+		m_aSounds[i] = m_apLoadingJobs[i]->SampleId();
+		m_apLoadingJobs[i] = nullptr;
 		ShowWarning = ShowWarning || m_aSounds[i] == -1;
+		if(m_LoadingProgress)
+			GameClient()->m_Menus.RenderLoading(pLoadingTitle, pLoadingMessage, 1);
 	}
 	if(ShowWarning)
 	{
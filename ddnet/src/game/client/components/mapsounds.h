@@ -1,11 +1,13 @@
 #ifndef GAME_CLIENT_COMPONENTS_MAPSOUNDS_H
 #define GAME_CLIENT_COMPONENTS_MAPSOUNDS_H
 
+#include <engine/shared/jobs.h>
 #include <engine/sound.h>
 
 #include <game/client/component.h>
 #include <game/mapitems.h>
 
+#include <memory>
 #include <vector>
 
 class CMapSounds : public CComponent
@@ -25,6 +27,34 @@ class CMapSounds : public CComponent
 	std::vector<CSourceQueueEntry> m_vSourceQueue;
 	void Clear();
 
+	// decodes a map sound from its file or the map data into a sample
+	class CMapSoundLoadJob : public IJob
+	{
+		ISound *m_pSound;
+		char m_aPath[IO_MAX_PATH_LENGTH];
+		const void *m_pData;
+		unsigned m_DataSize;
+		int m_SampleId = -1;
+		int64_t m_Duration = 0;
+
+	protected:
+		void Run() override;
+
+	public:
+		CMapSoundLoadJob(ISound *pSound, const char *pPath);
+		CMapSoundLoadJob(ISound *pSound, const void *pData, unsigned DataSize);
+
+		int SampleId() const { return m_SampleId; }
+		int64_t Duration() const { return m_Duration; }
+	};
+
+	// sounds that are being decoded between StartLoading and OnMapLoad
+	bool m_Loading = false;
+	bool m_LoadingProgress = false;
+	bool m_LoadingShowWarning = false;
+	int m_LoadingStart = 0;
+	std::shared_ptr<CMapSoundLoadJob> m_apLoadingJobs[MAX_MAPSOUNDS];
+
 public:
 	CMapSounds();
 	int Sizeof() const override { return sizeof(*this); }
@@ -32,6 +62,9 @@ public:
 	void Play(int Channel, int SoundId);
 	void PlayAt(int Channel, int SoundId, vec2 Position);
 
+	// starts decoding the sounds of the map in jobs, returns the number of jobs
+	int StartLoading(bool ReportProgress);
+	// waits for the decoded sounds, reporting one step of the loading progress per sound if requested
 	void OnMapLoad() override;
 	void OnRender() override;
 	void OnStateChange(int NewState, int OldState) override;
@@ -4,6 +4,7 @@
 #include <algorithm>
 #include <chrono>
 #include <cmath>
+#include <thread>
 #include <vector>
 
 #include <base/log.h>
@@ -840,6 +841,22 @@ void CMenus::RenderLoading(const char *pCaption, const char *pContent, int Incre
 	Client()->UpdateAndSwap();
 }
 
+void CMenus::WaitLoading(const IJob &Job, const char *pCaption, const char *pContent, bool ShowLoading)
+{
+	while(!Job.Done())
+	{
+		if(ShowLoading)
+			RenderLoading(pCaption, pContent, 0);
+		std::this_thread::sleep_for(10us);
+	}
+}
+
+void CMenus::StartLoading(int Total)
+{
+	m_LoadingState.m_Current = 0;
+	m_LoadingState.m_Total = Total;
+}
+
 void CMenus::FinishLoading()
 {
 	m_LoadingState.m_Current = 0;
@@ -16,6 +16,7 @@
 #include <engine/friends.h>
 #include <engine/serverbrowser.h>
 #include <engine/shared/config.h>
+#include <engine/shared/jobs.h>
 #include <engine/textrender.h>
 
 #include <game/client/component.h>
@@ -618,6 +619,9 @@ public:
 	int Sizeof() const override { return sizeof(*this); }
 
 	void RenderLoading(const char *pCaption, const char *pContent, int IncreaseCounter);
+	// blocks until the job is done, keeping the loading screen updated meanwhile if requested
+	void WaitLoading(const IJob &Job, const char *pCaption, const char *pContent, bool ShowLoading = true);
+	void StartLoading(int Total);
 	void FinishLoading();
 
 	bool IsInit() const { return m_IsInit; }
@@ -562,10 +562,20 @@ void CRenderLayerTile::Init()
 		m_TextureHandle = m_pMapImages->Get(m_pLayerTilemap->m_Image);
 	else
 		m_TextureHandle.Invalidate();
-	UploadTileData(m_VisualTiles, 0, false);
+	m_TexturedVisuals = GetTexture().IsValid();
 }
 
-void CRenderLayerTile::UploadTileData(std::optional<CTileLayerVisuals> &VisualsOptional, int CurOverlay, bool AddAsSpeedup, bool IsGameLayer)
+void CRenderLayerTile::GenerateVisuals()
+{
+	GenerateTileData(m_VisualTiles, 0, false);
+}
+
+void CRenderLayerTile::UploadVisuals()
+{
+	UploadTileData(m_VisualTiles);
+}
+
+void CRenderLayerTile::GenerateTileData(std::optional<CTileLayerVisuals> &VisualsOptional, int CurOverlay, bool AddAsSpeedup, bool IsGameLayer)
 {
 	if(!Graphics()->IsTileBufferingEnabled())
 		return;
@@ -584,7 +594,7 @@ void CRenderLayerTile::UploadTileData(std::optional<CTileLayerVisuals> &VisualsO
 	std::vector<SGraphicTile> vTmpBorderCorners;
 	std::vector<SGraphicTileTexureCoords> vTmpBorderCornersTexCoords;
 
-	const bool DoTextureCoords = GetTexture().IsValid();
+	const bool DoTextureCoords = m_TexturedVisuals;
 
 	// create the visual and set it in the optional, afterwards get it
 	CTileLayerVisuals v;
@@ -765,8 +775,25 @@ void CRenderLayerTile::UploadTileData(std::optional<CTileLayerVisuals> &VisualsO
 			mem_copy_special(pUploadData + sizeof(vec2), pTmpTileTexCoords, sizeof(ubvec4), vTmpTiles.size() * 4, sizeof(vec2));
 		}
 
-		// first create the buffer object
-		int BufferObjectIndex = Graphics()->CreateBufferObject(UploadDataSize, pUploadData, 0, true);
+		Visuals.m_pUploadData = pUploadData;
+		Visuals.m_UploadDataSize = UploadDataSize;
+		Visuals.m_UploadTileCount = vTmpTiles.size();
+	}
+}
+
+void CRenderLayerTile::UploadTileData(std::optional<CTileLayerVisuals> &VisualsOptional)
+{
+	if(!VisualsOptional.has_value())
+		return;
+
+	CTileLayerVisuals &Visuals = VisualsOptional.value();
+	if(Visuals.m_pUploadData != nullptr)
+	{
+		const bool DoTextureCoords = Visuals.m_IsTextured;
+
+		// first create the buffer object, it takes the ownership of the data
+		int BufferObjectIndex = Graphics()->CreateBufferObject(Visuals.m_UploadDataSize, Visuals.m_pUploadData, 0, true);
+		Visuals.m_pUploadData = nullptr;
 
 		// then create the buffer container
 		SBufferContainerInfo ContainerInfo;
@@ -792,7 +819,7 @@ void CRenderLayerTile::UploadTileData(std::optional<CTileLayerVisuals> &VisualsO
 
 		Visuals.m_BufferContainerIndex = Graphics()->CreateBufferContainer(&ContainerInfo);
 		// and finally inform the backend how many indices are required
-		Graphics()->IndicesNumRequiredNotify(vTmpTiles.size() * 6);
+		Graphics()->IndicesNumRequiredNotify(Visuals.m_UploadTileCount * 6);
 	}
 	RenderLoading();
 }
@@ -809,6 +836,8 @@ void CRenderLayerTile::Unload()
 void CRenderLayerTile::CTileLayerVisuals::Unload()
 {
 	Graphics()->DeleteBufferContainer(m_BufferContainerIndex);
+	free(m_pUploadData);
+	m_pUploadData = nullptr;
 }
 
 int CRenderLayerTile::GetDataIndex(unsigned int &TileSize) const
@@ -1296,9 +1325,9 @@ IGraphics::CTextureHandle CRenderLayerEntityBase::GetTexture() const
 CRenderLayerEntityGame::CRenderLayerEntityGame(int GroupId, int LayerId, int Flags, CMapItemLayerTilemap *pLayerTilemap) :
 	CRenderLayerEntityBase(GroupId, LayerId, Flags, pLayerTilemap) {}
 
-void CRenderLayerEntityGame::Init()
+void CRenderLayerEntityGame::GenerateVisuals()
 {
-	UploadTileData(m_VisualTiles, 0, false, true);
+	GenerateTileData(m_VisualTiles, 0, false, true);
 }
 
 void CRenderLayerEntityGame::RenderTileLayerWithTileBuffer(const ColorRGBA &Color, const CRenderLayerParams &Params)
@@ -1354,10 +1383,16 @@ int CRenderLayerEntityTele::GetDataIndex(unsigned int &TileSize) const
 	return m_pLayerTilemap->m_Tele;
 }
 
-void CRenderLayerEntityTele::Init()
+void CRenderLayerEntityTele::GenerateVisuals()
+{
+	GenerateTileData(m_VisualTiles, 0, false);
+	GenerateTileData(m_VisualTeleNumbers, 1, false);
+}
+
+void CRenderLayerEntityTele::UploadVisuals()
 {
-	UploadTileData(m_VisualTiles, 0, false);
-	UploadTileData(m_VisualTeleNumbers, 1, false);
+	UploadTileData(m_VisualTiles);
+	UploadTileData(m_VisualTeleNumbers);
 }
 
 void CRenderLayerEntityTele::InitTileData()
@@ -1424,11 +1459,18 @@ int CRenderLayerEntitySpeedup::GetDataIndex(unsigned int &TileSize) const
 	return m_pLayerTilemap->m_Speedup;
 }
 
-void CRenderLayerEntitySpeedup::Init()
+void CRenderLayerEntitySpeedup::GenerateVisuals()
 {
-	UploadTileData(m_VisualTiles, 0, true);
-	UploadTileData(m_VisualForce, 1, false);
-	UploadTileData(m_VisualMaxSpeed, 2, false);
+	GenerateTileData(m_VisualTiles, 0, true);
+	GenerateTileData(m_VisualForce, 1, false);
+	GenerateTileData(m_VisualMaxSpeed, 2, false);
+}
+
+void CRenderLayerEntitySpeedup::UploadVisuals()
+{
+	UploadTileData(m_VisualTiles);
+	UploadTileData(m_VisualForce);
+	UploadTileData(m_VisualMaxSpeed);
 }
 
 void CRenderLayerEntitySpeedup::InitTileData()
@@ -1504,11 +1546,18 @@ int CRenderLayerEntitySwitch::GetDataIndex(unsigned int &TileSize) const
 	return m_pLayerTilemap->m_Switch;
 }
 
-void CRenderLayerEntitySwitch::Init()
+void CRenderLayerEntitySwitch::GenerateVisuals()
+{
+	GenerateTileData(m_VisualTiles, 0, false);
+	GenerateTileData(m_VisualSwitchNumberTop, 1, false);
+	GenerateTileData(m_VisualSwitchNumberBottom, 2, false);
+}
+
+void CRenderLayerEntitySwitch::UploadVisuals()
 {
-	UploadTileData(m_VisualTiles, 0, false);
-	UploadTileData(m_VisualSwitchNumberTop, 1, false);
-	UploadTileData(m_VisualSwitchNumberBottom, 2, false);
+	UploadTileData(m_VisualTiles);
+	UploadTileData(m_VisualSwitchNumberTop);
+	UploadTileData(m_VisualSwitchNumberBottom);
 }
 
 void CRenderLayerEntitySwitch::InitTileData()
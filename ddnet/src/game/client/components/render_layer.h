@@ -100,6 +100,10 @@ public:
 	bool DoRender(const CRenderLayerParams &Params) const override;
 	void Init() override;
 	void OnInit(CGameClient *pGameClient, IMap *pMap, CMapImages *pMapImages, std::shared_ptr<CMapBasedEnvelopePointAccess> &pEvelopePoints, bool OnlineOnly) override;
+	// builds the vertex data of the visuals without using the graphics, so it can run in a job after Init
+	virtual void GenerateVisuals();
+	// creates the buffers of the generated visuals, must be called on the render thread
+	virtual void UploadVisuals();
 
 	virtual int GetDataIndex(unsigned int &TileSize) const;
 	bool IsValid() const override { return GetRawData() != nullptr; }
@@ -129,6 +133,9 @@ protected:
 			m_Height = 0;
 			m_BufferContainerIndex = -1;
 			m_IsTextured = false;
+			m_pUploadData = nullptr;
+			m_UploadDataSize = 0;
+			m_UploadTileCount = 0;
 		}
 
 		bool Init(unsigned int Width, unsigned int Height);
@@ -188,9 +195,15 @@ protected:
 		unsigned int m_Height;
 		int m_BufferContainerIndex;
 		bool m_IsTextured;
+
+		// interleaved vertex data from GenerateTileData, moved to the graphics by UploadTileData
+		void *m_pUploadData;
+		size_t m_UploadDataSize;
+		size_t m_UploadTileCount;
 	};
 
-	void UploadTileData(std::optional<CTileLayerVisuals> &VisualsOptional, int CurOverlay, bool AddAsSpeedup, bool IsGameLayer = false);
+	void GenerateTileData(std::optional<CTileLayerVisuals> &VisualsOptional, int CurOverlay, bool AddAsSpeedup, bool IsGameLayer = false);
+	void UploadTileData(std::optional<CTileLayerVisuals> &VisualsOptional);
 
 	virtual void RenderTileLayerWithTileBuffer(const ColorRGBA &Color, const CRenderLayerParams &Params);
 	virtual void RenderTileLayerNoTileBuffer(const ColorRGBA &Color, const CRenderLayerParams &Params);
@@ -202,6 +215,8 @@ protected:
 	std::optional<CRenderLayerTile::CTileLayerVisuals> m_VisualTiles;
 	CMapItemLayerTilemap *m_pLayerTilemap;
 	ColorRGBA m_Color;
+	// getting the texture may load it, so whether the visuals are textured is decided in Init
+	bool m_TexturedVisuals = false;
 };
 
 class CRenderLayerQuads : public CRenderLayer
@@ -273,7 +288,7 @@ class CRenderLayerEntityGame final : public CRenderLayerEntityBase
 {
 public:
 	CRenderLayerEntityGame(int GroupId, int LayerId, int Flags, CMapItemLayerTilemap *pLayerTilemap);
-	void Init() override;
+	void GenerateVisuals() override;
 
 protected:
 	void RenderTileLayerWithTileBuffer(const ColorRGBA &Color, const CRenderLayerParams &Params) override;
@@ -295,7 +310,8 @@ class CRenderLayerEntityTele final : public CRenderLayerEntityBase
 public:
 	CRenderLayerEntityTele(int GroupId, int LayerId, int Flags, CMapItemLayerTilemap *pLayerTilemap);
 	int GetDataIndex(unsigned int &TileSize) const override;
-	void Init() override;
+	void GenerateVisuals() override;
+	void UploadVisuals() override;
 	void InitTileData() override;
 	void Unload() override;
 
@@ -314,7 +330,8 @@ class CRenderLayerEntitySpeedup final : public CRenderLayerEntityBase
 public:
 	CRenderLayerEntitySpeedup(int GroupId, int LayerId, int Flags, CMapItemLayerTilemap *pLayerTilemap);
 	int GetDataIndex(unsigned int &TileSize) const override;
-	void Init() override;
+	void GenerateVisuals() override;
+	void UploadVisuals() override;
 	void InitTileData() override;
 	void Unload() override;
 
@@ -335,7 +352,8 @@ class CRenderLayerEntitySwitch final : public CRenderLayerEntityBase
 public:
 	CRenderLayerEntitySwitch(int GroupId, int LayerId, int Flags, CMapItemLayerTilemap *pLayerTilemap);
 	int GetDataIndex(unsigned int &TileSize) const override;
-	void Init() override;
+	void GenerateVisuals() override;
+	void UploadVisuals() override;
 	void InitTileData() override;
 	void Unload() override;
 
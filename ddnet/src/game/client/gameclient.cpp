@@ -572,18 +572,33 @@ void CGameClient::OnConnected()
 	const char *pLoadMapContent = Localize("Initializing map logic");
 	// render loading before skip is calculated
 	m_Menus.RenderLoading(pConnectCaption, pLoadMapContent, 0);
+	const int64_t StartTime = time_get();
 	m_Layers.Init(Kernel()->RequestInterface<IMap>(), false);
+
+	// decode the map images and sounds in jobs while the map logic is initialized,
+	// their components wait for them and upload them in OnMapLoad
+	const int NumLoadingJobs = m_MapImages.StartLoading(Layers(), Layers()->Map(), true) + m_MapSounds.StartLoading(true);
+	m_Menus.StartLoading(1 + NumLoadingJobs + (int)ComponentCount());
+
 	m_Collision.Init(Layers());
 	m_GameWorld.m_Core.InitSwitchers(m_Collision.m_HighestSwitchNumber);
 	m_RaceHelper.Init(this);
+	const int64_t LogicTime = time_get();
 
 	// render loading before going through all components
-	m_Menus.RenderLoading(pConnectCaption, pLoadMapContent, 0);
+	m_Menus.RenderLoading(pConnectCaption, pLoadMapContent, 1);
+	const char *pLoadComponentsContent = Localize("Loading map");
 	for(auto &pComponent : m_vpAll)
 	{
 		pComponent->OnMapLoad();
 		pComponent->OnReset();
+		m_Menus.RenderLoading(pConnectCaption, pLoadComponentsContent, 1);
 	}
+	m_Menus.FinishLoading();
+	const int64_t EndTime = time_get();
+	log_debug("gameclient", "loaded map in %.2fms (map logic %.2fms, components %.2fms)",
+		(EndTime - StartTime) * 1000.0f / (float)time_freq(), (LogicTime - StartTime) * 1000.0f / (float)time_freq(),
+		(EndTime - LogicTime) * 1000.0f / (float)time_freq());
 
 	ConfigManager()->ResetGameSettings();
 	LoadMapSettings();
@@ -616,6 +631,13 @@ void CGameClient::OnReset()
 	m_PredictedTick = -1;
 	std::fill(std::begin(m_aLastNewPredictedTick), std::end(m_aLastNewPredictedTick), -1);
 
+	InvalidatePrediction();
+	m_PredictionBaseTick = -1;
+	m_PredictionDirtyTick = -1;
+	m_ResimulatedTicks = 0;
+	m_ResimulatedTicksPerSecond = 0;
+	m_ResimulatedTicksStart = time_get();
+
 	m_LastRoundStartTick = -1;
 	m_LastRaceTick = -1;
 	m_LastFlagCarrierRed = -4;
@@ -1117,7 +1139,7 @@ void CGameClient::OnMessage(int MsgId, CUnpacker *pUnpacker, int Conn, bool Dumm
 		}
 
 		if(i <= 16)
-			m_Teams.m_IsDDRace16 = true;
+			m_Teams.SetDDRace16(true);
 
 		m_Ghost.m_AllowRestart = true;
 		m_RaceDemo.m_AllowRestart = true;
@@ -1132,6 +1154,7 @@ void CGameClient::OnMessage(int MsgId, CUnpacker *pUnpacker, int Conn, bool Dumm
 			if(CCharacter *pChar = m_GameWorld.GetCharacterById(pMsg->m_Victim))
 				pChar->ResetPrediction();
 			m_GameWorld.ReleaseHooked(pMsg->m_Victim);
+			m_GameWorld.OnModified();
 		}
 
 		// if we are spectating a static id set (team 0) and somebody killed, and its not a guy in solo, we remove him from the list
@@ -1182,6 +1205,7 @@ void CGameClient::OnMessage(int MsgId, CUnpacker *pUnpacker, int Conn, bool Dumm
 		{
 			m_CharOrder.GiveWeak(Id.first);
 		}
+		m_GameWorld.OnModified();
 	}
 	else if(MsgId == NETMSGTYPE_SV_CHANGEINFOCOOLDOWN)
 	{
@@ -1203,6 +1227,8 @@ void CGameClient::OnMessage(int MsgId, CUnpacker *pUnpacker, int Conn, bool Dumm
 	{
 		CNetMsg_Sv_PreInput *pMsg = (CNetMsg_Sv_PreInput *)pRawMsg;
 		m_aClients[pMsg->m_Owner].m_aPreInputs[pMsg->m_IntendedTick % 200] = *pMsg;
+		if(m_PredictionDirtyTick == -1 || pMsg->m_IntendedTick < m_PredictionDirtyTick)
+			m_PredictionDirtyTick = pMsg->m_IntendedTick;
 	}
 }
 
@@ -1598,10 +1624,11 @@ void CGameClient::InvalidateSnapshot()
 
 void CGameClient::OnNewSnapshot()
 {
-	auto &&Evolve = [this](CNetObj_Character *pCharacter, int Tick) {
+	// the evolved characters only read the teams, so they share one default teams core
+	CTeamsCore TempTeams;
+	auto &&Evolve = [this, &TempTeams](CNetObj_Character *pCharacter, int Tick) {
 		CWorldCore TempWorld;
 		CCharacterCore TempCore = CCharacterCore();
-		CTeamsCore TempTeams = CTeamsCore();
 		TempCore.Init(&TempWorld, Collision(), &TempTeams);
 		TempCore.Read(pCharacter);
 		TempCore.m_ActiveWeapon = pCharacter->m_Weapon;
@@ -2335,6 +2362,219 @@ void CGameClient::UpdateEditorIngameMoved()
 	}
 }
 
+bool CGameClient::CPredictionInput::Matches(int Tick, const CNetObj_PlayerInput *pInput, const CNetObj_PlayerInput *pDummyInput, bool CanMoveInFreeze) const
+{
+	if(m_Tick != Tick || m_CanMoveInFreeze != CanMoveInFreeze)
+		return false;
+	const CNetObj_PlayerInput *apInputs[NUM_DUMMIES] = {pInput, pDummyInput};
+	for(int i = 0; i < NUM_DUMMIES; i++)
+	{
+		if(m_aHasInput[i] != (apInputs[i] != nullptr))
+			return false;
+		if(apInputs[i] && mem_comp(&m_aInput[i], apInputs[i], sizeof(CNetObj_PlayerInput)) != 0)
+			return false;
+	}
+	return true;
+}
+
+void CGameClient::CPredictionInput::Set(int Tick, const CNetObj_PlayerInput *pInput, const CNetObj_PlayerInput *pDummyInput, bool CanMoveInFreeze)
+{
+	m_Tick = Tick;
+	m_CanMoveInFreeze = CanMoveInFreeze;
+	const CNetObj_PlayerInput *apInputs[NUM_DUMMIES] = {pInput, pDummyInput};
+	for(int i = 0; i < NUM_DUMMIES; i++)
+	{
+		m_aHasInput[i] = apInputs[i] != nullptr;
+		if(apInputs[i])
+			m_aInput[i] = *apInputs[i];
+	}
+}
+
+int CGameClient::PredictionResumeTick(int StartTick, int PredTick, int PredictionTick, int DummyId)
+{
+	// everything has to be predicted again if a new snapshot arrived or the game world changed
+	if(!g_Config.m_ClPredictIncremental || m_LastPredictedTick < StartTick || m_PredictionBaseTick != StartTick - 1)
+		return StartTick;
+	if(!m_PredictedWorld.m_IsValidCopy || m_PredictedWorld.m_pParent != &m_GameWorld || m_GameWorld.m_pChild != &m_PredictedWorld)
+		return StartTick;
+	if(m_PredictionLocalId != m_Snap.m_LocalClientId || m_PredictionDummyId != DummyId || m_PredictionDummySwapping != m_IsDummySwapping || m_PredictionPreInput != (bool)g_Config.m_ClAntiPingPreInput)
+		return StartTick;
+
+	// the tick of the previous characters is always predicted again
+	int ResumeTick = minimum(m_LastPredictedTick + 1, PredTick, PredictionTick);
+	if(m_PredictionDirtyTick != -1)
+		ResumeTick = minimum(ResumeTick, m_PredictionDirtyTick);
+
+	// find the first tick predicted with different inputs
+	const bool PredictDummyInput = DummyId >= 0 && m_PredictedWorld.GetCharacterById(DummyId);
+	for(int Tick = StartTick; Tick < ResumeTick; Tick++)
+	{
+		const CNetObj_PlayerInput *pInputData = (CNetObj_PlayerInput *)Client()->GetInput(Tick, m_IsDummySwapping);
+		const CNetObj_PlayerInput *pDummyInputData = !PredictDummyInput ? nullptr : (CNetObj_PlayerInput *)Client()->GetInput(Tick, m_IsDummySwapping ^ 1);
+		if(!m_aPredictionInputs[Tick % NUM_PREDICTION_INPUTS].Matches(Tick, pInputData, pDummyInputData, CanMoveInFreeze(Tick, PredTick)))
+		{
+			ResumeTick = Tick;
+			break;
+		}
+	}
+	if(ResumeTick <= StartTick || ResumeTick - 1 == m_LastPredictedTick)
+		return maximum(ResumeTick, StartTick);
+
+	// continue after the latest checkpoint before the tick
+	for(int Tick = ResumeTick - 1; Tick >= StartTick; Tick--)
+		if(m_aPredictionCheckpoints[Tick % NUM_PREDICTION_CHECKPOINTS].m_Tick == Tick)
+			return Tick + 1;
+	return StartTick;
+}
+
+void CGameClient::RemoveUnpredictedEntities(CGameWorld *pWorld)
+{
+	// don't predict inactive players, or entities from other teams
+	for(int i = 0; i < MAX_CLIENTS; i++)
+		if(CCharacter *pChar = pWorld->GetCharacterById(i))
+			if((!m_Snap.m_aCharacters[i].m_Active && pChar->m_SnapTicks > 10) || IsOtherTeam(i))
+				pChar->Destroy();
+
+	CProjectile *pProjNext = nullptr;
+	for(CProjectile *pProj = (CProjectile *)pWorld->FindFirst(CGameWorld::ENTTYPE_PROJECTILE); pProj; pProj = pProjNext)
+	{
+		pProjNext = (CProjectile *)pProj->TypeNext();
+		if(IsOtherTeam(pProj->GetOwner()))
+		{
+			pProj->Destroy();
+		}
+	}
+}
+
+void CGameClient::PredictTick(CGameWorld *pWorld, int Tick, CCharacter *pLocalChar, CCharacter *pDummyChar, const CNetObj_PlayerInput *pInputData, const CNetObj_PlayerInput *pDummyInputData)
+{
+	// apply inputs and tick
+	bool DummyFirst = pInputData && pDummyInputData && pDummyChar->GetCid() < pLocalChar->GetCid();
+
+	if(DummyFirst)
+		pDummyChar->OnDirectInput(pDummyInputData);
+	if(pInputData)
+		pLocalChar->OnDirectInput(pInputData);
+	if(pDummyInputData && !DummyFirst)
+		pDummyChar->OnDirectInput(pDummyInputData);
+
+	if(g_Config.m_ClAntiPingPreInput)
+	{
+		for(int i = 0; i < MAX_CLIENTS; i++)
+		{
+			if(CCharacter *pChar = pWorld->GetCharacterById(i))
+			{
+				if(pDummyChar == pChar || pLocalChar == pChar)
+					continue;
+
+				const CNetMsg_Sv_PreInput PreInput = m_aClients[i].m_aPreInputs[Tick % 200];
+				if(PreInput.m_IntendedTick != Tick)
+					continue;
+
+				//convert preinput to input
+				CNetObj_PlayerInput Input = {0};
+				Input.m_Direction = PreInput.m_Direction;
+				Input.m_TargetX = PreInput.m_TargetX;
+				Input.m_TargetY = PreInput.m_TargetY;
+				Input.m_Jump = PreInput.m_Jump;
+				Input.m_Fire = PreInput.m_Fire;
+				Input.m_Hook = PreInput.m_Hook;
+				Input.m_WantedWeapon = PreInput.m_WantedWeapon;
+				Input.m_NextWeapon = PreInput.m_NextWeapon;
+				Input.m_PrevWeapon = PreInput.m_PrevWeapon;
+
+				pChar->OnDirectInput(&Input);
+			}
+		}
+	}
+
+	pWorld->m_GameTick = Tick;
+	if(pInputData)
+		pLocalChar->OnPredictedInput(pInputData);
+	if(pDummyInputData)
+		pDummyChar->OnPredictedInput(pDummyInputData);
+
+	if(g_Config.m_ClAntiPingPreInput)
+	{
+		for(int i = 0; i < MAX_CLIENTS; i++)
+		{
+			if(CCharacter *pChar = pWorld->GetCharacterById(i))
+			{
+				if(pDummyChar == pChar || pLocalChar == pChar)
+					continue;
+
+				const CNetMsg_Sv_PreInput PreInput = m_aClients[i].m_aPreInputs[Tick % 200];
+				if(PreInput.m_IntendedTick != Tick)
+					continue;
+
+				//convert preinput to input
+				CNetObj_PlayerInput Input = {0};
+				Input.m_Direction = PreInput.m_Direction;
+				Input.m_TargetX = PreInput.m_TargetX;
+				Input.m_TargetY = PreInput.m_TargetY;
+				Input.m_Jump = PreInput.m_Jump;
+				Input.m_Fire = PreInput.m_Fire;
+				Input.m_Hook = PreInput.m_Hook;
+				Input.m_WantedWeapon = PreInput.m_WantedWeapon;
+				Input.m_NextWeapon = PreInput.m_NextWeapon;
+				Input.m_PrevWeapon = PreInput.m_PrevWeapon;
+
+				pChar->OnPredictedInput(&Input);
+			}
+		}
+	}
+
+	pWorld->Tick();
+}
+
+void CGameClient::VerifyIncrementalPrediction(int StartTick, int PredTick)
+{
+	// predict all ticks again from the snapshot like without cl_predict_incremental, in an unlinked world
+	CGameWorld World;
+	World.SaveCheckpoint(&m_GameWorld);
+	RemoveUnpredictedEntities(&World);
+
+	CCharacter *pLocalChar = World.GetCharacterById(m_Snap.m_LocalClientId);
+	if(!pLocalChar)
+		return;
+	CCharacter *pDummyChar = nullptr;
+	if(m_PredictionDummyId >= 0)
+		pDummyChar = World.GetCharacterById(m_PredictionDummyId);
+
+	for(int Tick = StartTick; Tick <= PredTick; Tick++)
+	{
+		if(CanMoveInFreeze(Tick, PredTick))
+			pLocalChar->m_CanMoveInFreeze = true;
+		const CNetObj_PlayerInput *pInputData = (CNetObj_PlayerInput *)Client()->GetInput(Tick, m_IsDummySwapping);
+		const CNetObj_PlayerInput *pDummyInputData = !pDummyChar ? nullptr : (CNetObj_PlayerInput *)Client()->GetInput(Tick, m_IsDummySwapping ^ 1);
+		PredictTick(&World, Tick, pLocalChar, pDummyChar, pInputData, pDummyInputData);
+	}
+
+	for(int Type = 0; Type < CGameWorld::NUM_ENTTYPES; Type++)
+	{
+		int Num = 0;
+		int NumIncremental = 0;
+		for(CEntity *pEnt = World.FindFirst(Type); pEnt; pEnt = pEnt->TypeNext())
+			Num++;
+		for(CEntity *pEnt = m_PredictedWorld.FindFirst(Type); pEnt; pEnt = pEnt->TypeNext())
+			NumIncremental++;
+		if(Num != NumIncremental)
+			log_error("prediction", "incremental prediction of tick %d has %d entities of type %d instead of %d", PredTick, NumIncremental, Type, Num);
+	}
+	for(int i = 0; i < MAX_CLIENTS; i++)
+	{
+		CCharacter *pChar = World.GetCharacterById(i);
+		CCharacter *pIncrementalChar = m_PredictedWorld.GetCharacterById(i);
+		if(!pChar || !pIncrementalChar)
+			continue;
+		CNetObj_CharacterCore Core, IncrementalCore;
+		pChar->GetCore().Write(&Core);
+		pIncrementalChar->GetCore().Write(&IncrementalCore);
+		if(mem_comp(&Core, &IncrementalCore, sizeof(Core)) != 0)
+			log_error("prediction", "incremental prediction of tick %d differs for client %d", PredTick, i);
+	}
+}
+
 void CGameClient::OnPredict()
 {
 	// store the previous values so we can detect prediction errors
@@ -2367,24 +2607,35 @@ void CGameClient::OnPredict()
 
 	// init
 	bool Dummy = g_Config.m_ClDummy ^ m_IsDummySwapping;
-	m_PredictedWorld.CopyWorld(&m_GameWorld);
-
-	// don't predict inactive players, or entities from other teams
-	for(int i = 0; i < MAX_CLIENTS; i++)
-		if(CCharacter *pChar = m_PredictedWorld.GetCharacterById(i))
-			if((!m_Snap.m_aCharacters[i].m_Active && pChar->m_SnapTicks > 10) || IsOtherTeam(i))
-				pChar->Destroy();
-
-	CProjectile *pProjNext = nullptr;
-	for(CProjectile *pProj = (CProjectile *)m_PredictedWorld.FindFirst(CGameWorld::ENTTYPE_PROJECTILE); pProj; pProj = pProjNext)
+	const int StartTick = Client()->GameTick(g_Config.m_ClDummy) + 1;
+	const int PredTick = Client()->PredGameTick(g_Config.m_ClDummy);
+	int PredictionTick = Client()->GetPredictionTick();
+	const int DummyId = PredictDummy() ? m_PredictedDummyId : -1;
+	const int ResumeTick = PredictionResumeTick(StartTick, PredTick, PredictionTick, DummyId);
+	if(ResumeTick == StartTick)
 	{
-		pProjNext = (CProjectile *)pProj->TypeNext();
-		if(IsOtherTeam(pProj->GetOwner()))
-		{
-			pProj->Destroy();
-		}
+		m_PredictedWorld.CopyWorld(&m_GameWorld);
+		RemoveUnpredictedEntities(&m_PredictedWorld);
+	}
+	else if(ResumeTick - 1 != m_LastPredictedTick)
+	{
+		m_PredictedWorld.RestoreCheckpoint(&m_aPredictionCheckpoints[(ResumeTick - 1) % NUM_PREDICTION_CHECKPOINTS].m_World, &m_GameWorld);
 	}
 
+	// checkpoints of ticks that are predicted again are outdated
+	for(auto &Checkpoint : m_aPredictionCheckpoints)
+		if(Checkpoint.m_Tick >= ResumeTick || Checkpoint.m_Tick < StartTick)
+			Checkpoint.m_Tick = -1;
+
+	// the predicted world only becomes valid to resume from again once all ticks are predicted
+	InvalidatePrediction();
+	m_PredictionBaseTick = StartTick - 1;
+	m_PredictionDirtyTick = -1;
+	m_PredictionLocalId = m_Snap.m_LocalClientId;
+	m_PredictionDummyId = DummyId;
+	m_PredictionDummySwapping = m_IsDummySwapping;
+	m_PredictionPreInput = g_Config.m_ClAntiPingPreInput;
+
 	CCharacter *pLocalChar = m_PredictedWorld.GetCharacterById(m_Snap.m_LocalClientId);
 	if(!pLocalChar)
 		return;
@@ -2392,9 +2643,8 @@ void CGameClient::OnPredict()
 	if(PredictDummy())
 		pDummyChar = m_PredictedWorld.GetCharacterById(m_PredictedDummyId);
 
-	int PredictionTick = Client()->GetPredictionTick();
 	// predict
-	for(int Tick = Client()->GameTick(g_Config.m_ClDummy) + 1; Tick <= Client()->PredGameTick(g_Config.m_ClDummy); Tick++)
+	for(int Tick = ResumeTick; Tick <= PredTick; Tick++)
 	{
 		// fetch the previous characters
 		if(Tick == PredictionTick)
@@ -2414,88 +2664,27 @@ void CGameClient::OnPredict()
 		}
 
 		// optionally allow some movement in freeze by not predicting freeze the last one to two ticks
-		if(g_Config.m_ClPredictFreeze == 2 && Client()->PredGameTick(g_Config.m_ClDummy) - 1 - Client()->PredGameTick(g_Config.m_ClDummy) % 2 <= Tick)
+		const bool MoveInFreeze = CanMoveInFreeze(Tick, PredTick);
+		if(MoveInFreeze)
 			pLocalChar->m_CanMoveInFreeze = true;
 
-		// apply inputs and tick
 		CNetObj_PlayerInput *pInputData = (CNetObj_PlayerInput *)Client()->GetInput(Tick, m_IsDummySwapping);
 		CNetObj_PlayerInput *pDummyInputData = !pDummyChar ? nullptr : (CNetObj_PlayerInput *)Client()->GetInput(Tick, m_IsDummySwapping ^ 1);
-		bool DummyFirst = pInputData && pDummyInputData && pDummyChar->GetCid() < pLocalChar->GetCid();
-
-		if(DummyFirst)
-			pDummyChar->OnDirectInput(pDummyInputData);
-		if(pInputData)
-			pLocalChar->OnDirectInput(pInputData);
-		if(pDummyInputData && !DummyFirst)
-			pDummyChar->OnDirectInput(pDummyInputData);
-
-		if(g_Config.m_ClAntiPingPreInput)
-		{
-			for(int i = 0; i < MAX_CLIENTS; i++)
-			{
-				if(CCharacter *pChar = m_PredictedWorld.GetCharacterById(i))
-				{
-					if(pDummyChar == pChar || pLocalChar == pChar)
-						continue;
-
-					const CNetMsg_Sv_PreInput PreInput = m_aClients[i].m_aPreInputs[Tick % 200];
-					if(PreInput.m_IntendedTick != Tick)
-						continue;
-
-					//convert preinput to input
-					CNetObj_PlayerInput Input = {0};
-					Input.m_Direction = PreInput.m_Direction;
-					Input.m_TargetX = PreInput.m_TargetX;
-					Input.m_TargetY = PreInput.m_TargetY;
-					Input.m_Jump = PreInput.m_Jump;
-					Input.m_Fire = PreInput.m_Fire;
-					Input.m_Hook = PreInput.m_Hook;
-					Input.m_WantedWeapon = PreInput.m_WantedWeapon;
-					Input.m_NextWeapon = PreInput.m_NextWeapon;
-					Input.m_PrevWeapon = PreInput.m_PrevWeapon;
-
-					pChar->OnDirectInput(&Input);
-				}
-			}
-		}
+		PredictTick(&m_PredictedWorld, Tick, pLocalChar, pDummyChar, pInputData, pDummyInputData);
 
-		m_PredictedWorld.m_GameTick = Tick;
-		if(pInputData)
-			pLocalChar->OnPredictedInput(pInputData);
-		if(pDummyInputData)
-			pDummyChar->OnPredictedInput(pDummyInputData);
-
-		if(g_Config.m_ClAntiPingPreInput)
+		if(g_Config.m_ClPredictIncremental)
 		{
-			for(int i = 0; i < MAX_CLIENTS; i++)
+			m_aPredictionInputs[Tick % NUM_PREDICTION_INPUTS].Set(Tick, pInputData, pDummyInputData, MoveInFreeze);
+			// the next prediction resumes at its prediction tick, which is usually this one or the next
+			if(Tick >= PredictionTick - 1 && Tick <= PredictionTick && Tick < PredTick)
 			{
-				if(CCharacter *pChar = m_PredictedWorld.GetCharacterById(i))
-				{
-					if(pDummyChar == pChar || pLocalChar == pChar)
-						continue;
-
-					const CNetMsg_Sv_PreInput PreInput = m_aClients[i].m_aPreInputs[Tick % 200];
-					if(PreInput.m_IntendedTick != Tick)
-						continue;
-
-					//convert preinput to input
-					CNetObj_PlayerInput Input = {0};
-					Input.m_Direction = PreInput.m_Direction;
-					Input.m_TargetX = PreInput.m_TargetX;
-					Input.m_TargetY = PreInput.m_TargetY;
-					Input.m_Jump = PreInput.m_Jump;
-					Input.m_Fire = PreInput.m_Fire;
-					Input.m_Hook = PreInput.m_Hook;
-					Input.m_WantedWeapon = PreInput.m_WantedWeapon;
-					Input.m_NextWeapon = PreInput.m_NextWeapon;
-					Input.m_PrevWeapon = PreInput.m_PrevWeapon;
-
-					pChar->OnPredictedInput(&Input);
-				}
+				CPredictionCheckpoint &Checkpoint = m_aPredictionCheckpoints[Tick % NUM_PREDICTION_CHECKPOINTS];
+				Checkpoint.m_Tick = Tick;
+				Checkpoint.m_World.SaveCheckpoint(&m_PredictedWorld);
 			}
 		}
-
-		m_PredictedWorld.Tick();
+		if(Tick <= m_aLastNewPredictedTick[Dummy])
+			m_ResimulatedTicks++;
 
 		// fetch the current characters
 		if(Tick == PredictionTick)
@@ -2556,6 +2745,20 @@ void CGameClient::OnPredict()
 		}
 	}
 
+	if(g_Config.m_ClPredictIncremental)
+	{
+		m_LastPredictedTick = PredTick;
+		if(g_Config.m_Debug && ResumeTick != StartTick)
+			VerifyIncrementalPrediction(StartTick, PredTick);
+	}
+
+	if(time_get() - m_ResimulatedTicksStart >= time_freq())
+	{
+		m_ResimulatedTicksPerSecond = m_ResimulatedTicks;
+		m_ResimulatedTicks = 0;
+		m_ResimulatedTicksStart = time_get();
+	}
+
 	// detect mispredictions of other players and make corrections smoother when possible
 	if(g_Config.m_ClAntiPingSmooth && Predict() && AntiPingPlayers() && m_NewTick && m_PredictedTick >= MIN_TICK && absolute(m_PredictedTick - Client()->PredGameTick(g_Config.m_ClDummy)) <= 1 && absolute(Client()->GameTick(g_Config.m_ClDummy) - Client()->PrevGameTick(g_Config.m_ClDummy)) <= 2)
 	{
@@ -220,6 +220,50 @@ private:
 	int m_PredictedTick;
 	int m_aLastNewPredictedTick[NUM_DUMMIES];
 
+	// incremental prediction: the inputs of every predicted tick are kept so only
+	// the ticks whose input changed have to be simulated again, resuming from the
+	// last predicted world or from a checkpoint of the world around the prediction tick
+	enum
+	{
+		NUM_PREDICTION_INPUTS = 100, // more than MaxLatencyTicks()
+		NUM_PREDICTION_CHECKPOINTS = 2,
+	};
+	class CPredictionInput
+	{
+	public:
+		int m_Tick = -1;
+		bool m_aHasInput[NUM_DUMMIES];
+		CNetObj_PlayerInput m_aInput[NUM_DUMMIES];
+		bool m_CanMoveInFreeze;
+
+		bool Matches(int Tick, const CNetObj_PlayerInput *pInput, const CNetObj_PlayerInput *pDummyInput, bool CanMoveInFreeze) const;
+		void Set(int Tick, const CNetObj_PlayerInput *pInput, const CNetObj_PlayerInput *pDummyInput, bool CanMoveInFreeze);
+	};
+	class CPredictionCheckpoint
+	{
+	public:
+		int m_Tick = -1;
+		CGameWorld m_World;
+	};
+	CPredictionInput m_aPredictionInputs[NUM_PREDICTION_INPUTS];
+	CPredictionCheckpoint m_aPredictionCheckpoints[NUM_PREDICTION_CHECKPOINTS];
+	int m_PredictionBaseTick = -1;
+	int m_LastPredictedTick = -1;
+	int m_PredictionDirtyTick = -1; // earliest tick with newly received preinputs
+	int m_PredictionLocalId = -1;
+	int m_PredictionDummyId = -1;
+	bool m_PredictionDummySwapping = false;
+	bool m_PredictionPreInput = false;
+	int m_ResimulatedTicks = 0;
+	int m_ResimulatedTicksPerSecond = 0;
+	int64_t m_ResimulatedTicksStart = 0;
+	void InvalidatePrediction() { m_LastPredictedTick = -1; }
+	int PredictionResumeTick(int StartTick, int PredTick, int PredictionTick, int DummyId);
+	void RemoveUnpredictedEntities(CGameWorld *pWorld);
+	void PredictTick(CGameWorld *pWorld, int Tick, CCharacter *pLocalChar, CCharacter *pDummyChar, const CNetObj_PlayerInput *pInputData, const CNetObj_PlayerInput *pDummyInputData);
+	void VerifyIncrementalPrediction(int StartTick, int PredTick);
+	bool CanMoveInFreeze(int Tick, int PredTick) const { return g_Config.m_ClPredictFreeze == 2 && PredTick - 1 - PredTick % 2 <= Tick; }
+
 	int m_LastRoundStartTick;
 	int m_LastRaceTick;
 
@@ -297,6 +341,7 @@ public:
 		return m_NetObjHandler.NumObjCorrections();
 	}
 	const char *NetobjCorrectedOn() { return m_NetObjHandler.CorrectedObjOn(); }
+	int PredictionResimulatedTicksPerSecond() const { return m_ResimulatedTicksPerSecond; }
 
 	bool m_SuppressEvents;
 	bool m_NewTick;
@@ -31,7 +31,7 @@ void CCharacter::SetSuper(bool Super)
 {
 	m_Core.m_Super = Super;
 	if(m_Core.m_Super)
-		TeamsCore()->Team(GetCid(), TeamsCore()->m_IsDDRace16 ? VANILLA_TEAM_SUPER : TEAM_SUPER);
+		TeamsCore()->Team(GetCid(), TeamsCore()->IsDDRace16() ? VANILLA_TEAM_SUPER : TEAM_SUPER);
 }
 
 bool CCharacter::IsGrounded()
@@ -1116,11 +1116,11 @@ void CCharacter::DDRacePostCoreTick()
 	HandleSkippableTiles(CurrentIndex);
 
 	// handle Anti-Skip tiles
-	std::vector<int> vIndices = Collision()->GetMapIndices(m_PrevPos, m_Pos);
-	if(!vIndices.empty())
-		for(int Index : vIndices)
-			HandleTiles(Index);
-	else
+	const int NumIndices = Collision()->ForEachMapIndex(m_PrevPos, m_Pos, [&](int Index) {
+		HandleTiles(Index);
+		return true;
+	});
+	if(!NumIndices)
 	{
 		HandleTiles(CurrentIndex);
 	}
@@ -625,6 +625,56 @@ void CGameWorld::CopyWorld(CGameWorld *pFrom)
 		m_pParent->m_pChild->m_IsValidCopy = false;
 	pFrom->m_pChild = this;
 
+	CopyEntities(pFrom, true);
+	m_IsValidCopy = true;
+}
+
+void CGameWorld::SaveCheckpoint(CGameWorld *pFrom)
+{
+	if(pFrom == this || !pFrom)
+		return;
+	m_IsValidCopy = false;
+
+	// remember the parents in list order, the copy keeps the order of the entities
+	m_vpCheckpointParents.clear();
+	for(int Type = 0; Type < NUM_ENTTYPES; Type++)
+		for(CEntity *pEnt = pFrom->FindFirst(Type); pEnt; pEnt = pEnt->TypeNext())
+			if(Type == ENTTYPE_PROJECTILE || Type == ENTTYPE_LASER || Type == ENTTYPE_DRAGGER || Type == ENTTYPE_CHARACTER || Type == ENTTYPE_PICKUP || Type == ENTTYPE_PLASMA)
+				m_vpCheckpointParents.push_back(pEnt->m_pParent);
+
+	CopyEntities(pFrom, false);
+}
+
+void CGameWorld::RestoreCheckpoint(CGameWorld *pCheckpoint, CGameWorld *pParent)
+{
+	if(pCheckpoint == this || !pCheckpoint || !pParent)
+		return;
+	m_IsValidCopy = false;
+	m_pParent = pParent;
+	if(m_pParent->m_pChild && m_pParent->m_pChild != this)
+		m_pParent->m_pChild->m_IsValidCopy = false;
+	pParent->m_pChild = this;
+
+	CopyEntities(pCheckpoint, false);
+
+	size_t Index = 0;
+	for(int Type = 0; Type < NUM_ENTTYPES; Type++)
+	{
+		for(CEntity *pEnt = FindFirst(Type); pEnt && Index < pCheckpoint->m_vpCheckpointParents.size(); pEnt = pEnt->TypeNext())
+		{
+			CEntity *pParentEnt = pCheckpoint->m_vpCheckpointParents[Index++];
+			if(pParentEnt)
+			{
+				pEnt->m_pParent = pParentEnt;
+				pParentEnt->m_pChild = pEnt;
+			}
+		}
+	}
+	m_IsValidCopy = true;
+}
+
+void CGameWorld::CopyEntities(CGameWorld *pFrom, bool LinkParents)
+{
 	m_GameTick = pFrom->m_GameTick;
 	m_pCollision = pFrom->m_pCollision;
 	m_WorldConfig = pFrom->m_WorldConfig;
@@ -663,13 +713,20 @@ void CGameWorld::CopyWorld(CGameWorld *pFrom)
 				pCopy = new CPlasma(*((CPlasma *)pEnt));
 			if(pCopy)
 			{
-				pCopy->m_pParent = pEnt;
-				pEnt->m_pChild = pCopy;
+				if(LinkParents)
+				{
+					pCopy->m_pParent = pEnt;
+					pEnt->m_pChild = pCopy;
+				}
+				else
+				{
+					pCopy->m_pParent = nullptr;
+					pCopy->m_pChild = nullptr;
+				}
 				this->InsertEntity(pCopy);
 			}
 		}
 	}
-	m_IsValidCopy = true;
 }
 
 CEntity *CGameWorld::FindMatch(int ObjId, int ObjType, const void *pObjData)
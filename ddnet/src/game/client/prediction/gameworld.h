@@ -98,6 +98,9 @@ public:
 	void NetObjAdd(int ObjId, int ObjType, const void *pObjData, const CNetObj_EntityEx *pDataEx);
 	void NetObjEnd();
 	void CopyWorld(CGameWorld *pFrom);
+	// checkpoints are unlinked copies of a world, restoring one links its entities to the parents of the original entities
+	void SaveCheckpoint(CGameWorld *pFrom);
+	void RestoreCheckpoint(CGameWorld *pCheckpoint, CGameWorld *pParent);
 	CEntity *FindMatch(int ObjId, int ObjType, const void *pObjData);
 	void Clear();
 
@@ -110,6 +113,9 @@ public:
 
 private:
 	void RemoveEntities();
+	void CopyEntities(CGameWorld *pFrom, bool LinkParents);
+
+	std::vector<CEntity *> m_vpCheckpointParents;
 
 	CEntity *m_pNextTraverseEntity = nullptr;
 	CEntity *m_apFirstEntityTypes[NUM_ENTTYPES];
@@ -146,6 +146,20 @@ void CCollision::Init(class CLayers *pLayers)
 			}
 		}
 	}
+
+	m_MaskStride = (m_Width + 63) / 64;
+	m_vMasks.assign((size_t)NUM_MASKS * m_Height * m_MaskStride, 0);
+	for(int i = 0; i < m_Width * m_Height; i++)
+	{
+		UpdateMasks(i);
+	}
+
+	m_vSpecialTiles.assign(((size_t)m_Width * m_Height + 63) / 64, 0);
+	for(int i = 0; i < m_Width * m_Height; i++)
+	{
+		if(IsSpecialTile(i))
+			m_vSpecialTiles[i / 64] |= (uint64_t)1 << (i % 64);
+	}
 }
 
 void CCollision::Unload()
@@ -169,6 +183,112 @@ void CCollision::Unload()
 	m_pTune = nullptr;
 	delete[] m_pDoor;
 	m_pDoor = nullptr;
+
+	m_vMasks.clear();
+	m_MaskStride = 0;
+	m_vSpecialTiles.clear();
+}
+
+int CCollision::TileMasks(int Index) const
+{
+	const int Tile = m_pTiles[Index].m_Index;
+	const int Front = m_pFront ? m_pFront[Index].m_Index : (int)TILE_AIR;
+	const int TeleType = m_pTele ? m_pTele[Index].m_Type : 0;
+
+	int Masks = 0;
+	if(Tile == TILE_SOLID || Tile == TILE_NOHOOK)
+		Masks |= (1 << MASK_SOLID) | (1 << MASK_HOOK) | (1 << MASK_WEAPON);
+	if(Tile == TILE_NOLASER)
+		Masks |= 1 << MASK_NOLASER;
+	if(Front == TILE_NOLASER)
+		Masks |= 1 << MASK_FRONT_NOLASER;
+	if(Tile == TILE_THROUGH_ALL || Tile == TILE_THROUGH_DIR || Front == TILE_THROUGH_ALL || Front == TILE_THROUGH_DIR)
+		Masks |= 1 << MASK_HOOK;
+	if(TeleType == TILE_TELEIN || TeleType == TILE_TELEINHOOK)
+		Masks |= 1 << MASK_HOOK;
+	if(TeleType == TILE_TELEIN || TeleType == TILE_TELEINWEAPON)
+		Masks |= 1 << MASK_WEAPON;
+	return Masks;
+}
+
+void CCollision::UpdateMasks(int Index)
+{
+	const int Nx = Index % m_Width;
+	const int Ny = Index / m_Width;
+	const int Masks = TileMasks(Index);
+	for(int Mask = 0; Mask < NUM_MASKS; Mask++)
+	{
+		uint64_t &Word = m_vMasks[((size_t)Mask * m_Height + Ny) * m_MaskStride + Nx / 64];
+		const uint64_t Bit = (uint64_t)1 << (Nx % 64);
+		if(Masks & (1 << Mask))
+			Word |= Bit;
+		else
+			Word &= ~Bit;
+	}
+}
+
+bool CCollision::HasAnyMask(int Masks, int Nx0, int Ny0, int Nx1, int Ny1) const
+{
+	const int Word0 = Nx0 / 64;
+	const int Word1 = Nx1 / 64;
+	const uint64_t FirstBits = ~(uint64_t)0 << (Nx0 % 64);
+	const uint64_t LastBits = ~(uint64_t)0 >> (63 - Nx1 % 64);
+	for(int Mask = 0; Mask < NUM_MASKS; Mask++)
+	{
+		if(!(Masks & (1 << Mask)))
+			continue;
+		for(int y = Ny0; y <= Ny1; y++)
+		{
+			const uint64_t *pRow = &m_vMasks[((size_t)Mask * m_Height + y) * m_MaskStride];
+			for(int w = Word0; w <= Word1; w++)
+			{
+				uint64_t Bits = pRow[w];
+				if(w == Word0)
+					Bits &= FirstBits;
+				if(w == Word1)
+					Bits &= LastBits;
+				if(Bits)
+					return true;
+			}
+		}
+	}
+	return false;
+}
+
+// The line checks test the tile under every sample of the line. This
+// returns the first sample from `Sample` on that may be on a tile with one
+// of the `Masks`, without changing which samples are hit. Samples up to
+// `*pCheckedUntil` don't need to be skipped again.
+//
+// The sample positions only grow (or shrink) along the line, so the tiles
+// of a run of samples are inside the rectangle spanned by the tiles of the
+// first and last sample of that run.
+int CCollision::SkipSamples(vec2 Pos0, vec2 Pos1, float Divisor, int Sample, int LastSample, int Masks, int *pCheckedUntil) const
+{
+	static const int RUN_LENGTH = 32;
+	if(m_vMasks.empty())
+	{
+		*pCheckedUntil = LastSample;
+		return LastSample + 1;
+	}
+	while(Sample <= LastSample)
+	{
+		const int RunEnd = minimum(Sample + RUN_LENGTH - 1, LastSample);
+		const vec2 First = mix(Pos0, Pos1, Sample / Divisor);
+		const vec2 Last = mix(Pos0, Pos1, RunEnd / Divisor);
+		const int Nx0 = std::clamp(round_to_int(First.x) / 32, 0, m_Width - 1);
+		const int Ny0 = std::clamp(round_to_int(First.y) / 32, 0, m_Height - 1);
+		const int Nx1 = std::clamp(round_to_int(Last.x) / 32, 0, m_Width - 1);
+		const int Ny1 = std::clamp(round_to_int(Last.y) / 32, 0, m_Height - 1);
+		if(HasAnyMask(Masks, minimum(Nx0, Nx1), minimum(Ny0, Ny1), maximum(Nx0, Nx1), maximum(Ny0, Ny1)))
+		{
+			*pCheckedUntil = RunEnd;
+			return Sample;
+		}
+		Sample = RunEnd + 1;
+	}
+	*pCheckedUntil = LastSample;
+	return Sample;
 }
 
 void CCollision::FillAntibot(CAntibotMapData *pMapData) const
@@ -326,14 +446,25 @@ int CCollision::GetTile(int x, int y) const
 	return 0;
 }
 
-// TODO: rewrite this smarter!
 int CCollision::IntersectLine(vec2 Pos0, vec2 Pos1, vec2 *pOutCollision, vec2 *pOutBeforeCollision) const
 {
 	float Distance = distance(Pos0, Pos1);
 	int End(Distance + 1);
 	vec2 Last = Pos0;
+	int CheckedUntil = -1;
 	for(int i = 0; i <= End; i++)
 	{
+		if(i > CheckedUntil)
+		{
+			int Next = SkipSamples(Pos0, Pos1, End, i, End, 1 << MASK_SOLID, &CheckedUntil);
+			if(Next > End)
+				break;
+			if(Next != i)
+			{
+				Last = mix(Pos0, Pos1, (Next - 1) / (float)End);
+				i = Next;
+			}
+		}
 		float a = i / (float)End;
 		vec2 Pos = mix(Pos0, Pos1, a);
 		// Temporary position for checking collision
@@ -365,8 +496,22 @@ int CCollision::IntersectLineTeleHook(vec2 Pos0, vec2 Pos1, vec2 *pOutCollision,
 	vec2 Last = Pos0;
 	int dx = 0, dy = 0; // Offset for checking the "through" tile
 	ThroughOffset(Pos0, Pos1, &dx, &dy);
+	if(pTeleNr)
+		*pTeleNr = 0;
+	int CheckedUntil = -1;
 	for(int i = 0; i <= End; i++)
 	{
+		if(i > CheckedUntil)
+		{
+			int Next = SkipSamples(Pos0, Pos1, End, i, End, 1 << MASK_HOOK, &CheckedUntil);
+			if(Next > End)
+				break;
+			if(Next != i)
+			{
+				Last = mix(Pos0, Pos1, (Next - 1) / (float)End);
+				i = Next;
+			}
+		}
 		float a = i / (float)End;
 		vec2 Pos = mix(Pos0, Pos1, a);
 		// Temporary position for checking collision
@@ -423,8 +568,22 @@ int CCollision::IntersectLineTeleWeapon(vec2 Pos0, vec2 Pos1, vec2 *pOutCollisio
 	float Distance = distance(Pos0, Pos1);
 	int End(Distance + 1);
 	vec2 Last = Pos0;
+	if(pTeleNr)
+		*pTeleNr = 0;
+	int CheckedUntil = -1;
 	for(int i = 0; i <= End; i++)
 	{
+		if(i > CheckedUntil)
+		{
+			int Next = SkipSamples(Pos0, Pos1, End, i, End, 1 << MASK_WEAPON, &CheckedUntil);
+			if(Next > End)
+				break;
+			if(Next != i)
+			{
+				Last = mix(Pos0, Pos1, (Next - 1) / (float)End);
+				i = Next;
+			}
+		}
 		float a = i / (float)End;
 		vec2 Pos = mix(Pos0, Pos1, a);
 		// Temporary position for checking collision
@@ -598,8 +757,12 @@ void CCollision::MoveBox(vec2 *pInoutPos, vec2 *pInoutVel, vec2 Size, vec2 Elast
 
 int CCollision::IsSolid(int x, int y) const
 {
-	int index = GetTile(x, y);
-	return index == TILE_SOLID || index == TILE_NOHOOK;
+	if(m_vMasks.empty())
+		return 0;
+
+	int Nx = std::clamp(x / 32, 0, m_Width - 1);
+	int Ny = std::clamp(y / 32, 0, m_Height - 1);
+	return HasMask(MASK_SOLID, Nx, Ny);
 }
 
 bool CCollision::IsThrough(int x, int y, int OffsetX, int OffsetY, vec2 Pos0, vec2 Pos1) const
@@ -638,12 +801,22 @@ int CCollision::IsWallJump(int Index) const
 
 int CCollision::IsNoLaser(int x, int y) const
 {
-	return (CCollision::GetTile(x, y) == TILE_NOLASER);
+	if(m_vMasks.empty())
+		return 0;
+
+	int Nx = std::clamp(x / 32, 0, m_Width - 1);
+	int Ny = std::clamp(y / 32, 0, m_Height - 1);
+	return HasMask(MASK_NOLASER, Nx, Ny);
 }
 
 int CCollision::IsFrontNoLaser(int x, int y) const
 {
-	return (CCollision::GetFrontTile(x, y) == TILE_NOLASER);
+	if(m_vMasks.empty())
+		return 0;
+
+	int Nx = std::clamp(x / 32, 0, m_Width - 1);
+	int Ny = std::clamp(y / 32, 0, m_Height - 1);
+	return HasMask(MASK_FRONT_NOLASER, Nx, Ny);
 }
 
 int CCollision::IsTeleport(int Index) const
@@ -836,11 +1009,8 @@ int CCollision::GetPureMapIndex(float x, float y) const
 	return Ny * m_Width + Nx;
 }
 
-bool CCollision::TileExists(int Index) const
+bool CCollision::IsSpecialTile(int Index) const
 {
-	if(Index < 0)
-		return false;
-
 	if((m_pTiles[Index].m_Index >= TILE_FREEZE && m_pTiles[Index].m_Index <= TILE_TELE_LASER_DISABLE) || (m_pTiles[Index].m_Index >= TILE_LFREEZE && m_pTiles[Index].m_Index <= TILE_LUNFREEZE))
 		return true;
 	if(m_pFront && ((m_pFront[Index].m_Index >= TILE_FREEZE && m_pFront[Index].m_Index <= TILE_TELE_LASER_DISABLE) || (m_pFront[Index].m_Index >= TILE_LFREEZE && m_pFront[Index].m_Index <= TILE_LUNFREEZE)))
@@ -912,46 +1082,29 @@ int CCollision::GetMapIndex(vec2 Pos) const
 		return -1;
 }
 
-std::vector<int> CCollision::GetMapIndices(vec2 PrevPos, vec2 Pos, unsigned MaxIndices) const
+void CCollision::UpdateSpecialTiles(int Index)
 {
-	std::vector<int> vIndices;
-	float d = distance(PrevPos, Pos);
-	int End(d + 1);
-	if(!d)
+	// stoppers make their neighbors special
+	for(int Neighbor : {Index - m_Width, Index - 1, Index, Index + 1, Index + m_Width})
 	{
-		int Nx = std::clamp((int)Pos.x / 32, 0, m_Width - 1);
-		int Ny = std::clamp((int)Pos.y / 32, 0, m_Height - 1);
-		int Index = Ny * m_Width + Nx;
-
-		if(TileExists(Index))
-		{
-			vIndices.push_back(Index);
-			return vIndices;
-		}
+		if(Neighbor < 0 || Neighbor >= m_Width * m_Height)
+			continue;
+		const uint64_t Bit = (uint64_t)1 << (Neighbor % 64);
+		if(IsSpecialTile(Neighbor))
+			m_vSpecialTiles[Neighbor / 64] |= Bit;
 		else
-			return vIndices;
+			m_vSpecialTiles[Neighbor / 64] &= ~Bit;
 	}
-	else
-	{
-		int LastIndex = 0;
-		for(int i = 0; i < End; i++)
-		{
-			float a = i / d;
-			vec2 Tmp = mix(PrevPos, Pos, a);
-			int Nx = std::clamp((int)Tmp.x / 32, 0, m_Width - 1);
-			int Ny = std::clamp((int)Tmp.y / 32, 0, m_Height - 1);
-			int Index = Ny * m_Width + Nx;
-			if(TileExists(Index) && LastIndex != Index)
-			{
-				if(MaxIndices && vIndices.size() > MaxIndices)
-					return vIndices;
-				vIndices.push_back(Index);
-				LastIndex = Index;
-			}
-		}
+}
 
-		return vIndices;
-	}
+std::vector<int> CCollision::GetMapIndices(vec2 PrevPos, vec2 Pos, unsigned MaxIndices) const
+{
+	std::vector<int> vIndices;
+	ForEachMapIndex(PrevPos, Pos, [&](int Index) {
+		vIndices.push_back(Index);
+		return !MaxIndices || vIndices.size() <= MaxIndices;
+	});
+	return vIndices;
 }
 
 vec2 CCollision::GetPos(int Index) const
@@ -1080,6 +1233,8 @@ void CCollision::SetCollisionAt(float x, float y, int Index)
 	int Ny = std::clamp(round_to_int(y) / 32, 0, m_Height - 1);
 
 	m_pTiles[Ny * m_Width + Nx].m_Index = Index;
+	UpdateMasks(Ny * m_Width + Nx);
+	UpdateSpecialTiles(Ny * m_Width + Nx);
 }
 
 void CCollision::SetDoorCollisionAt(float x, float y, int Type, int Flags, int Number)
@@ -1092,6 +1247,7 @@ void CCollision::SetDoorCollisionAt(float x, float y, int Type, int Flags, int N
 	m_pDoor[Ny * m_Width + Nx].m_Index = Type;
 	m_pDoor[Ny * m_Width + Nx].m_Flags = Flags;
 	m_pDoor[Ny * m_Width + Nx].m_Number = Number;
+	UpdateSpecialTiles(Ny * m_Width + Nx);
 }
 
 void CCollision::GetDoorTile(int Index, CDoorTile *pDoorTile) const
@@ -1143,8 +1299,20 @@ int CCollision::IntersectNoLaser(vec2 Pos0, vec2 Pos1, vec2 *pOutCollision, vec2
 	float d = distance(Pos0, Pos1);
 	vec2 Last = Pos0;
 
+	int CheckedUntil = -1;
 	for(int i = 0, id = std::ceil(d); i < id; i++)
 	{
+		if(i > CheckedUntil)
+		{
+			int Next = SkipSamples(Pos0, Pos1, d, i, id - 1, (1 << MASK_SOLID) | (1 << MASK_NOLASER) | (1 << MASK_FRONT_NOLASER), &CheckedUntil);
+			if(Next >= id)
+				break;
+			if(Next != i)
+			{
+				Last = mix(Pos0, Pos1, (Next - 1) / d);
+				i = Next;
+			}
+		}
 		float a = i / d;
 		vec2 Pos = mix(Pos0, Pos1, a);
 		int Nx = std::clamp(round_to_int(Pos.x) / 32, 0, m_Width - 1);
@@ -1174,8 +1342,20 @@ int CCollision::IntersectNoLaserNoWalls(vec2 Pos0, vec2 Pos1, vec2 *pOutCollisio
 	float d = distance(Pos0, Pos1);
 	vec2 Last = Pos0;
 
+	int CheckedUntil = -1;
 	for(int i = 0, id = std::ceil(d); i < id; i++)
 	{
+		if(i > CheckedUntil)
+		{
+			int Next = SkipSamples(Pos0, Pos1, d, i, id - 1, (1 << MASK_NOLASER) | (1 << MASK_FRONT_NOLASER), &CheckedUntil);
+			if(Next >= id)
+				break;
+			if(Next != i)
+			{
+				Last = mix(Pos0, Pos1, (Next - 1) / d);
+				i = Next;
+			}
+		}
 		float a = (float)i / d;
 		vec2 Pos = mix(Pos0, Pos1, a);
 		if(IsNoLaser(round_to_int(Pos.x), round_to_int(Pos.y)) || IsFrontNoLaser(round_to_int(Pos.x), round_to_int(Pos.y)))
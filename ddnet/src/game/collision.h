@@ -6,6 +6,8 @@
 #include <base/vmath.h>
 #include <engine/shared/protocol.h>
 
+#include <algorithm>
+#include <cstdint>
 #include <map>
 #include <vector>
 
@@ -76,8 +78,47 @@ public:
 	int GetPureMapIndex(float x, float y) const;
 	int GetPureMapIndex(vec2 Pos) const { return GetPureMapIndex(Pos.x, Pos.y); }
 	std::vector<int> GetMapIndices(vec2 PrevPos, vec2 Pos, unsigned MaxIndices = 0) const;
+
+	// Calls `Fn(Index)` for the tiles with a special meaning passed when moving
+	// from `PrevPos` to `Pos`, in order and without repeating a tile directly.
+	// Stops when `Fn` returns false. Returns the number of calls.
+	template<typename TFn>
+	int ForEachMapIndex(vec2 PrevPos, vec2 Pos, TFn &&Fn) const
+	{
+		const float d = distance(PrevPos, Pos);
+		if(!d)
+		{
+			const int Nx = std::clamp((int)Pos.x / 32, 0, m_Width - 1);
+			const int Ny = std::clamp((int)Pos.y / 32, 0, m_Height - 1);
+			const int Index = Ny * m_Width + Nx;
+			if(!TileExists(Index))
+				return 0;
+			Fn(Index);
+			return 1;
+		}
+
+		const int End(d + 1);
+		int LastIndex = 0;
+		int Num = 0;
+		for(int i = 0; i < End; i++)
+		{
+			const vec2 Tmp = mix(PrevPos, Pos, i / d);
+			const int Nx = std::clamp((int)Tmp.x / 32, 0, m_Width - 1);
+			const int Ny = std::clamp((int)Tmp.y / 32, 0, m_Height - 1);
+			const int Index = Ny * m_Width + Nx;
+			if(TileExists(Index) && LastIndex != Index)
+			{
+				Num++;
+				LastIndex = Index;
+				if(!Fn(Index))
+					break;
+			}
+		}
+		return Num;
+	}
+
 	int GetMapIndex(vec2 Pos) const;
-	bool TileExists(int Index) const;
+	bool TileExists(int Index) const { return Index >= 0 && (m_vSpecialTiles[Index / 64] >> (Index % 64)) & 1; }
 	bool TileExistsNext(int Index) const;
 	vec2 GetPos(int Index) const;
 	int GetTileIndex(int Index) const;
@@ -165,6 +206,35 @@ private:
 	std::map<int, std::vector<vec2>> m_TeleCheckOuts;
 	// TILE_TELEINEVIL, TILE_TELECHECK, TILE_TELECHECKIN, TILE_TELECHECKINEVIL
 	std::map<int, std::vector<vec2>> m_TeleOthers;
+
+	// One bit per tile for each of the masks, rows of `m_MaskStride` words
+	enum
+	{
+		MASK_SOLID = 0, // TILE_SOLID or TILE_NOHOOK
+		MASK_NOLASER,
+		MASK_FRONT_NOLASER,
+		MASK_HOOK, // tiles that can stop the hook
+		MASK_WEAPON, // tiles that can stop weapons
+		NUM_MASKS,
+	};
+	std::vector<uint64_t> m_vMasks;
+	int m_MaskStride;
+
+	int TileMasks(int Index) const;
+	void UpdateMasks(int Index);
+	bool HasMask(int Mask, int Nx, int Ny) const
+	{
+		const uint64_t Word = m_vMasks[((size_t)Mask * m_Height + Ny) * m_MaskStride + Nx / 64];
+		return (Word >> (Nx % 64)) & 1;
+	}
+	bool HasAnyMask(int Masks, int Nx0, int Ny0, int Nx1, int Ny1) const;
+	int SkipSamples(vec2 Pos0, vec2 Pos1, float Divisor, int Sample, int LastSample, int Masks, int *pCheckedUntil) const;
+
+	// One bit per tile index, set if `IsSpecialTile` is true for it
+	std::vector<uint64_t> m_vSpecialTiles;
+
+	bool IsSpecialTile(int Index) const;
+	void UpdateSpecialTiles(int Index);
 };
 
 void ThroughOffset(vec2 Pos0, vec2 Pos1, int *pOffsetX, int *pOffsetY);
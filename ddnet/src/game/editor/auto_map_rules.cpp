@@ -0,0 +1,570 @@
+#include "auto_map_rules.h"
+
+#include "enums.h"
+
+#include <base/math.h>
+#include <base/system.h>
+
+#include <engine/shared/jobs.h>
+#include <engine/shared/linereader.h>
+
+#include <game/mapitems.h>
+
+#include <algorithm>
+#include <cstdio> // sscanf
+#include <functional>
+#include <map>
+
+// Based on triple32inc from https://github.com/skeeto/hash-prospector/tree/79a6074062a84907df6e45b756134b74e2956760
+static uint32_t HashUInt32(uint32_t Num)
+{
+	Num++;
+	Num ^= Num >> 17;
+	Num *= 0xed5ad4bbu;
+	Num ^= Num >> 11;
+	Num *= 0xac4c1b51u;
+	Num ^= Num >> 15;
+	Num *= 0x31848babu;
+	Num ^= Num >> 14;
+	return Num;
+}
+
+#define HASH_MAX 65536
+
+static int HashLocation(uint32_t Seed, uint32_t Run, uint32_t Rule, uint32_t X, uint32_t Y)
+{
+	const uint32_t Prime = 31;
+	uint32_t Hash = 1;
+	Hash = Hash * Prime + HashUInt32(Seed);
+	Hash = Hash * Prime + HashUInt32(Run);
+	Hash = Hash * Prime + HashUInt32(Rule);
+	Hash = Hash * Prime + HashUInt32(X);
+	Hash = Hash * Prime + HashUInt32(Y);
+	Hash = HashUInt32(Hash * Prime); // Just to double-check that values are well-distributed
+	return Hash % HASH_MAX;
+}
+
+// The flags compared by the rules, packed into 3 bits
+static int FlagKey(int Flags)
+{
+	return (Flags & (TILEFLAG_XFLIP | TILEFLAG_YFLIP)) | ((Flags & TILEFLAG_ROTATE) ? 4 : 0);
+}
+
+// Key of a tile in the key sets, 0 is used for the tiles outside of the layer
+static int TileKey(int Index, int Flags)
+{
+	return (Index + 1) * 8 + FlagKey(Flags);
+}
+
+// Runs Func(RowBegin, RowEnd) on bands of rows, in the worker threads of the shared job pool for large layers
+static void ForEachRowBand(int Height, size_t TileCount, int MaxThreads, const std::function<void(int, int)> &Func)
+{
+	static constexpr size_t MIN_TILES_PER_BAND = 128 * 128;
+
+	CJobPool::ParallelForShared(Height, minimum<size_t>(TileCount / MIN_TILES_PER_BAND, maximum(MaxThreads, 1)), Func);
+}
+
+void CAutoMapRules::Load(CLineReader &LineReader)
+{
+	CConfiguration *pCurrentConf = nullptr;
+	CRun *pCurrentRun = nullptr;
+	CIndexRule *pCurrentIndex = nullptr;
+
+	// read each line
+	while(const char *pLine = LineReader.Get())
+	{
+		// skip blank/empty lines as well as comments
+		if(str_length(pLine) > 0 && pLine[0] != '#' && pLine[0] != '\n' && pLine[0] != '\r' && pLine[0] != '\t' && pLine[0] != '\v' && pLine[0] != ' ')
+		{
+			if(pLine[0] == '[')
+			{
+				// new configuration, get the name
+				pLine++;
+				CConfiguration NewConf;
+				NewConf.m_aName[0] = '\0';
+				NewConf.m_StartX = 0;
+				NewConf.m_StartY = 0;
+				NewConf.m_EndX = 0;
+				NewConf.m_EndY = 0;
+				m_vConfigs.push_back(NewConf);
+				int ConfigurationId = m_vConfigs.size() - 1;
+				pCurrentConf = &m_vConfigs[ConfigurationId];
+				str_copy(pCurrentConf->m_aName, pLine, minimum<int>(sizeof(pCurrentConf->m_aName), str_length(pLine)));
+
+				// add start run
+				CRun NewRun;
+				NewRun.m_AutomapCopy = true;
+				pCurrentConf->m_vRuns.push_back(NewRun);
+				int RunId = pCurrentConf->m_vRuns.size() - 1;
+				pCurrentRun = &pCurrentConf->m_vRuns[RunId];
+			}
+			else if(str_startswith(pLine, "NewRun") && pCurrentConf)
+			{
+				// add new run
+				CRun NewRun;
+				NewRun.m_AutomapCopy = true;
+				pCurrentConf->m_vRuns.push_back(NewRun);
+				int RunId = pCurrentConf->m_vRuns.size() - 1;
+				pCurrentRun = &pCurrentConf->m_vRuns[RunId];
+			}
+			else if(str_startswith(pLine, "Index") && pCurrentRun)
+			{
+				// new index
+				CIndexRule NewIndexRule;
+
+				char aOrientation1[128] = "";
+				char aOrientation2[128] = "";
+				char aOrientation3[128] = "";
+
+				sscanf(pLine, "Index %d %127s %127s %127s", &NewIndexRule.m_Id, aOrientation1, aOrientation2, aOrientation3);
+
+				NewIndexRule.m_Flag = 0;
+				NewIndexRule.m_RandomProbability = 1.0f;
+				NewIndexRule.m_DefaultRule = true;
+				NewIndexRule.m_SkipEmpty = false;
+				NewIndexRule.m_SkipFull = false;
+
+				if(str_length(aOrientation1) > 0)
+					NewIndexRule.m_Flag = CheckIndexFlag(NewIndexRule.m_Flag, aOrientation1, false);
+
+				if(str_length(aOrientation2) > 0)
+					NewIndexRule.m_Flag = CheckIndexFlag(NewIndexRule.m_Flag, aOrientation2, false);
+
+				if(str_length(aOrientation3) > 0)
+					NewIndexRule.m_Flag = CheckIndexFlag(NewIndexRule.m_Flag, aOrientation3, false);
+
+				// add the index rule object and make it current
+				pCurrentRun->m_vIndexRules.push_back(NewIndexRule);
+				int IndexRuleId = pCurrentRun->m_vIndexRules.size() - 1;
+				pCurrentIndex = &pCurrentRun->m_vIndexRules[IndexRuleId];
+			}
+			else if(str_startswith(pLine, "Pos") && pCurrentIndex)
+			{
+				int x = 0, y = 0;
+				char aValue[128];
+				int Value = CPosRule::NORULE;
+				std::vector<CIndexInfo> vNewIndexList;
+
+				sscanf(pLine, "Pos %d %d %127s", &x, &y, aValue);
+
+				if(!str_comp(aValue, "EMPTY"))
+				{
+					Value = CPosRule::INDEX;
+					CIndexInfo NewIndexInfo = {0, 0, false};
+					vNewIndexList.push_back(NewIndexInfo);
+				}
+				else if(!str_comp(aValue, "FULL"))
+				{
+					Value = CPosRule::NOTINDEX;
+					CIndexInfo NewIndexInfo1 = {0, 0, false};
+					// CIndexInfo NewIndexInfo2 = {-1, 0};
+					vNewIndexList.push_back(NewIndexInfo1);
+					// vNewIndexList.push_back(NewIndexInfo2);
+				}
+				else if(!str_comp(aValue, "INDEX") || !str_comp(aValue, "NOTINDEX"))
+				{
+					if(!str_comp(aValue, "INDEX"))
+						Value = CPosRule::INDEX;
+					else
+						Value = CPosRule::NOTINDEX;
+
+					int pWord = 4;
+					while(true)
+					{
+						CIndexInfo NewIndexInfo;
+
+						char aOrientation1[128] = "";
+						char aOrientation2[128] = "";
+						char aOrientation3[128] = "";
+						char aOrientation4[128] = "";
+						sscanf(str_trim_words(pLine, pWord), "%d %127s %127s %127s %127s", &NewIndexInfo.m_Id, aOrientation1, aOrientation2, aOrientation3, aOrientation4);
+
+						NewIndexInfo.m_Flag = 0;
+						NewIndexInfo.m_TestFlag = false;
+
+						if(!str_comp(aOrientation1, "OR"))
+						{
+							vNewIndexList.push_back(NewIndexInfo);
+							pWord += 2;
+							continue;
+						}
+						else if(str_length(aOrientation1) > 0)
+						{
+							NewIndexInfo.m_Flag = CheckIndexFlag(NewIndexInfo.m_Flag, aOrientation1, true);
+							NewIndexInfo.m_TestFlag = !(NewIndexInfo.m_Flag == 0 && str_comp(aOrientation1, "NONE"));
+						}
+						else
+						{
+							vNewIndexList.push_back(NewIndexInfo);
+							break;
+						}
+
+						if(!str_comp(aOrientation2, "OR"))
+						{
+							vNewIndexList.push_back(NewIndexInfo);
+							pWord += 3;
+							continue;
+						}
+						else if(str_length(aOrientation2) > 0 && NewIndexInfo.m_Flag != 0)
+						{
+							NewIndexInfo.m_Flag = CheckIndexFlag(NewIndexInfo.m_Flag, aOrientation2, false);
+						}
+						else
+						{
+							vNewIndexList.push_back(NewIndexInfo);
+							break;
+						}
+
+						if(!str_comp(aOrientation3, "OR"))
+						{
+							vNewIndexList.push_back(NewIndexInfo);
+							pWord += 4;
+							continue;
+						}
+						else if(str_length(aOrientation3) > 0 && NewIndexInfo.m_Flag != 0)
+						{
+							NewIndexInfo.m_Flag = CheckIndexFlag(NewIndexInfo.m_Flag, aOrientation3, false);
+						}
+						else
+						{
+							vNewIndexList.push_back(NewIndexInfo);
+							break;
+						}
+
+						if(!str_comp(aOrientation4, "OR"))
+						{
+							vNewIndexList.push_back(NewIndexInfo);
+							pWord += 5;
+							continue;
+						}
+						else
+						{
+							vNewIndexList.push_back(NewIndexInfo);
+							break;
+						}
+					}
+				}
+
+				if(Value != CPosRule::NORULE)
+				{
+					CPosRule NewPosRule = {x, y, Value, vNewIndexList};
+					pCurrentIndex->m_vRules.push_back(NewPosRule);
+
+					pCurrentConf->m_StartX = minimum(pCurrentConf->m_StartX, NewPosRule.m_X);
+					pCurrentConf->m_StartY = minimum(pCurrentConf->m_StartY, NewPosRule.m_Y);
+					pCurrentConf->m_EndX = maximum(pCurrentConf->m_EndX, NewPosRule.m_X);
+					pCurrentConf->m_EndY = maximum(pCurrentConf->m_EndY, NewPosRule.m_Y);
+
+					if(x == 0 && y == 0)
+					{
+						for(const auto &Index : vNewIndexList)
+						{
+							if(Index.m_Id == 0 && Value == CPosRule::INDEX)
+							{
+								// Skip full tiles if we have a rule "POS 0 0 INDEX 0"
+								// because that forces the tile to be empty
+								pCurrentIndex->m_SkipFull = true;
+							}
+							else if((Index.m_Id > 0 && Value == CPosRule::INDEX) || (Index.m_Id == 0 && Value == CPosRule::NOTINDEX))
+							{
+								// Skip empty tiles if we have a rule "POS 0 0 INDEX i" where i > 0
+								// or if we have a rule "POS 0 0 NOTINDEX 0"
+								pCurrentIndex->m_SkipEmpty = true;
+							}
+						}
+					}
+				}
+			}
+			else if(str_startswith(pLine, "Random") && pCurrentIndex)
+			{
+				float Value;
+				char Specifier = ' ';
+				sscanf(pLine, "Random %f%c", &Value, &Specifier);
+				if(Specifier == '%')
+				{
+					pCurrentIndex->m_RandomProbability = Value / 100.0f;
+				}
+				else
+				{
+					pCurrentIndex->m_RandomProbability = 1.0f / Value;
+				}
+			}
+			else if(str_startswith(pLine, "Modulo") && pCurrentIndex)
+			{
+				CModuloRule NewModuloRule;
+				sscanf(pLine, "Modulo %d %d %d %d", &NewModuloRule.m_ModX, &NewModuloRule.m_ModY, &NewModuloRule.m_OffsetX, &NewModuloRule.m_OffsetY);
+				if(NewModuloRule.m_ModX == 0)
+					NewModuloRule.m_ModX = 1;
+				if(NewModuloRule.m_ModY == 0)
+					NewModuloRule.m_ModY = 1;
+				pCurrentIndex->m_vModuloRules.push_back(NewModuloRule);
+			}
+			else if(str_startswith(pLine, "NoDefaultRule") && pCurrentIndex)
+			{
+				pCurrentIndex->m_DefaultRule = false;
+			}
+			else if(str_startswith(pLine, "NoLayerCopy") && pCurrentRun)
+			{
+				pCurrentRun->m_AutomapCopy = false;
+			}
+		}
+	}
+
+	// add default rule for Pos 0 0 if there is none
+	for(auto &Config : m_vConfigs)
+	{
+		for(auto &Run : Config.m_vRuns)
+		{
+			for(auto &IndexRule : Run.m_vIndexRules)
+			{
+				bool Found = false;
+
+				// Search for the exact rule "POS 0 0 INDEX 0" which corresponds to the default rule
+				for(const auto &Rule : IndexRule.m_vRules)
+				{
+					if(Rule.m_X == 0 && Rule.m_Y == 0 && Rule.m_Value == CPosRule::INDEX)
+					{
+						for(const auto &Index : Rule.m_vIndexList)
+						{
+							if(Index.m_Id == 0)
+								Found = true;
+						}
+						break;
+					}
+
+					if(Found)
+						break;
+				}
+
+				// If the default rule was not found, and we require it, then add it
+				if(!Found && IndexRule.m_DefaultRule)
+				{
+					std::vector<CIndexInfo> vNewIndexList;
+					CIndexInfo NewIndexInfo = {0, 0, false};
+					vNewIndexList.push_back(NewIndexInfo);
+					CPosRule NewPosRule = {0, 0, CPosRule::NOTINDEX, vNewIndexList};
+					IndexRule.m_vRules.push_back(NewPosRule);
+
+					IndexRule.m_SkipEmpty = true;
+					IndexRule.m_SkipFull = false;
+				}
+
+				if(IndexRule.m_SkipEmpty && IndexRule.m_SkipFull)
+				{
+					IndexRule.m_SkipEmpty = false;
+					IndexRule.m_SkipFull = false;
+				}
+			}
+		}
+	}
+
+	Compile();
+}
+
+void CAutoMapRules::Compile()
+{
+	m_vKeySets.clear();
+	std::map<std::vector<uint64_t>, int> KeySetIndices;
+	std::vector<uint64_t> vKeySet(KEY_SET_WORDS);
+	for(auto &Config : m_vConfigs)
+	{
+		for(auto &Run : Config.m_vRuns)
+		{
+			for(auto &IndexRule : Run.m_vIndexRules)
+			{
+				IndexRule.m_vCompiledRules.clear();
+				for(const CPosRule &Rule : IndexRule.m_vRules)
+				{
+					std::fill(vKeySet.begin(), vKeySet.end(), 0);
+					for(const CIndexInfo &Index : Rule.m_vIndexList)
+					{
+						if(Index.m_Id < -1 || Index.m_Id > 255)
+							continue;
+						for(int Flags = 0; Flags < 8; Flags++)
+						{
+							if(!Index.m_TestFlag || Flags == FlagKey(Index.m_Flag))
+							{
+								const int Key = (Index.m_Id + 1) * 8 + Flags;
+								vKeySet[Key / 64] |= (uint64_t)1 << (Key % 64);
+							}
+						}
+					}
+					if(Rule.m_Value == CPosRule::NOTINDEX)
+					{
+						for(uint64_t &Word : vKeySet)
+							Word = ~Word;
+					}
+
+					auto [It, Inserted] = KeySetIndices.emplace(vKeySet, (int)m_vKeySets.size());
+					if(Inserted)
+						m_vKeySets.insert(m_vKeySets.end(), vKeySet.begin(), vKeySet.end());
+					IndexRule.m_vCompiledRules.push_back(CCompiledPosRule{Rule.m_X, Rule.m_Y, It->second});
+				}
+
+				// all rules have to pass, check the tile itself first as it fails the most
+				std::stable_partition(IndexRule.m_vCompiledRules.begin(), IndexRule.m_vCompiledRules.end(), [](const CCompiledPosRule &Rule) {
+					return Rule.m_X == 0 && Rule.m_Y == 0;
+				});
+			}
+		}
+	}
+}
+
+void CAutoMapRules::Clear()
+{
+	m_vConfigs.clear();
+	m_vKeySets.clear();
+}
+
+int CAutoMapRules::CheckIndexFlag(int Flag, const char *pFlag, bool CheckNone)
+{
+	if(!str_comp(pFlag, "XFLIP"))
+		Flag |= TILEFLAG_XFLIP;
+	else if(!str_comp(pFlag, "YFLIP"))
+		Flag |= TILEFLAG_YFLIP;
+	else if(!str_comp(pFlag, "ROTATE"))
+		Flag |= TILEFLAG_ROTATE;
+	else if(!str_comp(pFlag, "NONE") && CheckNone)
+		Flag = 0;
+
+	return Flag;
+}
+
+const char *CAutoMapRules::ConfigName(int Index) const
+{
+	if(Index < 0 || Index >= (int)m_vConfigs.size())
+	{
+		return "(unknown)";
+	}
+	return m_vConfigs[Index].m_aName;
+}
+
+void CAutoMapRules::ConfigArea(int ConfigId, int *pStartX, int *pStartY, int *pEndX, int *pEndY) const
+{
+	const CConfiguration &Config = m_vConfigs[ConfigId];
+	*pStartX = Config.m_StartX;
+	*pStartY = Config.m_StartY;
+	*pEndX = Config.m_EndX;
+	*pEndY = Config.m_EndY;
+}
+
+void CAutoMapRules::Proceed(CTile *pTiles, int Width, int Height, const CTile *pGameTiles, int GameWidth, int GameHeight, int ReferenceId, int ConfigId, int Seed, int SeedOffsetX, int SeedOffsetY, uint8_t *pChanged, int NumThreads) const
+{
+	if(ConfigId < 0 || ConfigId >= (int)m_vConfigs.size() || Width <= 0 || Height <= 0)
+		return;
+
+	static const int s_aTileIndex[] = {TILE_SOLID, TILE_DEATH, TILE_NOHOOK, TILE_FREEZE, TILE_UNFREEZE, TILE_DFREEZE, TILE_DUNFREEZE, TILE_LFREEZE, TILE_LUNFREEZE};
+
+	static_assert(std::size(AUTOMAP_REFERENCE_NAMES) == std::size(s_aTileIndex) + 1, "AUTOMAP_REFERENCE_NAMES and s_aTileIndex must include the same items");
+
+	const CConfiguration &Conf = m_vConfigs[ConfigId];
+	std::vector<uint16_t> vKeys((size_t)Width * Height);
+
+	// for every run: get the keys of the tiles to read, automap, overwrite tiles
+	for(size_t h = 0; h < Conf.m_vRuns.size(); ++h)
+	{
+		const CRun &Run = Conf.m_vRuns[h];
+		const bool IsFilterable = h == 0 && ReferenceId >= 0;
+		dbg_assert(!IsFilterable || pGameTiles != nullptr, "automapping with a reference requires the game layer");
+
+		const CTile *pRead = IsFilterable ? pGameTiles : pTiles;
+		const int ReadWidth = IsFilterable ? GameWidth : Width;
+		const int ReadHeight = IsFilterable ? GameHeight : Height;
+		const bool Filter = Run.m_AutomapCopy && h == 0 && ReferenceId >= 1;
+		for(int y = 0; y < Height; y++)
+		{
+			for(int x = 0; x < Width; x++)
+			{
+				int Key = TileKey(0, 0);
+				if(x < ReadWidth && y < ReadHeight)
+				{
+					const CTile &Tile = pRead[y * ReadWidth + x];
+					Key = TileKey(Filter && Tile.m_Index != s_aTileIndex[ReferenceId - 1] ? 0 : Tile.m_Index, Tile.m_Flags);
+				}
+				vKeys[y * Width + x] = Key;
+			}
+		}
+
+		// without a copy the run reads the tiles it writes, so it has to go
+		// through them in order
+		const bool UpdateKeys = !Run.m_AutomapCopy && !IsFilterable;
+		if(UpdateKeys)
+		{
+			ProceedRows(Run, h, pTiles, Width, Height, vKeys.data(), true, IsFilterable, Seed, SeedOffsetX, SeedOffsetY, pChanged, 0, Height);
+		}
+		else
+		{
+			ForEachRowBand(Height, (size_t)Width * Height, NumThreads, [&](int RowBegin, int RowEnd) {
+				ProceedRows(Run, h, pTiles, Width, Height, vKeys.data(), false, IsFilterable, Seed, SeedOffsetX, SeedOffsetY, pChanged, RowBegin, RowEnd);
+			});
+		}
+	}
+}
+
+void CAutoMapRules::ProceedRows(const CRun &Run, int RunId, CTile *pTiles, int Width, int Height, uint16_t *pKeys, bool UpdateKeys, bool IsFilterable, int Seed, int SeedOffsetX, int SeedOffsetY, uint8_t *pChanged, int RowBegin, int RowEnd) const
+{
+	for(int y = RowBegin; y < RowEnd; y++)
+	{
+		for(int x = 0; x < Width; x++)
+		{
+			const int TileIndex = y * Width + x;
+			CTile *pTile = &pTiles[TileIndex];
+
+			for(size_t i = 0; i < Run.m_vIndexRules.size(); ++i)
+			{
+				const CIndexRule *pIndexRule = &Run.m_vIndexRules[i];
+				const bool ReadEmpty = pKeys[TileIndex] / 8 == 1;
+				if(ReadEmpty)
+				{
+					if(pTile->m_Index != 0 && IsFilterable) // TODO: This is a lazy workaround
+					{
+						pTile->m_Index = 0;
+						pTile->m_Flags = pIndexRule->m_Flag;
+						if(pChanged)
+							pChanged[TileIndex] = 1;
+						continue;
+					}
+
+					if(pIndexRule->m_SkipEmpty) // skip empty tiles
+						continue;
+				}
+				if(pIndexRule->m_SkipFull && !ReadEmpty) // skip full tiles
+					continue;
+
+				bool RespectRules = true;
+				for(const CCompiledPosRule &Rule : pIndexRule->m_vCompiledRules)
+				{
+					const int CheckX = x + Rule.m_X;
+					const int CheckY = y + Rule.m_Y;
+					const int Key = CheckX >= 0 && CheckX < Width && CheckY >= 0 && CheckY < Height ? pKeys[CheckY * Width + CheckX] : 0;
+					if(!HasKey(Rule.m_KeySet, Key))
+					{
+						RespectRules = false;
+						break;
+					}
+				}
+				if(!RespectRules)
+					continue;
+
+				bool PassesModuloCheck;
+				if(pIndexRule->m_vModuloRules.empty())
+					PassesModuloCheck = true;
+				else
+					PassesModuloCheck = std::any_of(pIndexRule->m_vModuloRules.cbegin(), pIndexRule->m_vModuloRules.cend(), [&](const CModuloRule &ModuloRule) {
+						return (x + SeedOffsetX + ModuloRule.m_OffsetX) % ModuloRule.m_ModX == 0 && (y + SeedOffsetY + ModuloRule.m_OffsetY) % ModuloRule.m_ModY == 0;
+					});
+
+				if(PassesModuloCheck &&
+					(pIndexRule->m_RandomProbability >= 1.0f || HashLocation(Seed, RunId, i, x + SeedOffsetX, y + SeedOffsetY) < HASH_MAX * pIndexRule->m_RandomProbability))
+				{
+					pTile->m_Index = pIndexRule->m_Id;
+					pTile->m_Flags = pIndexRule->m_Flag;
+					if(pChanged)
+						pChanged[TileIndex] = 1;
+					if(UpdateKeys)
+						pKeys[TileIndex] = TileKey(pTile->m_Index, pTile->m_Flags);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,134 @@
+#ifndef GAME_EDITOR_AUTO_MAP_RULES_H
+#define GAME_EDITOR_AUTO_MAP_RULES_H
+
+#include <cstdint>
+#include <vector>
+
+class CLineReader;
+class CTile;
+
+// The configurations of an automapper rules file and the automapping of tiles
+// with them, without depending on the editor so tools can use it as well.
+//
+// The position rules are compiled to the set of tile keys (index and flags)
+// they accept, so each of them is checked with a single lookup. Runs that read
+// from a copy of the layer are evaluated in bands of rows on several threads,
+// the result does not depend on the number of threads.
+class CAutoMapRules
+{
+	class CIndexInfo
+	{
+	public:
+		int m_Id;
+		int m_Flag;
+		bool m_TestFlag;
+	};
+
+	class CPosRule
+	{
+	public:
+		int m_X;
+		int m_Y;
+		int m_Value;
+		std::vector<CIndexInfo> m_vIndexList;
+
+		enum
+		{
+			NORULE = 0,
+			INDEX,
+			NOTINDEX
+		};
+	};
+
+	class CCompiledPosRule
+	{
+	public:
+		int m_X;
+		int m_Y;
+		// first word of the accepted key set in `m_vKeySets`
+		int m_KeySet;
+	};
+
+	class CModuloRule
+	{
+	public:
+		int m_ModX;
+		int m_ModY;
+		int m_OffsetX;
+		int m_OffsetY;
+	};
+
+	class CIndexRule
+	{
+	public:
+		int m_Id;
+		std::vector<CPosRule> m_vRules;
+		std::vector<CCompiledPosRule> m_vCompiledRules;
+		int m_Flag;
+		float m_RandomProbability;
+		std::vector<CModuloRule> m_vModuloRules;
+		bool m_DefaultRule;
+		bool m_SkipEmpty;
+		bool m_SkipFull;
+	};
+
+	class CRun
+	{
+	public:
+		std::vector<CIndexRule> m_vIndexRules;
+		bool m_AutomapCopy;
+	};
+
+	class CConfiguration
+	{
+	public:
+		std::vector<CRun> m_vRuns;
+		char m_aName[128];
+		int m_StartX;
+		int m_StartY;
+		int m_EndX;
+		int m_EndY;
+	};
+
+public:
+	enum
+	{
+		// tile index -1 (outside of the layer) to 255, each with 8 flag combinations
+		NUM_TILE_KEYS = 257 * 8,
+		KEY_SET_WORDS = (NUM_TILE_KEYS + 63) / 64,
+	};
+
+	void Load(CLineReader &LineReader);
+	void Clear();
+
+	static int CheckIndexFlag(int Flag, const char *pFlag, bool CheckNone);
+
+	int NumConfigs() const { return m_vConfigs.size(); }
+	const char *ConfigName(int Index) const;
+
+	// Offsets of the tiles that the rules of a configuration check
+	void ConfigArea(int ConfigId, int *pStartX, int *pStartY, int *pEndX, int *pEndY) const;
+
+	/**
+	 * Automaps the tiles of a layer.
+	 *
+	 * @param pTiles The `Width` x `Height` tiles of the layer.
+	 * @param pGameTiles The game layer, only read by the first run if `ReferenceId` is not -1.
+	 * @param pChanged Set to 1 for every tile a rule was applied to, if not null.
+	 * @param NumThreads The maximum number of threads to use, large layers are
+	 * split over the workers of the shared job pool.
+	 */
+	void Proceed(CTile *pTiles, int Width, int Height, const CTile *pGameTiles, int GameWidth, int GameHeight, int ReferenceId, int ConfigId, int Seed, int SeedOffsetX, int SeedOffsetY, uint8_t *pChanged, int NumThreads) const;
+
+private:
+	void Compile();
+	bool HasKey(int KeySet, int Key) const { return (m_vKeySets[KeySet + Key / 64] >> (Key % 64)) & 1; }
+
+	void ProceedRows(const CRun &Run, int RunId, CTile *pTiles, int Width, int Height, uint16_t *pKeys, bool UpdateKeys, bool IsFilterable, int Seed, int SeedOffsetX, int SeedOffsetY, uint8_t *pChanged, int RowBegin, int RowEnd) const;
+
+	std::vector<CConfiguration> m_vConfigs;
+	// deduplicated key sets of the compiled position rules, `KEY_SET_WORDS` words each
+	std::vector<uint64_t> m_vKeySets;
+};
+
+#endif
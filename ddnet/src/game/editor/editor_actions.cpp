@@ -15,40 +15,40 @@ CEditorBrushDrawAction::CEditorBrushDrawAction(CEditor *pEditor, int Group) :
 
 			if(pLayer == Map.m_pTeleLayer)
 			{
-				if(!Map.m_pTeleLayer->m_History.empty())
+				if(!Map.m_pTeleLayer->m_History.Empty())
 				{
-					m_TeleTileChanges = std::map(Map.m_pTeleLayer->m_History);
+					m_TeleTileChanges = std::move(Map.m_pTeleLayer->m_History);
 					Map.m_pTeleLayer->ClearHistory();
 				}
 			}
 			else if(pLayer == Map.m_pTuneLayer)
 			{
-				if(!Map.m_pTuneLayer->m_History.empty())
+				if(!Map.m_pTuneLayer->m_History.Empty())
 				{
-					m_TuneTileChanges = std::map(Map.m_pTuneLayer->m_History);
+					m_TuneTileChanges = std::move(Map.m_pTuneLayer->m_History);
 					Map.m_pTuneLayer->ClearHistory();
 				}
 			}
 			else if(pLayer == Map.m_pSwitchLayer)
 			{
-				if(!Map.m_pSwitchLayer->m_History.empty())
+				if(!Map.m_pSwitchLayer->m_History.Empty())
 				{
-					m_SwitchTileChanges = std::map(Map.m_pSwitchLayer->m_History);
+					m_SwitchTileChanges = std::move(Map.m_pSwitchLayer->m_History);
 					Map.m_pSwitchLayer->ClearHistory();
 				}
 			}
 			else if(pLayer == Map.m_pSpeedupLayer)
 			{
-				if(!Map.m_pSpeedupLayer->m_History.empty())
+				if(!Map.m_pSpeedupLayer->m_History.Empty())
 				{
-					m_SpeedupTileChanges = std::map(Map.m_pSpeedupLayer->m_History);
+					m_SpeedupTileChanges = std::move(Map.m_pSpeedupLayer->m_History);
 					Map.m_pSpeedupLayer->ClearHistory();
 				}
 			}
 
-			if(!pLayerTiles->m_TilesHistory.empty())
+			if(!pLayerTiles->m_TilesHistory.Empty())
 			{
-				m_vTileChanges.emplace_back(k, std::map(pLayerTiles->m_TilesHistory));
+				m_vTileChanges.emplace_back(k, std::move(pLayerTiles->m_TilesHistory));
 				pLayerTiles->ClearHistory();
 			}
 		}
@@ -71,49 +71,23 @@ void CEditorBrushDrawAction::SetInfos()
 		m_TotalLayers++;
 
 		if(pLayer->m_Type == LAYERTYPE_TILES)
-		{
-			std::shared_ptr<CLayerTiles> pLayerTiles = std::static_pointer_cast<CLayerTiles>(pLayer);
-			auto Changes = Pair.second;
-			for(auto &Change : Changes)
-			{
-				m_TotalTilesDrawn += Change.second.size();
-			}
-		}
-	}
-
-	// Process speedup tiles
-	for(auto const &SpeedupChange : m_SpeedupTileChanges)
-	{
-		m_TotalTilesDrawn += SpeedupChange.second.size();
-	}
-
-	// Process tele tiles
-	for(auto const &TeleChange : m_TeleTileChanges)
-	{
-		m_TotalTilesDrawn += TeleChange.second.size();
+			m_TotalTilesDrawn += Pair.second.Size();
 	}
 
-	// Process switch tiles
-	for(auto const &SwitchChange : m_SwitchTileChanges)
-	{
-		m_TotalTilesDrawn += SwitchChange.second.size();
-	}
-
-	// Process tune tiles
-	for(auto const &TuneChange : m_TuneTileChanges)
-	{
-		m_TotalTilesDrawn += TuneChange.second.size();
-	}
+	m_TotalTilesDrawn += m_SpeedupTileChanges.Size();
+	m_TotalTilesDrawn += m_TeleTileChanges.Size();
+	m_TotalTilesDrawn += m_SwitchTileChanges.Size();
+	m_TotalTilesDrawn += m_TuneTileChanges.Size();
 
-	m_TotalLayers += !m_SpeedupTileChanges.empty();
-	m_TotalLayers += !m_SwitchTileChanges.empty();
-	m_TotalLayers += !m_TeleTileChanges.empty();
-	m_TotalLayers += !m_TuneTileChanges.empty();
+	m_TotalLayers += !m_SpeedupTileChanges.Empty();
+	m_TotalLayers += !m_SwitchTileChanges.Empty();
+	m_TotalLayers += !m_TeleTileChanges.Empty();
+	m_TotalLayers += !m_TuneTileChanges.Empty();
 }
 
 bool CEditorBrushDrawAction::IsEmpty()
 {
-	return m_vTileChanges.empty() && m_SpeedupTileChanges.empty() && m_SwitchTileChanges.empty() && m_TeleTileChanges.empty() && m_TuneTileChanges.empty();
+	return m_vTileChanges.empty() && m_SpeedupTileChanges.Empty() && m_SwitchTileChanges.Empty() && m_TeleTileChanges.Empty() && m_TuneTileChanges.Empty();
 }
 
 void CEditorBrushDrawAction::Undo()
@@ -139,96 +113,55 @@ void CEditorBrushDrawAction::Apply(bool Undo)
 		if(pLayer->m_Type == LAYERTYPE_TILES)
 		{
 			std::shared_ptr<CLayerTiles> pLayerTiles = std::static_pointer_cast<CLayerTiles>(pLayer);
-			auto Changes = Pair.second;
-			for(auto &Change : Changes)
-			{
-				int y = Change.first;
-				auto Line = Change.second;
-				for(auto &Tile : Line)
-				{
-					int x = Tile.first;
-					STileStateChange State = Tile.second;
-					pLayerTiles->SetTileIgnoreHistory(x, y, Undo ? State.m_Previous : State.m_Current);
-				}
-			}
+			Pair.second.ForEach([&](int x, int y, const STileStateChange &State) {
+				pLayerTiles->SetTileIgnoreHistory(x, y, Undo ? State.m_Previous : State.m_Current);
+			});
 		}
 	}
 
 	// Process speedup tiles
-	for(auto const &SpeedupChange : m_SpeedupTileChanges)
-	{
-		int y = SpeedupChange.first;
-		auto Line = SpeedupChange.second;
-		for(auto &Tile : Line)
-		{
-			int x = Tile.first;
-			int Index = y * Map.m_pSpeedupLayer->m_Width + x;
-			SSpeedupTileStateChange State = Tile.second;
-			SSpeedupTileStateChange::SData Data = Undo ? State.m_Previous : State.m_Current;
-
-			Map.m_pSpeedupLayer->m_pSpeedupTile[Index].m_Force = Data.m_Force;
-			Map.m_pSpeedupLayer->m_pSpeedupTile[Index].m_MaxSpeed = Data.m_MaxSpeed;
-			Map.m_pSpeedupLayer->m_pSpeedupTile[Index].m_Angle = Data.m_Angle;
-			Map.m_pSpeedupLayer->m_pSpeedupTile[Index].m_Type = Data.m_Type;
-			Map.m_pSpeedupLayer->m_pTiles[Index].m_Index = Data.m_Index;
-		}
-	}
+	m_SpeedupTileChanges.ForEach([&](int x, int y, const SSpeedupTileStateChange &State) {
+		int Index = y * Map.m_pSpeedupLayer->m_Width + x;
+		SSpeedupTileStateChange::SData Data = Undo ? State.m_Previous : State.m_Current;
+
+		Map.m_pSpeedupLayer->m_pSpeedupTile[Index].m_Force = Data.m_Force;
+		Map.m_pSpeedupLayer->m_pSpeedupTile[Index].m_MaxSpeed = Data.m_MaxSpeed;
+		Map.m_pSpeedupLayer->m_pSpeedupTile[Index].m_Angle = Data.m_Angle;
+		Map.m_pSpeedupLayer->m_pSpeedupTile[Index].m_Type = Data.m_Type;
+		Map.m_pSpeedupLayer->m_pTiles[Index].m_Index = Data.m_Index;
+	});
 
 	// Process tele tiles
-	for(auto const &TeleChange : m_TeleTileChanges)
-	{
-		int y = TeleChange.first;
-		auto Line = TeleChange.second;
-		for(auto &Tile : Line)
-		{
-			int x = Tile.first;
-			int Index = y * Map.m_pTeleLayer->m_Width + x;
-			STeleTileStateChange State = Tile.second;
-			STeleTileStateChange::SData Data = Undo ? State.m_Previous : State.m_Current;
-
-			Map.m_pTeleLayer->m_pTeleTile[Index].m_Number = Data.m_Number;
-			Map.m_pTeleLayer->m_pTeleTile[Index].m_Type = Data.m_Type;
-			Map.m_pTeleLayer->m_pTiles[Index].m_Index = Data.m_Index;
-		}
-	}
+	m_TeleTileChanges.ForEach([&](int x, int y, const STeleTileStateChange &State) {
+		int Index = y * Map.m_pTeleLayer->m_Width + x;
+		STeleTileStateChange::SData Data = Undo ? State.m_Previous : State.m_Current;
+
+		Map.m_pTeleLayer->m_pTeleTile[Index].m_Number = Data.m_Number;
+		Map.m_pTeleLayer->m_pTeleTile[Index].m_Type = Data.m_Type;
+		Map.m_pTeleLayer->m_pTiles[Index].m_Index = Data.m_Index;
+	});
 
 	// Process switch tiles
-	for(auto const &SwitchChange : m_SwitchTileChanges)
-	{
-		int y = SwitchChange.first;
-		auto Line = SwitchChange.second;
-		for(auto &Tile : Line)
-		{
-			int x = Tile.first;
-			int Index = y * Map.m_pSwitchLayer->m_Width + x;
-			SSwitchTileStateChange State = Tile.second;
-			SSwitchTileStateChange::SData Data = Undo ? State.m_Previous : State.m_Current;
-
-			Map.m_pSwitchLayer->m_pSwitchTile[Index].m_Number = Data.m_Number;
-			Map.m_pSwitchLayer->m_pSwitchTile[Index].m_Type = Data.m_Type;
-			Map.m_pSwitchLayer->m_pSwitchTile[Index].m_Flags = Data.m_Flags;
-			Map.m_pSwitchLayer->m_pSwitchTile[Index].m_Delay = Data.m_Delay;
-			Map.m_pSwitchLayer->m_pTiles[Index].m_Index = Data.m_Index;
-		}
-	}
+	m_SwitchTileChanges.ForEach([&](int x, int y, const SSwitchTileStateChange &State) {
+		int Index = y * Map.m_pSwitchLayer->m_Width + x;
+		SSwitchTileStateChange::SData Data = Undo ? State.m_Previous : State.m_Current;
+
+		Map.m_pSwitchLayer->m_pSwitchTile[Index].m_Number = Data.m_Number;
+		Map.m_pSwitchLayer->m_pSwitchTile[Index].m_Type = Data.m_Type;
+		Map.m_pSwitchLayer->m_pSwitchTile[Index].m_Flags = Data.m_Flags;
+		Map.m_pSwitchLayer->m_pSwitchTile[Index].m_Delay = Data.m_Delay;
+		Map.m_pSwitchLayer->m_pTiles[Index].m_Index = Data.m_Index;
+	});
 
 	// Process tune tiles
-	for(auto const &TuneChange : m_TuneTileChanges)
-	{
-		int y = TuneChange.first;
-		auto Line = TuneChange.second;
-		for(auto &Tile : Line)
-		{
-			int x = Tile.first;
-			int Index = y * Map.m_pTuneLayer->m_Width + x;
-			STuneTileStateChange State = Tile.second;
-			STuneTileStateChange::SData Data = Undo ? State.m_Previous : State.m_Current;
-
-			Map.m_pTuneLayer->m_pTuneTile[Index].m_Number = Data.m_Number;
-			Map.m_pTuneLayer->m_pTuneTile[Index].m_Type = Data.m_Type;
-			Map.m_pTuneLayer->m_pTiles[Index].m_Index = Data.m_Index;
-		}
-	}
+	m_TuneTileChanges.ForEach([&](int x, int y, const STuneTileStateChange &State) {
+		int Index = y * Map.m_pTuneLayer->m_Width + x;
+		STuneTileStateChange::SData Data = Undo ? State.m_Previous : State.m_Current;
+
+		Map.m_pTuneLayer->m_pTuneTile[Index].m_Number = Data.m_Number;
+		Map.m_pTuneLayer->m_pTuneTile[Index].m_Type = Data.m_Type;
+		Map.m_pTuneLayer->m_pTiles[Index].m_Index = Data.m_Index;
+	});
 }
 
 // -------------------------------------------
@@ -479,8 +412,8 @@ void CEditorActionBulk::Redo()
 
 // ---------
 
-CEditorActionTileChanges::CEditorActionTileChanges(CEditor *pEditor, int GroupIndex, int LayerIndex, const char *pAction, const EditorTileStateChangeHistory<STileStateChange> &Changes) :
-	CEditorActionLayerBase(pEditor, GroupIndex, LayerIndex), m_Changes(Changes)
+CEditorActionTileChanges::CEditorActionTileChanges(CEditor *pEditor, int GroupIndex, int LayerIndex, const char *pAction, CTileStateChangeHistory<STileStateChange> Changes) :
+	CEditorActionLayerBase(pEditor, GroupIndex, LayerIndex), m_Changes(std::move(Changes))
 {
 	ComputeInfos();
 	str_format(m_aDisplayText, sizeof(m_aDisplayText), "%s (x%d)", pAction, m_TotalChanges);
@@ -500,26 +433,16 @@ void CEditorActionTileChanges::Apply(bool Undo)
 {
 	auto &Map = m_pEditor->m_Map;
 	std::shared_ptr<CLayerTiles> pLayerTiles = std::static_pointer_cast<CLayerTiles>(m_pLayer);
-	for(auto &Change : m_Changes)
-	{
-		int y = Change.first;
-		auto Line = Change.second;
-		for(auto &Tile : Line)
-		{
-			int x = Tile.first;
-			STileStateChange State = Tile.second;
-			pLayerTiles->SetTileIgnoreHistory(x, y, Undo ? State.m_Previous : State.m_Current);
-		}
-	}
+	m_Changes.ForEach([&](int x, int y, const STileStateChange &State) {
+		pLayerTiles->SetTileIgnoreHistory(x, y, Undo ? State.m_Previous : State.m_Current);
+	});
 
 	Map.OnModify();
 }
 
 void CEditorActionTileChanges::ComputeInfos()
 {
-	m_TotalChanges = 0;
-	for(auto &Line : m_Changes)
-		m_TotalChanges += Line.second.size();
+	m_TotalChanges = m_Changes.Size();
 }
 
 // ---------
@@ -31,13 +31,13 @@ public:
 private:
 	int m_Group;
 	// m_vTileChanges is a list of changes for each layer that was modified.
-	// The std::pair is used to pair one layer (index) with its history (2D map).
-	// EditorTileStateChangeHistory<T> is a 2D map, storing a change item at a specific y,x position.
-	std::vector<std::pair<int, EditorTileStateChangeHistory<STileStateChange>>> m_vTileChanges;
-	EditorTileStateChangeHistory<STeleTileStateChange> m_TeleTileChanges;
-	EditorTileStateChangeHistory<SSpeedupTileStateChange> m_SpeedupTileChanges;
-	EditorTileStateChangeHistory<SSwitchTileStateChange> m_SwitchTileChanges;
-	EditorTileStateChangeHistory<STuneTileStateChange> m_TuneTileChanges;
+	// The std::pair is used to pair one layer (index) with its history.
+	// CTileStateChangeHistory<T> stores a change item at every changed x,y position.
+	std::vector<std::pair<int, CTileStateChangeHistory<STileStateChange>>> m_vTileChanges;
+	CTileStateChangeHistory<STeleTileStateChange> m_TeleTileChanges;
+	CTileStateChangeHistory<SSpeedupTileStateChange> m_SpeedupTileChanges;
+	CTileStateChangeHistory<SSwitchTileStateChange> m_SwitchTileChanges;
+	CTileStateChangeHistory<STuneTileStateChange> m_TuneTileChanges;
 
 	int m_TotalTilesDrawn;
 	int m_TotalLayers;
@@ -159,13 +159,13 @@ private:
 class CEditorActionTileChanges : public CEditorActionLayerBase
 {
 public:
-	CEditorActionTileChanges(CEditor *pEditor, int GroupIndex, int LayerIndex, const char *pAction, const EditorTileStateChangeHistory<STileStateChange> &Changes);
+	CEditorActionTileChanges(CEditor *pEditor, int GroupIndex, int LayerIndex, const char *pAction, CTileStateChangeHistory<STileStateChange> Changes);
 
 	void Undo() override;
 	void Redo() override;
 
 private:
-	EditorTileStateChangeHistory<STileStateChange> m_Changes;
+	CTileStateChangeHistory<STileStateChange> m_Changes;
 	int m_TotalChanges;
 
 	void ComputeInfos();
@@ -175,10 +175,7 @@ void CLayerSpeedup::BrushDraw(std::shared_ptr<CLayer> pBrush, vec2 WorldPos)
 
 void CLayerSpeedup::RecordStateChange(int x, int y, SSpeedupTileStateChange::SData Previous, SSpeedupTileStateChange::SData Current)
 {
-	if(!m_History[y][x].m_Changed)
-		m_History[y][x] = SSpeedupTileStateChange{true, Previous, Current};
-	else
-		m_History[y][x].m_Current = Current;
+	m_History.Record(x, y, Previous, Current);
 }
 
 void CLayerSpeedup::BrushFlipX()
@@ -5,7 +5,6 @@
 
 struct SSpeedupTileStateChange
 {
-	bool m_Changed;
 	struct SData
 	{
 		int m_Force;
@@ -37,11 +36,11 @@ public:
 	void BrushRotate(float Amount) override;
 	void FillSelection(bool Empty, std::shared_ptr<CLayer> pBrush, CUIRect Rect) override;
 
-	EditorTileStateChangeHistory<SSpeedupTileStateChange> m_History;
+	CTileStateChangeHistory<SSpeedupTileStateChange> m_History;
 	void ClearHistory() override
 	{
 		CLayerTiles::ClearHistory();
-		m_History.clear();
+		m_History.Clear();
 	}
 
 	std::shared_ptr<CLayer> Duplicate() const override;
@@ -177,10 +177,7 @@ void CLayerSwitch::BrushDraw(std::shared_ptr<CLayer> pBrush, vec2 WorldPos)
 
 void CLayerSwitch::RecordStateChange(int x, int y, SSwitchTileStateChange::SData Previous, SSwitchTileStateChange::SData Current)
 {
-	if(!m_History[y][x].m_Changed)
-		m_History[y][x] = SSwitchTileStateChange{true, Previous, Current};
-	else
-		m_History[y][x].m_Current = Current;
+	m_History.Record(x, y, Previous, Current);
 }
 
 void CLayerSwitch::BrushFlipX()
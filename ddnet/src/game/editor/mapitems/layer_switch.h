@@ -5,7 +5,6 @@
 
 struct SSwitchTileStateChange
 {
-	bool m_Changed;
 	struct SData
 	{
 		int m_Number;
@@ -42,11 +41,11 @@ public:
 	int m_GotoSwitchOffset;
 	ivec2 m_GotoSwitchLastPos;
 
-	EditorTileStateChangeHistory<SSwitchTileStateChange> m_History;
+	CTileStateChangeHistory<SSwitchTileStateChange> m_History;
 	inline void ClearHistory() override
 	{
 		CLayerTiles::ClearHistory();
-		m_History.clear();
+		m_History.Clear();
 	}
 
 	std::shared_ptr<CLayer> Duplicate() const override;
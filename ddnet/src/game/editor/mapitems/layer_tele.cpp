@@ -171,12 +171,7 @@ void CLayerTele::BrushDraw(std::shared_ptr<CLayer> pBrush, vec2 WorldPos)
 
 void CLayerTele::RecordStateChange(int x, int y, STeleTileStateChange::SData Previous, STeleTileStateChange::SData Current)
 {
-	if(!m_History[y][x].m_Changed)
-		m_History[y][x] = STeleTileStateChange{true, Previous, Current};
-	else
-	{
-		m_History[y][x].m_Current = Current;
-	}
+	m_History.Record(x, y, Previous, Current);
 }
 
 void CLayerTele::BrushFlipX()
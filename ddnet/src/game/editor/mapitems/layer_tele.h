@@ -5,7 +5,6 @@
 
 struct STeleTileStateChange
 {
-	bool m_Changed;
 	struct SData
 	{
 		int m_Number;
@@ -40,11 +39,11 @@ public:
 	int m_GotoTeleOffset;
 	ivec2 m_GotoTeleLastPos;
 
-	EditorTileStateChangeHistory<STeleTileStateChange> m_History;
+	CTileStateChangeHistory<STeleTileStateChange> m_History;
 	inline void ClearHistory() override
 	{
 		CLayerTiles::ClearHistory();
-		m_History.clear();
+		m_History.Clear();
 	}
 
 	std::shared_ptr<CLayer> Duplicate() const override;
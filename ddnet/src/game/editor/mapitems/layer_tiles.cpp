@@ -117,10 +117,7 @@ void CLayerTiles::SetTileIgnoreHistory(int x, int y, CTile Tile) const
 
 void CLayerTiles::RecordStateChange(int x, int y, CTile Previous, CTile Tile)
 {
-	if(!m_TilesHistory[y][x].m_Changed)
-		m_TilesHistory[y][x] = STileStateChange{true, Previous, Tile};
-	else
-		m_TilesHistory[y][x].m_Current = Tile;
+	m_TilesHistory.Record(x, y, Previous, Tile);
 }
 
 void CLayerTiles::PrepareForSave()
@@ -1007,10 +1004,10 @@ CUi::EPopupMenuFunctionResult CLayerTiles::RenderProperties(CUIRect *pToolBox)
 				{
 					m_AutoAutoMap = !m_AutoAutoMap;
 					FlagModified(0, 0, m_Width, m_Height);
-					if(!m_TilesHistory.empty()) // Sometimes pressing that button causes the automap to run so we should be able to undo that
+					if(!m_TilesHistory.Empty()) // Sometimes pressing that button causes the automap to run so we should be able to undo that
 					{
 						// record undo
-						m_pEditor->m_EditorHistory.RecordAction(std::make_shared<CEditorActionTileChanges>(m_pEditor, m_pEditor->m_SelectedGroup, m_pEditor->m_vSelectedLayers[0], "Auto map", m_TilesHistory));
+						m_pEditor->m_EditorHistory.RecordAction(std::make_shared<CEditorActionTileChanges>(m_pEditor, m_pEditor->m_SelectedGroup, m_pEditor->m_vSelectedLayers[0], "Auto map", std::move(m_TilesHistory)));
 						ClearHistory();
 					}
 				}
@@ -1021,7 +1018,7 @@ CUi::EPopupMenuFunctionResult CLayerTiles::RenderProperties(CUIRect *pToolBox)
 			{
 				m_pEditor->m_Map.m_vpImages[m_Image]->m_AutoMapper.Proceed(this, m_pEditor->m_Map.m_pGameLayer.get(), m_AutoMapperReference, m_AutoMapperConfig, m_Seed);
 				// record undo
-				m_pEditor->m_EditorHistory.RecordAction(std::make_shared<CEditorActionTileChanges>(m_pEditor, m_pEditor->m_SelectedGroup, m_pEditor->m_vSelectedLayers[0], "Auto map", m_TilesHistory));
+				m_pEditor->m_EditorHistory.RecordAction(std::make_shared<CEditorActionTileChanges>(m_pEditor, m_pEditor->m_SelectedGroup, m_pEditor->m_vSelectedLayers[0], "Auto map", std::move(m_TilesHistory)));
 				ClearHistory();
 				return CUi::POPUP_CLOSE_CURRENT;
 			}
@@ -1166,9 +1163,9 @@ CUi::EPopupMenuFunctionResult CLayerTiles::RenderProperties(CUIRect *pToolBox)
 		FlagModified(0, 0, m_Width, m_Height);
 
 		// Record undo if automapper was ran
-		if(m_AutoAutoMap && !m_TilesHistory.empty())
+		if(m_AutoAutoMap && !m_TilesHistory.Empty())
 		{
-			m_pEditor->m_EditorHistory.RecordAction(std::make_shared<CEditorActionTileChanges>(m_pEditor, m_pEditor->m_SelectedGroup, m_pEditor->m_vSelectedLayers[0], "Auto map", m_TilesHistory));
+			m_pEditor->m_EditorHistory.RecordAction(std::make_shared<CEditorActionTileChanges>(m_pEditor, m_pEditor->m_SelectedGroup, m_pEditor->m_vSelectedLayers[0], "Auto map", std::move(m_TilesHistory)));
 			ClearHistory();
 		}
 	}
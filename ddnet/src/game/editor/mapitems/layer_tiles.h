@@ -3,20 +3,16 @@
 
 #include <game/editor/editor_trackers.h>
 #include <game/editor/enums.h>
-#include <map>
+#include <game/editor/tile_state_change_history.h>
 
 #include "layer.h"
 
 struct STileStateChange
 {
-	bool m_Changed;
 	CTile m_Previous;
 	CTile m_Current;
 };
 
-template<typename T>
-using EditorTileStateChangeHistory = std::map<int, std::map<int, T>>;
-
 enum
 {
 	DIRECTION_LEFT = 0,
@@ -189,8 +185,8 @@ public:
 	char m_aFileName[IO_MAX_PATH_LENGTH];
 	bool m_KnownTextModeLayer = false;
 
-	EditorTileStateChangeHistory<STileStateChange> m_TilesHistory;
-	inline virtual void ClearHistory() { m_TilesHistory.clear(); }
+	CTileStateChangeHistory<STileStateChange> m_TilesHistory;
+	inline virtual void ClearHistory() { m_TilesHistory.Clear(); }
 
 	static bool HasAutomapEffect(ETilesProp Prop);
 
@@ -159,10 +159,7 @@ void CLayerTune::BrushDraw(std::shared_ptr<CLayer> pBrush, vec2 WorldPos)
 
 void CLayerTune::RecordStateChange(int x, int y, STuneTileStateChange::SData Previous, STuneTileStateChange::SData Current)
 {
-	if(!m_History[y][x].m_Changed)
-		m_History[y][x] = STuneTileStateChange{true, Previous, Current};
-	else
-		m_History[y][x].m_Current = Current;
+	m_History.Record(x, y, Previous, Current);
 }
 
 void CLayerTune::BrushFlipX()
@@ -5,7 +5,6 @@
 
 struct STuneTileStateChange
 {
-	bool m_Changed;
 	struct SData
 	{
 		int m_Number;
@@ -39,11 +38,11 @@ public:
 	int m_GotoTuneOffset;
 	ivec2 m_GotoTuneLastPos;
 
-	EditorTileStateChangeHistory<STuneTileStateChange> m_History;
+	CTileStateChangeHistory<STuneTileStateChange> m_History;
 	inline void ClearHistory() override
 	{
 		CLayerTiles::ClearHistory();
-		m_History.clear();
+		m_History.Clear();
 	}
 
 	std::shared_ptr<CLayer> Duplicate() const override;
@@ -523,7 +523,7 @@ CUi::EPopupMenuFunctionResult CEditor::PopupGroup(void *pContext, CUIRect View,
 				}
 			}
 
-			if(!pGameLayer->m_TilesHistory.empty())
+			if(!pGameLayer->m_TilesHistory.Empty())
 			{
 				if(GameLayerIndex == -1)
 				{
@@ -532,7 +532,7 @@ CUi::EPopupMenuFunctionResult CEditor::PopupGroup(void *pContext, CUIRect View,
 				else
 				{
 					// record undo
-					pEditor->m_EditorHistory.RecordAction(std::make_shared<CEditorActionTileChanges>(pEditor, pEditor->m_SelectedGroup, GameLayerIndex, "Clean up game tiles", pGameLayer->m_TilesHistory));
+					pEditor->m_EditorHistory.RecordAction(std::make_shared<CEditorActionTileChanges>(pEditor, pEditor->m_SelectedGroup, GameLayerIndex, "Clean up game tiles", std::move(pGameLayer->m_TilesHistory)));
 				}
 				pGameLayer->ClearHistory();
 			}
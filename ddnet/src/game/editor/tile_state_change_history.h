@@ -0,0 +1,168 @@
+#ifndef GAME_EDITOR_TILE_STATE_CHANGE_HISTORY_H
+#define GAME_EDITOR_TILE_STATE_CHANGE_HISTORY_H
+
+#include <bit>
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+/**
+ * Changes of the tiles of a layer for the undo history, storing the state
+ * before the first and after the last change of every changed tile.
+ *
+ * The layer is split into chunks of 32x32 tiles. A chunk stores which of its
+ * tiles changed in a bitmap and the changes densely in the order of the tiles,
+ * so large fills and automapping don't allocate a node per tile.
+ *
+ * @tparam T Change of a single tile with `m_Previous` and `m_Current` members.
+ */
+template<typename T>
+class CTileStateChangeHistory
+{
+public:
+	using SData = decltype(T::m_Previous);
+
+	// Records a change, the previous state is only kept from the first change of a tile
+	void Record(int x, int y, const SData &Previous, const SData &Current)
+	{
+		CChunk &Chunk = GetChunk(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT);
+		const int Row = y & CHUNK_MASK;
+		const uint32_t Bit = (uint32_t)1 << (x & CHUNK_MASK);
+		const int Offset = Row * CHUNK_SIZE + (x & CHUNK_MASK);
+		if(Chunk.m_aRows[Row] & Bit)
+		{
+			Chunk.m_vChanges[Chunk.Rank(Row, Bit)].m_Current = Current;
+			return;
+		}
+
+		Chunk.m_aRows[Row] |= Bit;
+		// tiles are mostly recorded in order, so the change is usually appended
+		if(Offset > Chunk.m_LastOffset)
+		{
+			Chunk.m_vChanges.push_back(T{Previous, Current});
+			Chunk.m_LastOffset = Offset;
+		}
+		else
+		{
+			Chunk.m_vChanges.insert(Chunk.m_vChanges.begin() + Chunk.Rank(Row, Bit), T{Previous, Current});
+		}
+		m_Size++;
+	}
+
+	const T *Find(int x, int y) const
+	{
+		auto It = m_Chunks.find(ChunkKey(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT));
+		if(It == m_Chunks.end())
+			return nullptr;
+		const CChunk &Chunk = It->second;
+		const int Row = y & CHUNK_MASK;
+		const uint32_t Bit = (uint32_t)1 << (x & CHUNK_MASK);
+		if(!(Chunk.m_aRows[Row] & Bit))
+			return nullptr;
+		return &Chunk.m_vChanges[Chunk.Rank(Row, Bit)];
+	}
+
+	// Calls Fn(x, y, Change) for every changed tile
+	template<typename TFn>
+	void ForEach(TFn &&Fn) const
+	{
+		for(const auto &[Key, Chunk] : m_Chunks)
+		{
+			const int BaseX = (int32_t)(uint32_t)Key << CHUNK_SHIFT;
+			const int BaseY = (int32_t)(uint32_t)(Key >> 32) << CHUNK_SHIFT;
+			const T *pChange = Chunk.m_vChanges.data();
+			for(int Row = 0; Row < CHUNK_SIZE; Row++)
+			{
+				for(uint32_t Bits = Chunk.m_aRows[Row]; Bits; Bits &= Bits - 1)
+					Fn(BaseX + std::countr_zero(Bits), BaseY + Row, *pChange++);
+			}
+		}
+	}
+
+	bool Empty() const { return m_Size == 0; }
+	size_t Size() const { return m_Size; }
+
+	void Clear()
+	{
+		m_Chunks.clear();
+		m_pLastChunk = nullptr;
+		m_Size = 0;
+	}
+
+	CTileStateChangeHistory() = default;
+	CTileStateChangeHistory(const CTileStateChangeHistory &Other) :
+		m_Chunks(Other.m_Chunks), m_Size(Other.m_Size) {}
+	CTileStateChangeHistory(CTileStateChangeHistory &&Other) noexcept :
+		m_Chunks(std::move(Other.m_Chunks)), m_Size(Other.m_Size)
+	{
+		Other.Clear();
+	}
+	CTileStateChangeHistory &operator=(const CTileStateChangeHistory &Other)
+	{
+		m_Chunks = Other.m_Chunks;
+		m_pLastChunk = nullptr;
+		m_Size = Other.m_Size;
+		return *this;
+	}
+	CTileStateChangeHistory &operator=(CTileStateChangeHistory &&Other) noexcept
+	{
+		m_Chunks = std::move(Other.m_Chunks);
+		m_pLastChunk = nullptr;
+		m_Size = Other.m_Size;
+		Other.Clear();
+		return *this;
+	}
+
+private:
+	enum
+	{
+		CHUNK_SHIFT = 5,
+		CHUNK_SIZE = 1 << CHUNK_SHIFT,
+		CHUNK_MASK = CHUNK_SIZE - 1,
+	};
+
+	class CChunk
+	{
+	public:
+		// one bit per tile of every row
+		uint32_t m_aRows[CHUNK_SIZE] = {};
+		// changes of the tiles set in `m_aRows`, in the order of the tiles
+		std::vector<T> m_vChanges;
+		int m_LastOffset = -1;
+
+		// Index of the change of the tile at `Bit` in `Row`
+		int Rank(int Row, uint32_t Bit) const
+		{
+			int Rank = std::popcount(m_aRows[Row] & (Bit - 1));
+			for(int i = 0; i < Row; i++)
+				Rank += std::popcount(m_aRows[i]);
+			return Rank;
+		}
+	};
+
+	static uint64_t ChunkKey(int ChunkX, int ChunkY)
+	{
+		// row-major order of the chunks
+		return ((uint64_t)(uint32_t)ChunkY << 32) | (uint32_t)ChunkX;
+	}
+
+	CChunk &GetChunk(int ChunkX, int ChunkY)
+	{
+		const uint64_t Key = ChunkKey(ChunkX, ChunkY);
+		if(m_pLastChunk == nullptr || m_LastChunkKey != Key)
+		{
+			m_pLastChunk = &m_Chunks[Key];
+			m_LastChunkKey = Key;
+		}
+		return *m_pLastChunk;
+	}
+
+	std::map<uint64_t, CChunk> m_Chunks;
+	// chunk of the previous change, as the following changes are usually in the same chunk
+	CChunk *m_pLastChunk = nullptr;
+	uint64_t m_LastChunkKey = 0;
+	size_t m_Size = 0;
+};
+
+#endif
@@ -2261,17 +2261,13 @@ void CCharacter::DDRacePostCoreTick()
 		return;
 
 	// handle Anti-Skip tiles
-	std::vector<int> vIndices = Collision()->GetMapIndices(m_PrevPos, m_Pos);
-	if(!vIndices.empty())
-	{
-		for(int &Index : vIndices)
-		{
-			HandleTiles(Index);
-			if(!m_Alive)
-				return;
-		}
-	}
-	else
+	const int NumIndices = Collision()->ForEachMapIndex(m_PrevPos, m_Pos, [&](int Index) {
+		HandleTiles(Index);
+		return m_Alive;
+	});
+	if(!m_Alive)
+		return;
+	if(!NumIndices)
 	{
 		HandleTiles(CurrentIndex);
 		if(!m_Alive)
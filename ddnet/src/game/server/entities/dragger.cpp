@@ -49,10 +49,26 @@ void CDragger::Tick()
 			}
 		}
 
-		LookForPlayersToDrag();
+		// an inactive dragger only has to look for players to release its beams
+		if(m_Layer != LAYER_SWITCH || !GameWorld()->SwitchSleeping(m_Number) || HasTargets())
+		{
+			LookForPlayersToDrag();
+		}
 	}
 }
 
+bool CDragger::HasTargets() const
+{
+	for(int i = 0; i < MAX_CLIENTS; i++)
+	{
+		if(m_aTargetIdInTeam[i] != -1 || m_apDraggerBeam[i] != nullptr)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
 void CDragger::LookForPlayersToDrag()
 {
 	// Create a list of players who are in the range of the dragger
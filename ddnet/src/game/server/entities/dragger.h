@@ -31,6 +31,7 @@ class CDragger : public CEntity
 	CDraggerBeam *m_apDraggerBeam[MAX_CLIENTS];
 
 	void LookForPlayersToDrag();
+	bool HasTargets() const;
 
 public:
 	CDragger(CGameWorld *pGameWorld, vec2 Pos, float Strength, bool IgnoreWalls, int Layer = 0, int Number = 0);
@@ -37,7 +37,8 @@ void CGun::Tick()
 		GameServer()->Collision()->MoverSpeed(m_Pos.x, m_Pos.y, &m_Core);
 		m_Pos += m_Core;
 	}
-	if(g_Config.m_SvPlasmaPerSec > 0)
+	// an inactive turret would not fire at anyone
+	if(g_Config.m_SvPlasmaPerSec > 0 && (m_Layer != LAYER_SWITCH || !GameWorld()->SwitchSleeping(m_Number)))
 	{
 		Fire();
 	}
@@ -92,7 +92,9 @@ void CLight::Tick()
 		Step();
 	}
 
-	HitCharacter();
+	// an inactive light only moves, it freezes no one
+	if(m_Layer != LAYER_SWITCH || !GameWorld()->SwitchSleeping(m_Number))
+		HitCharacter();
 }
 
 void CLight::Snap(int SnappingClient)
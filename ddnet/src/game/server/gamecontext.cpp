@@ -609,14 +609,14 @@ void CGameContext::SendChatTarget(int To, const char *pText, int VersionFlags) c
 
 	if(To == -1)
 	{
+		CClientMask Recipients;
 		for(int i = 0; i < Server()->MaxClients(); i++)
 		{
-			if(!((Server()->IsSixup(i) && (VersionFlags & FLAG_SIXUP)) ||
-				   (!Server()->IsSixup(i) && (VersionFlags & FLAG_SIX))))
-				continue;
-
-			Server()->SendPackMsg(&Msg, MSGFLAG_VITAL | MSGFLAG_NORECORD, i);
+			if((Server()->IsSixup(i) && (VersionFlags & FLAG_SIXUP)) ||
+				(!Server()->IsSixup(i) && (VersionFlags & FLAG_SIX)))
+				Recipients.set(i);
 		}
+		Server()->SendPackMsgMulticast(&Msg, MSGFLAG_VITAL | MSGFLAG_NORECORD, Recipients);
 	}
 	else
 	{
@@ -630,9 +630,19 @@ void CGameContext::SendChatTarget(int To, const char *pText, int VersionFlags) c
 
 void CGameContext::SendChatTeam(int Team, const char *pText) const
 {
+	CNetMsg_Sv_Chat Msg;
+	Msg.m_Team = 0;
+	Msg.m_ClientId = -1;
+	Msg.m_pMessage = pText;
+
+	if(g_Config.m_SvDemoChat)
+		Server()->SendPackMsg(&Msg, MSGFLAG_VITAL | MSGFLAG_NOSEND, SERVER_DEMO_CLIENT);
+
+	CClientMask Recipients;
 	for(int i = 0; i < MAX_CLIENTS; i++)
 		if(m_apPlayers[i] != nullptr && GetDDRaceTeam(i) == Team)
-			SendChatTarget(i, pText);
+			Recipients.set(i);
+	Server()->SendPackMsgMulticast(&Msg, MSGFLAG_VITAL | MSGFLAG_NORECORD, Recipients);
 }
 
 void CGameContext::SendChat(int ChatterClientId, int Team, const char *pText, int SpamProtectionClientId, int VersionFlags)
@@ -667,6 +677,7 @@ void CGameContext::SendChat(int ChatterClientId, int Team, const char *pText, in
 			Server()->SendPackMsg(&Msg, MSGFLAG_VITAL | MSGFLAG_NOSEND, SERVER_DEMO_CLIENT);
 
 		// send to the clients
+		CClientMask Recipients;
 		for(int i = 0; i < Server()->MaxClients(); i++)
 		{
 			if(!m_apPlayers[i])
@@ -675,8 +686,9 @@ void CGameContext::SendChat(int ChatterClientId, int Team, const char *pText, in
 				    (!Server()->IsSixup(i) && (VersionFlags & FLAG_SIX));
 
 			if(!m_apPlayers[i]->m_DND && Send)
-				Server()->SendPackMsg(&Msg, MSGFLAG_VITAL | MSGFLAG_NORECORD, i);
+				Recipients.set(i);
 		}
+		Server()->SendPackMsgMulticast(&Msg, MSGFLAG_VITAL | MSGFLAG_NORECORD, Recipients);
 
 		str_format(aBuf, sizeof(aBuf), "Chat: %s", aText);
 		LogEvent(aBuf, ChatterClientId);
@@ -694,6 +706,7 @@ void CGameContext::SendChat(int ChatterClientId, int Team, const char *pText, in
 			Server()->SendPackMsg(&Msg, MSGFLAG_VITAL | MSGFLAG_NOSEND, SERVER_DEMO_CLIENT);
 
 		// send to the clients
+		CClientMask Recipients;
 		for(int i = 0; i < Server()->MaxClients(); i++)
 		{
 			if(m_apPlayers[i] != nullptr)
@@ -702,18 +715,19 @@ void CGameContext::SendChat(int ChatterClientId, int Team, const char *pText, in
 				{
 					if(m_apPlayers[i]->GetTeam() == TEAM_SPECTATORS)
 					{
-						Server()->SendPackMsg(&Msg, MSGFLAG_VITAL | MSGFLAG_NORECORD, i);
+						Recipients.set(i);
 					}
 				}
 				else
 				{
 					if(pTeams->Team(i) == Team && m_apPlayers[i]->GetTeam() != TEAM_SPECTATORS)
 					{
-						Server()->SendPackMsg(&Msg, MSGFLAG_VITAL | MSGFLAG_NORECORD, i);
+						Recipients.set(i);
 					}
 				}
 			}
 		}
+		Server()->SendPackMsgMulticast(&Msg, MSGFLAG_VITAL | MSGFLAG_NORECORD, Recipients);
 	}
 }
 
@@ -4441,6 +4455,14 @@ void CGameContext::OnShutdown(void *pPersistentData)
 			dbg_msg("teehistorian", "error closing file, err=%d", Error);
 			Server()->SetErrorShutdown("teehistorian close error");
 		}
+		ASYNCIO_STATS Stats;
+		aio_stats(m_pTeeHistorianFile, &Stats);
+		if(Stats.writes > 0)
+		{
+			dbg_msg("teehistorian", "wrote %" PRIu64 " bytes in %" PRIu64 " writes (%s), latency avg=%.2fms max=%.2fms",
+				Stats.written_bytes, Stats.writes, Stats.io_uring ? "io_uring" : "thread",
+				Stats.total_latency * 1000.0 / Stats.writes / time_freq(), Stats.max_latency * 1000.0 / time_freq());
+		}
 		aio_free(m_pTeeHistorianFile);
 	}
 
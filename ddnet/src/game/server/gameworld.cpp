@@ -198,6 +198,8 @@ void CGameWorld::Tick()
 
 	if(!m_Paused)
 	{
+		UpdateSleepingSwitches();
+
 		// update all objects
 		for(int i = 0; i < NUM_ENTTYPES; i++)
 		{
@@ -254,6 +256,27 @@ void CGameWorld::Tick()
 	}
 }
 
+void CGameWorld::UpdateSleepingSwitches()
+{
+	m_vSleepingSwitches.clear();
+	if(!g_Config.m_SvEntitySleeping)
+		return;
+
+	// switch states only change outside of the world tick and in the ticks of the characters
+	m_vSleepingSwitches.resize(m_Core.m_vSwitchers.size());
+	for(size_t Number = 0; Number < m_Core.m_vSwitchers.size(); Number++)
+	{
+		const bool *pStatus = m_Core.m_vSwitchers[Number].m_aStatus;
+		m_vSleepingSwitches[Number] = std::none_of(pStatus, pStatus + NUM_DDRACE_TEAMS, [](bool Status) { return Status; });
+	}
+}
+
+bool CGameWorld::SwitchSleeping(int Number) const
+{
+	// switch number 0 is always active
+	return Number > 0 && Number < (int)m_vSleepingSwitches.size() && m_vSleepingSwitches[Number];
+}
+
 ESaveResult CGameWorld::BlocksSave(int ClientId)
 {
 	// check all objects
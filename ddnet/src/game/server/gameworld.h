@@ -33,10 +33,14 @@ public:
 private:
 	void Reset();
 	void RemoveEntities();
+	void UpdateSleepingSwitches();
 
 	CEntity *m_pNextTraverseEntity = nullptr;
 	CEntity *m_apFirstEntityTypes[NUM_ENTTYPES];
 
+	// switch numbers that are inactive for all teams this tick, only filled with sv_entity_sleeping
+	std::vector<bool> m_vSleepingSwitches;
+
 	class CGameContext *m_pGameServer;
 	class CConfig *m_pConfig;
 	class IServer *m_pServer;
@@ -162,6 +166,18 @@ public:
 	*/
 	void Tick();
 
+	/*
+		Function: SwitchSleeping
+			Checks if the entities of a switch number may skip their work
+			this tick, because sv_entity_sleeping is enabled and the switch
+			is inactive for all teams. Only valid for entities that are ticked
+			before the characters, which change the switch states.
+
+		Arguments:
+			Number - Switch number of the entity.
+	*/
+	bool SwitchSleeping(int Number) const;
+
 	/*
 		Function: SwapClients
 			Calls SwapClients on all the entities in the world to ensure that /swap
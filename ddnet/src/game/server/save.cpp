@@ -1,4 +1,5 @@
 #include <engine/shared/config.h>
+#include <engine/shared/packer.h>
 #include <engine/shared/protocol.h>
 #include <game/server/entities/character.h>
 #include <game/server/gamemodes/DDRace.h>
@@ -261,20 +262,22 @@ bool CSaveTee::Load(CCharacter *pChr, int Team, bool IsSwap)
 	return Valid;
 }
 
-char *CSaveTee::GetString(const CSaveTeam *pTeam)
+int CSaveTee::HookedPlayerIndex(const CSaveTeam *pTeam) const
 {
-	int HookedPlayer = -1;
 	if(m_HookedPlayer != -1)
 	{
 		for(int n = 0; n < pTeam->GetMembersCount(); n++)
 		{
 			if(m_HookedPlayer == pTeam->m_pSavedTees[n].GetClientId())
-			{
-				HookedPlayer = n;
-				break;
-			}
+				return n;
 		}
 	}
+	return -1;
+}
+
+char *CSaveTee::GetString(const CSaveTeam *pTeam)
+{
+	const int HookedPlayer = HookedPlayerIndex(pTeam);
 
 	str_format(m_aString, sizeof(m_aString),
 		"%s\t%d\t%d\t%d\t%d\t%d\t"
@@ -471,6 +474,197 @@ int CSaveTee::FromString(const char *pString)
 	}
 }
 
+static void AddFloat(CAbstractPacker *pPacker, float Value)
+{
+	int Bits;
+	static_assert(sizeof(Bits) == sizeof(Value));
+	mem_copy(&Bits, &Value, sizeof(Bits));
+	pPacker->AddInt(Bits);
+}
+
+static void AddVec2(CAbstractPacker *pPacker, vec2 Value)
+{
+	AddFloat(pPacker, Value.x);
+	AddFloat(pPacker, Value.y);
+}
+
+static float GetFloat(CUnpacker *pUnpacker)
+{
+	const int Bits = pUnpacker->GetInt();
+	float Value;
+	mem_copy(&Value, &Bits, sizeof(Value));
+	return Value;
+}
+
+static vec2 GetVec2(CUnpacker *pUnpacker)
+{
+	const float x = GetFloat(pUnpacker);
+	return vec2(x, GetFloat(pUnpacker));
+}
+
+// Same fields as the text format. Unlike the text format, positions are
+// stored exactly instead of being truncated to integers.
+void CSaveTee::ToBinary(CAbstractPacker *pPacker, const CSaveTeam *pTeam) const
+{
+	pPacker->AddString(m_aName);
+	pPacker->AddInt(m_Alive);
+	pPacker->AddInt(m_Paused);
+	pPacker->AddInt(m_NeededFaketuning);
+	pPacker->AddInt(m_TeeFinished);
+	pPacker->AddInt(m_IsSolo);
+	for(const CWeaponStat &Weapon : m_aWeapons)
+	{
+		pPacker->AddInt(Weapon.m_AmmoRegenStart);
+		pPacker->AddInt(Weapon.m_Ammo);
+		pPacker->AddInt(Weapon.m_Ammocost);
+		pPacker->AddInt(Weapon.m_Got);
+	}
+	pPacker->AddInt(m_LastWeapon);
+	pPacker->AddInt(m_QueuedWeapon);
+
+	pPacker->AddInt(m_EndlessJump);
+	pPacker->AddInt(m_Jetpack);
+	pPacker->AddInt(m_NinjaJetpack);
+	pPacker->AddInt(m_FreezeTime);
+	pPacker->AddInt(m_FreezeStart);
+	pPacker->AddInt(m_DeepFrozen);
+	pPacker->AddInt(m_EndlessHook);
+	pPacker->AddInt(m_DDRaceState);
+	pPacker->AddInt(m_HitDisabledFlags);
+	pPacker->AddInt(m_CollisionEnabled);
+	pPacker->AddInt(m_TuneZone);
+	pPacker->AddInt(m_TuneZoneOld);
+	pPacker->AddInt(m_HookHitEnabled);
+	pPacker->AddInt(m_Time);
+	AddVec2(pPacker, m_Pos);
+	AddVec2(pPacker, m_PrevPos);
+	pPacker->AddInt(m_TeleCheckpoint);
+	pPacker->AddInt(m_LastPenalty);
+	AddVec2(pPacker, m_CorePos);
+	AddVec2(pPacker, m_Vel);
+	pPacker->AddInt(m_ActiveWeapon);
+	pPacker->AddInt(m_Jumped);
+	pPacker->AddInt(m_JumpedTotal);
+	pPacker->AddInt(m_Jumps);
+	AddVec2(pPacker, m_HookPos);
+	AddVec2(pPacker, m_HookDir);
+	AddVec2(pPacker, m_HookTeleBase);
+	pPacker->AddInt(m_HookTick);
+	pPacker->AddInt(m_HookState);
+
+	pPacker->AddInt(m_TimeCpBroadcastEndTime);
+	pPacker->AddInt(m_LastTimeCp);
+	pPacker->AddInt(m_LastTimeCpBroadcasted);
+	for(float TimeCp : m_aCurrentTimeCp)
+		AddFloat(pPacker, TimeCp);
+
+	pPacker->AddInt(m_NotEligibleForFinish);
+	pPacker->AddInt(m_HasTelegunGun);
+	pPacker->AddInt(m_HasTelegunLaser);
+	pPacker->AddInt(m_HasTelegunGrenade);
+	CUuid GameUuid;
+	if(ParseUuid(&GameUuid, m_aGameUuid))
+		GameUuid = CalculateUuid("game-uuid-nonexistent@ddnet.tw");
+	pPacker->AddRaw(&GameUuid, sizeof(GameUuid));
+	pPacker->AddInt(HookedPlayerIndex(pTeam));
+	pPacker->AddInt(m_NewHook);
+	pPacker->AddInt(m_InputDirection);
+	pPacker->AddInt(m_InputJump);
+	pPacker->AddInt(m_InputFire);
+	pPacker->AddInt(m_InputHook);
+	pPacker->AddInt(m_ReloadTimer);
+	pPacker->AddInt(m_TeeStarted);
+	pPacker->AddInt(m_LiveFrozen);
+	AddVec2(pPacker, m_Ninja.m_ActivationDir);
+	pPacker->AddInt(m_Ninja.m_ActivationTick);
+	pPacker->AddInt(m_Ninja.m_CurrentMoveTime);
+	pPacker->AddInt(m_Ninja.m_OldVelAmount);
+}
+
+bool CSaveTee::FromBinary(CUnpacker *pUnpacker)
+{
+	const char *pName = pUnpacker->GetString(CUnpacker::SANITIZE_CC);
+	if(pUnpacker->Error() || str_length(pName) >= (int)sizeof(m_aName))
+		return false;
+	str_copy(m_aName, pName);
+	m_Alive = pUnpacker->GetInt();
+	m_Paused = pUnpacker->GetInt();
+	m_NeededFaketuning = pUnpacker->GetInt();
+	m_TeeFinished = pUnpacker->GetInt();
+	m_IsSolo = pUnpacker->GetInt();
+	for(CWeaponStat &Weapon : m_aWeapons)
+	{
+		Weapon.m_AmmoRegenStart = pUnpacker->GetInt();
+		Weapon.m_Ammo = pUnpacker->GetInt();
+		Weapon.m_Ammocost = pUnpacker->GetInt();
+		Weapon.m_Got = pUnpacker->GetInt();
+	}
+	m_LastWeapon = pUnpacker->GetInt();
+	m_QueuedWeapon = pUnpacker->GetInt();
+
+	m_EndlessJump = pUnpacker->GetInt();
+	m_Jetpack = pUnpacker->GetInt();
+	m_NinjaJetpack = pUnpacker->GetInt();
+	m_FreezeTime = pUnpacker->GetInt();
+	m_FreezeStart = pUnpacker->GetInt();
+	m_DeepFrozen = pUnpacker->GetInt();
+	m_EndlessHook = pUnpacker->GetInt();
+	m_DDRaceState = pUnpacker->GetInt();
+	m_HitDisabledFlags = pUnpacker->GetInt();
+	m_CollisionEnabled = pUnpacker->GetInt();
+	m_TuneZone = pUnpacker->GetInt();
+	m_TuneZoneOld = pUnpacker->GetInt();
+	m_HookHitEnabled = pUnpacker->GetInt();
+	m_Time = pUnpacker->GetInt();
+	m_Pos = GetVec2(pUnpacker);
+	m_PrevPos = GetVec2(pUnpacker);
+	m_TeleCheckpoint = pUnpacker->GetInt();
+	m_LastPenalty = pUnpacker->GetInt();
+	m_CorePos = GetVec2(pUnpacker);
+	m_Vel = GetVec2(pUnpacker);
+	m_ActiveWeapon = pUnpacker->GetInt();
+	m_Jumped = pUnpacker->GetInt();
+	m_JumpedTotal = pUnpacker->GetInt();
+	m_Jumps = pUnpacker->GetInt();
+	m_HookPos = GetVec2(pUnpacker);
+	m_HookDir = GetVec2(pUnpacker);
+	m_HookTeleBase = GetVec2(pUnpacker);
+	m_HookTick = pUnpacker->GetInt();
+	m_HookState = pUnpacker->GetInt();
+
+	m_TimeCpBroadcastEndTime = pUnpacker->GetInt();
+	m_LastTimeCp = pUnpacker->GetInt();
+	m_LastTimeCpBroadcasted = pUnpacker->GetInt();
+	for(float &TimeCp : m_aCurrentTimeCp)
+		TimeCp = GetFloat(pUnpacker);
+
+	m_NotEligibleForFinish = pUnpacker->GetInt();
+	m_HasTelegunGun = pUnpacker->GetInt();
+	m_HasTelegunLaser = pUnpacker->GetInt();
+	m_HasTelegunGrenade = pUnpacker->GetInt();
+	const unsigned char *pGameUuid = pUnpacker->GetRaw(sizeof(CUuid));
+	if(pGameUuid)
+	{
+		CUuid GameUuid;
+		mem_copy(&GameUuid, pGameUuid, sizeof(GameUuid));
+		FormatUuid(GameUuid, m_aGameUuid, sizeof(m_aGameUuid));
+	}
+	m_HookedPlayer = pUnpacker->GetInt();
+	m_NewHook = pUnpacker->GetInt();
+	m_InputDirection = pUnpacker->GetInt();
+	m_InputJump = pUnpacker->GetInt();
+	m_InputFire = pUnpacker->GetInt();
+	m_InputHook = pUnpacker->GetInt();
+	m_ReloadTimer = pUnpacker->GetInt();
+	m_TeeStarted = pUnpacker->GetInt();
+	m_LiveFrozen = pUnpacker->GetInt();
+	m_Ninja.m_ActivationDir = GetVec2(pUnpacker);
+	m_Ninja.m_ActivationTick = pUnpacker->GetInt();
+	m_Ninja.m_CurrentMoveTime = pUnpacker->GetInt();
+	m_Ninja.m_OldVelAmount = pUnpacker->GetInt();
+	return !pUnpacker->Error();
+}
+
 void CSaveTee::LoadHookedPlayer(const CSaveTeam *pTeam)
 {
 	if(m_HookedPlayer == -1)
@@ -691,7 +885,133 @@ char *CSaveTeam::GetString()
 	return m_aString;
 }
 
+char *CSaveTeam::GetBinaryString()
+{
+	// the base64 string has to fit into m_aString
+	class CSavePacker : public CAbstractPacker
+	{
+	public:
+		CSavePacker() :
+			CAbstractPacker(m_aBuffer, sizeof(m_aBuffer)) {}
+		unsigned char m_aBuffer[(sizeof(CSaveTeam::m_aString) - 2) / 4 * 3];
+	};
+	CSavePacker Packer;
+	Packer.Reset();
+	Packer.AddInt(BINARY_VERSION);
+	Packer.AddInt((int)m_TeamState);
+	Packer.AddInt(m_MembersCount);
+	Packer.AddInt(m_HighestSwitchNumber);
+	Packer.AddInt(m_TeamLocked);
+	Packer.AddInt(m_Practice);
+	for(int i = 0; i < m_MembersCount; i++)
+		m_pSavedTees[i].ToBinary(&Packer, this);
+	if(m_pSwitchers)
+	{
+		for(int i = 1; i < m_HighestSwitchNumber + 1; i++)
+		{
+			Packer.AddInt(m_pSwitchers[i].m_Status);
+			Packer.AddInt(m_pSwitchers[i].m_EndTime);
+			Packer.AddInt(m_pSwitchers[i].m_Type);
+		}
+	}
+	if(Packer.Error())
+		return GetString();
+
+	m_aString[0] = BINARY_PREFIX;
+	str_base64(m_aString + 1, sizeof(m_aString) - 1, Packer.Data(), Packer.Size());
+	return m_aString;
+}
+
 int CSaveTeam::FromString(const char *pString)
+{
+	if(pString[0] == BINARY_PREFIX)
+		return FromBinaryString(pString + 1);
+	return FromTextString(pString);
+}
+
+int CSaveTeam::FromBinaryString(const char *pString)
+{
+	// decode into the string buffer, which is unused for binary saves
+	dbg_assert(pString < m_aString || pString >= m_aString + sizeof(m_aString), "binary save must not be decoded from its own buffer");
+	const int Size = str_base64_decode(m_aString, sizeof(m_aString), pString);
+	if(Size < 0)
+	{
+		dbg_msg("load", "savegame: wrong format (invalid base64)");
+		return 1;
+	}
+
+	CUnpacker Unpacker;
+	Unpacker.Reset(m_aString, Size);
+	const int Version = Unpacker.GetInt();
+	if(Unpacker.Error() || Version != BINARY_VERSION)
+	{
+		dbg_msg("load", "savegame: unsupported binary version %d", Version);
+		return 1;
+	}
+
+	const int TeamState = Unpacker.GetInt();
+	m_MembersCount = Unpacker.GetInt();
+	m_HighestSwitchNumber = Unpacker.GetInt();
+	m_TeamLocked = Unpacker.GetInt();
+	m_Practice = Unpacker.GetInt();
+	m_TeamState = (ETeamState)TeamState;
+	if(Unpacker.Error())
+	{
+		dbg_msg("load", "failed to load teamstats");
+		return 1;
+	}
+
+	if(m_pSavedTees)
+	{
+		delete[] m_pSavedTees;
+		m_pSavedTees = nullptr;
+	}
+	if(m_pSwitchers)
+	{
+		delete[] m_pSwitchers;
+		m_pSwitchers = nullptr;
+	}
+
+	if(m_MembersCount < 0 || m_MembersCount > 64)
+	{
+		dbg_msg("load", "savegame: team has too many players");
+		return 1;
+	}
+	if(m_HighestSwitchNumber < 0 || m_HighestSwitchNumber > Size)
+	{
+		dbg_msg("load", "savegame: wrong format (invalid switcher count)");
+		return 1;
+	}
+
+	if(m_MembersCount)
+		m_pSavedTees = new CSaveTee[m_MembersCount];
+	for(int n = 0; n < m_MembersCount; n++)
+	{
+		if(!m_pSavedTees[n].FromBinary(&Unpacker))
+		{
+			dbg_msg("load", "failed to load tee");
+			return 1;
+		}
+	}
+
+	if(m_HighestSwitchNumber)
+		m_pSwitchers = new SSimpleSwitchers[m_HighestSwitchNumber + 1];
+	for(int n = 1; n < m_HighestSwitchNumber + 1; n++)
+	{
+		m_pSwitchers[n].m_Status = Unpacker.GetInt();
+		m_pSwitchers[n].m_EndTime = Unpacker.GetInt();
+		m_pSwitchers[n].m_Type = Unpacker.GetInt();
+	}
+	if(Unpacker.Error())
+	{
+		dbg_msg("load", "failed to load switcher");
+		return 1;
+	}
+
+	return 0;
+}
+
+int CSaveTeam::FromTextString(const char *pString)
 {
 	char aTeamStats[MAX_CLIENTS];
 	char aSwitcher[64];
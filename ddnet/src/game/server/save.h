@@ -8,6 +8,8 @@
 
 #include <optional>
 
+class CAbstractPacker;
+class CUnpacker;
 class IGameController;
 class CGameContext;
 class CGameWorld;
@@ -41,6 +43,8 @@ public:
 	bool Load(CCharacter *pchr, int Team, bool IsSwap = false);
 	char *GetString(const CSaveTeam *pTeam);
 	int FromString(const char *pString);
+	void ToBinary(CAbstractPacker *pPacker, const CSaveTeam *pTeam) const;
+	bool FromBinary(CUnpacker *pUnpacker);
 	void LoadHookedPlayer(const CSaveTeam *pTeam);
 	bool IsHooking() const;
 	vec2 GetPos() const { return m_Pos; }
@@ -58,6 +62,8 @@ public:
 	};
 
 private:
+	int HookedPlayerIndex(const CSaveTeam *pTeam) const;
+
 	int m_ClientId;
 
 	char m_aString[2048];
@@ -173,7 +179,11 @@ public:
 	CSaveTeam();
 	~CSaveTeam();
 	char *GetString();
+	// Compact binary encoding as base64 string for the database, falls back
+	// to the text format if the team does not fit
+	char *GetBinaryString();
 	int GetMembersCount() const { return m_MembersCount; }
+	// Accepts both the text and the binary format
 	// MatchPlayers has to be called afterwards
 	int FromString(const char *pString);
 	// returns true if a team can load, otherwise writes a nice error Message in pMessage
@@ -186,9 +196,19 @@ public:
 	// returns true if an error occurred
 	static bool HandleSaveError(ESaveResult Result, int ClientId, CGameContext *pGameContext);
 
+	enum
+	{
+		BINARY_VERSION = 1,
+	};
+	// marks binary saves, not part of the base64 alphabet and text saves start with a number
+	static constexpr char BINARY_PREFIX = '$';
+
 private:
 	CCharacter *MatchCharacter(CGameContext *pGameServer, int ClientId, int SaveId, bool KeepCurrentCharacter) const;
 
+	int FromTextString(const char *pString);
+	int FromBinaryString(const char *pString);
+
 	char m_aString[65536];
 
 	struct SSimpleSwitchers
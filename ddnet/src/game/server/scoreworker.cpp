@@ -1672,7 +1672,7 @@ bool CScoreWorker::SaveTeam(IDbConnection *pSqlServer, const ISqlData *pGameData
 	char aSaveId[UUID_MAXSTRSIZE];
 	FormatUuid(pResult->m_SaveId, aSaveId, UUID_MAXSTRSIZE);
 
-	char *pSaveState = pResult->m_SavedTeam.GetString();
+	char *pSaveState = pData->m_BinarySave ? pResult->m_SavedTeam.GetBinaryString() : pResult->m_SavedTeam.GetString();
 	char aBuf[65536];
 
 	dbg_msg("score/dbg", "code=%s failure=%d", pData->m_aCode, (int)w);
@@ -198,6 +198,7 @@ struct CSqlTeamSaveData : ISqlData
 	char m_aCode[128];
 	char m_aGeneratedCode[128];
 	char m_aServer[5];
+	bool m_BinarySave;
 };
 
 struct CSqlTeamLoadRequest : ISqlData
@@ -21,7 +21,10 @@ int CTeamsCore::Team(int ClientId) const
 void CTeamsCore::Team(int ClientId, int Team)
 {
 	dbg_assert(Team >= TEAM_FLOCK && Team <= TEAM_SUPER, "invalid team");
+	if(m_aTeam[ClientId] == Team)
+		return;
 	m_aTeam[ClientId] = Team;
+	UpdateCanCollide(ClientId);
 }
 
 bool CTeamsCore::CanKeepHook(int ClientId1, int ClientId2) const
@@ -31,7 +34,7 @@ bool CTeamsCore::CanKeepHook(int ClientId1, int ClientId2) const
 	return m_aTeam[ClientId1] == m_aTeam[ClientId2];
 }
 
-bool CTeamsCore::CanCollide(int ClientId1, int ClientId2) const
+bool CTeamsCore::CalculateCanCollide(int ClientId1, int ClientId2) const
 {
 	if(m_aTeam[ClientId1] == (m_IsDDRace16 ? VANILLA_TEAM_SUPER : TEAM_SUPER) || m_aTeam[ClientId2] == (m_IsDDRace16 ? VANILLA_TEAM_SUPER : TEAM_SUPER) || ClientId1 == ClientId2)
 		return true;
@@ -40,6 +43,38 @@ bool CTeamsCore::CanCollide(int ClientId1, int ClientId2) const
 	return m_aTeam[ClientId1] == m_aTeam[ClientId2];
 }
 
+void CTeamsCore::UpdateCanCollide(int ClientId)
+{
+	// the whole mask is rebuilt anyway
+	if(m_CanCollideOutdated)
+		return;
+
+	// the pairs are symmetric, so the row and the column of the client change
+	for(int i = 0; i < MAX_CLIENTS; ++i)
+	{
+		const uint64_t Collide = CalculateCanCollide(ClientId, i);
+		uint64_t &Row = m_aaCanCollide[ClientId][i / 64];
+		uint64_t &Column = m_aaCanCollide[i][ClientId / 64];
+		Row = (Row & ~((uint64_t)1 << (i % 64))) | (Collide << (i % 64));
+		Column = (Column & ~((uint64_t)1 << (ClientId % 64))) | (Collide << (ClientId % 64));
+	}
+}
+
+void CTeamsCore::UpdateCanCollide() const
+{
+	for(int i = 0; i < MAX_CLIENTS; ++i)
+	{
+		for(int Word = 0; Word < MAX_CLIENTS / 64; ++Word)
+		{
+			uint64_t Bits = 0;
+			for(int Bit = 0; Bit < 64; ++Bit)
+				Bits |= (uint64_t)CalculateCanCollide(i, Word * 64 + Bit) << Bit;
+			m_aaCanCollide[i][Word] = Bits;
+		}
+	}
+	m_CanCollideOutdated = false;
+}
+
 void CTeamsCore::Reset()
 {
 	m_IsDDRace16 = false;
@@ -52,12 +87,24 @@ void CTeamsCore::Reset()
 			m_aTeam[i] = TEAM_FLOCK;
 		m_aIsSolo[i] = false;
 	}
+	m_CanCollideOutdated = true;
 }
 
 void CTeamsCore::SetSolo(int ClientId, bool Value)
 {
 	dbg_assert(ClientId >= 0 && ClientId < MAX_CLIENTS, "Invalid client id");
+	if(m_aIsSolo[ClientId] == Value)
+		return;
 	m_aIsSolo[ClientId] = Value;
+	UpdateCanCollide(ClientId);
+}
+
+void CTeamsCore::SetDDRace16(bool IsDDRace16)
+{
+	if(m_IsDDRace16 == IsDDRace16)
+		return;
+	m_IsDDRace16 = IsDDRace16;
+	m_CanCollideOutdated = true;
 }
 
 bool CTeamsCore::GetSolo(int ClientId) const
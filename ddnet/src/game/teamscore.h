@@ -4,6 +4,8 @@
 
 #include <engine/shared/protocol.h>
 
+#include <cstdint>
+
 enum
 {
 	TEAM_FLOCK = 0,
@@ -25,16 +27,31 @@ class CTeamsCore
 {
 	int m_aTeam[MAX_CLIENTS];
 	bool m_aIsSolo[MAX_CLIENTS];
-
-public:
 	bool m_IsDDRace16;
 
+	// whether each pair of clients can collide, one bit per client, kept up to date
+	// when a team, solo or the super team changes so that the physics only test a bit,
+	// rebuilt on the first test after a reset or a change of the super team
+	mutable uint64_t m_aaCanCollide[MAX_CLIENTS][MAX_CLIENTS / 64];
+	mutable bool m_CanCollideOutdated;
+	static_assert(MAX_CLIENTS % 64 == 0);
+
+	bool CalculateCanCollide(int ClientId1, int ClientId2) const;
+	void UpdateCanCollide(int ClientId);
+	void UpdateCanCollide() const;
+
+public:
 	CTeamsCore();
 
 	bool SameTeam(int ClientId1, int ClientId2) const;
 
 	bool CanKeepHook(int ClientId1, int ClientId2) const;
-	bool CanCollide(int ClientId1, int ClientId2) const;
+	bool CanCollide(int ClientId1, int ClientId2) const
+	{
+		if(m_CanCollideOutdated)
+			UpdateCanCollide();
+		return (m_aaCanCollide[ClientId1][ClientId2 / 64] >> (ClientId2 % 64)) & 1;
+	}
 
 	int Team(int ClientId) const;
 	void Team(int ClientId, int Team);
@@ -42,6 +59,9 @@ public:
 	void Reset();
 	void SetSolo(int ClientId, bool Value);
 	bool GetSolo(int ClientId) const;
+
+	bool IsDDRace16() const { return m_IsDDRace16; }
+	void SetDDRace16(bool IsDDRace16);
 };
 
 #endif
@@ -38,7 +38,11 @@ protected:
 		aio_close(m_pAio);
 		aio_wait(m_pAio);
 		aio_free(m_pAio);
+		ExpectFile(pOutput);
+	}
 
+	void ExpectFile(const char *pOutput)
+	{
 		char aBuf[BUF_SIZE];
 		IOHANDLE File = io_open(m_Info.m_aFilename, IOFLAG_READ);
 		ASSERT_TRUE(File);
@@ -144,3 +148,92 @@ TEST_F(Async, Transaction)
 	}
 	Expect(aText);
 }
+
+TEST_F(Async, Stats)
+{
+	static const int NUM_LETTERS = 13;
+	static const int SIZE = BUF_SIZE / NUM_LETTERS * NUM_LETTERS;
+	char aText[SIZE + 1];
+	for(unsigned i = 0; i < sizeof(aText) - 1; i++)
+	{
+		aText[i] = 'a' + i % NUM_LETTERS;
+	}
+	aText[sizeof(aText) - 1] = 0;
+	for(unsigned i = 0; i < (sizeof(aText) - 1) / NUM_LETTERS; i++)
+	{
+		Write("abcdefghijklm");
+	}
+	aio_close(m_pAio);
+	aio_wait(m_pAio);
+
+	ASYNCIO_STATS Stats;
+	aio_stats(m_pAio, &Stats);
+	aio_free(m_pAio);
+	EXPECT_EQ(Stats.queued_bytes, 0u);
+	EXPECT_EQ(Stats.written_bytes, (uint64_t)SIZE);
+	EXPECT_GE(Stats.writes, 1u);
+	EXPECT_LE(Stats.writes, (uint64_t)SIZE / NUM_LETTERS);
+	EXPECT_GE(Stats.max_latency, 0);
+	EXPECT_GE(Stats.total_latency, Stats.max_latency);
+	ExpectFile(aText);
+}
+
+TEST(AsyncHandle, SharedWithFile)
+{
+	// data written to the handle before and after the asynchronous writes
+	// must end up around them
+	CTestInfo Info;
+	IOHANDLE File = io_open(Info.m_aFilename, IOFLAG_WRITE);
+	ASSERT_TRUE(File);
+	io_write(File, "abc", 3);
+	ASYNCIO *pAio = aio_new(File);
+	aio_write(pAio, "def", 3);
+	aio_wait(pAio);
+	EXPECT_EQ(aio_error(pAio), 0);
+	aio_free(pAio);
+	io_write(File, "ghi", 3);
+	io_close(File);
+
+	char aBuf[16];
+	File = io_open(Info.m_aFilename, IOFLAG_READ);
+	ASSERT_TRUE(File);
+	const int Read = io_read(File, aBuf, sizeof(aBuf));
+	io_close(File);
+	ASSERT_EQ(Read, 9);
+	EXPECT_EQ(mem_comp(aBuf, "abcdefghi", 9), 0);
+	fs_remove(Info.m_aFilename);
+}
+
+TEST(AsyncHandle, InterleavedWithFile)
+{
+	// other writes to the same file while the handle is in use, like stderr
+	// redirected to the same log file, must not overwrite the asynchronous
+	// writes
+	CTestInfo Info;
+	IOHANDLE File = io_open(Info.m_aFilename, IOFLAG_WRITE);
+	ASSERT_TRUE(File);
+	ASYNCIO *pAio = aio_new(File);
+	aio_write(pAio, "abc", 3);
+	ASYNCIO_STATS Stats;
+	do
+	{
+		thread_yield();
+		aio_stats(pAio, &Stats);
+	} while(Stats.written_bytes < 3);
+	io_write(File, "def", 3);
+	io_flush(File);
+	aio_write(pAio, "ghi", 3);
+	aio_wait(pAio);
+	EXPECT_EQ(aio_error(pAio), 0);
+	aio_free(pAio);
+	io_close(File);
+
+	char aBuf[16];
+	File = io_open(Info.m_aFilename, IOFLAG_READ);
+	ASSERT_TRUE(File);
+	const int Read = io_read(File, aBuf, sizeof(aBuf));
+	io_close(File);
+	ASSERT_EQ(Read, 9);
+	EXPECT_EQ(mem_comp(aBuf, "abcdefghi", 9), 0);
+	fs_remove(Info.m_aFilename);
+}
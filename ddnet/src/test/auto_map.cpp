@@ -0,0 +1,172 @@
+#include <gtest/gtest.h>
+
+#include <base/system.h>
+
+#include <engine/shared/jobs.h>
+#include <engine/shared/linereader.h>
+
+#include <game/editor/auto_map_rules.h>
+#include <game/mapitems.h>
+
+#include <vector>
+
+static void LoadRules(CAutoMapRules &Rules, const char *pRules)
+{
+	const int Size = str_length(pRules) + 1;
+	char *pBuffer = (char *)malloc(Size);
+	str_copy(pBuffer, pRules, Size);
+	CLineReader LineReader;
+	LineReader.OpenBuffer(pBuffer);
+	Rules.Load(LineReader);
+}
+
+// Layer from rows of characters, '#' is tile 1 and everything else is empty
+static std::vector<CTile> Layer(std::initializer_list<const char *> Rows)
+{
+	std::vector<CTile> vTiles;
+	for(const char *pRow : Rows)
+		for(const char *p = pRow; *p; p++)
+			vTiles.push_back(CTile{(unsigned char)(*p == '#' ? 1 : 0), 0, 0, 0});
+	return vTiles;
+}
+
+static std::vector<int> Indices(const std::vector<CTile> &vTiles)
+{
+	std::vector<int> vIndices;
+	for(const CTile &Tile : vTiles)
+		vIndices.push_back(Tile.m_Index);
+	return vIndices;
+}
+
+TEST(AutoMap, Configs)
+{
+	CAutoMapRules Rules;
+	LoadRules(Rules, "[First]\nIndex 1\n[Second]\nIndex 1\n");
+	ASSERT_EQ(Rules.NumConfigs(), 2);
+	EXPECT_STREQ(Rules.ConfigName(0), "First");
+	EXPECT_STREQ(Rules.ConfigName(1), "Second");
+	EXPECT_STREQ(Rules.ConfigName(2), "(unknown)");
+	Rules.Clear();
+	EXPECT_EQ(Rules.NumConfigs(), 0);
+}
+
+TEST(AutoMap, PosRules)
+{
+	CAutoMapRules Rules;
+	LoadRules(Rules,
+		"[Surface]\n"
+		"Index 1\n"
+		"Index 2\n"
+		"Pos 0 -1 EMPTY\n"
+		"Index 3 XFLIP\n"
+		"Pos 0 -1 EMPTY\n"
+		"Pos 1 0 INDEX 1 OR 2\n"
+		"Pos -1 0 NOTINDEX 1\n");
+
+	std::vector<CTile> vTiles = Layer({
+		"....",
+		".###",
+		".###",
+	});
+	std::vector<uint8_t> vChanged(vTiles.size());
+	Rules.Proceed(vTiles.data(), 4, 3, nullptr, 0, 0, -1, 0, 1, 0, 0, vChanged.data(), 1);
+	EXPECT_EQ(Indices(vTiles), (std::vector<int>{
+					   0, 0, 0, 0,
+					   0, 3, 2, 2,
+					   0, 1, 1, 1,
+				   }));
+	EXPECT_EQ(vTiles[5].m_Flags, TILEFLAG_XFLIP);
+	EXPECT_EQ(vChanged, (std::vector<uint8_t>{
+				    0, 0, 0, 0,
+				    0, 1, 1, 1,
+				    0, 1, 1, 1,
+			    }));
+}
+
+TEST(AutoMap, NoLayerCopy)
+{
+	// without a copy, the rule sees the tiles it already changed on the left
+	const char *pRules =
+		"[Copy]\n"
+		"Index 2\n"
+		"Pos -1 0 NOTINDEX 1\n"
+		"[NoCopy]\n"
+		"NoLayerCopy\n"
+		"Index 2\n"
+		"Pos -1 0 NOTINDEX 1\n";
+	CAutoMapRules Rules;
+	LoadRules(Rules, pRules);
+
+	std::vector<CTile> vCopy = Layer({".####"});
+	Rules.Proceed(vCopy.data(), 5, 1, nullptr, 0, 0, -1, 0, 1, 0, 0, nullptr, 1);
+	EXPECT_EQ(Indices(vCopy), (std::vector<int>{0, 2, 1, 1, 1}));
+
+	std::vector<CTile> vNoCopy = Layer({".####"});
+	Rules.Proceed(vNoCopy.data(), 5, 1, nullptr, 0, 0, -1, 1, 1, 0, 0, nullptr, 1);
+	EXPECT_EQ(Indices(vNoCopy), (std::vector<int>{0, 2, 2, 2, 2}));
+}
+
+TEST(AutoMap, Reference)
+{
+	CAutoMapRules Rules;
+	LoadRules(Rules, "[Reference]\nIndex 5\n");
+
+	// the first run reads the game layer, only its freeze tiles for reference 4
+	std::vector<CTile> vTiles = Layer({"##.."});
+	const std::vector<CTile> vGameTiles = {
+		CTile{TILE_SOLID, 0, 0, 0},
+		CTile{TILE_AIR, 0, 0, 0},
+		CTile{TILE_FREEZE, 0, 0, 0},
+		CTile{TILE_SOLID, 0, 0, 0},
+	};
+	Rules.Proceed(vTiles.data(), 4, 1, vGameTiles.data(), 4, 1, 4, 0, 1, 0, 0, nullptr, 1);
+	EXPECT_EQ(Indices(vTiles), (std::vector<int>{0, 0, 5, 0}));
+}
+
+TEST(AutoMap, ThreadsDeterministic)
+{
+	CAutoMapRules Rules;
+	LoadRules(Rules,
+		"[Random]\n"
+		"Index 1\n"
+		"Index 2\n"
+		"Pos 0 -1 EMPTY\n"
+		"Random 30%\n"
+		"Index 3\n"
+		"Pos 1 1 FULL\n"
+		"Random 20%\n"
+		"NewRun\n"
+		"Index 4\n"
+		"Pos 0 1 INDEX 2\n"
+		"Modulo 3 2 0 1\n");
+
+	const int Width = 300;
+	const int Height = 200;
+	std::vector<CTile> vTiles(Width * Height);
+	for(int i = 0; i < Width * Height; i++)
+		vTiles[i].m_Index = (i * 7919 % 13) < 6 ? 1 : 0;
+
+	CJobPool Pool;
+	Pool.Init(7);
+	CJobPool::SetShared(&Pool);
+
+	std::vector<CTile> vSingle = vTiles;
+	std::vector<uint8_t> vSingleChanged(vTiles.size());
+	Rules.Proceed(vSingle.data(), Width, Height, nullptr, 0, 0, -1, 0, 1234, 5, 7, vSingleChanged.data(), 1);
+	for(int NumThreads : {2, 3, 8})
+	{
+		std::vector<CTile> vMulti = vTiles;
+		std::vector<uint8_t> vMultiChanged(vTiles.size());
+		Rules.Proceed(vMulti.data(), Width, Height, nullptr, 0, 0, -1, 0, 1234, 5, 7, vMultiChanged.data(), NumThreads);
+		EXPECT_EQ(Indices(vMulti), Indices(vSingle)) << NumThreads << " threads";
+		EXPECT_EQ(vMultiChanged, vSingleChanged) << NumThreads << " threads";
+	}
+
+	CJobPool::SetShared(nullptr);
+	Pool.Shutdown();
+
+	// a different seed picks different random tiles
+	std::vector<CTile> vOtherSeed = vTiles;
+	Rules.Proceed(vOtherSeed.data(), Width, Height, nullptr, 0, 0, -1, 0, 4321, 5, 7, nullptr, 1);
+	EXPECT_NE(Indices(vOtherSeed), Indices(vSingle));
+}
@@ -0,0 +1,497 @@
+#include <gtest/gtest.h>
+
+#include <base/math.h>
+#include <base/system.h>
+
+#include <engine/map.h>
+#include <engine/shared/config.h>
+
+#include <game/collision.h>
+#include <game/layers.h>
+#include <game/mapitems.h>
+#include <game/prng.h>
+
+#include <cmath>
+#include <vector>
+
+// A map with only a game, front and tele layer, filled with random tiles
+class CRandomMap : public IMap
+{
+	CMapItemGroup m_Group;
+	CMapItemLayerTilemap m_aLayers[3];
+	std::vector<CTile> m_vGame;
+	std::vector<CTile> m_vFront;
+	std::vector<CTeleTile> m_vTele;
+
+public:
+	CRandomMap(CPrng &Prng, int Width, int Height)
+	{
+		mem_zero(&m_Group, sizeof(m_Group));
+		m_Group.m_Version = 3;
+		m_Group.m_StartLayer = 0;
+		m_Group.m_NumLayers = 3;
+
+		static const int s_aLayerFlags[] = {TILESLAYERFLAG_GAME, TILESLAYERFLAG_FRONT, TILESLAYERFLAG_TELE};
+		for(int i = 0; i < 3; i++)
+		{
+			CMapItemLayerTilemap &Layer = m_aLayers[i];
+			mem_zero(&Layer, sizeof(Layer));
+			Layer.m_Layer.m_Type = LAYERTYPE_TILES;
+			Layer.m_Version = 3;
+			Layer.m_Width = Width;
+			Layer.m_Height = Height;
+			Layer.m_Flags = s_aLayerFlags[i];
+			Layer.m_Data = 0;
+			Layer.m_Front = 1;
+			Layer.m_Tele = 2;
+		}
+
+		static const int s_aGameTiles[] = {TILE_SOLID, TILE_DEATH, TILE_NOHOOK, TILE_NOLASER, TILE_THROUGH, TILE_THROUGH_ALL, TILE_THROUGH_DIR, TILE_FREEZE, TILE_STOP, TILE_STOPS, TILE_STOPA, TILE_START, TILE_LFREEZE};
+		static const int s_aFrontTiles[] = {TILE_DEATH, TILE_NOLASER, TILE_THROUGH, TILE_THROUGH_CUT, TILE_THROUGH_ALL, TILE_THROUGH_DIR, TILE_STOP, TILE_STOPA, TILE_FINISH};
+		static const int s_aTeleTypes[] = {TILE_TELEIN, TILE_TELEINHOOK, TILE_TELEINWEAPON, TILE_TELEOUT, TILE_TELEINEVIL, TILE_TELECHECK, TILE_TELECHECKIN, TILE_TELECHECKOUT};
+		m_vGame.resize((size_t)Width * Height);
+		m_vFront.resize((size_t)Width * Height);
+		m_vTele.resize((size_t)Width * Height);
+		for(int i = 0; i < Width * Height; i++)
+		{
+			m_vGame[i] = RandomTile(Prng, s_aGameTiles, std::size(s_aGameTiles), 6);
+			m_vFront[i] = RandomTile(Prng, s_aFrontTiles, std::size(s_aFrontTiles), 20);
+			mem_zero(&m_vTele[i], sizeof(m_vTele[i]));
+			if(Prng.RandomBits() % 40 == 0)
+			{
+				m_vTele[i].m_Type = s_aTeleTypes[Prng.RandomBits() % std::size(s_aTeleTypes)];
+				m_vTele[i].m_Number = 1 + Prng.RandomBits() % 3;
+			}
+		}
+	}
+
+	static CTile RandomTile(CPrng &Prng, const int *pTiles, int NumTiles, int OneIn)
+	{
+		CTile Tile;
+		mem_zero(&Tile, sizeof(Tile));
+		if(Prng.RandomBits() % OneIn == 0)
+		{
+			Tile.m_Index = pTiles[Prng.RandomBits() % NumTiles];
+			static const int s_aRotations[] = {ROTATION_0, ROTATION_90, ROTATION_180, ROTATION_270};
+			Tile.m_Flags = s_aRotations[Prng.RandomBits() % std::size(s_aRotations)];
+		}
+		return Tile;
+	}
+
+	int GetDataSize(int Index) const override
+	{
+		if(Index == 2)
+			return m_vTele.size() * sizeof(CTeleTile);
+		return (Index == 0 ? m_vGame : m_vFront).size() * sizeof(CTile);
+	}
+	void *GetData(int Index) override
+	{
+		if(Index == 2)
+			return m_vTele.data();
+		return (Index == 0 ? m_vGame : m_vFront).data();
+	}
+	void *GetDataSwapped(int Index) override { return GetData(Index); }
+	const char *GetDataString(int Index) override { return nullptr; }
+	void UnloadData(int Index) override {}
+	int NumData() const override { return 3; }
+
+	int GetItemSize(int Index) override { return Index == 0 ? sizeof(m_Group) : sizeof(CMapItemLayerTilemap); }
+	void *GetItem(int Index, int *pType, int *pId) override
+	{
+		if(Index == 0)
+			return &m_Group;
+		return &m_aLayers[Index - 1];
+	}
+	void GetType(int Type, int *pStart, int *pNum) override
+	{
+		*pStart = Type == MAPITEMTYPE_LAYER ? 1 : 0;
+		*pNum = Type == MAPITEMTYPE_GROUP ? 1 : Type == MAPITEMTYPE_LAYER ? 3 : 0;
+	}
+	int FindItemIndex(int Type, int Id) override { return -1; }
+	void *FindItem(int Type, int Id) override { return nullptr; }
+	int NumItems() const override { return 4; }
+};
+
+// The line checks as they were before they skipped empty tiles, they
+// test the tile under every sample of the line
+static bool RefIsSolid(const CCollision &Collision, int x, int y)
+{
+	const int Tile = Collision.GetTile(x, y);
+	return Tile == TILE_SOLID || Tile == TILE_NOHOOK;
+}
+
+static int RefIntersectLine(const CCollision &Collision, vec2 Pos0, vec2 Pos1, vec2 *pOutCollision, vec2 *pOutBeforeCollision)
+{
+	float Distance = distance(Pos0, Pos1);
+	int End(Distance + 1);
+	vec2 Last = Pos0;
+	for(int i = 0; i <= End; i++)
+	{
+		float a = i / (float)End;
+		vec2 Pos = mix(Pos0, Pos1, a);
+		int ix = round_to_int(Pos.x);
+		int iy = round_to_int(Pos.y);
+		if(RefIsSolid(Collision, ix, iy))
+		{
+			*pOutCollision = Pos;
+			*pOutBeforeCollision = Last;
+			return Collision.GetCollisionAt(ix, iy);
+		}
+		Last = Pos;
+	}
+	*pOutCollision = Pos1;
+	*pOutBeforeCollision = Pos1;
+	return 0;
+}
+
+static int RefIntersectLineTeleHook(const CCollision &Collision, vec2 Pos0, vec2 Pos1, vec2 *pOutCollision, vec2 *pOutBeforeCollision, int *pTeleNr)
+{
+	float Distance = distance(Pos0, Pos1);
+	int End(Distance + 1);
+	vec2 Last = Pos0;
+	int dx = 0, dy = 0;
+	ThroughOffset(Pos0, Pos1, &dx, &dy);
+	for(int i = 0; i <= End; i++)
+	{
+		float a = i / (float)End;
+		vec2 Pos = mix(Pos0, Pos1, a);
+		int ix = round_to_int(Pos.x);
+		int iy = round_to_int(Pos.y);
+
+		int Index = Collision.GetPureMapIndex(Pos);
+		*pTeleNr = g_Config.m_SvOldTeleportHook ? Collision.IsTeleport(Index) : Collision.IsTeleportHook(Index);
+		if(*pTeleNr)
+		{
+			*pOutCollision = Pos;
+			*pOutBeforeCollision = Last;
+			return TILE_TELEINHOOK;
+		}
+
+		int Hit = 0;
+		if(RefIsSolid(Collision, ix, iy))
+		{
+			if(!Collision.IsThrough(ix, iy, dx, dy, Pos0, Pos1))
+				Hit = Collision.GetCollisionAt(ix, iy);
+		}
+		else if(Collision.IsHookBlocker(ix, iy, Pos0, Pos1))
+		{
+			Hit = TILE_NOHOOK;
+		}
+		if(Hit)
+		{
+			*pOutCollision = Pos;
+			*pOutBeforeCollision = Last;
+			return Hit;
+		}
+		Last = Pos;
+	}
+	*pOutCollision = Pos1;
+	*pOutBeforeCollision = Pos1;
+	return 0;
+}
+
+static int RefIntersectLineTeleWeapon(const CCollision &Collision, vec2 Pos0, vec2 Pos1, vec2 *pOutCollision, vec2 *pOutBeforeCollision, int *pTeleNr)
+{
+	float Distance = distance(Pos0, Pos1);
+	int End(Distance + 1);
+	vec2 Last = Pos0;
+	for(int i = 0; i <= End; i++)
+	{
+		float a = i / (float)End;
+		vec2 Pos = mix(Pos0, Pos1, a);
+		int ix = round_to_int(Pos.x);
+		int iy = round_to_int(Pos.y);
+
+		int Index = Collision.GetPureMapIndex(Pos);
+		*pTeleNr = g_Config.m_SvOldTeleportWeapons ? Collision.IsTeleport(Index) : Collision.IsTeleportWeapon(Index);
+		if(*pTeleNr)
+		{
+			*pOutCollision = Pos;
+			*pOutBeforeCollision = Last;
+			return TILE_TELEINWEAPON;
+		}
+
+		if(RefIsSolid(Collision, ix, iy))
+		{
+			*pOutCollision = Pos;
+			*pOutBeforeCollision = Last;
+			return Collision.GetCollisionAt(ix, iy);
+		}
+		Last = Pos;
+	}
+	*pOutCollision = Pos1;
+	*pOutBeforeCollision = Pos1;
+	return 0;
+}
+
+static int RefIntersectNoLaser(const CCollision &Collision, vec2 Pos0, vec2 Pos1, vec2 *pOutCollision, vec2 *pOutBeforeCollision)
+{
+	float d = distance(Pos0, Pos1);
+	vec2 Last = Pos0;
+	for(int i = 0, id = std::ceil(d); i < id; i++)
+	{
+		float a = i / d;
+		vec2 Pos = mix(Pos0, Pos1, a);
+		int Nx = std::clamp(round_to_int(Pos.x) / 32, 0, Collision.GetWidth() - 1);
+		int Ny = std::clamp(round_to_int(Pos.y) / 32, 0, Collision.GetHeight() - 1);
+		if(Collision.GetIndex(Nx, Ny) == TILE_SOLID || Collision.GetIndex(Nx, Ny) == TILE_NOHOOK || Collision.GetIndex(Nx, Ny) == TILE_NOLASER || Collision.GetFrontIndex(Nx, Ny) == TILE_NOLASER)
+		{
+			*pOutCollision = Pos;
+			*pOutBeforeCollision = Last;
+			if(Collision.GetFrontIndex(Nx, Ny) == TILE_NOLASER)
+				return Collision.GetFrontCollisionAt(Pos.x, Pos.y);
+			else
+				return Collision.GetCollisionAt(Pos.x, Pos.y);
+		}
+		Last = Pos;
+	}
+	*pOutCollision = Pos1;
+	*pOutBeforeCollision = Pos1;
+	return 0;
+}
+
+static int RefIntersectNoLaserNoWalls(const CCollision &Collision, vec2 Pos0, vec2 Pos1, vec2 *pOutCollision, vec2 *pOutBeforeCollision)
+{
+	float d = distance(Pos0, Pos1);
+	vec2 Last = Pos0;
+	for(int i = 0, id = std::ceil(d); i < id; i++)
+	{
+		float a = (float)i / d;
+		vec2 Pos = mix(Pos0, Pos1, a);
+		const bool NoLaser = Collision.GetTile(round_to_int(Pos.x), round_to_int(Pos.y)) == TILE_NOLASER;
+		const bool FrontNoLaser = Collision.GetFrontTile(round_to_int(Pos.x), round_to_int(Pos.y)) == TILE_NOLASER;
+		if(NoLaser || FrontNoLaser)
+		{
+			*pOutCollision = Pos;
+			*pOutBeforeCollision = Last;
+			if(NoLaser)
+				return Collision.GetCollisionAt(Pos.x, Pos.y);
+			else
+				return Collision.GetFrontCollisionAt(Pos.x, Pos.y);
+		}
+		Last = Pos;
+	}
+	*pOutCollision = Pos1;
+	*pOutBeforeCollision = Pos1;
+	return 0;
+}
+
+static bool RefTileExists(const CCollision &Collision, int Index)
+{
+	const auto &&IsSpecial = [](int Tile) {
+		return (Tile >= TILE_FREEZE && Tile <= TILE_TELE_LASER_DISABLE) || (Tile >= TILE_LFREEZE && Tile <= TILE_LUNFREEZE);
+	};
+	if(IsSpecial(Collision.GetTileIndex(Index)) || IsSpecial(Collision.GetFrontTileIndex(Index)))
+		return true;
+	const int TeleType = Collision.TeleLayer()[Index].m_Type;
+	if(TeleType == TILE_TELEIN || TeleType == TILE_TELEINEVIL || TeleType == TILE_TELECHECKINEVIL || TeleType == TILE_TELECHECK || TeleType == TILE_TELECHECKIN)
+		return true;
+	// the random map has no speedup, switch and tune layers
+	return Collision.TileExistsNext(Index);
+}
+
+static std::vector<int> RefGetMapIndices(const CCollision &Collision, vec2 PrevPos, vec2 Pos)
+{
+	std::vector<int> vIndices;
+	float d = distance(PrevPos, Pos);
+	int End(d + 1);
+	if(!d)
+	{
+		int Nx = std::clamp((int)Pos.x / 32, 0, Collision.GetWidth() - 1);
+		int Ny = std::clamp((int)Pos.y / 32, 0, Collision.GetHeight() - 1);
+		int Index = Ny * Collision.GetWidth() + Nx;
+		if(RefTileExists(Collision, Index))
+			vIndices.push_back(Index);
+		return vIndices;
+	}
+	int LastIndex = 0;
+	for(int i = 0; i < End; i++)
+	{
+		float a = i / d;
+		vec2 Tmp = mix(PrevPos, Pos, a);
+		int Nx = std::clamp((int)Tmp.x / 32, 0, Collision.GetWidth() - 1);
+		int Ny = std::clamp((int)Tmp.y / 32, 0, Collision.GetHeight() - 1);
+		int Index = Ny * Collision.GetWidth() + Nx;
+		if(RefTileExists(Collision, Index) && LastIndex != Index)
+		{
+			vIndices.push_back(Index);
+			LastIndex = Index;
+		}
+	}
+	return vIndices;
+}
+
+class CollisionMasks : public ::testing::Test
+{
+protected:
+	CPrng m_Prng;
+
+	CollisionMasks()
+	{
+		uint64_t aSeed[2] = {4, 2};
+		m_Prng.Seed(aSeed);
+	}
+
+	float RandomCoordinate(int Size)
+	{
+		// also outside of the map, where the border tiles are used
+		return (m_Prng.RandomBits() % ((Size * 32 + 200) * 16)) / 16.0f - 100.0f;
+	}
+
+	vec2 RandomPos(const CCollision &Collision)
+	{
+		return vec2(RandomCoordinate(Collision.GetWidth()), RandomCoordinate(Collision.GetHeight()));
+	}
+
+	vec2 RandomLineEnd(const CCollision &Collision, vec2 Pos0)
+	{
+		switch(m_Prng.RandomBits() % 4)
+		{
+		case 0: return RandomPos(Collision);
+		case 1: return Pos0 + vec2((int)(m_Prng.RandomBits() % 400) - 200, 0);
+		case 2: return Pos0 + vec2(0, (int)(m_Prng.RandomBits() % 400) - 200);
+		default: return Pos0 + vec2((int)(m_Prng.RandomBits() % 200) - 100, (int)(m_Prng.RandomBits() % 200) - 100) / 3.0f;
+		}
+	}
+
+	void ExpectSameLines(const CCollision &Collision, int NumLines)
+	{
+		for(int i = 0; i < NumLines; i++)
+		{
+			const vec2 Pos0 = RandomPos(Collision);
+			const vec2 Pos1 = RandomLineEnd(Collision, Pos0);
+			vec2 aCol[2], aBefore[2];
+			int aTeleNr[2];
+
+			EXPECT_EQ(Collision.IntersectLine(Pos0, Pos1, &aCol[0], &aBefore[0]), RefIntersectLine(Collision, Pos0, Pos1, &aCol[1], &aBefore[1]));
+			EXPECT_EQ(aCol[0], aCol[1]);
+			EXPECT_EQ(aBefore[0], aBefore[1]);
+
+			EXPECT_EQ(Collision.IntersectLineTeleHook(Pos0, Pos1, &aCol[0], &aBefore[0], &aTeleNr[0]), RefIntersectLineTeleHook(Collision, Pos0, Pos1, &aCol[1], &aBefore[1], &aTeleNr[1]));
+			EXPECT_EQ(aCol[0], aCol[1]);
+			EXPECT_EQ(aBefore[0], aBefore[1]);
+			EXPECT_EQ(aTeleNr[0], aTeleNr[1]);
+
+			EXPECT_EQ(Collision.IntersectLineTeleWeapon(Pos0, Pos1, &aCol[0], &aBefore[0], &aTeleNr[0]), RefIntersectLineTeleWeapon(Collision, Pos0, Pos1, &aCol[1], &aBefore[1], &aTeleNr[1]));
+			EXPECT_EQ(aCol[0], aCol[1]);
+			EXPECT_EQ(aBefore[0], aBefore[1]);
+			EXPECT_EQ(aTeleNr[0], aTeleNr[1]);
+
+			EXPECT_EQ(Collision.IntersectNoLaser(Pos0, Pos1, &aCol[0], &aBefore[0]), RefIntersectNoLaser(Collision, Pos0, Pos1, &aCol[1], &aBefore[1]));
+			EXPECT_EQ(aCol[0], aCol[1]);
+			EXPECT_EQ(aBefore[0], aBefore[1]);
+
+			EXPECT_EQ(Collision.IntersectNoLaserNoWalls(Pos0, Pos1, &aCol[0], &aBefore[0]), RefIntersectNoLaserNoWalls(Collision, Pos0, Pos1, &aCol[1], &aBefore[1]));
+			EXPECT_EQ(aCol[0], aCol[1]);
+			EXPECT_EQ(aBefore[0], aBefore[1]);
+
+			if(HasFailure())
+			{
+				FAIL() << "line from (" << Pos0.x << ", " << Pos0.y << ") to (" << Pos1.x << ", " << Pos1.y << ")";
+			}
+		}
+	}
+
+	void ExpectSameMapIndices(const CCollision &Collision, int NumLines)
+	{
+		for(int Index = 0; Index < Collision.GetWidth() * Collision.GetHeight(); Index++)
+		{
+			ASSERT_EQ(Collision.TileExists(Index), RefTileExists(Collision, Index)) << Index;
+		}
+		EXPECT_FALSE(Collision.TileExists(-1));
+
+		for(int i = 0; i < NumLines; i++)
+		{
+			const vec2 PrevPos = RandomPos(Collision);
+			const vec2 Pos = i % 10 == 0 ? PrevPos : RandomLineEnd(Collision, PrevPos);
+			const std::vector<int> vExpected = RefGetMapIndices(Collision, PrevPos, Pos);
+			ASSERT_EQ(Collision.GetMapIndices(PrevPos, Pos), vExpected);
+
+			std::vector<int> vIndices;
+			const unsigned MaxIndices = 1 + m_Prng.RandomBits() % 3;
+			const int NumIndices = Collision.ForEachMapIndex(PrevPos, Pos, [&](int Index) {
+				vIndices.push_back(Index);
+				return vIndices.size() < MaxIndices;
+			});
+			ASSERT_EQ(NumIndices, (int)vIndices.size());
+			ASSERT_EQ(vIndices, std::vector<int>(vExpected.begin(), vExpected.begin() + minimum<size_t>(vExpected.size(), MaxIndices)));
+		}
+	}
+
+	void ExpectSamePoints(const CCollision &Collision)
+	{
+		for(int y = -40; y < Collision.GetHeight() * 32 + 40; y++)
+		{
+			for(int x = -40; x < Collision.GetWidth() * 32 + 40; x++)
+			{
+				ASSERT_EQ(Collision.CheckPoint(x, y), RefIsSolid(Collision, x, y)) << x << ", " << y;
+				ASSERT_EQ(Collision.IsNoLaser(x, y), Collision.GetTile(x, y) == TILE_NOLASER) << x << ", " << y;
+				ASSERT_EQ(Collision.IsFrontNoLaser(x, y), Collision.GetFrontTile(x, y) == TILE_NOLASER) << x << ", " << y;
+			}
+		}
+	}
+};
+
+TEST_F(CollisionMasks, Points)
+{
+	for(int Width : {1, 63, 64, 65, 130})
+	{
+		CRandomMap Map(m_Prng, Width, 7);
+		CLayers Layers;
+		Layers.Init(&Map, false);
+		CCollision Collision;
+		Collision.Init(&Layers);
+		ExpectSamePoints(Collision);
+	}
+}
+
+TEST_F(CollisionMasks, Lines)
+{
+	for(int Width : {1, 20, 64, 100})
+	{
+		CRandomMap Map(m_Prng, Width, 50);
+		CLayers Layers;
+		Layers.Init(&Map, false);
+		CCollision Collision;
+		Collision.Init(&Layers);
+		ExpectSameLines(Collision, 5000);
+
+		g_Config.m_SvOldTeleportHook = 1;
+		g_Config.m_SvOldTeleportWeapons = 1;
+		ExpectSameLines(Collision, 1000);
+		g_Config.m_SvOldTeleportHook = 0;
+		g_Config.m_SvOldTeleportWeapons = 0;
+	}
+}
+
+TEST_F(CollisionMasks, SetCollisionAt)
+{
+	CRandomMap Map(m_Prng, 80, 30);
+	CLayers Layers;
+	Layers.Init(&Map, false);
+	CCollision Collision;
+	Collision.Init(&Layers);
+
+	static const int s_aTiles[] = {TILE_AIR, TILE_SOLID, TILE_NOHOOK, TILE_NOLASER, TILE_THROUGH_ALL, TILE_FREEZE, TILE_STOPS, TILE_STOPA};
+	for(int i = 0; i < 500; i++)
+	{
+		const vec2 Pos = RandomPos(Collision);
+		Collision.SetCollisionAt(Pos.x, Pos.y, s_aTiles[m_Prng.RandomBits() % std::size(s_aTiles)]);
+	}
+	ExpectSamePoints(Collision);
+	ExpectSameLines(Collision, 3000);
+	ExpectSameMapIndices(Collision, 3000);
+}
+
+TEST_F(CollisionMasks, MapIndices)
+{
+	for(int Width : {1, 20, 64, 100})
+	{
+		CRandomMap Map(m_Prng, Width, 50);
+		CLayers Layers;
+		Layers.Init(&Map, false);
+		CCollision Collision;
+		Collision.Init(&Layers);
+		ExpectSameMapIndices(Collision, 5000);
+	}
+}
@@ -16,13 +16,21 @@
 #include <engine/shared/assertion_logger.h>
 #include <engine/shared/config.h>
 #include <game/generated/protocol.h>
+#include <game/mapitems.h>
 #include <game/server/entities/character.h>
+#include <game/server/entities/dragger.h>
+#include <game/server/entities/dragger_beam.h>
+#include <game/server/entities/gun.h>
+#include <game/server/entities/light.h>
+#include <game/server/entities/plasma.h>
 #include <game/server/gamecontext.h>
 #include <game/server/gameworld.h>
 #include <game/version.h>
 
+#include <algorithm>
 #include <memory>
 #include <thread>
+#include <vector>
 
 bool IsInterrupted()
 {
@@ -261,3 +269,233 @@ TEST_F(CTestGameWorld, BasicTick)
 
 	GameServer()->OnTick();
 }
+
+TEST_F(CTestGameWorld, SleepingSwitches)
+{
+	CGameWorld &World = GameServer()->m_World;
+	World.m_Core.InitSwitchers(2);
+	for(auto &Switcher : World.m_Core.m_vSwitchers)
+		std::fill(std::begin(Switcher.m_aStatus), std::end(Switcher.m_aStatus), false);
+	World.m_Core.m_vSwitchers[2].m_aStatus[0] = true;
+
+	g_Config.m_SvEntitySleeping = 0;
+	World.Tick();
+	EXPECT_FALSE(World.SwitchSleeping(1));
+
+	g_Config.m_SvEntitySleeping = 1;
+	World.Tick();
+	EXPECT_FALSE(World.SwitchSleeping(0));
+	EXPECT_TRUE(World.SwitchSleeping(1));
+	EXPECT_FALSE(World.SwitchSleeping(2));
+	EXPECT_FALSE(World.SwitchSleeping(3));
+
+	// the switch wakes up with the next tick after it is activated for any team
+	World.m_Core.m_vSwitchers[1].m_aStatus[TEAM_SUPER] = true;
+	EXPECT_TRUE(World.SwitchSleeping(1));
+	World.Tick();
+	EXPECT_FALSE(World.SwitchSleeping(1));
+
+	g_Config.m_SvEntitySleeping = 0;
+}
+
+// The tests do not run the main loop of the server, which advances the tick
+class CTestServerTick : public IServer
+{
+public:
+	static void Set(IServer *pServer, int Tick)
+	{
+		pServer->*(&CTestServerTick::m_CurrentGameTick) = Tick;
+	}
+};
+
+// What a light, a turret and a dragger on one switch did to two characters in one tick
+struct SSwitchEntitiesState
+{
+	int m_aFreezeTime[2];
+	vec2 m_aVel[2];
+	int m_NumPlasmas;
+	int m_NumDraggerBeams;
+
+	bool operator==(const SSwitchEntitiesState &Other) const
+	{
+		return m_aFreezeTime[0] == Other.m_aFreezeTime[0] && m_aFreezeTime[1] == Other.m_aFreezeTime[1] &&
+		       m_aVel[0] == Other.m_aVel[0] && m_aVel[1] == Other.m_aVel[1] &&
+		       m_NumPlasmas == Other.m_NumPlasmas && m_NumDraggerBeams == Other.m_NumDraggerBeams;
+	}
+};
+
+static void PrintTo(const SSwitchEntitiesState &State, std::ostream *pStream)
+{
+	for(int i = 0; i < 2; i++)
+		*pStream << "character " << i << ": freeze " << State.m_aFreezeTime[i] << ", vel " << State.m_aVel[i].x << " " << State.m_aVel[i].y << "; ";
+	*pStream << "plasmas " << State.m_NumPlasmas << ", beams " << State.m_NumDraggerBeams;
+}
+
+// The ticks at which the team of the characters changes the switch of the entities
+struct SSwitchEntitiesScenario
+{
+	int m_ActivateTick;
+	// the dragger still holds a beam when the switch is deactivated
+	int m_DeactivateTick;
+	// the first character moved away from the dragger in the meantime, so it drags the second one
+	int m_ReactivateTick;
+	int m_NumTicks;
+};
+
+// A fresh server for every run, so the runs do not influence each other
+class CSwitchEntitiesRun : public CTestGameWorld
+{
+	void TestBody() override {}
+
+	// Center of the first free area of 9x9 tiles
+	vec2 FreePos()
+	{
+		const CCollision *pCollision = GameServer()->Collision();
+		for(int y = 5; y < pCollision->GetHeight() - 5; y++)
+		{
+			for(int x = 5; x < pCollision->GetWidth() - 5; x++)
+			{
+				bool Free = true;
+				for(int TileY = y - 4; Free && TileY <= y + 4; TileY++)
+				{
+					for(int TileX = x - 4; Free && TileX <= x + 4; TileX++)
+					{
+						const int Index = TileY * pCollision->GetWidth() + TileX;
+						Free = pCollision->GetTileIndex(Index) == TILE_AIR && pCollision->GetFrontTileIndex(Index) == TILE_AIR &&
+						       pCollision->GetSwitchType(Index) == 0 && pCollision->IsTeleport(Index) == 0;
+					}
+				}
+				if(Free)
+					return vec2(x * 32.0f + 16.0f, y * 32.0f + 16.0f);
+			}
+		}
+		return vec2(0.0f, 0.0f);
+	}
+
+public:
+	// Puts two characters of the same team in range of a light, a turret and a dragger on an
+	// inactive switch and ticks the world while the team changes the switch.
+	std::vector<SSwitchEntitiesState> Run(int EntitySleeping, const SSwitchEntitiesScenario &Scenario)
+	{
+		std::vector<SSwitchEntitiesState> vStates;
+
+		// spawned characters are sent their tuning, which needs the client slots of the network server
+		NETADDR BindAddr = {};
+		BindAddr.type = NETTYPE_IPV4;
+		if(!m_pServer->m_NetServer.Open(BindAddr, &m_pServer->m_ServerBan, MAX_CLIENTS, MAX_CLIENTS))
+		{
+			ADD_FAILURE() << "Failed to open the network server";
+			return vStates;
+		}
+
+		// only the entities of the test act on the characters
+		CGameWorld &World = GameServer()->m_World;
+		for(CEntity *pEnt = World.FindFirst(CGameWorld::ENTTYPE_LASER); pEnt;)
+		{
+			CEntity *pNext = pEnt->TypeNext();
+			World.RemoveEntity(pEnt);
+			pEnt->Destroy();
+			pEnt = pNext;
+		}
+
+		// a switch number that no entity of the map uses
+		const int Number = maximum<int>(World.m_Core.m_vSwitchers.size(), 1);
+		World.m_Core.m_vSwitchers.resize(Number + 1);
+		SSwitchers &Switcher = World.m_Core.m_vSwitchers[Number];
+		std::fill(std::begin(Switcher.m_aStatus), std::end(Switcher.m_aStatus), false);
+
+		const vec2 Pos = FreePos();
+		EXPECT_NE(Pos, vec2(0.0f, 0.0f));
+		CTestServerTick::Set(m_pServer, 700);
+
+		// the first character is closer to the dragger until the switch is reactivated
+		const vec2 aaPos[2][2] = {{Pos, Pos - vec2(64.0f, 0.0f)}, {Pos + vec2(0.0f, 64.0f), Pos + vec2(0.0f, 64.0f)}};
+		CCharacter *apChr[2];
+		for(int ClientId = 0; ClientId < 2; ClientId++)
+		{
+			GameServer()->CreatePlayer(ClientId, GameServer()->m_pController->GetAutoTeam(ClientId), false, -1);
+			apChr[ClientId] = GameServer()->m_apPlayers[ClientId]->ForceSpawn(aaPos[ClientId][0]);
+		}
+		EXPECT_EQ(apChr[0]->Team(), apChr[1]->Team());
+		const int Team = apChr[0]->Team();
+
+		CLight *pLight = new CLight(&World, Pos - vec2(128.0f, 0.0f), pi / 2, 256, LAYER_SWITCH, Number);
+		pLight->m_CurveLength = pLight->m_Length;
+		new CGun(&World, Pos - vec2(0.0f, 96.0f), false, false, LAYER_SWITCH, Number);
+		new CDragger(&World, Pos + vec2(96.0f, 0.0f), 1, false, LAYER_SWITCH, Number);
+
+		g_Config.m_SvEntitySleeping = EntitySleeping;
+		for(int Tick = 0; Tick < Scenario.m_NumTicks; Tick++)
+		{
+			// switches change between the world ticks
+			if(Tick == Scenario.m_ActivateTick || Tick == Scenario.m_ReactivateTick)
+				Switcher.m_aStatus[Team] = true;
+			else if(Tick == Scenario.m_DeactivateTick)
+				Switcher.m_aStatus[Team] = false;
+
+			// keep the characters in range of the entities
+			for(int i = 0; i < 2; i++)
+			{
+				const vec2 CharPos = aaPos[i][Tick >= Scenario.m_DeactivateTick];
+				apChr[i]->SetPosition(CharPos);
+				apChr[i]->m_Pos = CharPos;
+				apChr[i]->ResetVelocity();
+			}
+
+			CTestServerTick::Set(m_pServer, m_pServer->Tick() + 1);
+			World.Tick();
+
+			SSwitchEntitiesState State = {{apChr[0]->m_FreezeTime, apChr[1]->m_FreezeTime}, {apChr[0]->Core()->m_Vel, apChr[1]->Core()->m_Vel}, 0, 0};
+			for(CEntity *pEnt = World.FindFirst(CGameWorld::ENTTYPE_LASER); pEnt; pEnt = pEnt->TypeNext())
+			{
+				State.m_NumPlasmas += dynamic_cast<CPlasma *>(pEnt) != nullptr;
+				State.m_NumDraggerBeams += dynamic_cast<CDraggerBeam *>(pEnt) != nullptr;
+			}
+			vStates.push_back(State);
+		}
+		g_Config.m_SvEntitySleeping = 0;
+
+		m_pServer->m_NetServer.Close();
+		return vStates;
+	}
+};
+
+TEST(GameWorld, SleepingSwitchesUnchanged)
+{
+	const SSwitchEntitiesScenario Scenario = {20, 60, 80, 120};
+
+	std::vector<SSwitchEntitiesState> vAwake;
+	{
+		CSwitchEntitiesRun Run;
+		vAwake = Run.Run(0, Scenario);
+	}
+	std::vector<SSwitchEntitiesState> vSleeping;
+	{
+		CSwitchEntitiesRun Run;
+		vSleeping = Run.Run(1, Scenario);
+	}
+	ASSERT_EQ(vAwake.size(), (size_t)Scenario.m_NumTicks);
+	EXPECT_EQ(vSleeping, vAwake);
+
+	// the entities did nothing while the switch was inactive
+	for(int Tick = 0; Tick < Scenario.m_ActivateTick; Tick++)
+	{
+		EXPECT_EQ(vAwake[Tick].m_aFreezeTime[0], 0) << Tick;
+		EXPECT_EQ(vAwake[Tick].m_NumPlasmas, 0) << Tick;
+		EXPECT_EQ(vAwake[Tick].m_NumDraggerBeams, 0) << Tick;
+	}
+
+	// the light froze the first character and the turret fired at it while the switch was active
+	const auto ActiveBegin = vAwake.begin() + Scenario.m_ActivateTick;
+	const auto ActiveEnd = vAwake.begin() + Scenario.m_DeactivateTick;
+	EXPECT_TRUE(std::any_of(ActiveBegin, ActiveEnd, [](const SSwitchEntitiesState &State) { return State.m_aFreezeTime[0] > 0; }));
+	EXPECT_TRUE(std::any_of(ActiveBegin, ActiveEnd, [](const SSwitchEntitiesState &State) { return State.m_NumPlasmas > 0; }));
+
+	// the dragger held a beam when the switch was deactivated and released it
+	EXPECT_GT(vAwake[Scenario.m_DeactivateTick - 1].m_NumDraggerBeams, 0);
+	EXPECT_EQ(vAwake[Scenario.m_ReactivateTick - 1].m_NumDraggerBeams, 0);
+
+	// after the reactivation, the dragger drags the second character, which is closer now
+	EXPECT_GT(vAwake.back().m_NumDraggerBeams, 0);
+	EXPECT_GT(vAwake.back().m_aVel[1].x, 0.0f);
+}
@@ -0,0 +1,238 @@
+#include "test.h"
+#include <gtest/gtest.h>
+
+#include <base/math.h>
+#include <base/system.h>
+
+#include <engine/gfx/image_manipulation.h>
+
+#include <game/prng.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Straightforward implementations that the optimized ones must match exactly
+namespace Reference {
+
+static void Dilate(int w, int h, const uint8_t *pSrc, uint8_t *pDest)
+{
+	const int aDirX[] = {0, -1, 1, 0};
+	const int aDirY[] = {-1, 0, 0, 1};
+
+	int m = 0;
+	for(int y = 0; y < h; y++)
+	{
+		for(int x = 0; x < w; x++, m += 4)
+		{
+			for(int i = 0; i < 4; ++i)
+				pDest[m + i] = pSrc[m + i];
+			if(pSrc[m + 3] > 10)
+				continue;
+
+			for(int c = 0; c < 4; c++)
+			{
+				const int ClampedX = std::clamp(x + aDirX[c], 0, w - 1);
+				const int ClampedY = std::clamp(y + aDirY[c], 0, h - 1);
+				const int SrcIndex = ClampedY * w * 4 + ClampedX * 4;
+				if(pSrc[SrcIndex + 3] > 10)
+				{
+					for(int p = 0; p < 3; ++p)
+						pDest[m + p] = pSrc[SrcIndex + p];
+					pDest[m + 3] = 255;
+					break;
+				}
+			}
+		}
+	}
+}
+
+static void DilateImageSub(uint8_t *pImageBuff, int w, int h, int x, int y, int SubWidth, int SubHeight)
+{
+	const size_t ImageSize = (size_t)SubWidth * SubHeight * 4;
+	std::vector<uint8_t> vOriginal(ImageSize);
+	std::vector<uint8_t> vBuffer0(ImageSize);
+	std::vector<uint8_t> vBuffer1(ImageSize);
+
+	for(int Y = 0; Y < SubHeight; ++Y)
+		mem_copy(&vOriginal[Y * SubWidth * 4], &pImageBuff[((y + Y) * w + x) * 4], SubWidth * 4);
+
+	Dilate(SubWidth, SubHeight, vOriginal.data(), vBuffer0.data());
+	for(int i = 0; i < 5; i++)
+	{
+		Dilate(SubWidth, SubHeight, vBuffer0.data(), vBuffer1.data());
+		Dilate(SubWidth, SubHeight, vBuffer1.data(), vBuffer0.data());
+	}
+
+	for(size_t m = 0; m < ImageSize; m += 4)
+	{
+		if(vOriginal[m + 3] == 0)
+			mem_copy(&vOriginal[m], &vBuffer0[m], 3);
+	}
+
+	for(int Y = 0; Y < SubHeight; ++Y)
+		mem_copy(&pImageBuff[((y + Y) * w + x) * 4], &vOriginal[Y * SubWidth * 4], SubWidth * 4);
+}
+
+static void ConvertToGrayscale(const CImageInfo &Image)
+{
+	const size_t Step = Image.PixelSize();
+	for(size_t i = 0; i < Image.m_Width * Image.m_Height; ++i)
+	{
+		const uint8_t R = Image.m_pData[i * Step];
+		const uint8_t G = Image.m_pData[i * Step + 1];
+		const uint8_t B = Image.m_pData[i * Step + 2];
+		const uint8_t Luma = (uint8_t)(0.2126f * R + 0.7152f * G + 0.0722f * B);
+
+		Image.m_pData[i * Step] = Luma;
+		Image.m_pData[i * Step + 1] = Luma;
+		Image.m_pData[i * Step + 2] = Luma;
+	}
+}
+
+static float CubicHermite(float A, float B, float C, float D, float t)
+{
+	float a = -A / 2.0f + (3.0f * B) / 2.0f - (3.0f * C) / 2.0f + D / 2.0f;
+	float b = A - (5.0f * B) / 2.0f + 2.0f * C - D / 2.0f;
+	float c = -A / 2.0f + C / 2.0f;
+	float d = B;
+
+	return (a * t * t * t) + (b * t * t) + (c * t) + d;
+}
+
+static std::vector<uint8_t> ResizeImage(const uint8_t *pSourceImage, uint32_t SW, uint32_t SH, uint32_t W, uint32_t H, size_t BPP)
+{
+	std::vector<uint8_t> vResult((size_t)W * H * BPP);
+	for(int y = 0; y < (int)H; ++y)
+	{
+		float v = (float)y / (float)(H - 1);
+		for(int x = 0; x < (int)W; ++x)
+		{
+			float u = (float)x / (float)(W - 1);
+			float X = (u * SW) - 0.5f;
+			int xInt = (int)X;
+			float xFract = X - std::floor(X);
+			float Y = (v * SH) - 0.5f;
+			int yInt = (int)Y;
+			float yFract = Y - std::floor(Y);
+
+			for(size_t i = 0; i < BPP; i++)
+			{
+				float aRows[4];
+				for(int Row = 0; Row < 4; ++Row)
+				{
+					float aSamples[4];
+					for(int Column = 0; Column < 4; ++Column)
+					{
+						const int SampleX = std::clamp<int>(xInt + Column - 1, 0, (int)SW - 1);
+						const int SampleY = std::clamp<int>(yInt + Row - 1, 0, (int)SH - 1);
+						aSamples[Column] = pSourceImage[SampleX * BPP + (SW * BPP * SampleY) + i];
+					}
+					aRows[Row] = CubicHermite(aSamples[0], aSamples[1], aSamples[2], aSamples[3], xFract);
+				}
+				vResult[x * BPP + ((W * BPP) * y) + i] = (uint8_t)std::clamp<float>(CubicHermite(aRows[0], aRows[1], aRows[2], aRows[3], yFract), 0.0f, 255.0f);
+			}
+		}
+	}
+	return vResult;
+}
+
+} // namespace Reference
+
+static CImageInfo RandomImage(CPrng &Prng, int Width, int Height, CImageInfo::EImageFormat Format)
+{
+	CImageInfo Image;
+	Image.m_Width = Width;
+	Image.m_Height = Height;
+	Image.m_Format = Format;
+	Image.m_pData = static_cast<uint8_t *>(malloc(Image.DataSize()));
+	for(size_t i = 0; i < Image.DataSize(); ++i)
+		Image.m_pData[i] = Prng.RandomBits();
+	if(Format == CImageInfo::FORMAT_RGBA)
+	{
+		// mostly transparent regions with some opaque and barely visible pixels, like tilesets
+		for(size_t i = 3; i < Image.DataSize(); i += 4)
+		{
+			const unsigned Kind = Prng.RandomBits() % 8;
+			Image.m_pData[i] = Kind < 5 ? 0 : (Kind < 7 ? 255 : Prng.RandomBits() % 16);
+		}
+	}
+	return Image;
+}
+
+static const int IMAGE_SIZES[][2] = {{1, 1}, {1, 7}, {7, 1}, {2, 2}, {5, 3}, {9, 9}, {64, 64}, {67, 33}, {600, 301}};
+
+TEST(ImageManipulation, Dilate)
+{
+	uint64_t aSeed[2] = {1, 2};
+	CPrng Prng;
+	Prng.Seed(aSeed);
+	for(const auto &aSize : IMAGE_SIZES)
+	{
+		CImageInfo Image = RandomImage(Prng, aSize[0], aSize[1], CImageInfo::FORMAT_RGBA);
+		CImageInfo Expected = Image.DeepCopy();
+		DilateImage(Image);
+		Reference::DilateImageSub(Expected.m_pData, Expected.m_Width, Expected.m_Height, 0, 0, Expected.m_Width, Expected.m_Height);
+		EXPECT_TRUE(Image.DataEquals(Expected)) << aSize[0] << "x" << aSize[1];
+		Image.Free();
+		Expected.Free();
+	}
+}
+
+TEST(ImageManipulation, DilateSub)
+{
+	uint64_t aSeed[2] = {3, 4};
+	CPrng Prng;
+	Prng.Seed(aSeed);
+	CImageInfo Image = RandomImage(Prng, 97, 80, CImageInfo::FORMAT_RGBA);
+	CImageInfo Expected = Image.DeepCopy();
+	const int aaRects[][4] = {{0, 0, 97, 80}, {0, 0, 16, 16}, {13, 7, 31, 45}, {96, 79, 1, 1}, {0, 20, 97, 10}};
+	for(const auto &aRect : aaRects)
+	{
+		DilateImageSub(Image.m_pData, Image.m_Width, Image.m_Height, aRect[0], aRect[1], aRect[2], aRect[3]);
+		Reference::DilateImageSub(Expected.m_pData, Expected.m_Width, Expected.m_Height, aRect[0], aRect[1], aRect[2], aRect[3]);
+		EXPECT_TRUE(Image.DataEquals(Expected)) << aRect[0] << "," << aRect[1] << " " << aRect[2] << "x" << aRect[3];
+	}
+	Image.Free();
+	Expected.Free();
+}
+
+TEST(ImageManipulation, Grayscale)
+{
+	uint64_t aSeed[2] = {5, 6};
+	CPrng Prng;
+	Prng.Seed(aSeed);
+	for(CImageInfo::EImageFormat Format : {CImageInfo::FORMAT_RGB, CImageInfo::FORMAT_RGBA})
+	{
+		for(const auto &aSize : IMAGE_SIZES)
+		{
+			CImageInfo Image = RandomImage(Prng, aSize[0], aSize[1], Format);
+			CImageInfo Expected = Image.DeepCopy();
+			ConvertToGrayscale(Image);
+			Reference::ConvertToGrayscale(Expected);
+			EXPECT_TRUE(Image.DataEquals(Expected)) << aSize[0] << "x" << aSize[1];
+			Image.Free();
+			Expected.Free();
+		}
+	}
+}
+
+TEST(ImageManipulation, Resize)
+{
+	uint64_t aSeed[2] = {7, 8};
+	CPrng Prng;
+	Prng.Seed(aSeed);
+	const int aaSizes[][4] = {{64, 64, 32, 32}, {64, 64, 128, 128}, {1024, 1024, 256, 256}, {33, 17, 70, 5}, {2, 2, 3, 3}};
+	for(CImageInfo::EImageFormat Format : {CImageInfo::FORMAT_R, CImageInfo::FORMAT_RGB, CImageInfo::FORMAT_RGBA})
+	{
+		for(const auto &aSize : aaSizes)
+		{
+			CImageInfo Image = RandomImage(Prng, aSize[0], aSize[1], Format);
+			const std::vector<uint8_t> vExpected = Reference::ResizeImage(Image.m_pData, Image.m_Width, Image.m_Height, aSize[2], aSize[3], Image.PixelSize());
+			ResizeImage(Image, aSize[2], aSize[3]);
+			ASSERT_EQ(Image.DataSize(), vExpected.size());
+			EXPECT_EQ(mem_comp(Image.m_pData, vExpected.data(), vExpected.size()), 0) << aSize[0] << "x" << aSize[1] << " -> " << aSize[2] << "x" << aSize[3];
+			Image.Free();
+		}
+	}
+}
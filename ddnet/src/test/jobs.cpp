@@ -163,3 +163,39 @@ TEST_F(Jobs, Many)
 	}
 	SetUp();
 }
+
+TEST_F(Jobs, ParallelFor)
+{
+	static const int COUNT = 1000;
+	std::vector<std::atomic<int>> vCalls(COUNT);
+	std::atomic<int> NumRanges(0);
+	m_Pool.ParallelFor(COUNT, 16, [&](int Begin, int End) {
+		EXPECT_LT(Begin, End);
+		for(int i = Begin; i < End; i++)
+			vCalls[i].fetch_add(1);
+		NumRanges.fetch_add(1);
+	});
+	EXPECT_EQ(NumRanges, TEST_NUM_THREADS + 1);
+	for(int i = 0; i < COUNT; i++)
+		EXPECT_EQ(vCalls[i], 1);
+}
+
+TEST_F(Jobs, ParallelForInJob)
+{
+	SEMAPHORE sphore;
+	sphore_init(&sphore);
+	int NumRanges = 0;
+	Add(std::make_shared<CJob>([&] {
+		EXPECT_TRUE(CJobPool::IsWorkerThread());
+		m_Pool.ParallelFor(1000, 16, [&](int Begin, int End) {
+			EXPECT_EQ(Begin, 0);
+			EXPECT_EQ(End, 1000);
+			NumRanges++;
+		});
+		sphore_signal(&sphore);
+	}));
+	sphore_wait(&sphore);
+	sphore_destroy(&sphore);
+	EXPECT_FALSE(CJobPool::IsWorkerThread());
+	EXPECT_EQ(NumRanges, 1);
+}
@@ -1,7 +1,15 @@
 #include <gtest/gtest.h>
 
+#include <base/math.h>
+#include <base/system.h>
+
 #include <engine/server/name_ban.h>
 
+#include <game/prng.h>
+
+#include <algorithm>
+#include <string>
+
 TEST(NameBan, Empty)
 {
 	CNameBans Bans;
@@ -78,3 +86,70 @@ TEST(NameBan, UnbanNotFound)
 	CNameBans Bans;
 	Bans.Unban("abc");
 }
+
+// compares the indexed lookup to checking every ban in order
+TEST(NameBan, RandomNames)
+{
+	uint64_t aSeed[2] = {5, 6};
+	CPrng Prng;
+	Prng.Seed(aSeed);
+
+	// few letters, so that many names are within the ban distances
+	const auto RandomName = [&](char *pName, int Size) {
+		const int Length = 1 + Prng.RandomBits() % minimum(Size - 1, 8);
+		for(int i = 0; i < Length; i++)
+			pName[i] = "abcdeo0l1"[Prng.RandomBits() % 9];
+		pName[Length] = '\0';
+	};
+
+	CNameBans Bans;
+	std::vector<CNameBan> vExpectedBans;
+	for(int i = 0; i < 300; i++)
+	{
+		char aName[MAX_NAME_LENGTH];
+		RandomName(aName, sizeof(aName));
+		const int Distance = Prng.RandomBits() % 3;
+		const bool IsSubstring = Prng.RandomBits() % 8 == 0;
+		Bans.Ban(aName, "", Distance, IsSubstring);
+
+		auto Existing = std::find_if(vExpectedBans.begin(), vExpectedBans.end(), [&](const CNameBan &Ban) { return str_comp(Ban.m_aName, aName) == 0; });
+		if(Existing == vExpectedBans.end())
+			vExpectedBans.emplace_back(aName, "", Distance, IsSubstring);
+		else
+		{
+			Existing->m_Distance = Distance;
+			Existing->m_IsSubstring = IsSubstring;
+		}
+
+		if(i % 50 == 49)
+		{
+			const std::string Removed = vExpectedBans[Prng.RandomBits() % vExpectedBans.size()].m_aName;
+			Bans.Unban(Removed.c_str());
+			vExpectedBans.erase(std::find_if(vExpectedBans.begin(), vExpectedBans.end(), [&](const CNameBan &Ban) { return Removed == Ban.m_aName; }));
+		}
+	}
+
+	int aBuffer[MAX_NAME_SKELETON_LENGTH * 2 + 2];
+	for(int i = 0; i < 2000; i++)
+	{
+		char aName[MAX_NAME_LENGTH];
+		RandomName(aName, sizeof(aName));
+		int aSkeleton[MAX_NAME_SKELETON_LENGTH];
+		const int SkeletonLength = str_utf8_to_skeleton(aName, aSkeleton, std::size(aSkeleton));
+
+		const CNameBan *pExpected = nullptr;
+		for(const CNameBan &Ban : vExpectedBans)
+		{
+			const int Distance = str_utf32_dist_buffer(aSkeleton, SkeletonLength, Ban.m_aSkeleton, Ban.m_SkeletonLength, aBuffer, std::size(aBuffer));
+			if(Distance <= Ban.m_Distance || (Ban.m_IsSubstring && str_utf8_find_nocase(aName, Ban.m_aName)))
+				pExpected = &Ban;
+		}
+
+		const CNameBan *pActual = Bans.IsBanned(aName);
+		ASSERT_EQ(pActual != nullptr, pExpected != nullptr) << aName;
+		if(pExpected)
+		{
+			EXPECT_STREQ(pActual->m_aName, pExpected->m_aName) << aName;
+		}
+	}
+}
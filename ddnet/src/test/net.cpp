@@ -2,6 +2,8 @@
 
 #include <base/system.h>
 
+#include <engine/shared/network.h>
+
 #include <chrono>
 
 using namespace std::chrono_literals;
@@ -52,3 +54,102 @@ TEST(Net, Ipv4AndIpv6Work)
 	net_udp_close(Socket1);
 	net_udp_close(Socket2);
 }
+
+TEST(Net, ServerThread)
+{
+	CNetBase::Init();
+
+	NETADDR ServerAddr;
+	NETADDR ClientAddr;
+	ASSERT_FALSE(net_addr_from_str(&ServerAddr, "127.0.0.1"));
+	ASSERT_FALSE(net_addr_from_str(&ClientAddr, "127.0.0.1"));
+
+	NETADDR Bindaddr = {};
+	Bindaddr.type = NETTYPE_IPV4;
+	NETSOCKET ServerSocket;
+	NETSOCKET ClientSocket;
+	do
+	{
+		Bindaddr.port = secure_rand() % 64511 + 1024;
+	} while(!(ServerSocket = net_udp_create(Bindaddr)));
+	ServerAddr.port = Bindaddr.port;
+	do
+	{
+		Bindaddr.port = secure_rand() % 64511 + 1024;
+	} while(!(ClientSocket = net_udp_create(Bindaddr)));
+	ClientAddr.port = Bindaddr.port;
+
+	CNetServerThread Thread;
+	Thread.Start(ServerSocket);
+
+	// received packets arrive decoded
+	unsigned char aExtra[NET_CONNLESS_EXTRA_SIZE] = {};
+	CNetBase::SendPacketConnless(ClientSocket, &ServerAddr, "abc", 3, false, aExtra);
+	ASSERT_TRUE(Thread.WaitRecv(10s));
+	CNetServerThread::CRecvPacket *pRecvPacket = Thread.NextRecv();
+	ASSERT_NE(pRecvPacket, nullptr);
+	EXPECT_EQ(pRecvPacket->m_Result, 0);
+	EXPECT_FALSE(pRecvPacket->m_Sixup);
+	EXPECT_TRUE(pRecvPacket->m_Packet.m_Flags & NET_PACKETFLAG_CONNLESS);
+	ASSERT_EQ(pRecvPacket->m_Packet.m_DataSize, 3);
+	EXPECT_EQ(mem_comp(pRecvPacket->m_Packet.m_aChunkData, "abc", 3), 0);
+	EXPECT_EQ(Thread.NextRecv(), nullptr);
+
+	// queued packets are compressed and sent
+	CNetPacketConstruct Packet = {};
+	Packet.m_Ack = 5;
+	Packet.m_NumChunks = 1;
+	Packet.m_DataSize = 64;
+	for(int i = 0; i < Packet.m_DataSize; i++)
+		Packet.m_aChunkData[i] = i % 4;
+	Thread.SendPacket(&ClientAddr, &Packet, NET_SECURITY_TOKEN_UNSUPPORTED, false);
+
+	ASSERT_EQ(net_socket_read_wait(ClientSocket, 10s), 1);
+	NETADDR Addr;
+	unsigned char *pData;
+	const int Bytes = net_udp_recv(ClientSocket, &Addr, &pData);
+	ASSERT_GT(Bytes, 0);
+	CNetPacketConstruct Received;
+	bool Sixup = false;
+	ASSERT_EQ(CNetBase::UnpackPacket(pData, Bytes, &Received, Sixup), 0);
+	EXPECT_TRUE(Received.m_Flags & NET_PACKETFLAG_COMPRESSION);
+	EXPECT_EQ(Received.m_Ack, 5);
+	ASSERT_EQ(Received.m_DataSize, Packet.m_DataSize);
+	EXPECT_EQ(mem_comp(Received.m_aChunkData, Packet.m_aChunkData, Packet.m_DataSize), 0);
+
+	// all kinds of packets are sent in the order they were queued
+	static const int NUM_ORDERED = 64;
+	for(int i = 0; i < NUM_ORDERED; i++)
+	{
+		const unsigned char Index = i;
+		if(i % 2 == 0)
+			Thread.SendPacketConnless(&ClientAddr, &Index, sizeof(Index), false, aExtra);
+		else
+			Thread.SendControlMsg(&ClientAddr, 0, NET_CTRLMSG_CLOSE, &Index, sizeof(Index), NET_SECURITY_TOKEN_UNSUPPORTED, false);
+	}
+	for(int i = 0; i < NUM_ORDERED; i++)
+	{
+		// the socket receives multiple packets at once
+		int Size;
+		while((Size = net_udp_recv(ClientSocket, &Addr, &pData)) <= 0)
+			ASSERT_EQ(net_socket_read_wait(ClientSocket, 10s), 1);
+		ASSERT_EQ(CNetBase::UnpackPacket(pData, Size, &Received, Sixup), 0);
+		if(i % 2 == 0)
+		{
+			EXPECT_TRUE(Received.m_Flags & NET_PACKETFLAG_CONNLESS);
+			ASSERT_EQ(Received.m_DataSize, 1);
+			EXPECT_EQ(Received.m_aChunkData[0], i);
+		}
+		else
+		{
+			EXPECT_TRUE(Received.m_Flags & NET_PACKETFLAG_CONTROL);
+			ASSERT_EQ(Received.m_DataSize, 2);
+			EXPECT_EQ(Received.m_aChunkData[0], NET_CTRLMSG_CLOSE);
+			EXPECT_EQ(Received.m_aChunkData[1], i);
+		}
+	}
+
+	Thread.Stop();
+	net_udp_close(ClientSocket);
+	net_udp_close(ServerSocket);
+}
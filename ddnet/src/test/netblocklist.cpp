@@ -0,0 +1,193 @@
+#include <gtest/gtest.h>
+
+#include <base/system.h>
+
+#include <engine/shared/netban.h>
+#include <engine/shared/netblocklist.h>
+
+#include <game/prng.h>
+
+#include <vector>
+
+static NETADDR ParseAddr(const char *pStr)
+{
+	NETADDR Addr;
+	EXPECT_EQ(net_addr_from_str(&Addr, pStr), 0) << pStr;
+	return Addr;
+}
+
+static bool Contains(const CNetBlocklist &Blocklist, const char *pAddr)
+{
+	const NETADDR Addr = ParseAddr(pAddr);
+	return Blocklist.Contains(&Addr);
+}
+
+static CNetBlocklist BuildBlocklist(const char *pText, int *pNumInvalid = nullptr)
+{
+	std::vector<CNetBlocklist::CPrefix> vPrefixes;
+	const int NumInvalid = CNetBlocklist::ParseText(vPrefixes, pText, str_length(pText));
+	if(pNumInvalid)
+		*pNumInvalid = NumInvalid;
+	CNetBlocklist Blocklist;
+	Blocklist.Build(vPrefixes);
+	return Blocklist;
+}
+
+TEST(NetBlocklist, Empty)
+{
+	CNetBlocklist Blocklist;
+	EXPECT_FALSE(Contains(Blocklist, "127.0.0.1"));
+	EXPECT_EQ(Blocklist.NumPrefixes(), 0);
+}
+
+TEST(NetBlocklist, ParseText)
+{
+	int NumInvalid;
+	const CNetBlocklist Blocklist = BuildBlocklist(
+		"# comment\n"
+		"\n"
+		"192.0.2.0/24\n"
+		"198.51.100.7 ; single address\r\n"
+		"203.0.113.10 - 203.0.113.20\n"
+		"2001:db8::/32\n"
+		"[2001:db9::1]\n"
+		"10.0.0.0/33\n"
+		"not an address\n"
+		"203.0.113.30-203.0.113.29",
+		&NumInvalid);
+	EXPECT_EQ(NumInvalid, 3);
+
+	EXPECT_TRUE(Contains(Blocklist, "192.0.2.0"));
+	EXPECT_TRUE(Contains(Blocklist, "192.0.2.255"));
+	EXPECT_FALSE(Contains(Blocklist, "192.0.3.0"));
+	EXPECT_TRUE(Contains(Blocklist, "198.51.100.7"));
+	EXPECT_FALSE(Contains(Blocklist, "198.51.100.8"));
+	EXPECT_FALSE(Contains(Blocklist, "203.0.113.9"));
+	EXPECT_TRUE(Contains(Blocklist, "203.0.113.10"));
+	EXPECT_TRUE(Contains(Blocklist, "203.0.113.15"));
+	EXPECT_TRUE(Contains(Blocklist, "203.0.113.20"));
+	EXPECT_FALSE(Contains(Blocklist, "203.0.113.21"));
+	EXPECT_TRUE(Contains(Blocklist, "[2001:db8:1234::1]"));
+	EXPECT_FALSE(Contains(Blocklist, "[2001:db7::1]"));
+	EXPECT_TRUE(Contains(Blocklist, "[2001:db9::1]"));
+	EXPECT_FALSE(Contains(Blocklist, "[2001:db9::2]"));
+
+	// IPv4 prefixes do not match the IPv6 address space
+	EXPECT_FALSE(Contains(Blocklist, "[c000:200::]"));
+}
+
+TEST(NetBlocklist, CoveredPrefixes)
+{
+	const CNetBlocklist Blocklist = BuildBlocklist(
+		"10.1.2.3\n"
+		"10.1.0.0/16\n"
+		"10.0.0.0/8\n"
+		"10.2.0.0/16\n"
+		"11.0.0.0/8\n");
+	EXPECT_EQ(Blocklist.NumPrefixes(), 2);
+	EXPECT_TRUE(Contains(Blocklist, "10.200.0.1"));
+	EXPECT_TRUE(Contains(Blocklist, "11.0.0.1"));
+	EXPECT_FALSE(Contains(Blocklist, "12.0.0.1"));
+}
+
+TEST(NetBlocklist, WholeAddressSpace)
+{
+	const CNetBlocklist Blocklist = BuildBlocklist("0.0.0.0/0\n");
+	EXPECT_TRUE(Contains(Blocklist, "0.0.0.0"));
+	EXPECT_TRUE(Contains(Blocklist, "255.255.255.255"));
+	EXPECT_FALSE(Contains(Blocklist, "[::1]"));
+
+	const CNetBlocklist BlocklistRange = BuildBlocklist(":: - ffff:ffff:ffff:ffff:ffff:ffff:ffff:ffff\n");
+	EXPECT_EQ(BlocklistRange.NumPrefixes(), 1);
+	EXPECT_TRUE(Contains(BlocklistRange, "[::1]"));
+	EXPECT_TRUE(Contains(BlocklistRange, "1.2.3.4"));
+}
+
+// compares the trie to checking every range for random ranges and addresses
+TEST(NetBlocklist, RandomRanges)
+{
+	uint64_t aSeed[2] = {3, 4};
+	CPrng Prng;
+	Prng.Seed(aSeed);
+
+	for(int Type : {NETTYPE_IPV4, NETTYPE_IPV6})
+	{
+		const int AddrSize = Type == NETTYPE_IPV4 ? 4 : 16;
+		// keep the addresses close together to get overlapping ranges
+		const auto RandomAddr = [&]() {
+			NETADDR Addr = NETADDR_ZEROED;
+			Addr.type = Type;
+			Addr.ip[0] = 10;
+			for(int i = AddrSize - 2; i < AddrSize; i++)
+				Addr.ip[i] = Prng.RandomBits() % 256;
+			return Addr;
+		};
+
+		std::vector<CNetRange> vRanges;
+		std::vector<CNetBlocklist::CPrefix> vPrefixes;
+		for(int i = 0; i < 200; i++)
+		{
+			CNetRange Range;
+			Range.m_LB = RandomAddr();
+			Range.m_UB = Range.m_LB;
+			const int Size = Prng.RandomBits() % (i % 4 == 0 ? 4096 : 16);
+			for(int Byte = AddrSize - 1, Carry = Size; Byte >= 0 && Carry > 0; Byte--)
+			{
+				Carry += Range.m_UB.ip[Byte];
+				Range.m_UB.ip[Byte] = Carry % 256;
+				Carry /= 256;
+			}
+			ASSERT_TRUE(CNetBlocklist::AddRange(vPrefixes, &Range));
+			vRanges.push_back(Range);
+		}
+
+		CNetBlocklist Blocklist;
+		Blocklist.Build(vPrefixes);
+
+		for(int i = 0; i < 20000; i++)
+		{
+			const NETADDR Addr = RandomAddr();
+			bool Expected = false;
+			for(const CNetRange &Range : vRanges)
+				Expected |= mem_comp(Range.m_LB.ip, Addr.ip, AddrSize) <= 0 && mem_comp(Range.m_UB.ip, Addr.ip, AddrSize) >= 0;
+			ASSERT_EQ(Blocklist.Contains(&Addr), Expected) << "type=" << Type << " i=" << i;
+		}
+	}
+}
+
+TEST(NetBlocklist, BinaryRoundTrip)
+{
+	const CNetBlocklist Blocklist = BuildBlocklist(
+		"192.0.2.0/24\n"
+		"203.0.113.10 - 203.0.113.20\n"
+		"2001:db8::/32\n"
+		"2001:db9::1\n");
+
+	std::vector<unsigned char> vData;
+	Blocklist.SaveBinary(vData);
+	EXPECT_TRUE(CNetBlocklist::IsBinary(vData.data(), vData.size()));
+	EXPECT_FALSE(CNetBlocklist::IsBinary("192.0.2.0/24\n", 13));
+
+	CNetBlocklist Loaded;
+	ASSERT_TRUE(Loaded.LoadBinary(vData.data(), vData.size()));
+	EXPECT_EQ(Loaded.NumPrefixes(), Blocklist.NumPrefixes());
+
+	std::vector<CNetBlocklist::CPrefix> vExpected, vActual;
+	Blocklist.Prefixes(vExpected);
+	Loaded.Prefixes(vActual);
+	ASSERT_EQ(vActual.size(), vExpected.size());
+	for(size_t i = 0; i < vExpected.size(); i++)
+	{
+		EXPECT_TRUE(vActual[i].m_Key == vExpected[i].m_Key);
+		EXPECT_EQ(vActual[i].m_Length, vExpected[i].m_Length);
+	}
+	EXPECT_TRUE(Contains(Loaded, "203.0.113.15"));
+	EXPECT_FALSE(Contains(Loaded, "203.0.113.21"));
+
+	// truncated data and unsorted prefixes are rejected, the old content is kept
+	EXPECT_FALSE(Loaded.LoadBinary(vData.data(), vData.size() - 1));
+	std::vector<unsigned char> vUnsorted = vData;
+	std::swap_ranges(vUnsorted.end() - 17, vUnsorted.end(), vUnsorted.end() - 34);
+	EXPECT_FALSE(Loaded.LoadBinary(vUnsorted.data(), vUnsorted.size()));
+	EXPECT_TRUE(Contains(Loaded, "203.0.113.15"));
+}
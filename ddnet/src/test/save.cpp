@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+
+#include <base/system.h>
+
+#include <game/server/save.h>
+
+#include <string>
+
+// Builds a text save with all fields of the current format, where every
+// number depends on the tee and the field index
+static std::string TextSave(int NumTees, int NumSwitchers)
+{
+	char aBuf[256];
+	str_format(aBuf, sizeof(aBuf), "%d\t%d\t%d\t%d\t%d", 3, NumTees, NumSwitchers, 1, 0);
+	std::string Save = aBuf;
+	for(int Tee = 0; Tee < NumTees; Tee++)
+	{
+		str_format(aBuf, sizeof(aBuf), "\ntee %d", Tee);
+		Save += aBuf;
+		for(int Field = 1; Field < 115; Field++)
+		{
+			if(Field == 100)
+				str_copy(aBuf, "\t5bfd9d9c-6c32-3bd4-8e1e-1f2c3b4a5d6e");
+			else if(Field == 101)
+				str_format(aBuf, sizeof(aBuf), "\t%d", (Tee + 1) % NumTees); // hooked player
+			else if(Field == 46)
+				str_format(aBuf, sizeof(aBuf), "\t%d.5", Tee * 32 + 16); // m_Pos.x
+			else
+				str_format(aBuf, sizeof(aBuf), "\t%d", (Tee * 131 + Field * 7) % 97 - 20);
+			Save += aBuf;
+		}
+	}
+	for(int Switcher = 1; Switcher <= NumSwitchers; Switcher++)
+	{
+		str_format(aBuf, sizeof(aBuf), "\n%d\t%d\t%d", Switcher % 2, Switcher * 50, Switcher % 3);
+		Save += aBuf;
+	}
+	return Save;
+}
+
+static void SetClientIds(CSaveTeam &Team)
+{
+	for(int i = 0; i < Team.GetMembersCount(); i++)
+		Team.m_pSavedTees[i].SetClientId(i);
+}
+
+TEST(Save, TextRoundTrip)
+{
+	const std::string Text = TextSave(4, 3);
+	CSaveTeam Team;
+	ASSERT_EQ(Team.FromString(Text.c_str()), 0);
+	SetClientIds(Team);
+	const std::string Saved = Team.GetString();
+
+	CSaveTeam Team2;
+	ASSERT_EQ(Team2.FromString(Saved.c_str()), 0);
+	SetClientIds(Team2);
+	EXPECT_EQ(Saved, Team2.GetString());
+}
+
+TEST(Save, BinaryRoundTrip)
+{
+	for(int NumTees : {1, 4, 64})
+	{
+		const std::string Text = TextSave(NumTees, 10);
+		CSaveTeam Team;
+		ASSERT_EQ(Team.FromString(Text.c_str()), 0);
+		SetClientIds(Team);
+		const std::string Saved = Team.GetString();
+		const std::string Binary = Team.GetBinaryString();
+		EXPECT_EQ(Binary[0], CSaveTeam::BINARY_PREFIX);
+		EXPECT_LT(Binary.size(), Saved.size());
+
+		CSaveTeam Team2;
+		ASSERT_EQ(Team2.FromString(Binary.c_str()), 0);
+		ASSERT_EQ(Team2.GetMembersCount(), NumTees);
+		SetClientIds(Team2);
+		EXPECT_EQ(Team2.GetString(), Saved);
+		EXPECT_EQ(Team2.GetBinaryString(), Binary);
+
+		// positions are not truncated in the binary format
+		EXPECT_EQ(Team2.m_pSavedTees[0].GetPos().x, 16.5f);
+		EXPECT_STREQ(Team2.m_pSavedTees[NumTees - 1].GetName(), Team.m_pSavedTees[NumTees - 1].GetName());
+	}
+}
+
+TEST(Save, BinaryInvalid)
+{
+	CSaveTeam Team;
+	ASSERT_EQ(Team.FromString(TextSave(2, 1).c_str()), 0);
+	SetClientIds(Team);
+	const std::string Binary = Team.GetBinaryString();
+
+	CSaveTeam Team2;
+	EXPECT_NE(Team2.FromString("$"), 0);
+	EXPECT_NE(Team2.FromString("$not base64!"), 0);
+
+	// truncated data
+	const std::string Truncated = Binary.substr(0, 1 + (Binary.size() - 1) / 8 * 4);
+	EXPECT_NE(Team2.FromString(Truncated.c_str()), 0);
+
+	// unknown version
+	char aBuf[16];
+	unsigned char aVersion[3] = {(unsigned char)(CSaveTeam::BINARY_VERSION + 1), 0, 0};
+	aBuf[0] = CSaveTeam::BINARY_PREFIX;
+	str_base64(aBuf + 1, sizeof(aBuf) - 1, aVersion, sizeof(aVersion));
+	EXPECT_NE(Team2.FromString(aBuf), 0);
+
+	EXPECT_EQ(Team2.FromString(Binary.c_str()), 0);
+}
@@ -4,6 +4,7 @@
 #include <base/system.h>
 
 #include <engine/client/serverbrowser_ping_cache.h>
+#include <engine/client/serverbrowser_ping_scheduler.h>
 #include <engine/console.h>
 #include <engine/engine.h>
 #include <engine/shared/config.h>
@@ -36,6 +37,7 @@ TEST(ServerBrowser, PingCache)
 	EXPECT_EQ(pPingCache->GetPing(&OtherLocalhost6, 1), -1);
 
 	pPingCache->Load();
+	pPingCache->Wait();
 
 	EXPECT_EQ(pPingCache->NumEntries(), 0);
 	EXPECT_EQ(pPingCache->GetPing(&Localhost4, 1), -1);
@@ -93,6 +95,7 @@ TEST(ServerBrowser, PingCache)
 
 	// Persistence.
 	pPingCache->Load();
+	pPingCache->Wait();
 	EXPECT_EQ(pPingCache->NumEntries(), 2);
 	EXPECT_EQ(pPingCache->GetPing(&Localhost4, 1), 1337);
 	EXPECT_EQ(pPingCache->GetPing(&Localhost6, 1), 345);
@@ -100,3 +103,96 @@ TEST(ServerBrowser, PingCache)
 	EXPECT_EQ(pPingCache->GetPing(&OtherLocalhost4, 1), 1337);
 	EXPECT_EQ(pPingCache->GetPing(&OtherLocalhost6, 1), 345);
 }
+
+TEST(ServerBrowser, PingCacheWriteBehind)
+{
+	CTestInfo Info;
+	Info.m_DeleteTestStorageFilesOnSuccess = true;
+
+	auto pConsole = CreateConsole(CFGFLAG_CLIENT);
+	std::unique_ptr<IStorage> pStorage = Info.CreateTestStorage();
+	ASSERT_NE(pStorage, nullptr) << "Error creating test storage";
+	auto pPingCache = std::unique_ptr<IServerBrowserPingCache>(CreateServerBrowserPingCache(pConsole.get(), pStorage.get()));
+
+	// Many pings are answered from memory right away.
+	NETADDR Addr;
+	ASSERT_FALSE(net_addr_from_str(&Addr, "10.0.0.0:8303"));
+	for(int i = 0; i < 3000; i++)
+	{
+		Addr.ip[2] = i / 256;
+		Addr.ip[3] = i % 256;
+		pPingCache->CachePing(Addr, i % 1000);
+	}
+	EXPECT_EQ(pPingCache->NumEntries(), 3000);
+	EXPECT_EQ(pPingCache->GetPing(&Addr, 1), 999);
+
+	// Pings cached while loading are not overwritten by the stored ones.
+	pPingCache->Wait();
+	pPingCache->Load();
+	pPingCache->CachePing(Addr, 12);
+	pPingCache->Wait();
+	EXPECT_EQ(pPingCache->NumEntries(), 3000);
+	EXPECT_EQ(pPingCache->GetPing(&Addr, 1), 12);
+
+	pPingCache.reset(CreateServerBrowserPingCache(pConsole.get(), pStorage.get()));
+	EXPECT_EQ(pPingCache->NumEntries(), 0);
+	EXPECT_FALSE(pPingCache->Update());
+	pPingCache->Load();
+	pPingCache->Wait();
+	EXPECT_EQ(pPingCache->NumEntries(), 3000);
+	EXPECT_EQ(pPingCache->GetPing(&Addr, 1), 12);
+	Addr.ip[3]--;
+	EXPECT_EQ(pPingCache->GetPing(&Addr, 1), 998);
+}
+
+TEST(ServerBrowser, PingScheduler)
+{
+	const int64_t Freq = time_freq();
+	CServerBrowserPingScheduler Scheduler;
+	Scheduler.Reset(0, 10);
+
+	// The whole window can be sent at once.
+	EXPECT_EQ(Scheduler.Budget(0, 0), 10);
+	Scheduler.OnSent(10);
+	EXPECT_EQ(Scheduler.Budget(0, 10), 0);
+
+	// Answers grow the window, the tokens refill with time.
+	for(int i = 0; i < 10; i++)
+		Scheduler.OnAnswered(100);
+	EXPECT_EQ(Scheduler.Window(), 20);
+	EXPECT_EQ(Scheduler.SmoothedRttMs(), 100);
+	EXPECT_EQ(Scheduler.Budget(Freq / 20, 0), 10);
+	EXPECT_EQ(Scheduler.Budget(Freq, 0), 20);
+	EXPECT_EQ(Scheduler.Budget(Freq, 15), 5);
+
+	// Losses of the same round trip halve the window once.
+	Scheduler.OnLost(2 * Freq);
+	Scheduler.OnLost(2 * Freq + Freq / 100);
+	EXPECT_EQ(Scheduler.Window(), 10);
+	Scheduler.OnLost(3 * Freq);
+	EXPECT_EQ(Scheduler.Window(), 5);
+
+	// After a loss the window grows by about one per round trip.
+	for(int i = 0; i < 6; i++)
+		Scheduler.OnAnswered(100);
+	EXPECT_EQ(Scheduler.Window(), 6);
+
+	for(int i = 0; i < 10; i++)
+		Scheduler.OnLost((4 + i) * Freq);
+	EXPECT_EQ(Scheduler.Window(), 1);
+	EXPECT_EQ(Scheduler.Budget(20 * Freq, 0), 1);
+}
+
+TEST(ServerBrowser, PingSchedulerTimeout)
+{
+	CServerBrowserPingScheduler Scheduler;
+	Scheduler.Reset(0, 10);
+	EXPECT_EQ(Scheduler.TimeoutMs(-1), (int)CServerBrowserPingScheduler::MAX_TIMEOUT_MS);
+	EXPECT_EQ(Scheduler.TimeoutMs(0), (int)CServerBrowserPingScheduler::MIN_TIMEOUT_MS);
+	EXPECT_EQ(Scheduler.TimeoutMs(100), 350);
+	EXPECT_EQ(Scheduler.TimeoutMs(999), (int)CServerBrowserPingScheduler::MAX_TIMEOUT_MS);
+
+	Scheduler.OnAnswered(40);
+	EXPECT_EQ(Scheduler.TimeoutMs(-1), 40 + 4 * 20 + 150);
+	EXPECT_EQ(Scheduler.TimeoutMs(100), 350);
+}
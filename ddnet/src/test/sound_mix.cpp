@@ -0,0 +1,83 @@
+#include "test.h"
+#include <gtest/gtest.h>
+
+#include <engine/client/sound_mix.h>
+
+#include <game/prng.h>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+static void ReferenceMixVoice(int *pMixBuffer, const short *pData, int Channels, unsigned Frames, int VolumeL, int VolumeR)
+{
+	const short *pInL = pData;
+	const short *pInR = Channels == 1 ? pData : pData + 1;
+	for(unsigned s = 0; s < Frames; s++)
+	{
+		*pMixBuffer++ += (*pInL) * VolumeL;
+		*pMixBuffer++ += (*pInR) * VolumeR;
+		pInL += Channels;
+		pInR += Channels;
+	}
+}
+
+static int ReferenceClamp(int Value, int MasterVolume)
+{
+	return std::clamp<int>(((Value * MasterVolume) / 101) >> 8, std::numeric_limits<short>::min(), std::numeric_limits<short>::max());
+}
+
+TEST(SoundMix, Voice)
+{
+	uint64_t aSeed[2] = {1, 2};
+	CPrng Prng;
+	Prng.Seed(aSeed);
+
+	const int aVolumes[] = {0, 1, 77, 128, 255, -3};
+	for(int Channels = 1; Channels <= 2; Channels++)
+	{
+		for(unsigned Frames : {0u, 1u, 3u, 4u, 7u, 8u, 9u, 17u, 512u})
+		{
+			std::vector<short> vData(Frames * Channels + 1);
+			for(short &Sample : vData)
+				Sample = Prng.RandomBits();
+			vData[0] = std::numeric_limits<short>::min();
+			for(int VolumeL : aVolumes)
+			{
+				for(int VolumeR : aVolumes)
+				{
+					std::vector<int> vExpected(Frames * 2);
+					for(int &Value : vExpected)
+						Value = (int)(Prng.RandomBits() % 100000) - 50000;
+					std::vector<int> vMix = vExpected;
+					ReferenceMixVoice(vExpected.data(), vData.data(), Channels, Frames, VolumeL, VolumeR);
+					SoundMixVoice(vMix.data(), vData.data(), Channels, Frames, VolumeL, VolumeR);
+					EXPECT_EQ(vMix, vExpected) << Channels << " channels, " << Frames << " frames, volume " << VolumeL << "/" << VolumeR;
+				}
+			}
+		}
+	}
+}
+
+TEST(SoundMix, Clamp)
+{
+	uint64_t aSeed[2] = {3, 4};
+	CPrng Prng;
+	Prng.Seed(aSeed);
+
+	std::vector<int> vMix(4099);
+	for(int &Value : vMix)
+		Value = (int)Prng.RandomBits() % 20000000;
+	const int aEdges[] = {0, 1, -1, 100, -100, 101 * 256, -101 * 256, 101 * 256 - 1, -(101 * 256 - 1), 21474836, -21474836, 8388607, -8388608, 8388608, 32767 * 256, -32768 * 256};
+	std::copy(std::begin(aEdges), std::end(aEdges), vMix.begin());
+
+	std::vector<short> vOut(vMix.size());
+	for(int MasterVolume : {0, 1, 50, 99, 100})
+	{
+		SoundMixClamp(vOut.data(), vMix.data(), vMix.size(), MasterVolume);
+		for(size_t i = 0; i < vMix.size(); i++)
+		{
+			EXPECT_EQ(vOut[i], ReferenceClamp(vMix[i], MasterVolume)) << vMix[i] << " at volume " << MasterVolume;
+		}
+	}
+}
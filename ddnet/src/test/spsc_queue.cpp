@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+
+#include <base/system.h>
+
+#include <engine/shared/spsc_queue.h>
+
+#include <thread>
+
+TEST(SpscQueue, Empty)
+{
+	CSpscQueue<int, 4> Queue;
+	EXPECT_TRUE(Queue.Empty());
+	EXPECT_EQ(Queue.Size(), 0u);
+	EXPECT_EQ(Queue.Front(), nullptr);
+}
+
+TEST(SpscQueue, FullAndWrapAround)
+{
+	CSpscQueue<int, 4> Queue;
+	int Next = 0;
+	int Expected = 0;
+	for(int Round = 0; Round < 3; Round++)
+	{
+		while(int *pItem = Queue.PushBegin())
+		{
+			*pItem = Next++;
+			Queue.PushEnd();
+		}
+		EXPECT_EQ(Queue.Size(), 4u);
+
+		// free some space and fill it again to move the indices around
+		for(int i = 0; i < 3; i++)
+		{
+			ASSERT_NE(Queue.Front(), nullptr);
+			EXPECT_EQ(*Queue.Front(), Expected++);
+			Queue.Pop();
+		}
+		EXPECT_EQ(Queue.Size(), 1u);
+	}
+	ASSERT_NE(Queue.Front(), nullptr);
+	EXPECT_EQ(*Queue.Front(), Expected++);
+	Queue.Pop();
+	EXPECT_TRUE(Queue.Empty());
+	EXPECT_EQ(Expected, Next);
+}
+
+TEST(SpscQueue, TwoThreads)
+{
+	static const int NUM_ITEMS = 200000;
+	CSpscQueue<int, 64> Queue;
+
+	std::thread Producer([&]() {
+		for(int i = 0; i < NUM_ITEMS; i++)
+		{
+			int *pItem;
+			while((pItem = Queue.PushBegin()) == nullptr)
+				std::this_thread::yield();
+			*pItem = i;
+			Queue.PushEnd();
+		}
+	});
+
+	bool InOrder = true;
+	for(int i = 0; i < NUM_ITEMS; i++)
+	{
+		int *pItem;
+		while((pItem = Queue.Front()) == nullptr)
+			std::this_thread::yield();
+		InOrder &= *pItem == i;
+		Queue.Pop();
+	}
+	Producer.join();
+
+	EXPECT_TRUE(InOrder);
+	EXPECT_TRUE(Queue.Empty());
+}
@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+
+#include <game/teamscore.h>
+
+#include <random>
+
+// the rules CTeamsCore::CanCollide had before it cached them
+static bool ExpectedCanCollide(const CTeamsCore &Teams, int ClientId1, int ClientId2)
+{
+	const int Super = Teams.IsDDRace16() ? VANILLA_TEAM_SUPER : TEAM_SUPER;
+	if(Teams.Team(ClientId1) == Super || Teams.Team(ClientId2) == Super || ClientId1 == ClientId2)
+		return true;
+	if(Teams.GetSolo(ClientId1) || Teams.GetSolo(ClientId2))
+		return false;
+	return Teams.Team(ClientId1) == Teams.Team(ClientId2);
+}
+
+static void ExpectCanCollide(const CTeamsCore &Teams)
+{
+	for(int i = 0; i < MAX_CLIENTS; i++)
+		for(int j = 0; j < MAX_CLIENTS; j++)
+			ASSERT_EQ(Teams.CanCollide(i, j), ExpectedCanCollide(Teams, i, j)) << i << " " << j;
+}
+
+TEST(TeamsCore, CanCollide)
+{
+	CTeamsCore Teams;
+	EXPECT_TRUE(Teams.CanCollide(0, MAX_CLIENTS - 1));
+
+	Teams.Team(3, 1);
+	EXPECT_FALSE(Teams.CanCollide(3, 70));
+	EXPECT_FALSE(Teams.CanCollide(70, 3));
+	Teams.Team(70, 1);
+	EXPECT_TRUE(Teams.CanCollide(3, 70));
+
+	Teams.SetSolo(70, true);
+	EXPECT_FALSE(Teams.CanCollide(3, 70));
+	EXPECT_TRUE(Teams.CanCollide(70, 70));
+
+	// the super team collides with everyone, even with solo players
+	Teams.Team(5, TEAM_SUPER);
+	EXPECT_TRUE(Teams.CanCollide(5, 70));
+	EXPECT_TRUE(Teams.CanCollide(127, 5));
+
+	Teams.SetDDRace16(true);
+	EXPECT_FALSE(Teams.CanCollide(5, 70));
+	Teams.Team(6, VANILLA_TEAM_SUPER);
+	EXPECT_TRUE(Teams.CanCollide(70, 6));
+	ExpectCanCollide(Teams);
+
+	Teams.Reset();
+	EXPECT_FALSE(Teams.IsDDRace16());
+	ExpectCanCollide(Teams);
+}
+
+TEST(TeamsCore, CanCollideRandom)
+{
+	std::mt19937 Rng(3);
+	CTeamsCore Teams;
+	for(int i = 0; i < 2000; i++)
+	{
+		const int ClientId = Rng() % MAX_CLIENTS;
+		const unsigned Change = Rng() % 8;
+		if(Change == 0)
+			Teams.SetSolo(ClientId, !Teams.GetSolo(ClientId));
+		else if(Change == 1)
+			Teams.Team(ClientId, TEAM_SUPER);
+		else if(Change == 2)
+			Teams.Team(ClientId, VANILLA_TEAM_SUPER);
+		else if(Change == 3)
+			Teams.SetDDRace16(!Teams.IsDDRace16());
+		else
+			Teams.Team(ClientId, Rng() % 4);
+		if(i % 100 == 0)
+			ExpectCanCollide(Teams);
+	}
+	ExpectCanCollide(Teams);
+}
@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+
+#include <game/editor/tile_state_change_history.h>
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <tuple>
+#include <vector>
+
+struct STestStateChange
+{
+	int m_Previous;
+	int m_Current;
+};
+
+using CTestHistory = CTileStateChangeHistory<STestStateChange>;
+
+static std::vector<std::tuple<int, int, int, int>> Changes(const CTestHistory &History)
+{
+	std::vector<std::tuple<int, int, int, int>> vChanges;
+	History.ForEach([&](int x, int y, const STestStateChange &Change) {
+		vChanges.emplace_back(y, x, Change.m_Previous, Change.m_Current);
+	});
+	return vChanges;
+}
+
+TEST(TileStateChangeHistory, Record)
+{
+	CTestHistory History;
+	EXPECT_TRUE(History.Empty());
+	EXPECT_EQ(History.Find(0, 0), nullptr);
+
+	History.Record(3, 4, 1, 2);
+	History.Record(3, 4, 2, 5);
+	History.Record(40, 4, 7, 8);
+	History.Record(0, 4, 9, 10);
+	EXPECT_FALSE(History.Empty());
+	EXPECT_EQ(History.Size(), 3u);
+
+	// the first previous and the last current state are kept
+	ASSERT_NE(History.Find(3, 4), nullptr);
+	EXPECT_EQ(History.Find(3, 4)->m_Previous, 1);
+	EXPECT_EQ(History.Find(3, 4)->m_Current, 5);
+	EXPECT_EQ(History.Find(4, 3), nullptr);
+	EXPECT_EQ(History.Find(40, 5), nullptr);
+
+	EXPECT_EQ(Changes(History), (std::vector<std::tuple<int, int, int, int>>{{4, 0, 9, 10}, {4, 3, 1, 5}, {4, 40, 7, 8}}));
+
+	History.Clear();
+	EXPECT_TRUE(History.Empty());
+	EXPECT_EQ(History.Size(), 0u);
+	EXPECT_EQ(History.Find(3, 4), nullptr);
+	EXPECT_TRUE(Changes(History).empty());
+}
+
+TEST(TileStateChangeHistory, Random)
+{
+	std::mt19937 Rng(7);
+	std::map<std::pair<int, int>, STestStateChange> Reference;
+	CTestHistory History;
+	for(int i = 0; i < 20000; i++)
+	{
+		// mostly ordered runs like brushes and fills, with some random tiles
+		const int x = i % 3 == 0 ? Rng() % 200 : (i / 3) % 150;
+		const int y = i % 3 == 0 ? Rng() % 200 : (i / 450) % 150;
+		const int Previous = Rng() % 1000;
+		const int Current = Rng() % 1000;
+		History.Record(x, y, Previous, Current);
+		auto [It, Inserted] = Reference.emplace(std::pair(y, x), STestStateChange{Previous, Current});
+		if(!Inserted)
+			It->second.m_Current = Current;
+	}
+
+	std::vector<std::tuple<int, int, int, int>> vExpected;
+	for(const auto &[Pos, Change] : Reference)
+	{
+		vExpected.emplace_back(Pos.first, Pos.second, Change.m_Previous, Change.m_Current);
+		const STestStateChange *pChange = History.Find(Pos.second, Pos.first);
+		ASSERT_NE(pChange, nullptr);
+		EXPECT_EQ(pChange->m_Previous, Change.m_Previous);
+		EXPECT_EQ(pChange->m_Current, Change.m_Current);
+	}
+	EXPECT_EQ(History.Size(), Reference.size());
+
+	// chunks are visited in row-major order, but not the tiles across chunks
+	std::vector<std::tuple<int, int, int, int>> vActual = Changes(History);
+	std::sort(vActual.begin(), vActual.end());
+	EXPECT_EQ(vActual, vExpected);
+}
+
+TEST(TileStateChangeHistory, CopyMove)
+{
+	CTestHistory History;
+	for(int x = 0; x < 100; x++)
+		History.Record(x, x / 2, x, x + 1);
+
+	CTestHistory Copy = History;
+	EXPECT_EQ(Changes(Copy), Changes(History));
+
+	// recording into the copy must not change the original
+	Copy.Record(0, 0, 5, 6);
+	Copy.Record(200, 0, 5, 6);
+	EXPECT_EQ(History.Find(0, 0)->m_Current, 1);
+	EXPECT_EQ(History.Find(200, 0), nullptr);
+	EXPECT_EQ(Copy.Size(), History.Size() + 1);
+
+	const auto vChanges = Changes(History);
+	CTestHistory Moved = std::move(History);
+	EXPECT_EQ(Changes(Moved), vChanges);
+	EXPECT_TRUE(History.Empty()); // NOLINT(bugprone-use-after-move)
+
+	// the moved from history can record again
+	History.Record(1, 1, 2, 3);
+	EXPECT_EQ(History.Size(), 1u);
+	EXPECT_EQ(Moved.Size(), vChanges.size());
+}
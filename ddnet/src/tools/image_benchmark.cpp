@@ -0,0 +1,112 @@
+#include <base/logger.h>
+#include <base/math.h>
+#include <base/system.h>
+
+#include <engine/gfx/image_loader.h>
+#include <engine/gfx/image_manipulation.h>
+
+#include <game/prng.h>
+
+static const int DEFAULT_ITERATIONS = 10;
+
+// A tileset-like image: a grid of opaque tiles with transparent gaps and noise
+static CImageInfo GenerateTileset(int Width, int Height)
+{
+	uint64_t aSeed[2] = {1, 2};
+	CPrng Prng;
+	Prng.Seed(aSeed);
+
+	CImageInfo Image;
+	Image.m_Width = Width;
+	Image.m_Height = Height;
+	Image.m_Format = CImageInfo::FORMAT_RGBA;
+	Image.m_pData = static_cast<uint8_t *>(malloc(Image.DataSize()));
+	for(int y = 0; y < Height; ++y)
+	{
+		for(int x = 0; x < Width; ++x)
+		{
+			uint8_t *pPixel = &Image.m_pData[((size_t)y * Width + x) * 4];
+			const bool Gap = (x % 64) < 8 || (y % 64) < 8;
+			pPixel[0] = Prng.RandomBits();
+			pPixel[1] = Prng.RandomBits();
+			pPixel[2] = Prng.RandomBits();
+			pPixel[3] = Gap ? 0 : (Prng.RandomBits() % 4 == 0 ? 0 : 255);
+		}
+	}
+	return Image;
+}
+
+template<typename TFunc>
+static void Measure(const char *pName, const char *pImageName, int Iterations, const CImageInfo &Source, TFunc &&Func)
+{
+	int64_t Total = 0;
+	int64_t Best = -1;
+	for(int i = 0; i < Iterations; ++i)
+	{
+		CImageInfo Image = Source.DeepCopy();
+		const int64_t Start = time_get();
+		Func(Image);
+		const int64_t Duration = time_get() - Start;
+		Image.Free();
+		Total += Duration;
+		if(Best < 0 || Duration < Best)
+			Best = Duration;
+	}
+	log_info("image_benchmark", "%s %s: average %.3fms, best %.3fms (%d iterations)", pImageName, pName,
+		Total * 1000.0 / time_freq() / Iterations, Best * 1000.0 / time_freq(), Iterations);
+}
+
+static void BenchmarkImage(const char *pImageName, const CImageInfo &Image, int Iterations)
+{
+	log_info("image_benchmark", "%s: %dx%d", pImageName, (int)Image.m_Width, (int)Image.m_Height);
+	Measure("dilate", pImageName, Iterations, Image, [](CImageInfo &Copy) { DilateImage(Copy); });
+	Measure("grayscale", pImageName, Iterations, Image, [](CImageInfo &Copy) { ConvertToGrayscale(Copy); });
+	Measure("resize (half)", pImageName, Iterations, Image, [](CImageInfo &Copy) { ResizeImage(Copy, maximum<int>(Copy.m_Width / 2, 2), maximum<int>(Copy.m_Height / 2, 2)); });
+}
+
+int main(int argc, const char **argv)
+{
+	CCmdlineFix CmdlineFix(&argc, &argv);
+	log_set_global_logger_default();
+
+	int Iterations = DEFAULT_ITERATIONS;
+	int FirstFile = 1;
+	if(argc >= 3 && str_comp(argv[1], "--iterations") == 0)
+	{
+		Iterations = maximum(str_toint(argv[2]), 1);
+		FirstFile = 3;
+	}
+
+	if(FirstFile >= argc)
+	{
+		log_info("image_benchmark", "Usage: %s [--iterations <n>] [<image1.png> ...]", argv[0]);
+		log_info("image_benchmark", "No images given, using generated tilesets");
+		const int aSizes[] = {1024, 2048, 4096};
+		for(int Size : aSizes)
+		{
+			char aName[64];
+			str_format(aName, sizeof(aName), "generated %d", Size);
+			CImageInfo Image = GenerateTileset(Size, Size);
+			BenchmarkImage(aName, Image, Iterations);
+			Image.Free();
+		}
+		return 0;
+	}
+
+	bool Success = true;
+	for(int i = FirstFile; i < argc; i++)
+	{
+		CImageInfo Image;
+		int PngliteIncompatible;
+		if(!CImageLoader::LoadPng(io_open(argv[i], IOFLAG_READ), argv[i], Image, PngliteIncompatible))
+		{
+			Success = false;
+			continue;
+		}
+		if(!ConvertToRgba(Image))
+			log_info("image_benchmark", "'%s' converted to RGBA", argv[i]);
+		BenchmarkImage(argv[i], Image, Iterations);
+		Image.Free();
+	}
+	return Success ? 0 : -1;
+}
@@ -0,0 +1,216 @@
+#include <base/logger.h>
+#include <base/system.h>
+
+#include <engine/shared/datafile.h>
+#include <engine/shared/jobs.h>
+#include <engine/shared/linereader.h>
+#include <engine/shared/map.h>
+#include <engine/storage.h>
+
+#include <game/editor/auto_map_rules.h>
+#include <game/mapitems.h>
+#include <game/mapitems_ex.h>
+
+#include "map_batch.h"
+
+#include <map>
+#include <memory>
+#include <string>
+
+static const char *TOOL_NAME = "map_automap";
+
+// Automapper rules by image name, loaded once per worker
+class CAutomapWorker
+{
+	std::map<std::string, std::unique_ptr<CAutoMapRules>> m_Rules;
+
+public:
+	const CAutoMapRules *Rules(IStorage *pStorage, const char *pImageName)
+	{
+		auto It = m_Rules.find(pImageName);
+		if(It != m_Rules.end())
+			return It->second.get();
+
+		std::unique_ptr<CAutoMapRules> pRules;
+		char aPath[IO_MAX_PATH_LENGTH];
+		str_format(aPath, sizeof(aPath), "editor/automap/%s.rules", pImageName);
+		CLineReader LineReader;
+		if(LineReader.OpenFile(pStorage->OpenFile(aPath, IOFLAG_READ, IStorage::TYPE_ALL)))
+		{
+			pRules = std::make_unique<CAutoMapRules>();
+			pRules->Load(LineReader);
+		}
+		return m_Rules.emplace(pImageName, std::move(pRules)).first->second.get();
+	}
+};
+
+// Automaps all tile layers that have an automapper configuration, with the
+// rules of their image and the seed stored in the map
+static bool AutomapMap(const char *pSourceMap, const char *pDestinationMap, IStorage *pStorage, CAutomapWorker &Worker, int NumThreads)
+{
+	CDataFileReader Reader;
+	if(!Reader.Open(pStorage, pSourceMap, IStorage::TYPE_ABSOLUTE))
+	{
+		log_error(TOOL_NAME, "failed to open source map '%s' for reading", pSourceMap);
+		return false;
+	}
+
+	int GroupStart, GroupNum, LayerStart, LayerNum, ImageStart, ImageNum, ConfigStart, ConfigNum;
+	Reader.GetType(MAPITEMTYPE_GROUP, &GroupStart, &GroupNum);
+	Reader.GetType(MAPITEMTYPE_LAYER, &LayerStart, &LayerNum);
+	Reader.GetType(MAPITEMTYPE_IMAGE, &ImageStart, &ImageNum);
+	Reader.GetType(MAPITEMTYPE_AUTOMAPPER_CONFIG, &ConfigStart, &ConfigNum);
+
+	// new tiles by item index of their layer
+	std::map<int, std::vector<CTile>> AutomappedLayers;
+	std::map<int, int> AutomappedData;
+	for(int i = 0; i < ConfigNum; i++)
+	{
+		const CMapItemAutoMapperConfig *pConfig = static_cast<CMapItemAutoMapperConfig *>(Reader.GetItem(ConfigStart + i));
+		if(pConfig->m_Version != 1 || pConfig->m_AutomapperConfig < 0 || pConfig->m_GroupId < 0 || pConfig->m_GroupId >= GroupNum)
+			continue;
+		const CMapItemGroup *pGroup = static_cast<CMapItemGroup *>(Reader.GetItem(GroupStart + pConfig->m_GroupId));
+		if(pConfig->m_LayerId < 0 || pConfig->m_LayerId >= pGroup->m_NumLayers || pGroup->m_StartLayer + pConfig->m_LayerId >= LayerNum)
+			continue;
+		const int LayerIndex = LayerStart + pGroup->m_StartLayer + pConfig->m_LayerId;
+		const CMapItemLayer *pLayer = static_cast<CMapItemLayer *>(Reader.GetItem(LayerIndex));
+		if(pLayer->m_Type != LAYERTYPE_TILES)
+			continue;
+		const CMapItemLayerTilemap *pTilemap = reinterpret_cast<const CMapItemLayerTilemap *>(pLayer);
+		if(pTilemap->m_Flags != 0 || pTilemap->m_Image < 0 || pTilemap->m_Image >= ImageNum)
+			continue;
+
+		const CMapItemImage_v1 *pImage = static_cast<CMapItemImage_v1 *>(Reader.GetItem(ImageStart + pTilemap->m_Image));
+		const char *pImageName = Reader.GetDataString(pImage->m_ImageName);
+		if(pImageName == nullptr)
+		{
+			log_error(TOOL_NAME, "failed to load name of image %d in '%s'", pTilemap->m_Image, pSourceMap);
+			return false;
+		}
+		const CAutoMapRules *pRules = Worker.Rules(pStorage, pImageName);
+		if(pRules == nullptr || pConfig->m_AutomapperConfig >= pRules->NumConfigs())
+		{
+			log_warn(TOOL_NAME, "skipping layer %d of group %d in '%s', no rules config %d for image '%s'", pConfig->m_LayerId, pConfig->m_GroupId, pSourceMap, pConfig->m_AutomapperConfig, pImageName);
+			continue;
+		}
+
+		const size_t NumTiles = (size_t)pTilemap->m_Width * pTilemap->m_Height;
+		const CTile *pSavedTiles = static_cast<CTile *>(Reader.GetData(pTilemap->m_Data));
+		const size_t SavedTilesSize = Reader.GetDataSize(pTilemap->m_Data) / sizeof(CTile);
+		std::vector<CTile> vTiles(NumTiles);
+		if(pTilemap->m_Version >= CMapItemLayerTilemap::VERSION_TEEWORLDS_TILESKIP)
+		{
+			CMap::ExtractTiles(vTiles.data(), NumTiles, pSavedTiles, SavedTilesSize);
+		}
+		else if(pSavedTiles != nullptr && SavedTilesSize >= NumTiles)
+		{
+			mem_copy(vTiles.data(), pSavedTiles, NumTiles * sizeof(CTile));
+		}
+		else
+		{
+			log_error(TOOL_NAME, "invalid tile data of layer %d of group %d in '%s'", pConfig->m_LayerId, pConfig->m_GroupId, pSourceMap);
+			return false;
+		}
+
+		const int64_t Start = time_get();
+		pRules->Proceed(vTiles.data(), pTilemap->m_Width, pTilemap->m_Height, nullptr, 0, 0, -1, pConfig->m_AutomapperConfig, pConfig->m_AutomapperSeed, 0, 0, nullptr, NumThreads);
+		log_info(TOOL_NAME, "automapped layer %d of group %d (%dx%d) with '%s' of '%s' in %.2fms", pConfig->m_LayerId, pConfig->m_GroupId, pTilemap->m_Width, pTilemap->m_Height,
+			pRules->ConfigName(pConfig->m_AutomapperConfig), pImageName, (time_get() - Start) * 1000.0 / time_freq());
+
+		AutomappedData[pTilemap->m_Data] = LayerIndex;
+		AutomappedLayers[LayerIndex] = std::move(vTiles);
+	}
+
+	CDataFileWriter Writer;
+	if(!Writer.Open(pStorage, pDestinationMap, IStorage::TYPE_ABSOLUTE))
+	{
+		log_error(TOOL_NAME, "failed to open destination map '%s' for writing", pDestinationMap);
+		return false;
+	}
+
+	for(int Index = 0; Index < Reader.NumItems(); Index++)
+	{
+		int Type, Id;
+		CUuid Uuid;
+		const void *pPtr = Reader.GetItem(Index, &Type, &Id, &Uuid);
+
+		// Filter ITEMTYPE_EX items, they will be automatically added again.
+		if(Type == ITEMTYPE_EX)
+			continue;
+
+		const int Size = Reader.GetItemSize(Index);
+		if(AutomappedLayers.count(Index))
+		{
+			// the automapped tiles are stored without skipping
+			std::vector<int> vItem(Size / sizeof(int));
+			mem_copy(vItem.data(), pPtr, Size);
+			CMapItemLayerTilemap *pTilemap = reinterpret_cast<CMapItemLayerTilemap *>(vItem.data());
+			pTilemap->m_Version = minimum(pTilemap->m_Version, CMapItemLayerTilemap::VERSION_TEEWORLDS_TILESKIP - 1);
+			Writer.AddItem(Type, Id, Size, vItem.data(), &Uuid);
+		}
+		else
+		{
+			Writer.AddItem(Type, Id, Size, pPtr, &Uuid);
+		}
+	}
+
+	for(int Index = 0; Index < Reader.NumData(); Index++)
+	{
+		auto It = AutomappedData.find(Index);
+		if(It != AutomappedData.end())
+		{
+			const std::vector<CTile> &vTiles = AutomappedLayers[It->second];
+			Writer.AddData(vTiles.size() * sizeof(CTile), vTiles.data());
+		}
+		else
+		{
+			Writer.AddData(Reader.GetDataSize(Index), Reader.GetData(Index));
+		}
+	}
+
+	Reader.Close();
+	Writer.Finish();
+	log_info(TOOL_NAME, "automapped %d layers of '%s' to '%s'", (int)AutomappedLayers.size(), pSourceMap, pDestinationMap);
+	return true;
+}
+
+int main(int argc, const char **argv)
+{
+	CCmdlineFix CmdlineFix(&argc, &argv);
+	log_set_global_logger_default();
+
+	if(argc < 3 || argc > 4)
+	{
+		log_error(TOOL_NAME, "Usage: %s <source map> <destination map> [<threads>]", TOOL_NAME);
+		log_error(TOOL_NAME, "Usage: %s <source directory> <destination directory> [<threads>]", TOOL_NAME);
+		log_error(TOOL_NAME, "Automaps the tile layers with an automapper config, using the rules from data/editor/automap and the seed stored in the map.");
+		return -1;
+	}
+
+	std::unique_ptr<IStorage> pStorage = std::unique_ptr<IStorage>(CreateStorage(IStorage::EInitializationType::BASIC, argc, argv));
+	if(!pStorage)
+	{
+		log_error(TOOL_NAME, "Error creating basic storage");
+		return -1;
+	}
+
+	const int NumThreads = MapBatchThreads(argc == 4 ? argv[3] : nullptr);
+	if(fs_is_dir(argv[1]))
+	{
+		// one thread per map, the maps are independent
+		const bool Success = RunMapBatch<CAutomapWorker>(TOOL_NAME, argv[1], argv[2], NumThreads, [&](CAutomapWorker &Worker, const CMapBatchItem &Item) {
+			return AutomapMap(Item.m_aSource, Item.m_aDestination, pStorage.get(), Worker, 1);
+		});
+		return Success ? 0 : -1;
+	}
+
+	// the calling thread works on the row bands of large layers together with the job pool
+	CJobPool JobPool;
+	JobPool.Init(NumThreads - 1);
+	CJobPool::SetShared(&JobPool);
+	CAutomapWorker Worker;
+	const bool Success = AutomapMap(argv[1], argv[2], pStorage.get(), Worker, NumThreads);
+	CJobPool::SetShared(nullptr);
+	JobPool.Shutdown();
+	return Success ? 0 : -1;
+}
@@ -0,0 +1,192 @@
+#ifndef TOOLS_MAP_BATCH_H
+#define TOOLS_MAP_BATCH_H
+
+#include <base/logger.h>
+#include <base/math.h>
+#include <base/system.h>
+
+#include <engine/shared/csv.h>
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Batch mode shared by the map tools: processes all maps of a directory on a
+// pool of worker threads and reports the time and size per map.
+//
+// The workers take the next unprocessed map from a shared cursor, so a worker
+// that finishes small maps early keeps taking over work instead of idling.
+// Every worker owns one instance of the tool specific TWorker type which
+// is passed to each map it processes, to reuse buffers between maps.
+
+class CMapBatchItem
+{
+public:
+	char m_aSource[IO_MAX_PATH_LENGTH];
+	char m_aDestination[IO_MAX_PATH_LENGTH];
+	bool m_Success = false;
+	int64_t m_Duration = 0;
+	int64_t m_SourceSize = -1;
+	int64_t m_DestinationSize = -1;
+};
+
+static int64_t MapBatchFileSize(const char *pPath)
+{
+	IOHANDLE File = io_open(pPath, IOFLAG_READ);
+	if(!File)
+		return -1;
+	const int64_t Size = io_length(File);
+	io_close(File);
+	return Size;
+}
+
+struct SMapBatchDirectorySize
+{
+	const char *m_pPath;
+	int64_t m_Size;
+};
+
+static int MapBatchDirectorySizeCallback(const char *pName, int IsDir, int StorageType, void *pUser)
+{
+	SMapBatchDirectorySize *pContext = static_cast<SMapBatchDirectorySize *>(pUser);
+	if(!IsDir)
+	{
+		char aPath[IO_MAX_PATH_LENGTH];
+		str_format(aPath, sizeof(aPath), "%s/%s", pContext->m_pPath, pName);
+		pContext->m_Size += maximum<int64_t>(MapBatchFileSize(aPath), 0);
+	}
+	return 0;
+}
+
+// Size of a file, or of all files directly inside of a directory
+static int64_t MapBatchOutputSize(const char *pPath)
+{
+	if(!fs_is_dir(pPath))
+		return MapBatchFileSize(pPath);
+
+	SMapBatchDirectorySize Context = {pPath, 0};
+	fs_listdir(pPath, MapBatchDirectorySizeCallback, 0, &Context);
+	return Context.m_Size;
+}
+
+static int MapBatchListCallback(const char *pName, int IsDir, int StorageType, void *pUser)
+{
+	if(!IsDir && str_endswith(pName, ".map"))
+		static_cast<std::vector<std::string> *>(pUser)->emplace_back(pName);
+	return 0;
+}
+
+static void MapBatchWriteReport(const char *pToolName, const char *pReportPath, const std::vector<CMapBatchItem> &vItems)
+{
+	IOHANDLE File = io_open(pReportPath, IOFLAG_WRITE);
+	if(!File)
+	{
+		log_error(pToolName, "failed to open report file '%s' for writing", pReportPath);
+		return;
+	}
+
+	const char *apHeader[] = {"map", "success", "milliseconds", "source_bytes", "destination_bytes"};
+	CsvWrite(File, std::size(apHeader), apHeader);
+	for(const CMapBatchItem &Item : vItems)
+	{
+		char aDuration[32];
+		char aSourceSize[32];
+		char aDestinationSize[32];
+		str_format(aDuration, sizeof(aDuration), "%.3f", Item.m_Duration * 1000.0 / time_freq());
+		str_format(aSourceSize, sizeof(aSourceSize), "%" PRId64, Item.m_SourceSize);
+		str_format(aDestinationSize, sizeof(aDestinationSize), "%" PRId64, Item.m_DestinationSize);
+		const char *apColumns[] = {Item.m_aSource, Item.m_Success ? "1" : "0", aDuration, aSourceSize, aDestinationSize};
+		CsvWrite(File, std::size(apColumns), apColumns);
+	}
+	io_close(File);
+	log_info(pToolName, "wrote report to '%s'", pReportPath);
+}
+
+// Parses the optional thread count of the batch mode, 0 means one thread per core
+static int MapBatchThreads(const char *pArg)
+{
+	const int Threads = pArg == nullptr ? 0 : str_toint(pArg);
+	if(Threads > 0)
+		return Threads;
+	return maximum<int>(std::thread::hardware_concurrency(), 1);
+}
+
+// Calls Process(TWorker &Worker, CMapBatchItem &Item) for every map in pSourceDir.
+// The destination of each item is the map file name in pDestinationDir.
+template<typename TWorker, typename TProcess>
+static bool RunMapBatch(const char *pToolName, const char *pSourceDir, const char *pDestinationDir, int NumThreads, const TProcess &Process)
+{
+	if(fs_makedir_rec_for(pDestinationDir) != 0 || fs_makedir(pDestinationDir) != 0)
+	{
+		log_error(pToolName, "failed to create destination directory '%s'", pDestinationDir);
+		return false;
+	}
+
+	std::vector<std::string> vMaps;
+	fs_listdir(pSourceDir, MapBatchListCallback, 0, &vMaps);
+	std::sort(vMaps.begin(), vMaps.end());
+
+	std::vector<CMapBatchItem> vItems(vMaps.size());
+	for(size_t i = 0; i < vMaps.size(); i++)
+	{
+		str_format(vItems[i].m_aSource, sizeof(vItems[i].m_aSource), "%s/%s", pSourceDir, vMaps[i].c_str());
+		str_format(vItems[i].m_aDestination, sizeof(vItems[i].m_aDestination), "%s/%s", pDestinationDir, vMaps[i].c_str());
+	}
+
+	NumThreads = std::clamp<int>(NumThreads, 1, maximum<int>(vItems.size(), 1));
+	log_info(pToolName, "processing %d maps from '%s' with %d threads", (int)vItems.size(), pSourceDir, NumThreads);
+
+	std::atomic<size_t> NextItem = 0;
+	const auto RunWorker = [&]() {
+		TWorker Worker;
+		while(true)
+		{
+			const size_t Index = NextItem.fetch_add(1);
+			if(Index >= vItems.size())
+				break;
+
+			CMapBatchItem &Item = vItems[Index];
+			Item.m_SourceSize = MapBatchFileSize(Item.m_aSource);
+			const int64_t Start = time_get();
+			Item.m_Success = Process(Worker, Item);
+			Item.m_Duration = time_get() - Start;
+			if(Item.m_DestinationSize < 0)
+				Item.m_DestinationSize = MapBatchOutputSize(Item.m_aDestination);
+		}
+	};
+
+	const int64_t StartTime = time_get();
+	std::vector<std::thread> vThreads;
+	for(int i = 1; i < NumThreads; i++)
+		vThreads.emplace_back(RunWorker);
+	RunWorker();
+	for(std::thread &Thread : vThreads)
+		Thread.join();
+	const int64_t WallDuration = time_get() - StartTime;
+
+	int NumFailed = 0;
+	int64_t TotalDuration = 0;
+	int64_t TotalSourceSize = 0;
+	int64_t TotalDestinationSize = 0;
+	for(const CMapBatchItem &Item : vItems)
+	{
+		log_info(pToolName, "%s '%s': %.2fms, %" PRId64 " -> %" PRId64 " bytes",
+			Item.m_Success ? "done" : "FAILED", Item.m_aSource, Item.m_Duration * 1000.0 / time_freq(), Item.m_SourceSize, Item.m_DestinationSize);
+		NumFailed += Item.m_Success ? 0 : 1;
+		TotalDuration += Item.m_Duration;
+		TotalSourceSize += maximum<int64_t>(Item.m_SourceSize, 0);
+		TotalDestinationSize += maximum<int64_t>(Item.m_DestinationSize, 0);
+	}
+	log_info(pToolName, "processed %d maps (%d failed) in %.2fs (%.2fs summed over all threads), %" PRId64 " -> %" PRId64 " bytes",
+		(int)vItems.size(), NumFailed, WallDuration / (double)time_freq(), TotalDuration / (double)time_freq(), TotalSourceSize, TotalDestinationSize);
+
+	char aReportPath[IO_MAX_PATH_LENGTH];
+	str_format(aReportPath, sizeof(aReportPath), "%s/%s_report.csv", pDestinationDir, pToolName);
+	MapBatchWriteReport(pToolName, aReportPath, vItems);
+
+	return NumFailed == 0;
+}
+
+#endif
@@ -11,23 +11,41 @@
 #include <game/gamecore.h>
 #include <game/mapitems.h>
 
+#include "map_batch.h"
+
 /*
 	Usage: map_convert_07 <source map filepath> <dest map filepath>
+	       map_convert_07 <source directory> <dest directory> [<threads>]
 */
 
-static CDataFileReader g_DataReader;
-static CDataFileWriter g_DataWriter;
+// State of the conversion of one map
+class CMapConverter07
+{
+public:
+	CDataFileReader m_DataReader;
+	CDataFileWriter m_DataWriter;
 
-// global new image data (set by ReplaceImageItem)
-static int g_aNewDataSize[MAX_MAPIMAGES];
-static void *g_apNewData[MAX_MAPIMAGES];
+	// new image data (set by ReplaceImageItem)
+	int m_aNewDataSize[MAX_MAPIMAGES];
+	void *m_apNewData[MAX_MAPIMAGES];
 
-static int g_Index = 0;
-static int g_NextDataItemId = -1;
+	int m_Index = 0;
+	int m_NextDataItemId = -1;
 
-static int g_aImageIds[MAX_MAPIMAGES];
+	int m_aImageIds[MAX_MAPIMAGES];
 
-static bool CheckImageDimensions(void *pLayerItem, int LayerType, const char *pFilename)
+	~CMapConverter07()
+	{
+		for(int Index = 0; Index < m_Index; Index++)
+			free(m_apNewData[Index]);
+	}
+
+	bool CheckImageDimensions(void *pLayerItem, int LayerType, const char *pFilename);
+	void *ReplaceImageItem(int Index, CMapItemImage *pImgItem, CMapItemImage *pNewImgItem);
+	bool Convert(IStorage *pStorage, const char *pSourceFileName, const char *pDestFileName);
+};
+
+bool CMapConverter07::CheckImageDimensions(void *pLayerItem, int LayerType, const char *pFilename)
 {
 	if(LayerType != MAPITEMTYPE_LAYER)
 		return true;
@@ -41,7 +59,7 @@ static bool CheckImageDimensions(void *pLayerItem, int LayerType, const char *pF
 		return true;
 
 	int Type;
-	void *pItem = g_DataReader.GetItem(g_aImageIds[pTMap->m_Image], &Type);
+	void *pItem = m_DataReader.GetItem(m_aImageIds[pTMap->m_Image], &Type);
 	if(Type != MAPITEMTYPE_IMAGE)
 		return true;
 
@@ -53,17 +71,17 @@ static bool CheckImageDimensions(void *pLayerItem, int LayerType, const char *pF
 	char aTileLayerName[12];
 	IntsToStr(pTMap->m_aName, std::size(pTMap->m_aName), aTileLayerName, std::size(aTileLayerName));
 
-	const char *pName = g_DataReader.GetDataString(pImgItem->m_ImageName);
+	const char *pName = m_DataReader.GetDataString(pImgItem->m_ImageName);
 	dbg_msg("map_convert_07", "%s: Tile layer \"%s\" uses image \"%s\" with width %d, height %d, which is not divisible by 16. This is not supported in Teeworlds 0.7. Please scale the image and replace it manually.", pFilename, aTileLayerName, pName == nullptr ? "(error)" : pName, pImgItem->m_Width, pImgItem->m_Height);
 	return false;
 }
 
-static void *ReplaceImageItem(int Index, CMapItemImage *pImgItem, CMapItemImage *pNewImgItem)
+void *CMapConverter07::ReplaceImageItem(int Index, CMapItemImage *pImgItem, CMapItemImage *pNewImgItem)
 {
 	if(!pImgItem->m_External)
 		return pImgItem;
 
-	const char *pName = g_DataReader.GetDataString(pImgItem->m_ImageName);
+	const char *pName = m_DataReader.GetDataString(pImgItem->m_ImageName);
 	if(pName == nullptr || pName[0] == '\0')
 	{
 		dbg_msg("map_convert_07", "failed to load name of image %d", Index);
@@ -93,78 +111,36 @@ static void *ReplaceImageItem(int Index, CMapItemImage *pImgItem, CMapItemImage
 	pNewImgItem->m_Width = ImgInfo.m_Width;
 	pNewImgItem->m_Height = ImgInfo.m_Height;
 	pNewImgItem->m_External = false;
-	pNewImgItem->m_ImageData = g_NextDataItemId++;
+	pNewImgItem->m_ImageData = m_NextDataItemId++;
 
-	g_apNewData[g_Index] = ImgInfo.m_pData;
-	g_aNewDataSize[g_Index] = ImgInfo.DataSize();
-	g_Index++;
+	m_apNewData[m_Index] = ImgInfo.m_pData;
+	m_aNewDataSize[m_Index] = ImgInfo.DataSize();
+	m_Index++;
 
 	return (void *)pNewImgItem;
 }
 
-int main(int argc, const char **argv)
+bool CMapConverter07::Convert(IStorage *pStorage, const char *pSourceFileName, const char *pDestFileName)
 {
-	CCmdlineFix CmdlineFix(&argc, &argv);
-	log_set_global_logger_default();
-
-	if(argc < 2 || argc > 3)
-	{
-		dbg_msg("map_convert_07", "Invalid arguments");
-		dbg_msg("map_convert_07", "Usage: map_convert_07 <source map filepath> [<dest map filepath>]");
-		return -1;
-	}
-
-	std::unique_ptr<IStorage> pStorage = std::unique_ptr<IStorage>(CreateStorage(IStorage::EInitializationType::BASIC, argc, argv));
-	if(!pStorage)
-	{
-		log_error("map_convert_07", "Error creating basic storage");
-		return -1;
-	}
-
-	const char *pSourceFileName = argv[1];
-	char aDestFileName[IO_MAX_PATH_LENGTH];
-
-	if(argc == 3)
-	{
-		str_copy(aDestFileName, argv[2], sizeof(aDestFileName));
-	}
-	else
-	{
-		char aBuf[IO_MAX_PATH_LENGTH];
-		IStorage::StripPathAndExtension(pSourceFileName, aBuf, sizeof(aBuf));
-		str_format(aDestFileName, sizeof(aDestFileName), "data/maps7/%s.map", aBuf);
-		if(fs_makedir("data") != 0)
-		{
-			dbg_msg("map_convert_07", "failed to create data directory");
-			return -1;
-		}
-
-		if(fs_makedir("data/maps7") != 0)
-		{
-			dbg_msg("map_convert_07", "failed to create data/maps7 directory");
-			return -1;
-		}
-	}
-
-	if(!g_DataReader.Open(pStorage.get(), pSourceFileName, IStorage::TYPE_ABSOLUTE))
+	if(!m_DataReader.Open(pStorage, pSourceFileName, IStorage::TYPE_ABSOLUTE))
 	{
 		dbg_msg("map_convert_07", "failed to open source map. filename='%s'", pSourceFileName);
-		return -1;
+		return false;
 	}
 
-	if(!g_DataWriter.Open(pStorage.get(), aDestFileName, IStorage::TYPE_ABSOLUTE))
+	if(!m_DataWriter.Open(pStorage, pDestFileName, IStorage::TYPE_ABSOLUTE))
 	{
-		dbg_msg("map_convert_07", "failed to open destination map. filename='%s'", aDestFileName);
-		return -1;
+		dbg_msg("map_convert_07", "failed to open destination map. filename='%s'", pDestFileName);
+		return false;
 	}
 
-	g_NextDataItemId = g_DataReader.NumData();
+	m_NextDataItemId = m_DataReader.NumData();
 
 	size_t i = 0;
-	for(int Index = 0; Index < g_DataReader.NumItems(); Index++)
+	for(int Index = 0; Index < m_DataReader.NumItems(); Index++)
 	{
 		int Type;
-		g_DataReader.GetItem(Index, &Type);
+		m_DataReader.GetItem(Index, &Type);
 		if(Type == MAPITEMTYPE_IMAGE)
 		{
 			if(i >= MAX_MAPIMAGES)
@@ -172,7 +148,7 @@ int main(int argc, const char **argv)
 				dbg_msg("map_convert_07", "map uses more images than the client maximum of %" PRIzu ". filename='%s'", MAX_MAPIMAGES, pSourceFileName);
 				break;
 			}
-			g_aImageIds[i] = Index;
+			m_aImageIds[i] = Index;
 			i++;
 		}
 	}
@@ -180,11 +156,11 @@ int main(int argc, const char **argv)
 	bool Success = true;
 
 	// add all items
-	for(int Index = 0; Index < g_DataReader.NumItems(); Index++)
+	for(int Index = 0; Index < m_DataReader.NumItems(); Index++)
 	{
 		int Type, Id;
 		CUuid Uuid;
-		void *pItem = g_DataReader.GetItem(Index, &Type, &Id, &Uuid);
+		void *pItem = m_DataReader.GetItem(Index, &Type, &Id, &Uuid);
 
 		// Filter ITEMTYPE_EX items, they will be automatically added again.
 		if(Type == ITEMTYPE_EX)
@@ -192,7 +168,7 @@ int main(int argc, const char **argv)
 			continue;
 		}
 
-		int Size = g_DataReader.GetItemSize(Index);
+		int Size = m_DataReader.GetItemSize(Index);
 		Success &= CheckImageDimensions(pItem, Type, pSourceFileName);
 
 		CMapItemImage NewImageItem;
@@ -200,27 +176,88 @@ int main(int argc, const char **argv)
 		{
 			pItem = ReplaceImageItem(Index, (CMapItemImage *)pItem, &NewImageItem);
 			if(!pItem)
-				return -1;
+				return false;
 			Size = sizeof(CMapItemImage);
 			NewImageItem.m_Version = 1;
 		}
-		g_DataWriter.AddItem(Type, Id, Size, pItem, &Uuid);
+		m_DataWriter.AddItem(Type, Id, Size, pItem, &Uuid);
 	}
 
 	// add all data
-	for(int Index = 0; Index < g_DataReader.NumData(); Index++)
+	for(int Index = 0; Index < m_DataReader.NumData(); Index++)
 	{
-		void *pData = g_DataReader.GetData(Index);
-		int Size = g_DataReader.GetDataSize(Index);
-		g_DataWriter.AddData(Size, pData);
+		void *pData = m_DataReader.GetData(Index);
+		int Size = m_DataReader.GetDataSize(Index);
+		m_DataWriter.AddData(Size, pData);
 	}
 
-	for(int Index = 0; Index < g_Index; Index++)
+	for(int Index = 0; Index < m_Index; Index++)
 	{
-		g_DataWriter.AddData(g_aNewDataSize[Index], g_apNewData[Index]);
+		m_DataWriter.AddData(m_aNewDataSize[Index], m_apNewData[Index]);
+	}
+
+	m_DataReader.Close();
+	m_DataWriter.Finish();
+	return Success;
+}
+
+int main(int argc, const char **argv)
+{
+	CCmdlineFix CmdlineFix(&argc, &argv);
+	log_set_global_logger_default();
+
+	if(argc < 2 || argc > 4 || (argc == 4 && !fs_is_dir(argv[1])))
+	{
+		dbg_msg("map_convert_07", "Invalid arguments");
+		dbg_msg("map_convert_07", "Usage: map_convert_07 <source map filepath> [<dest map filepath>]");
+		dbg_msg("map_convert_07", "Usage: map_convert_07 <source directory> [<dest directory>] [<threads>]");
+		return -1;
+	}
+
+	std::unique_ptr<IStorage> pStorage = std::unique_ptr<IStorage>(CreateStorage(IStorage::EInitializationType::BASIC, argc, argv));
+	if(!pStorage)
+	{
+		log_error("map_convert_07", "Error creating basic storage");
+		return -1;
+	}
+
+	if(fs_is_dir(argv[1]))
+	{
+		struct SNoWorkerState
+		{
+		};
+		const bool Success = RunMapBatch<SNoWorkerState>("map_convert_07", argv[1], argc >= 3 ? argv[2] : "data/maps7", MapBatchThreads(argc == 4 ? argv[3] : nullptr), [&](SNoWorkerState &, const CMapBatchItem &Item) {
+			CMapConverter07 Converter;
+			return Converter.Convert(pStorage.get(), Item.m_aSource, Item.m_aDestination);
+		});
+		return Success ? 0 : -1;
+	}
+
+	const char *pSourceFileName = argv[1];
+	char aDestFileName[IO_MAX_PATH_LENGTH];
+
+	if(argc == 3)
+	{
+		str_copy(aDestFileName, argv[2], sizeof(aDestFileName));
+	}
+	else
+	{
+		char aBuf[IO_MAX_PATH_LENGTH];
+		IStorage::StripPathAndExtension(pSourceFileName, aBuf, sizeof(aBuf));
+		str_format(aDestFileName, sizeof(aDestFileName), "data/maps7/%s.map", aBuf);
+		if(fs_makedir("data") != 0)
+		{
+			dbg_msg("map_convert_07", "failed to create data directory");
+			return -1;
+		}
+
+		if(fs_makedir("data/maps7") != 0)
+		{
+			dbg_msg("map_convert_07", "failed to create data/maps7 directory");
+			return -1;
+		}
 	}
 
-	g_DataReader.Close();
-	g_DataWriter.Finish();
-	return Success ? 0 : -1;
+	CMapConverter07 Converter;
+	return Converter.Convert(pStorage.get(), pSourceFileName, aDestFileName) ? 0 : -1;
 }
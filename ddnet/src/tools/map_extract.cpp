@@ -9,6 +9,8 @@
 
 #include <game/mapitems.h>
 
+#include "map_batch.h"
+
 static void PrintMapInfo(CDataFileReader &Reader)
 {
 	const CMapItemInfo *pInfo = static_cast<CMapItemInfo *>(Reader.FindItem(MAPITEMTYPE_INFO, 0));
@@ -147,16 +149,38 @@ int main(int argc, const char *argv[])
 	{
 		pDir = ".";
 	}
-	else if(argc == 3)
+	else if(argc == 3 || (argc == 4 && fs_is_dir(argv[1])))
 	{
 		pDir = argv[2];
 	}
 	else
 	{
 		log_error("map_extract", "usage: %s <map> [directory]", argv[0]);
+		log_error("map_extract", "usage: %s <map directory> [directory] [threads]", argv[0]);
 		return -1;
 	}
 
+	if(fs_is_dir(argv[1]))
+	{
+		// every map is extracted into its own subdirectory
+		struct SNoWorkerState
+		{
+		};
+		const bool Success = RunMapBatch<SNoWorkerState>("map_extract", argv[1], pDir, MapBatchThreads(argc == 4 ? argv[3] : nullptr), [&](SNoWorkerState &, CMapBatchItem &Item) {
+			char aMapDir[IO_MAX_PATH_LENGTH];
+			str_truncate(aMapDir, sizeof(aMapDir), Item.m_aDestination, str_length(Item.m_aDestination) - str_length(".map"));
+			if(fs_makedir(aMapDir) != 0)
+			{
+				log_error("map_extract", "failed to create directory '%s'", aMapDir);
+				return false;
+			}
+			const bool Result = ExtractMap(pStorage.get(), Item.m_aSource, aMapDir);
+			Item.m_DestinationSize = MapBatchOutputSize(aMapDir);
+			return Result;
+		});
+		return Success ? 0 : 1;
+	}
+
 	if(!fs_is_dir(pDir))
 	{
 		log_error("map_extract", "directory '%s' does not exist", pDir);
@@ -8,6 +8,8 @@
 #include <game/mapitems.h>
 #include <vector>
 
+#include "map_batch.h"
+
 static void ClearTransparentPixels(uint8_t *pImg, int Width, int Height)
 {
 	for(int y = 0; y < Height; ++y)
@@ -60,63 +62,48 @@ static void ClearPixelsTile(uint8_t *pImg, int Width, int Height, int TileIndex)
 	}
 }
 
-static void GetImageSHA256(uint8_t *pImgBuff, int ImgSize, int Width, int Height, char *pSHA256Str, size_t SHA256StrSize)
+static void GetImageSHA256(uint8_t *pImgBuff, int ImgSize, int Width, int Height, char *pSHA256Str, size_t SHA256StrSize, std::vector<uint8_t> &vBuffer)
 {
-	uint8_t *pNewImgBuff = (uint8_t *)malloc(ImgSize);
+	vBuffer.resize(ImgSize);
+	uint8_t *pNewImgBuff = vBuffer.data();
 
 	// Clear fully transparent pixels, so the SHA is easier to identify with the original image
 	CopyOpaquePixels(pNewImgBuff, pImgBuff, Width, Height);
 	SHA256_DIGEST SHAStr = sha256(pNewImgBuff, (size_t)ImgSize);
 
 	sha256_str(SHAStr, pSHA256Str, SHA256StrSize);
-
-	free(pNewImgBuff);
 }
 
-int main(int argc, const char **argv)
+struct SMapOptimizeItem
 {
-	CCmdlineFix CmdlineFix(&argc, &argv);
-	log_set_global_logger_default();
-
-	std::unique_ptr<IStorage> pStorage = std::unique_ptr<IStorage>(CreateStorage(IStorage::EInitializationType::BASIC, argc, argv));
-	if(!pStorage)
-	{
-		log_error("map_optimize", "Error creating basic storage");
-		return -1;
-	}
-	if(argc <= 1 || argc > 3)
-	{
-		dbg_msg("map_optimize", "Usage: map_optimize <source map filepath> [<dest map filepath>]");
-		return -1;
-	}
-
-	char aFileName[IO_MAX_PATH_LENGTH];
-	if(argc == 3)
-	{
-		str_format(aFileName, sizeof(aFileName), "out/%s", argv[2]);
-
-		fs_makedir_rec_for(aFileName);
-	}
-	else
-	{
-		fs_makedir("out");
-		char aBuff[IO_MAX_PATH_LENGTH];
-		IStorage::StripPathAndExtension(argv[1], aBuff, sizeof(aBuff));
-		str_format(aFileName, sizeof(aFileName), "out/%s.map", aBuff);
-	}
+	CMapItemImage *m_pImage;
+	int m_Index;
+	int m_Data;
+	int m_Text;
+};
+
+// Buffers reused between the maps optimized by the same thread
+struct SMapOptimizeBuffers
+{
+	std::vector<SMapOptimizeItem> m_vDataFindHelper;
+	std::vector<uint8_t> m_vImage;
+	std::vector<uint8_t> m_vHashImage;
+};
 
+static bool OptimizeMap(IStorage *pStorage, const char *pSourceFileName, const char *pDestFileName, SMapOptimizeBuffers &Buffers)
+{
 	CDataFileReader Reader;
-	if(!Reader.Open(pStorage.get(), argv[1], IStorage::TYPE_ABSOLUTE))
+	if(!Reader.Open(pStorage, pSourceFileName, IStorage::TYPE_ABSOLUTE))
 	{
-		dbg_msg("map_optimize", "Failed to open source file.");
-		return -1;
+		dbg_msg("map_optimize", "Failed to open source file '%s'.", pSourceFileName);
+		return false;
 	}
 
 	CDataFileWriter Writer;
-	if(!Writer.Open(pStorage.get(), aFileName, IStorage::TYPE_ABSOLUTE))
+	if(!Writer.Open(pStorage, pDestFileName, IStorage::TYPE_ABSOLUTE))
 	{
-		dbg_msg("map_optimize", "Failed to open target file.");
-		return -1;
+		dbg_msg("map_optimize", "Failed to open target file '%s'.", pDestFileName);
+		return false;
 	}
 
 	int aImageFlags[MAX_MAPIMAGES] = {
@@ -129,15 +116,8 @@ int main(int argc, const char **argv)
 		},
 	};
 
-	struct SMapOptimizeItem
-	{
-		CMapItemImage *m_pImage;
-		int m_Index;
-		int m_Data;
-		int m_Text;
-	};
-
-	std::vector<SMapOptimizeItem> vDataFindHelper;
+	std::vector<SMapOptimizeItem> &vDataFindHelper = Buffers.m_vDataFindHelper;
+	vDataFindHelper.clear();
 
 	// add all items
 	for(int Index = 0, i = 0; Index < Reader.NumItems(); Index++)
@@ -215,7 +195,6 @@ int main(int argc, const char **argv)
 	// add all data
 	for(int Index = 0; Index < Reader.NumData(); Index++)
 	{
-		bool DeletePtr = false;
 		void *pPtr = Reader.GetData(Index);
 		int Size = Reader.GetDataSize(Index);
 		auto it = std::find_if(vDataFindHelper.begin(), vDataFindHelper.end(), [Index](const SMapOptimizeItem &Other) -> bool { return Other.m_Data == Index || Other.m_Text == Index; });
@@ -227,12 +206,11 @@ int main(int argc, const char **argv)
 			int ImageIndex = it->m_Index;
 			if(it->m_Data == Index)
 			{
-				DeletePtr = true;
 				// optimize embedded images
 				// use a new pointer, to be safe, when using the original image data
-				void *pNewPtr = malloc(Size);
-				mem_copy(pNewPtr, pPtr, Size);
-				pPtr = pNewPtr;
+				Buffers.m_vImage.resize(Size);
+				mem_copy(Buffers.m_vImage.data(), pPtr, Size);
+				pPtr = Buffers.m_vImage.data();
 				uint8_t *pImgBuff = (uint8_t *)pPtr;
 
 				bool DoClearTransparentPixels = false;
@@ -298,28 +276,66 @@ int main(int argc, const char **argv)
 				char aSHA256Str[SHA256_MAXSTRSIZE];
 				// This is the important function, that calculates the SHA256 in a special way
 				// Please read the comments inside the functions to understand it
-				GetImageSHA256(pImgBuff, ImgSize, Width, Height, aSHA256Str, sizeof(aSHA256Str));
+				GetImageSHA256(pImgBuff, ImgSize, Width, Height, aSHA256Str, sizeof(aSHA256Str), Buffers.m_vHashImage);
 
+				// make the new name ready
 				char aNewName[IO_MAX_PATH_LENGTH];
 				int StrLen = str_format(aNewName, std::size(aNewName), "%s_cut_%s", pImgName, aSHA256Str);
-
-				DeletePtr = true;
-				// make the new name ready
-				char *pNewPtr = (char *)malloc(StrLen + 1);
-				str_copy(pNewPtr, aNewName, StrLen + 1);
-				pPtr = pNewPtr;
-				Size = StrLen + 1;
+				Writer.AddData(StrLen + 1, aNewName, CDataFileWriter::COMPRESSION_BEST);
+				continue;
 			}
 		}
 
 		Writer.AddData(Size, pPtr, CDataFileWriter::COMPRESSION_BEST);
-
-		if(DeletePtr)
-			free(pPtr);
 	}
 
 	Reader.Close();
 	Writer.Finish();
 
-	return 0;
+	return true;
+}
+
+int main(int argc, const char **argv)
+{
+	CCmdlineFix CmdlineFix(&argc, &argv);
+	log_set_global_logger_default();
+
+	std::unique_ptr<IStorage> pStorage = std::unique_ptr<IStorage>(CreateStorage(IStorage::EInitializationType::BASIC, argc, argv));
+	if(!pStorage)
+	{
+		log_error("map_optimize", "Error creating basic storage");
+		return -1;
+	}
+	if(argc <= 1 || argc > 4 || (argc == 4 && !fs_is_dir(argv[1])))
+	{
+		dbg_msg("map_optimize", "Usage: map_optimize <source map filepath> [<dest map filepath>]");
+		dbg_msg("map_optimize", "Usage: map_optimize <source directory> [<dest directory>] [<threads>]");
+		return -1;
+	}
+
+	if(fs_is_dir(argv[1]))
+	{
+		const bool Success = RunMapBatch<SMapOptimizeBuffers>("map_optimize", argv[1], argc >= 3 ? argv[2] : "out", MapBatchThreads(argc == 4 ? argv[3] : nullptr), [&](SMapOptimizeBuffers &Buffers, const CMapBatchItem &Item) {
+			return OptimizeMap(pStorage.get(), Item.m_aSource, Item.m_aDestination, Buffers);
+		});
+		return Success ? 0 : -1;
+	}
+
+	char aFileName[IO_MAX_PATH_LENGTH];
+	if(argc == 3)
+	{
+		str_format(aFileName, sizeof(aFileName), "out/%s", argv[2]);
+
+		fs_makedir_rec_for(aFileName);
+	}
+	else
+	{
+		fs_makedir("out");
+		char aBuff[IO_MAX_PATH_LENGTH];
+		IStorage::StripPathAndExtension(argv[1], aBuff, sizeof(aBuff));
+		str_format(aFileName, sizeof(aFileName), "out/%s.map", aBuff);
+	}
+
+	SMapOptimizeBuffers Buffers;
+	return OptimizeMap(pStorage.get(), argv[1], aFileName, Buffers) ? 0 : -1;
 }
@@ -7,6 +7,8 @@
 #include <engine/shared/datafile.h>
 #include <engine/storage.h>
 
+#include "map_batch.h"
+
 static const char *TOOL_NAME = "map_resave";
 
 static int ResaveMap(const char *pSourceMap, const char *pDestinationMap, IStorage *pStorage)
@@ -62,9 +64,10 @@ int main(int argc, const char **argv)
 	CCmdlineFix CmdlineFix(&argc, &argv);
 	log_set_global_logger_default();
 
-	if(argc != 3)
+	if(argc < 3 || argc > 4 || (argc == 4 && !fs_is_dir(argv[1])))
 	{
 		log_error(TOOL_NAME, "Usage: %s <source map> <destination map>", TOOL_NAME);
+		log_error(TOOL_NAME, "Usage: %s <source directory> <destination directory> [<threads>]", TOOL_NAME);
 		return -1;
 	}
 
@@ -75,5 +78,16 @@ int main(int argc, const char **argv)
 		return -1;
 	}
 
+	if(fs_is_dir(argv[1]))
+	{
+		struct SNoWorkerState
+		{
+		};
+		const bool Success = RunMapBatch<SNoWorkerState>(TOOL_NAME, argv[1], argv[2], MapBatchThreads(argc == 4 ? argv[3] : nullptr), [&](SNoWorkerState &, const CMapBatchItem &Item) {
+			return ResaveMap(Item.m_aSource, Item.m_aDestination, pStorage.get()) == 0;
+		});
+		return Success ? 0 : -1;
+	}
+
 	return ResaveMap(argv[1], argv[2], pStorage.get());
 }
@@ -0,0 +1,65 @@
+#include <base/logger.h>
+#include <base/math.h>
+#include <base/system.h>
+
+#include <engine/server/name_ban.h>
+
+#include <game/prng.h>
+
+#include <array>
+#include <vector>
+
+// Checks random player names against a large synthetic list of name bans,
+// like the server does for every joining or renaming player
+
+static void RandomName(CPrng &Prng, char *pName, int Size)
+{
+	static const char s_aLetters[] = "abcdefghijklmnopqrstuvwxyz0123456789_ ";
+	const int Length = 3 + Prng.RandomBits() % minimum(Size - 4, 12);
+	for(int i = 0; i < Length; i++)
+		pName[i] = s_aLetters[Prng.RandomBits() % (sizeof(s_aLetters) - 1)];
+	pName[Length] = '\0';
+}
+
+int main(int argc, const char **argv)
+{
+	CCmdlineFix CmdlineFix(&argc, &argv);
+	log_set_global_logger_default();
+
+	if(argc > 3)
+	{
+		log_error("name_ban_benchmark", "Usage: %s [<bans>] [<lookups>]", argv[0]);
+		return -1;
+	}
+	const int NumBans = argc >= 2 ? maximum(str_toint(argv[1]), 1) : 5000;
+	const int NumLookups = argc >= 3 ? maximum(str_toint(argv[2]), 1) : 2000;
+
+	uint64_t aSeed[2] = {1, 2};
+	CPrng Prng;
+	Prng.Seed(aSeed);
+
+	// distances like the default of name_ban, a few substring bans
+	CNameBans Bans;
+	int64_t StartTime = time_get();
+	for(int i = 0; i < NumBans; i++)
+	{
+		char aName[MAX_NAME_LENGTH];
+		RandomName(Prng, aName, sizeof(aName));
+		Bans.Ban(aName, "", str_length(aName) / 3, i % 100 == 0);
+	}
+	const double BanMilliseconds = (time_get() - StartTime) * 1000.0 / time_freq();
+
+	std::vector<std::array<char, MAX_NAME_LENGTH>> vNames(NumLookups);
+	for(auto &Name : vNames)
+		RandomName(Prng, Name.data(), Name.size());
+
+	int NumBanned = 0;
+	StartTime = time_get();
+	for(const auto &Name : vNames)
+		NumBanned += Bans.IsBanned(Name.data()) != nullptr;
+	const double LookupMilliseconds = (time_get() - StartTime) * 1000.0 / time_freq();
+
+	log_info("name_ban_benchmark", "added %d bans in %.2fms", NumBans, BanMilliseconds);
+	log_info("name_ban_benchmark", "checked %d names in %.2fms (%.2fus per name), %d banned", NumLookups, LookupMilliseconds, LookupMilliseconds * 1000.0 / NumLookups, NumBanned);
+	return 0;
+}
@@ -0,0 +1,77 @@
+#include <base/logger.h>
+#include <base/math.h>
+#include <base/system.h>
+
+#include <engine/client/sound_mix.h>
+
+#include <game/prng.h>
+
+#include <vector>
+
+// Mixes a crowded scene of voices like the audio callback of the client does, without an audio device
+
+static const int NUM_VOICES = 256;
+static const int SAMPLE_FRAMES = 48000;
+
+int main(int argc, const char **argv)
+{
+	CCmdlineFix CmdlineFix(&argc, &argv);
+	log_set_global_logger_default();
+
+	if(argc > 3)
+	{
+		log_error("sound_mix_benchmark", "Usage: %s [<buffer frames>] [<callbacks>]", argv[0]);
+		return -1;
+	}
+	const unsigned BufferFrames = argc >= 2 ? maximum(str_toint(argv[1]), 1) : 512;
+	const int Callbacks = argc >= 3 ? maximum(str_toint(argv[2]), 1) : 2000;
+
+	uint64_t aSeed[2] = {1, 2};
+	CPrng Prng;
+	Prng.Seed(aSeed);
+
+	// half of the voices are mono, half are stereo, like map sounds and game sounds
+	std::vector<short> vMonoSample(SAMPLE_FRAMES);
+	std::vector<short> vStereoSample(SAMPLE_FRAMES * 2);
+	for(short &Value : vMonoSample)
+		Value = Prng.RandomBits();
+	for(short &Value : vStereoSample)
+		Value = Prng.RandomBits();
+
+	int aVoiceTicks[NUM_VOICES];
+	int aVoiceVolumes[NUM_VOICES][2];
+	for(int i = 0; i < NUM_VOICES; i++)
+	{
+		aVoiceTicks[i] = Prng.RandomBits() % SAMPLE_FRAMES;
+		aVoiceVolumes[i][0] = Prng.RandomBits() % 256;
+		aVoiceVolumes[i][1] = Prng.RandomBits() % 256;
+	}
+
+	std::vector<int> vMixBuffer(BufferFrames * 2);
+	std::vector<short> vFinalOut(BufferFrames * 2);
+
+	int64_t MixedFrames = 0;
+	const int64_t StartTime = time_get();
+	for(int Callback = 0; Callback < Callbacks; Callback++)
+	{
+		mem_zero(vMixBuffer.data(), vMixBuffer.size() * sizeof(int));
+		for(int i = 0; i < NUM_VOICES; i++)
+		{
+			const bool Mono = i % 2 == 0;
+			const int Channels = Mono ? 1 : 2;
+			const short *pData = Mono ? vMonoSample.data() : vStereoSample.data();
+			const unsigned Frames = minimum<unsigned>(BufferFrames, SAMPLE_FRAMES - aVoiceTicks[i]);
+			SoundMixVoice(vMixBuffer.data(), &pData[aVoiceTicks[i] * Channels], Channels, Frames, aVoiceVolumes[i][0], aVoiceVolumes[i][1]);
+			aVoiceTicks[i] = (aVoiceTicks[i] + Frames) % SAMPLE_FRAMES;
+			MixedFrames += Frames;
+		}
+		SoundMixClamp(vFinalOut.data(), vMixBuffer.data(), BufferFrames * 2, 100);
+	}
+	const int64_t Duration = time_get() - StartTime;
+
+	const double Milliseconds = Duration * 1000.0 / time_freq();
+	const double VoicesPerMillisecond = (double)NUM_VOICES * Callbacks / Milliseconds;
+	log_info("sound_mix_benchmark", "mixed %d callbacks of %u frames with %d voices in %.2fms", Callbacks, BufferFrames, NUM_VOICES, Milliseconds);
+	log_info("sound_mix_benchmark", "%.1f voices/ms, %.1f frames/ms, %.1fus per callback", VoicesPerMillisecond, MixedFrames / Milliseconds, Milliseconds * 1000.0 / Callbacks);
+	return 0;
+}
@@ -0,0 +1,128 @@
+#include <base/logger.h>
+#include <base/math.h>
+#include <base/system.h>
+
+#include <game/editor/tile_state_change_history.h>
+#include <game/mapitems.h>
+
+#include <map>
+#include <vector>
+
+// Records the tile changes of filling and automapping a large layer like the editor does,
+// and undoes and redoes them, with the tree of maps used before and the chunked history
+
+static const char *TOOL_NAME = "tile_history_benchmark";
+
+struct SBenchmarkStateChange
+{
+	CTile m_Previous;
+	CTile m_Current;
+};
+
+template<typename T>
+using TreeHistory = std::map<int, std::map<int, T>>;
+
+static double Milliseconds(int64_t Start)
+{
+	return (time_get() - Start) * 1000.0 / time_freq();
+}
+
+static CTile FillTile(int x, int y, int Pass)
+{
+	return CTile{(unsigned char)((x + y + Pass) % 255 + 1), 0, 0, 0};
+}
+
+int main(int argc, const char **argv)
+{
+	CCmdlineFix CmdlineFix(&argc, &argv);
+	log_set_global_logger_default();
+
+	if(argc > 3)
+	{
+		log_error(TOOL_NAME, "Usage: %s [<width>] [<height>]", argv[0]);
+		return -1;
+	}
+	const int Width = argc >= 2 ? maximum(str_toint(argv[1]), 1) : 1000;
+	const int Height = argc >= 3 ? maximum(str_toint(argv[2]), 1) : 1000;
+	std::vector<CTile> vTiles((size_t)Width * Height);
+
+	// fill, then change every tile again like automapping after the fill
+	{
+		int64_t Start = time_get();
+		TreeHistory<SBenchmarkStateChange> History;
+		for(int Pass = 0; Pass < 2; Pass++)
+		{
+			for(int y = 0; y < Height; y++)
+			{
+				for(int x = 0; x < Width; x++)
+				{
+					CTile &Tile = vTiles[y * Width + x];
+					const CTile Previous = Tile;
+					Tile = FillTile(x, y, Pass);
+					if(!History[y].count(x))
+						History[y][x] = SBenchmarkStateChange{Previous, Tile};
+					else
+						History[y][x].m_Current = Tile;
+				}
+			}
+		}
+		// the action used to copy the history of the layer
+		TreeHistory<SBenchmarkStateChange> Action = History;
+		History.clear();
+		const double RecordTime = Milliseconds(Start);
+
+		Start = time_get();
+		for(int Undo = 1; Undo >= 0; Undo--)
+		{
+			for(const auto &[y, Line] : Action)
+				for(const auto &[x, Change] : Line)
+					vTiles[y * Width + x] = Undo ? Change.m_Previous : Change.m_Current;
+		}
+		const double ApplyTime = Milliseconds(Start);
+
+		Start = time_get();
+		{
+			TreeHistory<SBenchmarkStateChange> Destroy = std::move(Action);
+		}
+		log_info(TOOL_NAME, "tree:    record %.2fms, undo and redo %.2fms, free %.2fms", RecordTime, ApplyTime, Milliseconds(Start));
+	}
+
+	std::fill(vTiles.begin(), vTiles.end(), CTile{0, 0, 0, 0});
+	{
+		int64_t Start = time_get();
+		CTileStateChangeHistory<SBenchmarkStateChange> History;
+		for(int Pass = 0; Pass < 2; Pass++)
+		{
+			for(int y = 0; y < Height; y++)
+			{
+				for(int x = 0; x < Width; x++)
+				{
+					CTile &Tile = vTiles[y * Width + x];
+					const CTile Previous = Tile;
+					Tile = FillTile(x, y, Pass);
+					History.Record(x, y, Previous, Tile);
+				}
+			}
+		}
+		CTileStateChangeHistory<SBenchmarkStateChange> Action = std::move(History);
+		const double RecordTime = Milliseconds(Start);
+
+		Start = time_get();
+		for(int Undo = 1; Undo >= 0; Undo--)
+		{
+			Action.ForEach([&](int x, int y, const SBenchmarkStateChange &Change) {
+				vTiles[y * Width + x] = Undo ? Change.m_Previous : Change.m_Current;
+			});
+		}
+		const double ApplyTime = Milliseconds(Start);
+
+		Start = time_get();
+		{
+			CTileStateChangeHistory<SBenchmarkStateChange> Destroy = std::move(Action);
+		}
+		log_info(TOOL_NAME, "chunked: record %.2fms, undo and redo %.2fms, free %.2fms", RecordTime, ApplyTime, Milliseconds(Start));
+	}
+
+	log_info(TOOL_NAME, "%d changed tiles of a %dx%d layer", Width * Height, Width, Height);
+	return 0;
+}